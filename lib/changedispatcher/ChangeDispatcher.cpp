@@ -0,0 +1,55 @@
+/*
+ * ChangeDispatcher.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "ChangeDispatcher.h"
+
+ChangeDispatcher::ChangeDispatcher(GPIOHandler &gpio) :
+		gpio(&gpio) {
+}
+
+ChangeDispatcher::~ChangeDispatcher() {
+
+}
+
+void ChangeDispatcher::onChange(const change_listener listener) {
+	change_listeners.push_back(listener);
+}
+
+void ChangeDispatcher::onConfigChange(const config_listener listener) {
+	config_listeners.push_back(listener);
+}
+
+void ChangeDispatcher::clearListeners() {
+	change_listeners.clear();
+	config_listeners.clear();
+}
+
+size_t ChangeDispatcher::dispatch() {
+	size_t dispatched = 0;
+	pin_change change;
+	while (gpio->getNextChange(change)) {
+		for (const change_listener &listener : change_listeners) {
+			listener(change);
+		}
+		dispatched++;
+	}
+	dispatched_changes += dispatched;
+
+	const uint32_t current_version = gpio->getConfigVersion();
+	if (current_version != config_version) {
+		config_version = current_version;
+		for (const config_listener &listener : config_listeners) {
+			listener();
+		}
+	}
+
+	return dispatched;
+}
+
+uint32_t ChangeDispatcher::getDispatchedChanges() const {
+	return dispatched_changes;
+}
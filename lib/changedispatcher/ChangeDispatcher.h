@@ -0,0 +1,109 @@
+/*
+ * ChangeDispatcher.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_CHANGEDISPATCHER_CHANGEDISPATCHER_H_
+#define LIB_CHANGEDISPATCHER_CHANGEDISPATCHER_H_
+
+#include "GPIOHandler.h"
+#include <functional>
+#include <vector>
+
+/**
+ * The single consumer of the change queue of a GPIOHandler.
+ *
+ * Reads every queued pin change once, and passes it to each registered change listener.
+ * Also notifies the registered config listeners once the pin configuration version changed.
+ * This way the web server, the MQTT handler, and the Influx exporter don't need to know about each other.
+ */
+class ChangeDispatcher {
+public:
+	/**
+	 * A function handling a single pin change.
+	 */
+	typedef std::function<void(const pin_change &change)> change_listener;
+
+	/**
+	 * A function handling a change of the pin configuration.
+	 */
+	typedef std::function<void()> config_listener;
+
+	/**
+	 * Creates a new ChangeDispatcher without any listeners.
+	 *
+	 * @param gpio	The GPIOHandler whose changes to dispatch.
+	 */
+	ChangeDispatcher(GPIOHandler &gpio = gpio_handler);
+
+	/**
+	 * Destroys this ChangeDispatcher.
+	 */
+	virtual ~ChangeDispatcher();
+
+	/**
+	 * Adds a listener to call for every pin change.
+	 * Listeners are called in the order they were added.
+	 *
+	 * @param listener	The listener to add.
+	 */
+	void onChange(const change_listener listener);
+
+	/**
+	 * Adds a listener to call when the pin configuration changed.
+	 * Listeners are called in the order they were added.
+	 *
+	 * @param listener	The listener to add.
+	 */
+	void onConfigChange(const config_listener listener);
+
+	/**
+	 * Removes all change and config listeners.
+	 */
+	void clearListeners();
+
+	/**
+	 * Passes all queued pin changes of the GPIOHandler to the change listeners,
+	 * and notifies the config listeners if the pin configuration changed since the last call.
+	 * Has to be called regularly from the main loop.
+	 *
+	 * @return	The number of dispatched pin changes.
+	 */
+	size_t dispatch();
+
+	/**
+	 * Gets the total number of pin changes dispatched by this ChangeDispatcher.
+	 *
+	 * @return	The number of dispatched pin changes.
+	 */
+	uint32_t getDispatchedChanges() const;
+private:
+	/**
+	 * The GPIOHandler whose changes to dispatch.
+	 */
+	GPIOHandler *gpio;
+
+	/**
+	 * The listeners to call for every pin change.
+	 */
+	std::vector<change_listener> change_listeners;
+
+	/**
+	 * The listeners to call when the pin configuration changed.
+	 */
+	std::vector<config_listener> config_listeners;
+
+	/**
+	 * The GPIOHandler config version the config listeners were last notified of.
+	 */
+	uint32_t config_version = 0;
+
+	/**
+	 * The total number of dispatched pin changes.
+	 */
+	uint32_t dispatched_changes = 0;
+};
+
+#endif /* LIB_CHANGEDISPATCHER_CHANGEDISPATCHER_H_ */
@@ -10,9 +10,11 @@
 
 GPIOHandler gpio_handler(&storage_handler);
 
-GPIOHandler::GPIOHandler(StorageHandler *handler) {
+GPIOHandler::GPIOHandler(StorageHandler *handler) :
+		change_sequence(0) {
 	storage = handler;
 	debouncing_states.reserve(20);
+	change_queue = xQueueCreate(CHANGE_QUEUE_LENGTH, sizeof(pin_change));
 	timer_init(DEBOUNCE_TIMER.group, DEBOUNCE_TIMER.timer, &debounce_timer_config);
 	timer_enable_intr(DEBOUNCE_TIMER.group, DEBOUNCE_TIMER.timer);
 	timer_isr_register(DEBOUNCE_TIMER.group, DEBOUNCE_TIMER.timer, timerInterrupt, this, 0, NULL);
@@ -22,6 +24,7 @@ GPIOHandler::GPIOHandler(StorageHandler *handler) {
 GPIOHandler::~GPIOHandler() {
 	timer_isr_register(DEBOUNCE_TIMER.group, DEBOUNCE_TIMER.timer, NULL, NULL, 0, NULL);
 	timer_disable_intr(DEBOUNCE_TIMER.group, DEBOUNCE_TIMER.timer);
+	vQueueDelete(change_queue);
 }
 
 gpio_err_t GPIOHandler::registerGPIO(const uint8_t pin, String name, const bool pull_up) {
@@ -39,20 +42,13 @@ gpio_err_t GPIOHandler::registerGPIO(const uint8_t pin, String name, const bool
 		return GPIO_NAME_INVALID;
 	}
 
-	if (pull_up) {
-		pinMode(pin, INPUT_PULLUP);
-	} else {
-		pinMode(pin, INPUT_PULLDOWN);
-	}
-
-	pin_state state(this, pin, name, pull_up, digitalRead(pin) == HIGH);
-
-	watched.insert(std::pair<uint8_t, pin_state>(pin, state));
-
-	if (interrupts) {
-		attachInterruptArg(pin, pinInterrupt, &watched.at(pin), CHANGE);
-	}
+	pin_state state(this, pin, name, pull_up, false);
+	pin_state &inserted = watched.insert(
+			std::pair<uint8_t, pin_state>(pin, state)).first->second;
+	configurePin(&inserted, true);
+	inserted.sequence = nextSequence();
 
+	config_version++;
 	writeToStorageHandler(true);
 	return GPIO_OK;
 }
@@ -73,10 +69,102 @@ gpio_err_t GPIOHandler::unregisterGPIO(const uint8_t pin) {
 
 	watched.erase(pin);
 	detachInterrupt(pin);
+	change_stats.erase(pin);
+	nextSequence();
+	config_version++;
 	writeToStorageHandler(true);
 	return GPIO_OK;
 }
 
+gpio_err_t GPIOHandler::configurePins(const std::vector<pin_config> &pins,
+		std::vector<gpio_err_t> *results, const bool remove_missing) {
+	std::map<uint8_t, pin_config> desired;
+	gpio_err_t result = GPIO_OK;
+	if (results != NULL) {
+		results->assign(pins.size(), GPIO_OK);
+	}
+
+	for (size_t i = 0; i < pins.size(); i++) {
+		const pin_config &config = pins[i];
+		gpio_err_t err = isValidPin(config.number);
+		pin_config trimmed = config;
+		trimmed.name.trim();
+		if (err == GPIO_OK && desired.count(config.number) > 0) {
+			err = GPIO_PIN_DUPLICATE;
+		} else if (err == GPIO_OK && !isValidName(trimmed.name)) {
+			err = GPIO_NAME_INVALID;
+		}
+
+		if (results != NULL) {
+			(*results)[i] = err;
+		}
+
+		if (err == GPIO_OK) {
+			desired.insert(std::pair<uint8_t, pin_config>(config.number, trimmed));
+		} else if (result == GPIO_OK) {
+			result = err;
+		}
+	}
+
+	if (result != GPIO_OK) {
+		return result;
+	}
+
+	bool changed = false;
+	if (remove_missing) {
+		for (std::map<uint8_t, pin_state>::iterator it = watched.begin(); it != watched.end();) {
+			if (desired.count(it->first) > 0) {
+				it++;
+				continue;
+			}
+
+			debouncing_states.erase(
+					std::remove(debouncing_states.begin(), debouncing_states.end(),
+							&it->second), debouncing_states.end());
+			detachInterrupt(it->first);
+			change_stats.erase(it->first);
+			it = watched.erase(it);
+			nextSequence();
+			changed = true;
+		}
+	}
+
+	for (std::pair<const uint8_t, pin_config> &entry : desired) {
+		const pin_config &config = entry.second;
+		std::map<uint8_t, pin_state>::iterator it = watched.find(config.number);
+		if (it == watched.end()) {
+			pin_state state(this, config.number, config.name, config.pull_up, false);
+			pin_state &inserted = watched.insert(
+					std::pair<uint8_t, pin_state>(config.number, state)).first->second;
+			configurePin(&inserted, true);
+			inserted.sequence = nextSequence();
+			changed = true;
+			continue;
+		}
+
+		pin_state &state = it->second;
+		if (state.pull_up != config.pull_up) {
+			state.pull_up = config.pull_up;
+			configurePin(&state);
+			updatePin(&state);
+			state.sequence = nextSequence();
+			changed = true;
+		}
+
+		if (state.name != config.name) {
+			state.name = config.name;
+			state.sequence = nextSequence();
+			changed = true;
+		}
+	}
+
+	if (changed) {
+		config_version++;
+		writeToStorageHandler(true);
+	}
+	return GPIO_OK;
+}
+
 gpio_err_t GPIOHandler::updateGPIO(const uint8_t pin, String name, const bool pull_up) {
 	gpio_err_t err = isValidPin(pin);
 	if (err != GPIO_OK) {
@@ -89,18 +177,8 @@ gpio_err_t GPIOHandler::updateGPIO(const uint8_t pin, String name, const bool pu
 
 	if (watched.at(pin).pull_up != pull_up) {
 		watched.at(pin).pull_up = pull_up;
-
-		if (pull_up) {
-			pinMode(pin, INPUT_PULLUP);
-		} else {
-			pinMode(pin, INPUT_PULLDOWN);
-		}
-
+		configurePin(&watched.at(pin));
 		updatePin(&watched.at(pin));
-
-		if (interrupts) {
-			attachInterruptArg(pin, pinInterrupt, &watched.at(pin), CHANGE);
-		}
 	}
 
 	return setName(pin, name);
@@ -145,6 +223,34 @@ gpio_err_t GPIOHandler::setChanges(const uint8_t pin, const uint64_t changes) {
 	return GPIO_OK;
 }
 
+gpio_err_t GPIOHandler::getStats(const uint8_t pin, const uint32_t window,
+		pin_stats &stats) const {
+	gpio_err_t err = isValidPin(pin);
+	if (err != GPIO_OK) {
+		return err;
+	}
+
+	if (watched.count(pin) == 0 || watched.at(pin).stats == NULL) {
+		return GPIO_NOT_WATCHED;
+	}
+
+	stats = watched.at(pin).stats->getStats(window, millis());
+	return GPIO_OK;
+}
+
+uint64_t GPIOHandler::getHighTime(const uint8_t pin) const {
+	if (watched.count(pin) == 0) {
+		return UINT64_MAX;
+	}
+
+	const pin_state &state = watched.at(pin);
+	uint64_t high_time = state.high_time;
+	if (state.state) {
+		high_time += millis() - state.last_change;
+	}
+	return high_time;
+}
+
 String GPIOHandler::getName(const uint8_t pin) const {
 	if (watched.count(pin) == 0) {
 		return "";
@@ -169,6 +275,8 @@ gpio_err_t GPIOHandler::setName(const uint8_t pin, String name) {
 	}
 
 	watched.at(pin).name = name;
+	watched.at(pin).sequence = nextSequence();
+	config_version++;
 	writeToStorageHandler(true);
 	return GPIO_OK;
 }
@@ -232,6 +340,30 @@ void GPIOHandler::writeToStorageHandler(bool force) {
 	}
 }
 
+bool GPIOHandler::getNextChange(pin_change &change) {
+	return xQueueReceive(change_queue, &change, 0) == pdTRUE;
+}
+
+uint32_t GPIOHandler::getDroppedChanges() const {
+	return dropped_changes;
+}
+
+uint32_t GPIOHandler::getPinInterrupts() const {
+	return pin_interrupts;
+}
+
+uint32_t GPIOHandler::getTimerInterrupts() const {
+	return timer_interrupts;
+}
+
+uint32_t GPIOHandler::getConfigVersion() const {
+	return config_version;
+}
+
+uint32_t GPIOHandler::getChangeSequence() const {
+	return change_sequence;
+}
+
 gpio_err_t GPIOHandler::isValidPin(const uint8_t pin) {
 	if (!digitalPinIsValid(pin)) {
 		return GPIO_PIN_INVALID;
@@ -250,6 +382,7 @@ void IRAM_ATTR GPIOHandler::pinInterrupt(void *arg) {
 	}
 
 	pin_state *pin = (pin_state *) arg;
+	pin->handler->pin_interrupts++;
 	pin->handler->updatePin(pin);
 }
 
@@ -259,6 +392,7 @@ void IRAM_ATTR GPIOHandler::timerInterrupt(void *arg) {
 	}
 
 	GPIOHandler *handler = (GPIOHandler *) arg;
+	handler->timer_interrupts++;
 	uint16_t next_update = 0;
 	const uint64_t now = millis();
 	pin_state *pin;
@@ -280,10 +414,17 @@ void IRAM_ATTR GPIOHandler::timerInterrupt(void *arg) {
 			}
 
 			if (pin->state != pin->raw_state) {
+				if (pin->state) {
+					pin->high_time += pin->raw_last_change - pin->last_change;
+				}
 				pin->state = pin->raw_state;
 				pin->last_change = pin->raw_last_change;
 				pin->changes++;
+				if (pin->stats != NULL) {
+					pin->stats->recordChange(pin->state, pin->last_change);
+				}
 				pin->handler->dirty = true;
+				handler->queueChange(pin);
 				handler->debouncing_states[i] = NULL;
 			}
 		} else if (next_update == 0 || handler->debounce_timeout + pin->raw_last_change - now < next_update) {
@@ -334,14 +475,62 @@ void IRAM_ATTR GPIOHandler::updatePin(pin_state *pin) {
 
 			startTimer(debounce_timeout);
 		} else {
+			if (pin->state) {
+				pin->high_time += pin->raw_last_change - pin->last_change;
+			}
 			pin->state = state;
 			pin->last_change = pin->raw_last_change;
 			pin->changes++;
+			if (pin->stats != NULL) {
+				pin->stats->recordChange(pin->state, pin->last_change);
+			}
 			dirty = true;
+			queueChange(pin);
 		}
 	}
 }
 
+void IRAM_ATTR GPIOHandler::queueChange(pin_state *pin) {
+	pin->sequence = nextSequence();
+	const pin_change change = { pin->number, pin->state, pin->changes,
+			pin->last_change, pin->sequence };
+	BaseType_t queued;
+	if (xPortInIsrContext()) {
+		queued = xQueueSendFromISR(change_queue, &change, NULL);
+	} else {
+		queued = xQueueSend(change_queue, &change, 0);
+	}
+
+	if (queued != pdTRUE) {
+		dropped_changes++;
+	}
+}
+
+uint32_t IRAM_ATTR GPIOHandler::nextSequence() {
+	return ++change_sequence;
+}
+
+void GPIOHandler::configurePin(pin_state *pin, const bool initialize) {
+	if (pin->pull_up) {
+		pinMode(pin->number, INPUT_PULLUP);
+	} else {
+		pinMode(pin->number, INPUT_PULLDOWN);
+	}
+
+	if (initialize) {
+		pin->state = pin->raw_state = digitalRead(pin->number) == HIGH;
+		// Used as the reference point for the time spent high.
+		pin->last_change = millis();
+		std::unique_ptr<PinStats> &entry = change_stats[pin->number];
+		entry.reset(new PinStats(pin->state, pin->last_change));
+		pin->stats = entry.get();
+	}
+
+	if (interrupts) {
+		attachInterruptArg(pin->number, pinInterrupt, pin, CHANGE);
+	}
+}
+
 void IRAM_ATTR GPIOHandler::startTimer(const uint16_t delay) {
 	uint64_t counter_val;
 	timer_get_counter_value(DEBOUNCE_TIMER.group, DEBOUNCE_TIMER.timer, &counter_val);
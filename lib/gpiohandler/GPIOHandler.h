@@ -9,8 +9,13 @@
 #define LIB_GPIOHANDLER_GPIOHANDLER_H_
 
 #include <Arduino.h>
+#include "PinStats.h"
 #include "driver/timer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <atomic>
 #include <map>
+#include <memory>
 #include <unordered_set>
 
 /**
@@ -40,11 +45,67 @@ enum gpio_err_t {
 	GPIO_NAME_INVALID,
 	GPIO_ALREADY_WATCHED,
 	GPIO_NOT_WATCHED,
-	GPIO_FLASH_PIN
+	GPIO_FLASH_PIN,
+	GPIO_PIN_DUPLICATE
+};
+
+/**
+ * The desired configuration of a single watched pin, for GPIOHandler::configurePins.
+ */
+struct pin_config {
+	/**
+	 * The hardware pin to watch.
+	 */
+	uint8_t number;
+
+	/**
+	 * The user facing name of the pin.
+	 */
+	String name;
+
+	/**
+	 * Whether the pin should use an internal pull up resistor instead of a pull down one.
+	 */
+	bool pull_up;
+};
+
+/**
+ * A single debounced pin state change, as queued by the GPIOHandler.
+ */
+struct pin_change {
+	/**
+	 * The pin that changed its state.
+	 */
+	uint8_t pin;
+
+	/**
+	 * The new state of the pin.
+	 */
+	bool state;
+
+	/**
+	 * The number of state changes of the pin, including this one.
+	 */
+	uint64_t changes;
+
+	/**
+	 * The time of the change, in milliseconds since boot.
+	 */
+	uint64_t time;
+
+	/**
+	 * The global change sequence number of this change.
+	 */
+	uint32_t sequence;
 };
 
 class GPIOHandler {
 public:
+	/**
+	 * The max number of pin changes that can be queued before new changes are dropped.
+	 */
+	static const size_t CHANGE_QUEUE_LENGTH = 64;
+
 	/**
 	 * The default GPIOHandler constructor creating a new GPIOHandler.
 	 *
@@ -113,6 +174,24 @@ public:
 	 */
 	gpio_err_t updateGPIO(const uint8_t pin, String name, const bool pull_up);
 
+	/**
+	 * Changes the set of watched pins to match the given configuration in a single transaction.
+	 * First validates all the given pins, and doesn't change anything if any of them is invalid.
+	 * Then registers, updates, and optionally unregisters pins as needed,
+	 * only touching the hardware configuration of pins whose resistor changed.
+	 * Writes the result to the StorageHandler once, and only if anything changed.
+	 *
+	 * @param pins				The desired configuration of the watched pins.
+	 * @param results			A vector to write the validation result of each given pin to, in the same order. Can be NULL.
+	 * 							If a pin is given multiple times, only the later entries get GPIO_PIN_DUPLICATE.
+	 * @param remove_missing	Whether to unregister watched pins that are not in the given configuration.
+	 * @return	The first error found while validating the given pins.
+	 * 			GPIO_OK if the configuration was applied.
+	 */
+	gpio_err_t configurePins(const std::vector<pin_config> &pins,
+			std::vector<gpio_err_t> *results = NULL,
+			const bool remove_missing = true);
+
 	/**
 	 * Check the states of all watched pins and update their states.
 	 */
@@ -146,6 +225,29 @@ public:
 	 */
 	gpio_err_t setChanges(const uint8_t pin, const uint64_t changes);
 
+	/**
+	 * Gets the total time in milliseconds the given pin spent in the high state since it was registered.
+	 * Includes the time since the last state change if the pin is currently high.
+	 * Returns UINT64_MAX if the pin isn't watched.
+	 *
+	 * @param pin	The pin to get the time spent high for.
+	 * @return	The time the pin was high, or UINT64_MAX if it isn't watched.
+	 */
+	uint64_t getHighTime(const uint8_t pin) const;
+
+	/**
+	 * Gets the rising and falling edges, and the time spent high, of the given pin over a recent window.
+	 * Answered from a fixed size ring of time buckets per pin, that is updated as the changes happen.
+	 * The window is rounded up to whole buckets, and limited to PinStats::MAX_WINDOW.
+	 *
+	 * @param pin		The pin to get the stats for.
+	 * @param window	The length of the window ending now, in milliseconds.
+	 * @param stats		The pin_stats object to write the stats to.
+	 * @return	What went wrong when getting the stats.
+	 * 			GPIO_OK if the stats were written.
+	 */
+	gpio_err_t getStats(const uint8_t pin, const uint32_t window, pin_stats &stats) const;
+
 	/**
 	 * Gets the name of the given pin to be shown to the user.
 	 * Returns an empty string if the pin isn't watched.
@@ -243,6 +345,55 @@ public:
 	 */
 	void writeToStorageHandler(bool force = false);
 
+	/**
+	 * Gets the oldest queued debounced pin state change, and removes it from the queue.
+	 * Changes are queued from the interrupts, so they can be handled outside of them.
+	 * Only intended for a single consumer, that distributes the changes to whatever needs them.
+	 *
+	 * @param change	The pin_change to write the change to.
+	 * @return	True if there was a queued change.
+	 */
+	bool getNextChange(pin_change &change);
+
+	/**
+	 * Gets the number of pin changes that were dropped because the change queue was full.
+	 *
+	 * @return	The number of dropped pin changes.
+	 */
+	uint32_t getDroppedChanges() const;
+
+	/**
+	 * Gets the number of times the pin interrupt was called for any of the watched pins.
+	 *
+	 * @return	The number of pin interrupts.
+	 */
+	uint32_t getPinInterrupts() const;
+
+	/**
+	 * Gets the number of times the debounce timer fired.
+	 *
+	 * @return	The number of debounce timer interrupts.
+	 */
+	uint32_t getTimerInterrupts() const;
+
+	/**
+	 * Gets the configuration version of this GPIOHandler.
+	 * The version is incremented every time a pin is registered, updated, or unregistered.
+	 *
+	 * @return	The current configuration version.
+	 */
+	uint32_t getConfigVersion() const;
+
+	/**
+	 * Gets the current global change sequence number.
+	 * The sequence number is incremented on every debounced pin state change,
+	 * and every time a pin is registered, updated, or unregistered.
+	 * The new sequence number is stored as the sequence of the changed pin.
+	 *
+	 * @return	The sequence number of the last change.
+	 */
+	uint32_t getChangeSequence() const;
+
 	/**
 	 * Checks whether the given pin is a valid input pin to watch.
 	 * Makes sure the following criteria are met:
@@ -276,6 +427,12 @@ private:
 	 */
 	std::map<uint8_t, pin_state> watched;
 
+	/**
+	 * The change statistics of the watched pins.
+	 * Separate from the pin_state objects, so copying those doesn't copy the buckets.
+	 */
+	std::map<uint8_t, std::unique_ptr<PinStats>> change_stats;
+
 	/**
 	 * Whether interrupts should be used.
 	 */
@@ -301,6 +458,37 @@ private:
 	 */
 	volatile uint16_t debounce_timeout = 10;
 
+	/**
+	 * The queue of debounced pin changes that weren't handled yet.
+	 */
+	QueueHandle_t change_queue;
+
+	/**
+	 * The number of pin changes that were dropped because the change queue was full.
+	 */
+	volatile uint32_t dropped_changes = 0;
+
+	/**
+	 * The number of times the pin interrupt was called.
+	 */
+	volatile uint32_t pin_interrupts = 0;
+
+	/**
+	 * The number of times the debounce timer fired.
+	 */
+	volatile uint32_t timer_interrupts = 0;
+
+	/**
+	 * The configuration version, incremented whenever the watched pins change.
+	 */
+	volatile uint32_t config_version = 0;
+
+	/**
+	 * The global change sequence number of the last change.
+	 * Atomic since it is incremented from both the interrupts and the main loop.
+	 */
+	std::atomic<uint32_t> change_sequence;
+
 	/**
 	 * The method handling a pin changing its state.
 	 * Requires the pin_state for the watched to be given as the arg.
@@ -325,6 +513,30 @@ private:
 	 */
 	void IRAM_ATTR updatePin(pin_state *pin);
 
+	/**
+	 * Stamps the given pin with a new change sequence number, and adds its current state to the change queue.
+	 * Can be called both from interrupts and from normal tasks.
+	 *
+	 * @param pin	The pin that changed its debounced state.
+	 */
+	void IRAM_ATTR queueChange(pin_state *pin);
+
+	/**
+	 * Increments the global change sequence number.
+	 *
+	 * @return	The new sequence number.
+	 */
+	uint32_t IRAM_ATTR nextSequence();
+
+	/**
+	 * Sets the pin mode of the given pin to input with its resistor.
+	 * Also attaches the pin interrupt, if interrupts are enabled.
+	 *
+	 * @param pin			The pin_state of the pin to configure.
+	 * @param initialize	Whether to read the initial state of a newly watched pin.
+	 */
+	void configurePin(pin_state *pin, const bool initialize = false);
+
 	/**
 	 * Starts the timer again so the callback gets called after the given time.
 	 *
@@ -379,8 +591,9 @@ struct pin_state {
 	pin_state(const pin_state &pin) :
 			handler(pin.handler), number(pin.number), name(pin.name), pull_up(
 					pin.pull_up), state(pin.state), last_change(
-					pin.last_change), changes(pin.changes), raw_state(
-					pin.raw_state), raw_last_change(pin.raw_last_change) {
+					pin.last_change), changes(pin.changes), high_time(
+					pin.high_time), raw_state(pin.raw_state), raw_last_change(
+					pin.raw_last_change), sequence(pin.sequence) {
 	}
 
 	virtual ~pin_state() {
@@ -421,6 +634,11 @@ struct pin_state {
 	 */
 	volatile uint64_t changes;
 
+	/**
+	 * The total time in milliseconds this pin spent in the high state up to its last state change.
+	 */
+	volatile uint64_t high_time = 0;
+
 	/**
 	 * The current state of the hardware pin.
 	 * Not debounced yet, to be used mainly for debouncing.
@@ -432,6 +650,17 @@ struct pin_state {
 	 * Not debounced yet, to be used mainly for debouncing.
 	 */
 	volatile uint64_t raw_last_change = 0;
+
+	/**
+	 * The global change sequence number of the last state or configuration change of this pin.
+	 */
+	volatile uint32_t sequence = 0;
+
+	/**
+	 * The change statistics of this pin, owned by the GPIOHandler.
+	 * Not copied, since it is only valid while the pin is watched.
+	 */
+	PinStats *stats = NULL;
 };
 
 extern GPIOHandler gpio_handler;
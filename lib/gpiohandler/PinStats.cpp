@@ -0,0 +1,106 @@
+/*
+ * PinStats.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "PinStats.h"
+
+PinStats::PinStats(const bool state, const uint32_t time) :
+		head(time / BUCKET_DURATION), head_end((head + 1) * BUCKET_DURATION), state(
+				state), last_change(time) {
+	memset(buckets, 0, sizeof(buckets));
+	// An index that is never part of the ring, so all buckets start out empty.
+	for (bucket &b : buckets) {
+		b.index = head - BUCKET_COUNT;
+	}
+
+	// Treat the registration like a change without an edge, so the time before it doesn't count as high.
+	const int16_t offset = time - (head_end - BUCKET_DURATION);
+	buckets[head % BUCKET_COUNT] = { head, 0, 0, (int16_t) (state ? -offset : 0), false };
+}
+
+PinStats::~PinStats() {
+
+}
+
+void IRAM_ATTR PinStats::recordChange(const bool state, const uint32_t time) {
+	const bool isr = xPortInIsrContext();
+	if (isr) {
+		portENTER_CRITICAL_ISR(&lock);
+	} else {
+		portENTER_CRITICAL(&lock);
+	}
+
+	uint32_t offset = time - (head_end - BUCKET_DURATION);
+	if (offset >= BUCKET_DURATION) {
+		const uint32_t steps = offset / BUCKET_DURATION;
+		head += steps;
+		head_end += steps * BUCKET_DURATION;
+		offset -= steps * BUCKET_DURATION;
+	}
+
+	bucket &current = buckets[head % BUCKET_COUNT];
+	if (current.index != head) {
+		current = { head, 0, 0, 0, this->state };
+	}
+
+	uint16_t &edges = state ? current.rising : current.falling;
+	if (edges < UINT16_MAX) {
+		edges++;
+	}
+	if (this->state) {
+		current.high_time += offset;
+	}
+	if (state) {
+		current.high_time -= offset;
+	}
+	this->state = state;
+	last_change = time;
+
+	if (isr) {
+		portEXIT_CRITICAL_ISR(&lock);
+	} else {
+		portEXIT_CRITICAL(&lock);
+	}
+}
+
+pin_stats PinStats::getStats(const uint32_t window, const uint32_t now) const {
+	uint32_t count = ((window < MAX_WINDOW ? window : MAX_WINDOW) + BUCKET_DURATION - 1) / BUCKET_DURATION;
+	if (count == 0) {
+		count = 1;
+	}
+
+	pin_stats stats = { 0, 0, 0, 0, 0 };
+	portENTER_CRITICAL(&lock);
+	// A change may have been recorded after now was read.
+	const uint32_t end_time = now - last_change > UINT32_MAX / 2 ? last_change : now;
+
+	const uint32_t head_start = head_end - BUCKET_DURATION;
+	const uint32_t index = head + (end_time - head_start) / BUCKET_DURATION;
+	const uint32_t index_start = head_start + (index - head) * BUCKET_DURATION;
+	// Don't start the window before boot.
+	if (count > index + 1) {
+		count = index + 1;
+	}
+	stats.start = index_start - (count - 1) * BUCKET_DURATION;
+	stats.duration = end_time - stats.start;
+
+	// Walk backwards, since a bucket without changes has the state the next change started from.
+	bool high = state;
+	for (uint32_t i = index; i != index - count; i--) {
+		const uint32_t end = i == index ? end_time - index_start : BUCKET_DURATION;
+		const bucket &b = buckets[i % BUCKET_COUNT];
+		if (b.index == i) {
+			stats.rising += b.rising;
+			stats.falling += b.falling;
+			stats.high_time += b.high_time + (high ? end : 0);
+			high = b.start_state;
+		} else if (high) {
+			stats.high_time += end;
+		}
+	}
+	portEXIT_CRITICAL(&lock);
+	return stats;
+}
@@ -0,0 +1,176 @@
+/*
+ * PinStats.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_GPIOHANDLER_PINSTATS_H_
+#define LIB_GPIOHANDLER_PINSTATS_H_
+
+#include <Arduino.h>
+
+/**
+ * The aggregated state changes of a single pin over a time window.
+ */
+struct pin_stats {
+	/**
+	 * The start of the window, in milliseconds since boot.
+	 * Aligned to the start of a bucket, so the window may be slightly longer than requested.
+	 * Wraps around together with millis().
+	 */
+	uint32_t start;
+
+	/**
+	 * The length of the window, in milliseconds.
+	 */
+	uint32_t duration;
+
+	/**
+	 * The number of low to high changes in the window.
+	 */
+	uint32_t rising;
+
+	/**
+	 * The number of high to low changes in the window.
+	 */
+	uint32_t falling;
+
+	/**
+	 * The time in milliseconds the pin spent in the high state in the window.
+	 */
+	uint32_t high_time;
+};
+
+/**
+ * A fixed size ring of time buckets, aggregating the debounced state changes of a single pin.
+ *
+ * Each bucket holds the rising and falling edges, and the time spent high, of one bucket duration.
+ * Changes are added to their bucket as they happen, so a query only has to sum up the buckets in its window.
+ * Buckets older than the ring are overwritten, so the memory use doesn't depend on the number of changes.
+ *
+ * Recording a change only touches the bucket it happened in, using 32-bit arithmetic, so it is cheap enough for interrupts.
+ * Buckets are tagged with their index instead of being cleared when the head moves past them,
+ * and the time a pin stayed high across bucket boundaries is only spread over the buckets by getStats.
+ */
+class PinStats {
+public:
+	/**
+	 * The time in milliseconds covered by a single bucket.
+	 */
+	static constexpr uint32_t BUCKET_DURATION = 15000;
+
+	/**
+	 * The number of buckets in the ring.
+	 * 240 buckets of 15 seconds cover the last hour.
+	 */
+	static constexpr size_t BUCKET_COUNT = 240;
+
+	/**
+	 * The longest window that can be queried, in milliseconds.
+	 */
+	static constexpr uint32_t MAX_WINDOW = BUCKET_DURATION * BUCKET_COUNT;
+
+	/**
+	 * Creates a new PinStats without any recorded changes.
+	 *
+	 * @param state	The current state of the pin.
+	 * @param time	The time since which the pin is in its current state, in milliseconds since boot.
+	 */
+	PinStats(const bool state, const uint32_t time);
+
+	/**
+	 * Destroys this PinStats.
+	 */
+	virtual ~PinStats();
+
+	/**
+	 * Adds a debounced state change to the bucket it happened in.
+	 * Takes constant time, and doesn't touch any other bucket.
+	 * Can be called both from interrupts and from normal tasks.
+	 * Changes have to be recorded in the order they happened.
+	 *
+	 * @param state	The new state of the pin.
+	 * @param time	The time of the change, in milliseconds since boot.
+	 */
+	void IRAM_ATTR recordChange(const bool state, const uint32_t time);
+
+	/**
+	 * Sums up the buckets of the given window ending now.
+	 * Buckets without a change in them count as high for their entire duration if the pin was high at their end.
+	 * Includes the time since the last change if the pin is currently high.
+	 * The window is rounded up to whole buckets, and limited to MAX_WINDOW.
+	 *
+	 * @param window	The length of the window, in milliseconds.
+	 * @param now		The current time, in milliseconds since boot.
+	 * @return	The aggregated changes of the window.
+	 */
+	pin_stats getStats(const uint32_t window, const uint32_t now) const;
+private:
+	/**
+	 * The aggregated changes of a single bucket duration.
+	 * The counts saturate instead of overflowing.
+	 */
+	struct bucket {
+		/**
+		 * The index of the bucket these changes belong to.
+		 * A bucket whose index doesn't match its position in the ring contains no changes.
+		 */
+		uint32_t index;
+
+		/**
+		 * The number of low to high changes in this bucket.
+		 */
+		uint16_t rising;
+
+		/**
+		 * The number of high to low changes in this bucket.
+		 */
+		uint16_t falling;
+
+		/**
+		 * The offsets, in milliseconds from the start of the bucket, of the falling edges,
+		 * minus the offsets of the rising edges.
+		 * Adding the end of the bucket if the pin was high at the end gives the time spent high.
+		 */
+		int16_t high_time;
+
+		/**
+		 * The state of the pin at the start of this bucket.
+		 */
+		bool start_state;
+	};
+
+	/**
+	 * The ring of buckets, indexed by their bucket index modulo the bucket count.
+	 */
+	bucket buckets[BUCKET_COUNT];
+
+	/**
+	 * The index of the bucket containing the last recorded change.
+	 * Counts up from the time the pin was registered, so it doesn't jump when millis() wraps around.
+	 */
+	uint32_t head;
+
+	/**
+	 * The time the head bucket ends, in milliseconds since boot.
+	 */
+	uint32_t head_end;
+
+	/**
+	 * The state of the pin after the last recorded change.
+	 */
+	bool state;
+
+	/**
+	 * The time of the last recorded change, in milliseconds since boot.
+	 */
+	uint32_t last_change;
+
+	/**
+	 * The spinlock synchronizing the interrupts recording changes with the tasks reading the stats.
+	 */
+	mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif /* LIB_GPIOHANDLER_PINSTATS_H_ */
@@ -0,0 +1,389 @@
+/*
+ * InfluxExporter.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "InfluxExporter.h"
+#include <HTTPClient.h>
+#include <algorithm>
+#include <sys/time.h>
+
+InfluxExporter::InfluxExporter(GPIOHandler &gpio, const size_t buffer_size,
+		const size_t spill_size) :
+		gpio(&gpio), buffer_size(buffer_size), spill_size(spill_size) {
+}
+
+InfluxExporter::~InfluxExporter() {
+	end();
+}
+
+void InfluxExporter::begin(const char *url, const char *host,
+		const char *token) {
+	if (writer_running) {
+		end();
+	}
+
+	// Allocated here, so the buffer doesn't use any memory if no server is set.
+	buffer.reset(new char[buffer_size]);
+	this->url = url;
+	if (this->url.find("precision=") == std::string::npos) {
+		this->url += this->url.find('?') == std::string::npos ? '?' : '&';
+		this->url += "precision=ms";
+	}
+
+	this->host = escapeTag(host);
+	authorization = token == NULL ? "" : std::string("Token ") + token;
+	last_snapshot = 0;
+	retry_delay = 0;
+
+	writer_running = true;
+	if (xTaskCreate(writeTask, "influx_writer", WRITER_STACK_SIZE, this,
+			WRITER_PRIORITY, &writer) != pdPASS) {
+		writer_running = false;
+		this->url.clear();
+		buffer.reset();
+	}
+}
+
+void InfluxExporter::end() {
+	if (writer_running) {
+		// Waits for the current write to finish, which can take up to twice the WRITE_TIMEOUT.
+		stopping = true;
+		xTaskNotifyGive(writer);
+		while (writer_running) {
+			delay(10);
+		}
+		stopping = false;
+	}
+
+	url.clear();
+	buffer.reset();
+	buffer_length = 0;
+	buffer_lines = 0;
+	spill.clear();
+	spill_length = 0;
+	in_flight.clear();
+	writing = false;
+	retry_delay = 0;
+}
+
+void InfluxExporter::handle() {
+	if (url.empty()) {
+		return;
+	}
+
+	const uint64_t now = millis();
+	if (snapshot_interval > 0
+			&& (last_snapshot == 0 || now - last_snapshot >= snapshot_interval)) {
+		recordSnapshot();
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	// The writer task owns the in flight batch until it is done writing it.
+	if (writing) {
+		return;
+	}
+
+	if (retry_delay > 0 && now - last_failure < retry_delay) {
+		return;
+	}
+
+	// Write the oldest batch first, so lines with the same timestamp don't overwrite newer ones.
+	if (!spill.empty()) {
+		spill_batch &batch = spill.front();
+		in_flight.swap(batch.data);
+		in_flight_lines = batch.lines;
+		spill_length -= in_flight.length();
+		spill.pop_front();
+	} else {
+		if (buffer_lines == 0) {
+			return;
+		}
+
+		if (buffer_length < buffer_size / 2
+				&& now - buffer_start < flush_interval) {
+			return;
+		}
+
+		// Reuses the capacity of the previous batch, so this usually doesn't allocate.
+		in_flight.assign(buffer.get(), buffer_length);
+		in_flight_lines = buffer_lines;
+		buffer_length = 0;
+		buffer_lines = 0;
+	}
+
+	writing = true;
+	xTaskNotifyGive(writer);
+}
+
+void InfluxExporter::record(const pin_change &change) {
+	if (url.empty()) {
+		return;
+	}
+
+	char timestamp[24];
+	formatTimestamp(change.time, timestamp, sizeof(timestamp));
+
+	const std::string name_tag = formatNameTag(gpio->getName(change.pin).c_str());
+
+	char line[256];
+	const int length = snprintf(line, sizeof(line),
+			"gpio_change,host=%s,pin=%u%s state=%ui,changes=%llui%s\n",
+			host.c_str(), change.pin, name_tag.c_str(), change.state ? 1 : 0,
+			change.changes, timestamp);
+	if (length < 0 || (size_t) length >= sizeof(line)) {
+		dropped_lines++;
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	append(line, length);
+}
+
+void InfluxExporter::recordSnapshot() {
+	if (url.empty()) {
+		return;
+	}
+
+	last_snapshot = millis();
+	char timestamp[24];
+	formatTimestamp(last_snapshot, timestamp, sizeof(timestamp));
+
+	char line[256];
+	std::lock_guard<std::mutex> guard(lock);
+	for (const pin_state &pin : gpio->getWatchedPins()) {
+		const int length = snprintf(line, sizeof(line),
+				"gpio_pin,host=%s,pin=%u%s state=%ui,changes=%llui,high_time=%llui%s\n",
+				host.c_str(), pin.number, formatNameTag(pin.name.c_str()).c_str(),
+				pin.state ? 1 : 0, pin.changes, gpio->getHighTime(pin.number),
+				timestamp);
+		if (length < 0 || (size_t) length >= sizeof(line)) {
+			dropped_lines++;
+			continue;
+		}
+		append(line, length);
+	}
+}
+
+void InfluxExporter::setFlushInterval(const uint32_t interval) {
+	flush_interval = interval;
+}
+
+uint32_t InfluxExporter::getFlushInterval() const {
+	return flush_interval;
+}
+
+void InfluxExporter::setSnapshotInterval(const uint32_t interval) {
+	snapshot_interval = interval;
+}
+
+uint32_t InfluxExporter::getSnapshotInterval() const {
+	return snapshot_interval;
+}
+
+uint32_t InfluxExporter::getBufferedLines() const {
+	return buffer_lines;
+}
+
+size_t InfluxExporter::getSpillSize() const {
+	return spill_length;
+}
+
+uint32_t InfluxExporter::getDroppedLines() const {
+	return dropped_lines;
+}
+
+uint32_t InfluxExporter::getSuccessfulWrites() const {
+	return successful_writes;
+}
+
+uint32_t InfluxExporter::getFailedWrites() const {
+	return failed_writes;
+}
+
+bool InfluxExporter::isWriting() const {
+	return writing;
+}
+
+void InfluxExporter::appendMetrics(std::string &metrics) const {
+	char line[128];
+	metrics += "# HELP esp_influx_buffer_bytes The number of bytes waiting in the InfluxDB line buffer.\n";
+	metrics += "# TYPE esp_influx_buffer_bytes gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_influx_buffer_bytes %u\n", buffer_length)));
+
+	metrics += "# HELP esp_influx_spill_bytes The number of bytes waiting to be written again after a failed write.\n";
+	metrics += "# TYPE esp_influx_spill_bytes gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_influx_spill_bytes %u\n", spill_length)));
+
+	metrics += "# HELP esp_influx_dropped_lines_total The number of lines dropped because the spill buffer was full, or the server rejected them.\n";
+	metrics += "# TYPE esp_influx_dropped_lines_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_influx_dropped_lines_total %u\n",
+					dropped_lines)));
+
+	metrics += "# HELP esp_influx_writes_total The number of write requests sent to the InfluxDB server, by result.\n";
+	metrics += "# TYPE esp_influx_writes_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_influx_writes_total{result=\"success\"} %u\n",
+					successful_writes)));
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_influx_writes_total{result=\"failed\"} %u\n",
+					failed_writes)));
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_influx_writes_total{result=\"rejected\"} %u\n",
+					rejected_writes)));
+}
+
+void InfluxExporter::append(const char *line, const size_t length) {
+	if (length > buffer_size) {
+		dropped_lines++;
+		return;
+	}
+
+	if (buffer_length + length > buffer_size) {
+		spillBuffer();
+	}
+
+	if (buffer_lines == 0) {
+		buffer_start = millis();
+	}
+
+	memcpy(buffer.get() + buffer_length, line, length);
+	buffer_length += length;
+	buffer_lines++;
+}
+
+void InfluxExporter::spillBuffer() {
+	if (buffer_lines == 0) {
+		return;
+	}
+
+	if (buffer_length > spill_size) {
+		dropped_lines += buffer_lines;
+	} else {
+		while (!spill.empty() && spill_length + buffer_length > spill_size) {
+			dropped_lines += spill.front().lines;
+			spill_length -= spill.front().data.length();
+			spill.pop_front();
+		}
+
+		const spill_batch batch = { std::string(buffer.get(), buffer_length),
+				buffer_lines };
+		spill.push_back(batch);
+		spill_length += buffer_length;
+	}
+
+	buffer_length = 0;
+	buffer_lines = 0;
+}
+
+void InfluxExporter::writeTask(void *exporter_ptr) {
+	InfluxExporter *exporter = (InfluxExporter*) exporter_ptr;
+	while (true) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if (exporter->stopping) {
+			break;
+		}
+
+		if (exporter->writing) {
+			exporter->finishWrite(
+					exporter->post(exporter->in_flight.c_str(),
+							exporter->in_flight.length()));
+		}
+	}
+
+	exporter->writer_running = false;
+	vTaskDelete(NULL);
+}
+
+int InfluxExporter::post(const char *data, const size_t length) const {
+	HTTPClient http;
+	http.setConnectTimeout(WRITE_TIMEOUT);
+	http.setTimeout(WRITE_TIMEOUT);
+	int code = -1;
+	if (http.begin(url.c_str())) {
+		http.addHeader("Content-Type", "text/plain; charset=utf-8");
+		if (!authorization.empty()) {
+			http.addHeader("Authorization", authorization.c_str());
+		}
+		code = http.POST((uint8_t*) data, length);
+		http.end();
+	}
+	return code;
+}
+
+void InfluxExporter::finishWrite(const int code) {
+	std::lock_guard<std::mutex> guard(lock);
+	writing = false;
+	if (code >= 200 && code < 300) {
+		successful_writes++;
+		retry_delay = 0;
+		in_flight.clear();
+		return;
+	}
+
+	// Retrying invalid lines would block all following lines forever.
+	if (code >= 400 && code < 500 && code != 408 && code != 429) {
+		rejected_writes++;
+		dropped_lines += in_flight_lines;
+		retry_delay = 0;
+		in_flight.clear();
+		return;
+	}
+
+	failed_writes++;
+	if (retry_delay == 0) {
+		retry_delay = MIN_RETRY_DELAY;
+	} else {
+		retry_delay = retry_delay * 2 > MAX_RETRY_DELAY ? MAX_RETRY_DELAY : retry_delay * 2;
+	}
+	last_failure = millis();
+
+	// The failed batch is older than all spilled batches, so it is dropped first if they don't fit.
+	if (spill_length + in_flight.length() > spill_size) {
+		dropped_lines += in_flight_lines;
+		in_flight.clear();
+		return;
+	}
+
+	spill_batch batch = { std::string(), in_flight_lines };
+	batch.data.swap(in_flight);
+	spill_length += batch.data.length();
+	spill.push_front(std::move(batch));
+}
+
+void InfluxExporter::formatTimestamp(const uint64_t time, char *timestamp,
+		const size_t max_len) {
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	if (now.tv_sec < MIN_VALID_TIME) {
+		timestamp[0] = 0;
+		return;
+	}
+
+	const uint64_t now_ms = (uint64_t) now.tv_sec * 1000 + now.tv_usec / 1000;
+	snprintf(timestamp, max_len, " %llu", now_ms - (millis() - time));
+}
+
+std::string InfluxExporter::formatNameTag(const char *name) {
+	// Empty tag values aren't valid in the line protocol.
+	if (name[0] == 0) {
+		return std::string();
+	}
+	return std::string(",name=") + escapeTag(name);
+}
+
+std::string InfluxExporter::escapeTag(const char *value) {
+	std::string escaped;
+	for (const char *c = value; *c != 0; c++) {
+		if (*c == ',' || *c == '=' || *c == ' ') {
+			escaped += '\\';
+		}
+		escaped += *c;
+	}
+	return escaped;
+}
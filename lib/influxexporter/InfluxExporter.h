@@ -0,0 +1,449 @@
+/*
+ * InfluxExporter.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_INFLUXEXPORTER_INFLUXEXPORTER_H_
+#define LIB_INFLUXEXPORTER_INFLUXEXPORTER_H_
+
+#include "GPIOHandler.h"
+#include <freertos/task.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * A batch of lines that couldn't be written yet, waiting in the spill buffer.
+ */
+struct spill_batch {
+	/**
+	 * The lines of this batch, separated by line feeds.
+	 */
+	std::string data;
+
+	/**
+	 * The number of lines in this batch.
+	 */
+	uint32_t lines;
+};
+
+/**
+ * Pushes the pin changes of a GPIOHandler to an InfluxDB server using its line protocol.
+ *
+ * Every change is written as a gpio_change line, and the state, change counter, and high time of all watched pins
+ * are written as gpio_pin lines in a fixed interval.
+ * Lines are formatted into a buffer that is allocated by begin, and written in a single request
+ * once it is half full, or its oldest line is older than the flush interval.
+ * The requests are sent by a separate task, so a slow or unreachable server never blocks the main loop.
+ * Batches that couldn't be written are moved to a spill buffer with a fixed max size, and retried with an exponential backoff.
+ * If the spill buffer is full its oldest batch is dropped.
+ */
+class InfluxExporter {
+public:
+	/**
+	 * The default size of the line buffer in bytes.
+	 */
+	static const size_t DEFAULT_BUFFER_SIZE = 4096;
+
+	/**
+	 * The default max size of the spill buffer in bytes.
+	 */
+	static const size_t DEFAULT_SPILL_SIZE = 16384;
+
+	/**
+	 * The default max time in milliseconds a line waits in the buffer before it is written.
+	 */
+	static const uint32_t DEFAULT_FLUSH_INTERVAL = 5000;
+
+	/**
+	 * The default time in milliseconds between two pin state snapshots.
+	 */
+	static const uint32_t DEFAULT_SNAPSHOT_INTERVAL = 60000;
+
+	/**
+	 * The time in milliseconds to wait before retrying after the first failed write.
+	 * Doubled for every further failed write.
+	 */
+	static const uint32_t MIN_RETRY_DELAY = 1000;
+
+	/**
+	 * The max time in milliseconds to wait before retrying a failed write.
+	 */
+	static const uint32_t MAX_RETRY_DELAY = 60000;
+
+	/**
+	 * The max time in milliseconds a single write request can take.
+	 */
+	static const uint16_t WRITE_TIMEOUT = 2000;
+
+	/**
+	 * The stack size of the task sending the write requests, in bytes.
+	 */
+	static const uint32_t WRITER_STACK_SIZE = 8192;
+
+	/**
+	 * The priority of the task sending the write requests.
+	 */
+	static const UBaseType_t WRITER_PRIORITY = 1;
+
+	/**
+	 * The earliest unix time considered valid.
+	 * Lines recorded before the time is synchronized are written without a timestamp.
+	 */
+	static constexpr time_t MIN_VALID_TIME = 1640995200;
+
+	/**
+	 * Creates a new InfluxExporter that doesn't write to any server.
+	 *
+	 * @param gpio			The GPIOHandler to get the pin names and states from.
+	 * @param buffer_size	The size of the line buffer in bytes.
+	 * @param spill_size	The max size of the spill buffer in bytes.
+	 */
+	InfluxExporter(GPIOHandler &gpio = gpio_handler, const size_t buffer_size =
+			DEFAULT_BUFFER_SIZE, const size_t spill_size = DEFAULT_SPILL_SIZE);
+
+	/**
+	 * Destroys this InfluxExporter, without writing the remaining lines.
+	 * Waits for the current write request to finish.
+	 */
+	virtual ~InfluxExporter();
+
+	/**
+	 * Sets the server to write to, and starts recording lines.
+	 * The url is the write endpoint of the server, for example "http://influx:8086/api/v2/write?org=home&bucket=gpio"
+	 * for InfluxDB 2, or "http://influx:8086/write?db=gpio" for InfluxDB 1.
+	 * "precision=ms" is added to the url if it doesn't contain a precision.
+	 * Allocates the line buffer, and starts the task sending the write requests.
+	 *
+	 * @param url	The url to write the lines to.
+	 * @param host	The value of the host tag of all lines, for example the host name of this device.
+	 * @param token	The api token to authenticate with. NULL if no authentication is required.
+	 */
+	void begin(const char *url, const char *host = "esp-wifi-gpio-monitor",
+			const char *token = NULL);
+
+	/**
+	 * Stops writing to the server, and discards the buffered and spilled lines.
+	 * Waits for the current write request to finish, and frees the line buffer.
+	 */
+	void end();
+
+	/**
+	 * Records a pin state snapshot if one is due, and passes a single batch to the writer task if one is due.
+	 * Spilled batches are written before the line buffer, so lines arrive in order.
+	 * Never waits for the write request, and does nothing while the previous batch is still being written.
+	 * Has to be called regularly from the main loop.
+	 */
+	void handle();
+
+	/**
+	 * Records a gpio_change line for the given pin change.
+	 * Ignores the change if no server was set.
+	 *
+	 * @param change	The change to record.
+	 */
+	void record(const pin_change &change);
+
+	/**
+	 * Records a gpio_pin line with the current state of each watched pin.
+	 * Ignores the call if no server was set.
+	 */
+	void recordSnapshot();
+
+	/**
+	 * Sets the max time a line waits in the buffer before it is written.
+	 * Set to zero to write every line as soon as possible.
+	 *
+	 * @param interval	The new flush interval in milliseconds.
+	 */
+	void setFlushInterval(const uint32_t interval);
+
+	/**
+	 * Gets the max time a line waits in the buffer before it is written.
+	 *
+	 * @return	The flush interval in milliseconds.
+	 */
+	uint32_t getFlushInterval() const;
+
+	/**
+	 * Sets the time between two pin state snapshots.
+	 * Set to zero to disable snapshots.
+	 *
+	 * @param interval	The new snapshot interval in milliseconds.
+	 */
+	void setSnapshotInterval(const uint32_t interval);
+
+	/**
+	 * Gets the time between two pin state snapshots.
+	 *
+	 * @return	The snapshot interval in milliseconds.
+	 */
+	uint32_t getSnapshotInterval() const;
+
+	/**
+	 * Gets the number of lines in the line buffer.
+	 *
+	 * @return	The number of buffered lines.
+	 */
+	uint32_t getBufferedLines() const;
+
+	/**
+	 * Gets the number of bytes in the spill buffer.
+	 *
+	 * @return	The size of the spilled batches.
+	 */
+	size_t getSpillSize() const;
+
+	/**
+	 * Gets the number of lines that were dropped, either because the spill buffer was full,
+	 * or because the server rejected them.
+	 *
+	 * @return	The number of dropped lines.
+	 */
+	uint32_t getDroppedLines() const;
+
+	/**
+	 * Gets the number of write requests that were accepted by the server.
+	 *
+	 * @return	The number of successful writes.
+	 */
+	uint32_t getSuccessfulWrites() const;
+
+	/**
+	 * Gets the number of write requests that failed, and will be retried.
+	 *
+	 * @return	The number of failed writes.
+	 */
+	uint32_t getFailedWrites() const;
+
+	/**
+	 * Checks whether the writer task is currently sending a batch.
+	 *
+	 * @return	True if a write request is in progress.
+	 */
+	bool isWriting() const;
+
+	/**
+	 * Appends the prometheus metrics of this exporter to the given string.
+	 * Contains the buffer and spill sizes, the dropped lines, and the write results.
+	 *
+	 * @param metrics	The string to append the metrics to.
+	 */
+	void appendMetrics(std::string &metrics) const;
+private:
+	/**
+	 * The GPIOHandler to get the pin names and states from.
+	 */
+	GPIOHandler *gpio;
+
+	/**
+	 * The url to write the lines to. Empty if no server was set.
+	 */
+	std::string url;
+
+	/**
+	 * The escaped value of the host tag.
+	 */
+	std::string host;
+
+	/**
+	 * The authorization header value. Empty if no token was set.
+	 */
+	std::string authorization;
+
+	/**
+	 * The buffer the lines are formatted into.
+	 * Allocated by begin, and reused for every batch.
+	 */
+	std::unique_ptr<char[]> buffer;
+
+	/**
+	 * The size of the line buffer in bytes.
+	 */
+	const size_t buffer_size;
+
+	/**
+	 * The number of bytes currently in the line buffer.
+	 */
+	size_t buffer_length = 0;
+
+	/**
+	 * The number of lines currently in the line buffer.
+	 */
+	uint32_t buffer_lines = 0;
+
+	/**
+	 * The time the oldest line in the line buffer was recorded, in milliseconds since boot.
+	 */
+	uint64_t buffer_start = 0;
+
+	/**
+	 * The batches that couldn't be written yet, oldest first.
+	 */
+	std::deque<spill_batch> spill;
+
+	/**
+	 * The max size of the spill buffer in bytes.
+	 */
+	const size_t spill_size;
+
+	/**
+	 * The number of bytes currently in the spill buffer.
+	 */
+	size_t spill_length = 0;
+
+	/**
+	 * The batch the writer task is currently sending, or the last batch it sent.
+	 * Only accessed by the writer task while writing is set.
+	 */
+	std::string in_flight;
+
+	/**
+	 * The number of lines in the in flight batch.
+	 */
+	uint32_t in_flight_lines = 0;
+
+	/**
+	 * The mutex synchronizing the buffers and the write results between the main loop and the writer task.
+	 */
+	std::mutex lock;
+
+	/**
+	 * The task sending the write requests.
+	 */
+	TaskHandle_t writer = NULL;
+
+	/**
+	 * Whether the writer task exists.
+	 */
+	volatile bool writer_running = false;
+
+	/**
+	 * Whether the writer task should exit.
+	 */
+	volatile bool stopping = false;
+
+	/**
+	 * Whether the writer task is currently sending the in flight batch.
+	 */
+	volatile bool writing = false;
+
+	/**
+	 * The max time a line waits in the buffer before it is written, in milliseconds.
+	 */
+	uint32_t flush_interval = DEFAULT_FLUSH_INTERVAL;
+
+	/**
+	 * The time between two pin state snapshots, in milliseconds.
+	 */
+	uint32_t snapshot_interval = DEFAULT_SNAPSHOT_INTERVAL;
+
+	/**
+	 * The last time a pin state snapshot was recorded, in milliseconds since boot.
+	 */
+	uint64_t last_snapshot = 0;
+
+	/**
+	 * The time to wait after the last failed write, in milliseconds. Zero if the last write succeeded.
+	 */
+	uint32_t retry_delay = 0;
+
+	/**
+	 * The time of the last failed write, in milliseconds since boot.
+	 */
+	uint64_t last_failure = 0;
+
+	/**
+	 * The number of lines that were dropped.
+	 */
+	uint32_t dropped_lines = 0;
+
+	/**
+	 * The number of write requests accepted by the server.
+	 */
+	uint32_t successful_writes = 0;
+
+	/**
+	 * The number of write requests that failed, and will be retried.
+	 */
+	uint32_t failed_writes = 0;
+
+	/**
+	 * The number of write requests the server rejected as invalid, whose lines were dropped.
+	 */
+	uint32_t rejected_writes = 0;
+
+	/**
+	 * Appends a single line to the line buffer.
+	 * Moves the current buffer content to the spill buffer first, if the line doesn't fit.
+	 *
+	 * @param line		The line to append, including its trailing line feed.
+	 * @param length	The length of the line.
+	 */
+	void append(const char *line, const size_t length);
+
+	/**
+	 * Moves the content of the line buffer to the spill buffer, and clears the line buffer.
+	 * Drops the oldest spilled batches if the spill buffer would be too large otherwise.
+	 */
+	void spillBuffer();
+
+	/**
+	 * The function of the writer task.
+	 * Sends the in flight batch every time it is notified, until stopping is set.
+	 *
+	 * @param exporter_ptr	The InfluxExporter whose batches to send.
+	 */
+	static void writeTask(void *exporter_ptr);
+
+	/**
+	 * Sends a single write request containing the given lines.
+	 * Blocks for up to WRITE_TIMEOUT milliseconds each for connecting and for the response.
+	 *
+	 * @param data		The lines to write.
+	 * @param length	The length of the data in bytes.
+	 * @return	The http status code of the response, or a negative value if the request failed.
+	 */
+	int post(const char *data, const size_t length) const;
+
+	/**
+	 * Updates the write counters and the retry delay after the in flight batch was sent.
+	 * Moves the batch back to the front of the spill buffer if it has to be written again.
+	 * Drops it instead if the server rejected it as invalid.
+	 *
+	 * @param code	The status code returned by post.
+	 */
+	void finishWrite(const int code);
+
+	/**
+	 * Formats the timestamp of a line recorded at the given time.
+	 * Writes an empty string if the current time isn't known.
+	 *
+	 * @param time		The time in milliseconds since boot.
+	 * @param timestamp	The buffer to write the timestamp to, including a leading space.
+	 * @param max_len	The size of the timestamp buffer.
+	 */
+	static void formatTimestamp(const uint64_t time, char *timestamp,
+			const size_t max_len);
+
+	/**
+	 * Formats the name tag of a line, including the leading comma.
+	 *
+	 * @param name	The name of the pin.
+	 * @return	The name tag, or an empty string if the name is empty.
+	 */
+	static std::string formatNameTag(const char *name);
+
+	/**
+	 * Escapes a tag value for the line protocol, by escaping commas, equal signs, and spaces.
+	 *
+	 * @param value	The value to escape.
+	 * @return	The escaped value.
+	 */
+	static std::string escapeTag(const char *value);
+};
+
+#endif /* LIB_INFLUXEXPORTER_INFLUXEXPORTER_H_ */
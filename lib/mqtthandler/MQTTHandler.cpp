@@ -0,0 +1,295 @@
+/*
+ * MQTTHandler.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "MQTTHandler.h"
+#include <algorithm>
+#include <map>
+
+MQTTHandler::MQTTHandler(GPIOHandler &gpio, const size_t queue_length) :
+		gpio(&gpio), queue_length(queue_length) {
+	client.onConnect([this](bool session_present) {
+		connected = true;
+		resync = true;
+		connects++;
+	});
+
+	client.onDisconnect([this](AsyncMqttClientDisconnectReason reason) {
+		connected = false;
+	});
+}
+
+MQTTHandler::~MQTTHandler() {
+	end();
+}
+
+void MQTTHandler::begin(const char *host, const uint16_t port,
+		const char *prefix, const char *user, const char *password) {
+	this->host = host;
+	this->prefix = prefix;
+	status_topic = this->prefix + "/status";
+	this->user = user == NULL ? "" : user;
+	this->password = password == NULL ? "" : password;
+
+	client.setServer(this->host.c_str(), port);
+	client.setClientId(this->prefix.c_str());
+	if (user != NULL) {
+		client.setCredentials(this->user.c_str(),
+				password == NULL ? NULL : this->password.c_str());
+	}
+
+	last_connect_attempt = 0;
+	handle();
+}
+
+void MQTTHandler::end() {
+	if (host.empty()) {
+		return;
+	}
+
+	host.clear();
+	client.disconnect();
+	connected = false;
+
+	std::lock_guard<std::mutex> guard(lock);
+	queue.clear();
+}
+
+void MQTTHandler::handle() {
+	if (host.empty()) {
+		return;
+	}
+
+	if (!connected) {
+		const uint64_t now = millis();
+		if (last_connect_attempt == 0
+				|| now - last_connect_attempt >= RECONNECT_INTERVAL) {
+			last_connect_attempt = now;
+			// Set before every attempt, so the will uses the current QoS level.
+			client.setWill(status_topic.c_str(), qos, true, "offline");
+			client.connect();
+		}
+		return;
+	}
+
+	if (resync) {
+		// Cleared first, so a configuration change while publishing causes another resync.
+		resync = false;
+		if (!publishAll()) {
+			resync = true;
+			return;
+		}
+	}
+
+	flush();
+}
+
+void MQTTHandler::publish(const pin_change &change) {
+	if (host.empty()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	if (queue.size() >= queue_length) {
+		queue.pop_front();
+		dropped_changes++;
+	}
+	queue.push_back(change);
+}
+
+void MQTTHandler::publishConfigChange() {
+	resync = true;
+}
+
+void MQTTHandler::setQoS(const uint8_t qos) {
+	this->qos = std::min<uint8_t>(qos, 2);
+}
+
+uint8_t MQTTHandler::getQoS() const {
+	return qos;
+}
+
+void MQTTHandler::setBatchInterval(const uint32_t interval) {
+	batch_interval = interval;
+}
+
+uint32_t MQTTHandler::getBatchInterval() const {
+	return batch_interval;
+}
+
+bool MQTTHandler::isConnected() const {
+	return connected;
+}
+
+size_t MQTTHandler::getQueueLength() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return queue.size();
+}
+
+uint32_t MQTTHandler::getDroppedChanges() const {
+	return dropped_changes;
+}
+
+uint32_t MQTTHandler::getPublishedMessages() const {
+	return published_messages;
+}
+
+void MQTTHandler::appendMetrics(std::string &metrics) const {
+	size_t queued;
+	uint64_t latency;
+	uint32_t latency_samples;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		queued = queue.size();
+		latency = latency_sum;
+		latency_samples = latency_count;
+	}
+
+	char line[128];
+	metrics += "# HELP esp_mqtt_connected Whether the MQTT broker is currently connected.\n";
+	metrics += "# TYPE esp_mqtt_connected gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_connected %u\n", connected ? 1 : 0)));
+
+	metrics += "# HELP esp_mqtt_connects_total The number of times the connection to the MQTT broker was established.\n";
+	metrics += "# TYPE esp_mqtt_connects_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_connects_total %u\n", connects)));
+
+	metrics += "# HELP esp_mqtt_queue_length The number of pin changes waiting to be published.\n";
+	metrics += "# TYPE esp_mqtt_queue_length gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_queue_length %u\n", queued)));
+
+	metrics += "# HELP esp_mqtt_dropped_changes_total The number of pin changes dropped because the MQTT queue was full.\n";
+	metrics += "# TYPE esp_mqtt_dropped_changes_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_dropped_changes_total %u\n",
+					dropped_changes)));
+
+	metrics += "# HELP esp_mqtt_messages_total The number of MQTT messages handed to the client, by result.\n";
+	metrics += "# TYPE esp_mqtt_messages_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_messages_total{result=\"published\"} %u\n",
+					published_messages)));
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_messages_total{result=\"failed\"} %u\n",
+					failed_messages)));
+
+	metrics += "# HELP esp_mqtt_publish_latency_seconds The time from a pin change until it was published.\n";
+	metrics += "# TYPE esp_mqtt_publish_latency_seconds summary\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_publish_latency_seconds_sum %llu.%03u\n",
+					latency / 1000, (uint32_t) (latency % 1000))));
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_mqtt_publish_latency_seconds_count %u\n",
+					latency_samples)));
+}
+
+bool MQTTHandler::publishAll() {
+	if (!publishMessage("status", "online")) {
+		return false;
+	}
+
+	std::set<uint8_t> watched;
+	for (const pin_state &pin : gpio->getWatchedPins()) {
+		if (!publishPin(pin.number, pin.state, pin.changes)) {
+			return false;
+		}
+		watched.insert(pin.number);
+	}
+
+	char topic[32];
+	for (const uint8_t pin : published_pins) {
+		if (watched.count(pin) > 0) {
+			continue;
+		}
+
+		// An empty retained message deletes the retained message of its topic.
+		snprintf(topic, sizeof(topic), "pins/%u/state", pin);
+		if (!publishMessage(topic, "")) {
+			return false;
+		}
+		snprintf(topic, sizeof(topic), "pins/%u/changes", pin);
+		if (!publishMessage(topic, "")) {
+			return false;
+		}
+	}
+
+	published_pins = watched;
+	return true;
+}
+
+void MQTTHandler::flush() {
+	std::map<uint8_t, pin_change> latest;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (queue.empty() || millis() - queue.front().time < batch_interval) {
+			return;
+		}
+
+		for (const pin_change &change : queue) {
+			latest[change.pin] = change;
+		}
+		queue.clear();
+	}
+
+	const uint64_t now = millis();
+	uint64_t latency = 0;
+	uint32_t published = 0;
+	std::map<uint8_t, pin_change>::iterator it = latest.begin();
+	for (; it != latest.end(); it++) {
+		const pin_change &change = it->second;
+		if (!publishPin(change.pin, change.state, change.changes)) {
+			break;
+		}
+		published_pins.insert(change.pin);
+		latency += now - change.time;
+		published++;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	latency_sum += latency;
+	latency_count += published;
+
+	// Queue the rest again in front of the changes queued since, since they are older.
+	std::map<uint8_t, pin_change>::reverse_iterator failed(latest.end());
+	std::map<uint8_t, pin_change>::reverse_iterator first_failed(it);
+	for (; failed != first_failed; failed++) {
+		if (queue.size() >= queue_length) {
+			dropped_changes++;
+			continue;
+		}
+		queue.push_front(failed->second);
+	}
+}
+
+bool MQTTHandler::publishPin(const uint8_t pin, const bool state,
+		const uint64_t changes) {
+	char topic[32];
+	snprintf(topic, sizeof(topic), "pins/%u/state", pin);
+	if (!publishMessage(topic, state ? "High" : "Low")) {
+		return false;
+	}
+
+	char payload[24];
+	snprintf(topic, sizeof(topic), "pins/%u/changes", pin);
+	snprintf(payload, sizeof(payload), "%llu", changes);
+	return publishMessage(topic, payload);
+}
+
+bool MQTTHandler::publishMessage(const char *topic, const char *payload,
+		const bool retain) {
+	const std::string full_topic = prefix + '/' + topic;
+	if (client.publish(full_topic.c_str(), qos, retain, payload, strlen(payload))
+			== 0) {
+		failed_messages++;
+		return false;
+	}
+
+	published_messages++;
+	return true;
+}
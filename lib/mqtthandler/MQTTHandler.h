@@ -0,0 +1,322 @@
+/*
+ * MQTTHandler.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_MQTTHANDLER_MQTTHANDLER_H_
+#define LIB_MQTTHANDLER_MQTTHANDLER_H_
+
+#include "GPIOHandler.h"
+#include <AsyncMqttClient.h>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+
+/**
+ * Publishes the debounced pin changes of a GPIOHandler to a MQTT broker.
+ *
+ * Each watched pin has a retained state topic and a retained change counter topic.
+ * Changes are queued, and only sent once the oldest queued change is older than the batch interval.
+ * All queued changes of the same pin are combined into a single message, so rapid changes don't flood the broker.
+ * While the broker isn't connected changes stay in the queue, which has a fixed max length.
+ * If it is full the oldest change is dropped, so the memory use is bounded no matter how long the broker is unreachable.
+ */
+class MQTTHandler {
+public:
+	/**
+	 * The default max number of changes that can be queued before the oldest change is dropped.
+	 */
+	static const size_t DEFAULT_QUEUE_LENGTH = 64;
+
+	/**
+	 * The default time in milliseconds the oldest queued change waits for more changes to combine it with.
+	 */
+	static const uint32_t DEFAULT_BATCH_INTERVAL = 100;
+
+	/**
+	 * The time in milliseconds between two attempts to connect to the broker.
+	 */
+	static const uint32_t RECONNECT_INTERVAL = 5000;
+
+	/**
+	 * The default MQTT port.
+	 */
+	static const uint16_t DEFAULT_PORT = 1883;
+
+	/**
+	 * Creates a new MQTTHandler that isn't connected to any broker.
+	 *
+	 * @param gpio			The GPIOHandler to get the pin states from when (re)connecting.
+	 * @param queue_length	The max number of changes that can be queued.
+	 */
+	MQTTHandler(GPIOHandler &gpio = gpio_handler, const size_t queue_length =
+			DEFAULT_QUEUE_LENGTH);
+
+	/**
+	 * Disconnects from the broker.
+	 */
+	virtual ~MQTTHandler();
+
+	/**
+	 * Sets the broker to connect to, and starts connecting to it.
+	 * All topics of this handler start with the given prefix, which is also used as the client id.
+	 *
+	 * @param host		The host name or ip address of the broker.
+	 * @param port		The port of the broker.
+	 * @param prefix	The prefix of all topics, for example the host name of this device.
+	 * @param user		The user to log in with. NULL to not log in.
+	 * @param password	The password to log in with. NULL if no password is required.
+	 */
+	void begin(const char *host, const uint16_t port = DEFAULT_PORT,
+			const char *prefix = "esp-wifi-gpio-monitor", const char *user =
+					NULL, const char *password = NULL);
+
+	/**
+	 * Disconnects from the broker, and stops connecting to it.
+	 * Clears the queue, and stops queueing changes until begin is called again.
+	 */
+	void end();
+
+	/**
+	 * Connects to the broker if not connected, and sends the queued changes.
+	 * Republishes the states of all watched pins after connecting, or after the pin configuration changed.
+	 * Has to be called regularly from the main loop.
+	 */
+	void handle();
+
+	/**
+	 * Adds a pin change to the queue.
+	 * Drops the oldest queued change if the queue is full.
+	 * Ignores the change if no broker was set.
+	 *
+	 * @param change	The change to queue.
+	 */
+	void publish(const pin_change &change);
+
+	/**
+	 * Republishes the states of all watched pins, and clears the topics of pins that are no longer watched.
+	 * To be called when the set of watched pins changed.
+	 */
+	void publishConfigChange();
+
+	/**
+	 * Sets the quality of service level to publish the pin topics with.
+	 * The last will uses the new level from the next connection attempt on.
+	 *
+	 * @param qos	The new QoS level. Values above 2 are treated as 2.
+	 */
+	void setQoS(const uint8_t qos);
+
+	/**
+	 * Gets the quality of service level the pin topics are published with.
+	 *
+	 * @return	The current QoS level.
+	 */
+	uint8_t getQoS() const;
+
+	/**
+	 * Sets the time the oldest queued change waits for more changes to combine it with.
+	 * Set to zero to send every change as soon as possible.
+	 *
+	 * @param interval	The new batch interval in milliseconds.
+	 */
+	void setBatchInterval(const uint32_t interval);
+
+	/**
+	 * Gets the time the oldest queued change waits for more changes to combine it with.
+	 *
+	 * @return	The batch interval in milliseconds.
+	 */
+	uint32_t getBatchInterval() const;
+
+	/**
+	 * Checks whether this handler is currently connected to the broker.
+	 *
+	 * @return	True if the broker is connected.
+	 */
+	bool isConnected() const;
+
+	/**
+	 * Gets the number of changes currently waiting to be sent.
+	 *
+	 * @return	The number of queued changes.
+	 */
+	size_t getQueueLength() const;
+
+	/**
+	 * Gets the number of changes that were dropped because the queue was full.
+	 *
+	 * @return	The number of dropped changes.
+	 */
+	uint32_t getDroppedChanges() const;
+
+	/**
+	 * Gets the number of messages that were handed to the MQTT client successfully.
+	 *
+	 * @return	The number of published messages.
+	 */
+	uint32_t getPublishedMessages() const;
+
+	/**
+	 * Appends the prometheus metrics of this handler to the given string.
+	 * Contains the connection state, the queue length, the published and dropped changes, and the publish latency.
+	 *
+	 * @param metrics	The string to append the metrics to.
+	 */
+	void appendMetrics(std::string &metrics) const;
+private:
+	/**
+	 * The MQTT client connecting to the broker.
+	 */
+	AsyncMqttClient client;
+
+	/**
+	 * The GPIOHandler to get the pin states from.
+	 */
+	GPIOHandler *gpio;
+
+	/**
+	 * The host of the broker. Empty if no broker was set.
+	 * Kept here, since the client only keeps a pointer to it.
+	 */
+	std::string host;
+
+	/**
+	 * The prefix of all topics, also used as the client id.
+	 */
+	std::string prefix;
+
+	/**
+	 * The topic to publish whether this device is online to.
+	 * Also used for the last will, so it is set to offline when the connection is lost.
+	 */
+	std::string status_topic;
+
+	/**
+	 * The user to log in with.
+	 */
+	std::string user;
+
+	/**
+	 * The password to log in with.
+	 */
+	std::string password;
+
+	/**
+	 * The changes waiting to be sent, oldest first.
+	 */
+	std::deque<pin_change> queue;
+
+	/**
+	 * The max number of changes in the queue.
+	 */
+	const size_t queue_length;
+
+	/**
+	 * The mutex synchronizing access to the queue.
+	 * The queue is filled and sent from the main loop, but the metrics are read by the web server task.
+	 */
+	mutable std::mutex lock;
+
+	/**
+	 * The pins whose topics were published since connecting.
+	 * Used to clear the topics of pins that are no longer watched.
+	 */
+	std::set<uint8_t> published_pins;
+
+	/**
+	 * The quality of service level to publish the pin topics with.
+	 */
+	uint8_t qos = 1;
+
+	/**
+	 * The time the oldest queued change waits for more changes to combine it with, in milliseconds.
+	 */
+	uint32_t batch_interval = DEFAULT_BATCH_INTERVAL;
+
+	/**
+	 * Whether the client is currently connected to the broker.
+	 * Set from the async tcp task.
+	 */
+	volatile bool connected = false;
+
+	/**
+	 * Whether the states of all watched pins have to be published again.
+	 */
+	volatile bool resync = false;
+
+	/**
+	 * The last time connecting to the broker was attempted, in milliseconds since boot.
+	 */
+	uint64_t last_connect_attempt = 0;
+
+	/**
+	 * The number of changes that were dropped because the queue was full.
+	 */
+	uint32_t dropped_changes = 0;
+
+	/**
+	 * The number of messages handed to the client successfully.
+	 */
+	uint32_t published_messages = 0;
+
+	/**
+	 * The number of messages the client couldn't send, for example because its send buffer was full.
+	 * The changes of failed messages are queued again.
+	 */
+	uint32_t failed_messages = 0;
+
+	/**
+	 * The number of times the connection to the broker was established.
+	 */
+	uint32_t connects = 0;
+
+	/**
+	 * The total time from a pin change to publishing it, in milliseconds.
+	 */
+	uint64_t latency_sum = 0;
+
+	/**
+	 * The number of pin changes that were published, used for the latency average.
+	 */
+	uint32_t latency_count = 0;
+
+	/**
+	 * Publishes the state and change counter of all watched pins,
+	 * and clears the topics of pins that are no longer watched.
+	 *
+	 * @return	True if all messages were handed to the client.
+	 */
+	bool publishAll();
+
+	/**
+	 * Combines all queued changes of the same pin, and publishes the latest change of each pin.
+	 * Queues the changes that couldn't be published again.
+	 */
+	void flush();
+
+	/**
+	 * Publishes the state and change counter topics of a single pin.
+	 *
+	 * @param pin		The pin to publish the topics of.
+	 * @param state		The current state of the pin.
+	 * @param changes	The current number of changes of the pin.
+	 * @return	True if both messages were handed to the client.
+	 */
+	bool publishPin(const uint8_t pin, const bool state, const uint64_t changes);
+
+	/**
+	 * Publishes a single message with the configured QoS level.
+	 *
+	 * @param topic		The topic to publish to, without the prefix.
+	 * @param payload	The payload of the message.
+	 * @param retain	Whether the broker should retain the message.
+	 * @return	True if the message was handed to the client.
+	 */
+	bool publishMessage(const char *topic, const char *payload, const bool retain = true);
+};
+
+#endif /* LIB_MQTTHANDLER_MQTTHANDLER_H_ */
@@ -0,0 +1,276 @@
+/*
+ * FlashPartition.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "FlashPartition.h"
+#include <algorithm>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+EspFlashPartition::EspFlashPartition(const char *label) :
+		label(label) {
+}
+
+bool EspFlashPartition::begin() {
+	if (label == NULL) {
+		return false;
+	}
+
+	partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+			ESP_PARTITION_SUBTYPE_ANY, label);
+	return partition != NULL;
+}
+
+size_t EspFlashPartition::size() const {
+	return partition == NULL ? 0 : partition->size;
+}
+
+size_t EspFlashPartition::sectorSize() const {
+	return SPI_FLASH_SEC_SIZE;
+}
+
+bool EspFlashPartition::read(const size_t offset, void *buffer,
+		const size_t length) {
+	if (partition == NULL) {
+		return false;
+	}
+
+	return esp_partition_read(partition, offset, buffer, length) == ESP_OK;
+}
+
+bool EspFlashPartition::write(const size_t offset, const void *data,
+		const size_t length) {
+	if (partition == NULL) {
+		return false;
+	}
+
+	return esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
+
+bool EspFlashPartition::erase(const size_t offset, const size_t length) {
+	if (partition == NULL) {
+		return false;
+	}
+
+	return esp_partition_erase_range(partition, offset, length) == ESP_OK;
+}
+#endif
+
+FileFlashPartition::FileFlashPartition(const char *path, const size_t size,
+		const size_t sector_size) :
+		path(path), partition_size(size), sector_size(sector_size) {
+}
+
+FileFlashPartition::~FileFlashPartition() {
+	if (file != NULL) {
+		fclose(file);
+	}
+}
+
+bool FileFlashPartition::begin() {
+	if (file != NULL) {
+		return true;
+	}
+
+	if (path == NULL || sector_size == 0 || partition_size % sector_size != 0) {
+		return false;
+	}
+
+	file = fopen(path, "r+b");
+	if (file != NULL) {
+		fseek(file, 0, SEEK_END);
+		if ((size_t) ftell(file) >= partition_size) {
+			return true;
+		}
+		fclose(file);
+	}
+
+	// Create a new, fully erased, image.
+	file = fopen(path, "w+b");
+	if (file == NULL) {
+		return false;
+	}
+
+	if (!erase(0, partition_size)) {
+		fclose(file);
+		file = NULL;
+		return false;
+	}
+	return true;
+}
+
+size_t FileFlashPartition::size() const {
+	return partition_size;
+}
+
+size_t FileFlashPartition::sectorSize() const {
+	return sector_size;
+}
+
+bool FileFlashPartition::read(const size_t offset, void *buffer,
+		const size_t length) {
+	if (file == NULL || offset + length > partition_size) {
+		return false;
+	}
+
+	if (fseek(file, offset, SEEK_SET) != 0) {
+		return false;
+	}
+
+	return fread(buffer, 1, length, file) == length;
+}
+
+bool FileFlashPartition::write(const size_t offset, const void *data,
+		const size_t length) {
+	if (file == NULL || offset + length > partition_size) {
+		return false;
+	}
+
+	// Like NOR flash, writing can only clear bits.
+	uint8_t buffer[64];
+	const uint8_t *source = (const uint8_t*) data;
+	for (size_t pos = 0; pos < length; pos += sizeof(buffer)) {
+		const size_t chunk = std::min(sizeof(buffer), length - pos);
+		if (!read(offset + pos, buffer, chunk)) {
+			return false;
+		}
+
+		for (size_t i = 0; i < chunk; i++) {
+			buffer[i] &= source[pos + i];
+		}
+
+		if (fseek(file, offset + pos, SEEK_SET) != 0
+				|| fwrite(buffer, 1, chunk, file) != chunk) {
+			return false;
+		}
+	}
+	return fflush(file) == 0;
+}
+
+bool FileFlashPartition::erase(const size_t offset, const size_t length) {
+	if (file == NULL || offset % sector_size != 0 || length % sector_size != 0
+			|| offset + length > partition_size) {
+		return false;
+	}
+
+	uint8_t buffer[64];
+	memset(buffer, 0xFF, sizeof(buffer));
+	if (fseek(file, offset, SEEK_SET) != 0) {
+		return false;
+	}
+
+	for (size_t pos = 0; pos < length; pos += sizeof(buffer)) {
+		const size_t chunk = std::min(sizeof(buffer), length - pos);
+		if (fwrite(buffer, 1, chunk, file) != chunk) {
+			return false;
+		}
+	}
+	return fflush(file) == 0;
+}
+
+MemoryFlashPartition::MemoryFlashPartition(const size_t size,
+		const size_t sector_size) :
+		content(size, 0xFF), sector_size(sector_size) {
+}
+
+bool MemoryFlashPartition::begin() {
+	return sector_size != 0 && content.size() % sector_size == 0;
+}
+
+size_t MemoryFlashPartition::size() const {
+	return content.size();
+}
+
+size_t MemoryFlashPartition::sectorSize() const {
+	return sector_size;
+}
+
+bool MemoryFlashPartition::read(const size_t offset, void *buffer,
+		const size_t length) {
+	if (offset + length > content.size()) {
+		return false;
+	}
+
+	memcpy(buffer, content.data() + offset, length);
+	return true;
+}
+
+bool MemoryFlashPartition::write(const size_t offset, const void *data,
+		const size_t length) {
+	if (offset + length > content.size()) {
+		return false;
+	}
+
+	// Like NOR flash, writing can only clear bits.
+	const uint8_t *source = (const uint8_t*) data;
+	for (size_t i = 0; i < length; i++) {
+		content[offset + i] &= source[i];
+	}
+	return true;
+}
+
+bool MemoryFlashPartition::erase(const size_t offset, const size_t length) {
+	if (offset % sector_size != 0 || length % sector_size != 0
+			|| offset + length > content.size()) {
+		return false;
+	}
+
+	memset(content.data() + offset, 0xFF, length);
+	return true;
+}
+
+CountingFlashPartition::CountingFlashPartition(FlashPartition &partition) :
+		partition(&partition) {
+}
+
+bool CountingFlashPartition::begin() {
+	return partition->begin();
+}
+
+size_t CountingFlashPartition::size() const {
+	return partition->size();
+}
+
+size_t CountingFlashPartition::sectorSize() const {
+	return partition->sectorSize();
+}
+
+bool CountingFlashPartition::read(const size_t offset, void *buffer,
+		const size_t length) {
+	return partition->read(offset, buffer, length);
+}
+
+bool CountingFlashPartition::write(const size_t offset, const void *data,
+		const size_t length) {
+	if (!partition->write(offset, data, length)) {
+		return false;
+	}
+
+	bytes_written += length;
+	return true;
+}
+
+bool CountingFlashPartition::erase(const size_t offset, const size_t length) {
+	if (!partition->erase(offset, length)) {
+		return false;
+	}
+
+	sectors_erased += length / partition->sectorSize();
+	return true;
+}
+
+uint64_t CountingFlashPartition::getBytesWritten() const {
+	return bytes_written;
+}
+
+uint32_t CountingFlashPartition::getSectorsErased() const {
+	return sectors_erased;
+}
+
+void CountingFlashPartition::resetCounters() {
+	bytes_written = 0;
+	sectors_erased = 0;
+}
@@ -0,0 +1,292 @@
+/*
+ * FlashPartition.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_STORAGEHANDLER_FLASHPARTITION_H_
+#define LIB_STORAGEHANDLER_FLASHPARTITION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+#endif
+
+/**
+ * An abstract raw flash partition.
+ * Behaves like NOR flash, meaning writes can only clear bits,
+ * and erasing a sector sets all its bits.
+ */
+class FlashPartition {
+public:
+	/**
+	 * Destroys this FlashPartition.
+	 */
+	virtual ~FlashPartition() {
+	}
+
+	/**
+	 * Initializes this partition.
+	 * Has to be called before any other method.
+	 *
+	 * @return	True if the partition can be used.
+	 */
+	virtual bool begin() = 0;
+
+	/**
+	 * Gets the total size of this partition in bytes.
+	 *
+	 * @return	The size of this partition.
+	 */
+	virtual size_t size() const = 0;
+
+	/**
+	 * Gets the size of the smallest erasable unit of this partition in bytes.
+	 *
+	 * @return	The sector size of this partition.
+	 */
+	virtual size_t sectorSize() const = 0;
+
+	/**
+	 * Reads data from this partition.
+	 *
+	 * @param offset	The offset from the start of the partition to read from.
+	 * @param buffer	The buffer to write the read data to.
+	 * @param length	The number of bytes to read.
+	 * @return	True if reading succeeded.
+	 */
+	virtual bool read(const size_t offset, void *buffer, const size_t length) = 0;
+
+	/**
+	 * Writes data to this partition.
+	 * The written area should be erased first.
+	 *
+	 * @param offset	The offset from the start of the partition to write to.
+	 * @param data		The data to write.
+	 * @param length	The number of bytes to write.
+	 * @return	True if writing succeeded.
+	 */
+	virtual bool write(const size_t offset, const void *data, const size_t length) = 0;
+
+	/**
+	 * Erases a range of this partition.
+	 * Offset and length have to be multiples of the sector size.
+	 *
+	 * @param offset	The offset from the start of the partition of the first sector to erase.
+	 * @param length	The number of bytes to erase.
+	 * @return	True if erasing succeeded.
+	 */
+	virtual bool erase(const size_t offset, const size_t length) = 0;
+};
+
+#ifdef ESP_PLATFORM
+/**
+ * A FlashPartition writing directly to a data partition of the ESP32 flash.
+ */
+class EspFlashPartition: public FlashPartition {
+public:
+	/**
+	 * Creates a new EspFlashPartition for the data partition with the given label.
+	 *
+	 * @param label	The label of the data partition in the partition table.
+	 */
+	EspFlashPartition(const char *label);
+
+	/**
+	 * Destroys this EspFlashPartition.
+	 */
+	virtual ~EspFlashPartition() {
+	}
+
+	bool begin() override;
+
+	size_t size() const override;
+
+	size_t sectorSize() const override;
+
+	bool read(const size_t offset, void *buffer, const size_t length) override;
+
+	bool write(const size_t offset, const void *data, const size_t length) override;
+
+	bool erase(const size_t offset, const size_t length) override;
+private:
+	/**
+	 * The label of the partition to use.
+	 */
+	const char *label;
+
+	/**
+	 * The partition found by begin. NULL if it wasn't found.
+	 */
+	const esp_partition_t *partition = NULL;
+};
+#endif
+
+/**
+ * A FlashPartition emulated using an image file.
+ * Emulates NOR flash semantics, so it can stand in for a real partition in tests and benchmarks.
+ * Works on any system with a posix like file api, including the ESP32 virtual file system.
+ */
+class FileFlashPartition: public FlashPartition {
+public:
+	/**
+	 * Creates a new FileFlashPartition using the image file at the given path.
+	 *
+	 * @param path			The path of the image file. Created if it doesn't exist.
+	 * @param size			The size of the emulated partition in bytes.
+	 * @param sector_size	The size of an emulated flash sector.
+	 */
+	FileFlashPartition(const char *path, const size_t size,
+			const size_t sector_size = 4096);
+
+	/**
+	 * Destroys this FileFlashPartition and closes the image file.
+	 */
+	virtual ~FileFlashPartition();
+
+	bool begin() override;
+
+	size_t size() const override;
+
+	size_t sectorSize() const override;
+
+	bool read(const size_t offset, void *buffer, const size_t length) override;
+
+	bool write(const size_t offset, const void *data, const size_t length) override;
+
+	bool erase(const size_t offset, const size_t length) override;
+private:
+	/**
+	 * The path of the image file.
+	 */
+	const char *path;
+
+	/**
+	 * The size of the emulated partition.
+	 */
+	const size_t partition_size;
+
+	/**
+	 * The size of an emulated flash sector.
+	 */
+	const size_t sector_size;
+
+	/**
+	 * The open image file. NULL if begin wasn't called or failed.
+	 */
+	FILE *file = NULL;
+};
+
+/**
+ * A FlashPartition emulated in RAM.
+ * Emulates NOR flash semantics, and has no dependencies, so it can be used as a flash simulator on any system.
+ */
+class MemoryFlashPartition: public FlashPartition {
+public:
+	/**
+	 * Creates a new, fully erased, MemoryFlashPartition.
+	 *
+	 * @param size			The size of the emulated partition in bytes.
+	 * @param sector_size	The size of an emulated flash sector.
+	 */
+	MemoryFlashPartition(const size_t size, const size_t sector_size = 4096);
+
+	/**
+	 * Destroys this MemoryFlashPartition.
+	 */
+	virtual ~MemoryFlashPartition() {
+	}
+
+	bool begin() override;
+
+	size_t size() const override;
+
+	size_t sectorSize() const override;
+
+	bool read(const size_t offset, void *buffer, const size_t length) override;
+
+	bool write(const size_t offset, const void *data, const size_t length) override;
+
+	bool erase(const size_t offset, const size_t length) override;
+private:
+	/**
+	 * The content of the emulated partition.
+	 */
+	std::vector<uint8_t> content;
+
+	/**
+	 * The size of an emulated flash sector.
+	 */
+	const size_t sector_size;
+};
+
+/**
+ * A FlashPartition wrapping another one, counting the bytes physically written and the sectors erased.
+ */
+class CountingFlashPartition: public FlashPartition {
+public:
+	/**
+	 * Creates a new CountingFlashPartition wrapping the given partition.
+	 *
+	 * @param partition	The partition to forward all calls to.
+	 */
+	CountingFlashPartition(FlashPartition &partition);
+
+	/**
+	 * Destroys this CountingFlashPartition.
+	 */
+	virtual ~CountingFlashPartition() {
+	}
+
+	bool begin() override;
+
+	size_t size() const override;
+
+	size_t sectorSize() const override;
+
+	bool read(const size_t offset, void *buffer, const size_t length) override;
+
+	bool write(const size_t offset, const void *data, const size_t length) override;
+
+	bool erase(const size_t offset, const size_t length) override;
+
+	/**
+	 * Gets the number of bytes successfully written to the wrapped partition.
+	 *
+	 * @return	The number of written bytes.
+	 */
+	uint64_t getBytesWritten() const;
+
+	/**
+	 * Gets the number of sectors successfully erased in the wrapped partition.
+	 *
+	 * @return	The number of erased sectors.
+	 */
+	uint32_t getSectorsErased() const;
+
+	/**
+	 * Resets the written bytes and erased sectors counters to 0.
+	 */
+	void resetCounters();
+private:
+	/**
+	 * The wrapped partition.
+	 */
+	FlashPartition *partition;
+
+	/**
+	 * The number of bytes written to the wrapped partition.
+	 */
+	uint64_t bytes_written = 0;
+
+	/**
+	 * The number of sectors erased in the wrapped partition.
+	 */
+	uint32_t sectors_erased = 0;
+};
+
+#endif /* LIB_STORAGEHANDLER_FLASHPARTITION_H_ */
@@ -0,0 +1,185 @@
+/*
+ * PartitionStore.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "PartitionStore.h"
+#include <algorithm>
+
+PartitionStore::PartitionStore(FlashPartition *partition) :
+		partition(partition) {
+}
+
+bool PartitionStore::begin() {
+	if (initialized) {
+		return true;
+	}
+
+	if (partition == NULL || !partition->begin()) {
+		return false;
+	}
+
+	const size_t sector_size = partition->sectorSize();
+	const size_t sectors = sector_size == 0 ? 0 : partition->size() / sector_size;
+	// With a single sector, rotating would erase the previous record before writing the new one.
+	if (sectors < 2 || sector_size <= sizeof(partition_record_header)) {
+		return false;
+	}
+
+	newest = SIZE_MAX;
+	sequence = 0;
+	// Without any valid record, make the first write erase and use sector 0.
+	sector = sectors - 1;
+	offset = sector_size;
+
+	partition_record_header header;
+	for (size_t i = 0; i < sectors; i++) {
+		size_t pos = 0;
+		bool contains_newest = false;
+		while (pos + sizeof(header) <= sector_size) {
+			if (!partition->read(i * sector_size + pos, &header, sizeof(header))) {
+				return false;
+			}
+
+			if (header.magic == UINT32_MAX) {
+				break;
+			}
+
+			// Either garbage or a header that was only partially written, so the rest of this sector is unusable.
+			if (header.magic != RECORD_MAGIC
+					|| header.length > sector_size - pos - sizeof(header)) {
+				pos = sector_size;
+				break;
+			}
+
+			if ((newest == SIZE_MAX || header.sequence > sequence)
+					&& verify(i * sector_size + pos, header)) {
+				newest = i * sector_size + pos;
+				sequence = header.sequence;
+				contains_newest = true;
+			}
+			pos += recordSize(header.length);
+		}
+
+		if (contains_newest) {
+			sector = i;
+			offset = pos;
+		}
+	}
+
+	initialized = true;
+	return true;
+}
+
+bool PartitionStore::write(const uint8_t *data, const size_t length) {
+	if (!begin()) {
+		return false;
+	}
+
+	const size_t sector_size = partition->sectorSize();
+	const size_t record_size = recordSize(length);
+	if (record_size > sector_size) {
+		return false;
+	}
+
+	if (offset + record_size > sector_size) {
+		sector = (sector + 1) % (partition->size() / sector_size);
+		offset = 0;
+		if (!partition->erase(sector * sector_size, sector_size)) {
+			// Make sure the next write doesn't try to use the partially erased sector.
+			offset = sector_size;
+			return false;
+		}
+	}
+
+	partition_record_header header;
+	header.magic = RECORD_MAGIC;
+	header.sequence = sequence + 1;
+	header.length = length;
+	header.crc = crc32(0, (const uint8_t*) &header.sequence,
+			sizeof(header.sequence) + sizeof(header.length));
+	header.crc = crc32(header.crc, data, length);
+
+	// The header is written first, so that an interrupted write always leaves a record with an invalid CRC.
+	const size_t position = sector * sector_size + offset;
+	offset += record_size;
+	if (!partition->write(position, &header, sizeof(header))
+			|| (length > 0
+					&& !partition->write(position + sizeof(header), data,
+							length))) {
+		return false;
+	}
+
+	newest = position;
+	sequence = header.sequence;
+	return true;
+}
+
+bool PartitionStore::read(std::string &target) {
+	if (!begin() || newest == SIZE_MAX) {
+		return false;
+	}
+
+	partition_record_header header;
+	if (!partition->read(newest, &header, sizeof(header))) {
+		return false;
+	}
+
+	target.resize(header.length);
+	if (header.length > 0
+			&& !partition->read(newest + sizeof(header), &target[0],
+					header.length)) {
+		target.clear();
+		return false;
+	}
+	return true;
+}
+
+bool PartitionStore::hasRecord() {
+	return begin() && newest != SIZE_MAX;
+}
+
+void PartitionStore::setPartition(FlashPartition *partition) {
+	this->partition = partition;
+	initialized = false;
+}
+
+FlashPartition* PartitionStore::getPartition() const {
+	return partition;
+}
+
+uint32_t PartitionStore::crc32(uint32_t crc, const uint8_t *data,
+		const size_t length) {
+	crc = ~crc;
+	for (size_t i = 0; i < length; i++) {
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+bool PartitionStore::verify(const size_t position,
+		const partition_record_header &header) {
+	uint32_t crc = crc32(0, (const uint8_t*) &header.sequence,
+			sizeof(header.sequence) + sizeof(header.length));
+
+	uint8_t buffer[64];
+	for (size_t pos = 0; pos < header.length; pos += sizeof(buffer)) {
+		const size_t chunk = std::min<size_t>(sizeof(buffer),
+				header.length - pos);
+		if (!partition->read(position + sizeof(header) + pos, buffer, chunk)) {
+			return false;
+		}
+		crc = crc32(crc, buffer, chunk);
+	}
+
+	return crc == header.crc;
+}
+
+size_t PartitionStore::recordSize(const size_t length) {
+	return (sizeof(partition_record_header) + length + 3) & ~(size_t) 3;
+}
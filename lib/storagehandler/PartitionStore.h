@@ -0,0 +1,177 @@
+/*
+ * PartitionStore.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_STORAGEHANDLER_PARTITIONSTORE_H_
+#define LIB_STORAGEHANDLER_PARTITIONSTORE_H_
+
+#include "FlashPartition.h"
+#include <string>
+
+/**
+ * The header in front of every record in a PartitionStore.
+ */
+struct __attribute__((packed)) partition_record_header {
+	/**
+	 * A constant value used to recognize records.
+	 * Erased flash reads as 0xFFFFFFFF, which marks the start of the free space in a sector.
+	 */
+	uint32_t magic;
+
+	/**
+	 * The sequence number of this record.
+	 * The valid record with the highest sequence number is the current one.
+	 */
+	uint32_t sequence;
+
+	/**
+	 * The length of the data in this record, excluding this header.
+	 */
+	uint32_t length;
+
+	/**
+	 * The CRC32 of the sequence number, length, and data.
+	 * Used to detect records that weren't completely written.
+	 */
+	uint32_t crc;
+};
+
+/**
+ * A log structured store keeping the latest version of a small blob of data in a raw flash partition.
+ *
+ * Every write appends a new record to the current sector.
+ * Once a sector is full, the next one is erased and used, wrapping around at the end of the partition.
+ * This means every sector is erased equally often, and the previous record stays valid
+ * until the new one was completely written.
+ */
+class PartitionStore {
+public:
+	/**
+	 * Creates a new PartitionStore using the given partition.
+	 *
+	 * @param partition	The partition to store the records in. NULL to disable this store.
+	 */
+	PartitionStore(FlashPartition *partition = NULL);
+
+	/**
+	 * Destroys this PartitionStore.
+	 */
+	virtual ~PartitionStore() {
+	}
+
+	/**
+	 * Scans the partition for the newest valid record, and the position to write the next one to.
+	 * Called automatically by the first read or write.
+	 *
+	 * @return	True if the partition can be used.
+	 */
+	bool begin();
+
+	/**
+	 * Writes a new version of the stored data.
+	 *
+	 * @param data		The data to store.
+	 * @param length	The length of the data to store.
+	 * 					Has to fit in a single sector together with the record header.
+	 * @return	True if writing succeeded.
+	 */
+	bool write(const uint8_t *data, const size_t length);
+
+	/**
+	 * Reads the newest valid version of the stored data.
+	 *
+	 * @param target	The string to write the stored data to.
+	 * @return	False if there is no valid record, or reading failed.
+	 */
+	bool read(std::string &target);
+
+	/**
+	 * Checks whether this store contains a valid record.
+	 *
+	 * @return	True if there is data that can be read.
+	 */
+	bool hasRecord();
+
+	/**
+	 * Sets the partition to store the data in.
+	 * Does not copy the data from the previous partition.
+	 *
+	 * @param partition	The new partition to use. NULL to disable this store.
+	 */
+	void setPartition(FlashPartition *partition);
+
+	/**
+	 * Gets the partition this store currently uses.
+	 *
+	 * @return	The current partition, or NULL if this store is disabled.
+	 */
+	FlashPartition* getPartition() const;
+
+	/**
+	 * Calculates the CRC32 of the given data.
+	 *
+	 * @param crc		The CRC of the previous data, or 0 for the first block.
+	 * @param data		The data to calculate the CRC for.
+	 * @param length	The length of the data.
+	 * @return	The new CRC value.
+	 */
+	static uint32_t crc32(uint32_t crc, const uint8_t *data, const size_t length);
+
+	/**
+	 * The magic number at the start of every record.
+	 */
+	static constexpr uint32_t RECORD_MAGIC = 0x31535050;
+private:
+	/**
+	 * The partition the records are stored in.
+	 */
+	FlashPartition *partition;
+
+	/**
+	 * Whether begin was already called successfully.
+	 */
+	bool initialized = false;
+
+	/**
+	 * The sector the next record will be written to.
+	 */
+	size_t sector = 0;
+
+	/**
+	 * The offset in the current sector to write the next record to.
+	 */
+	size_t offset = 0;
+
+	/**
+	 * The sequence number of the newest record.
+	 */
+	uint32_t sequence = 0;
+
+	/**
+	 * The offset of the newest valid record from the start of the partition.
+	 * SIZE_MAX if there is no valid record.
+	 */
+	size_t newest = SIZE_MAX;
+
+	/**
+	 * Checks whether the record at the given offset is valid.
+	 *
+	 * @param position	The offset of the record from the start of the partition.
+	 * @param header	The already read header of the record.
+	 * @return	True if the record data matches its CRC.
+	 */
+	bool verify(const size_t position, const partition_record_header &header);
+
+	/**
+	 * Calculates the total size of a record with the given data length, including padding.
+	 *
+	 * @param length	The length of the record data.
+	 * @return	The size the record takes up in the partition.
+	 */
+	static size_t recordSize(const size_t length);
+};
+
+#endif /* LIB_STORAGEHANDLER_PARTITIONSTORE_H_ */
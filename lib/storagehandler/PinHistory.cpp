@@ -0,0 +1,366 @@
+/*
+ * PinHistory.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "PinHistory.h"
+
+PinHistory::PinHistory(fs::FS &file_system, const char *path,
+		const uint16_t pages) :
+		fs(&file_system), path(path), pages(pages) {
+	memset(buffer, 0, HISTORY_PAGE_SIZE);
+}
+
+PinHistory::~PinHistory() {
+}
+
+bool PinHistory::begin() {
+	if (initialized) {
+		return true;
+	}
+
+	if (path == NULL || pages == 0) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	memset(buffer, 0, HISTORY_PAGE_SIZE);
+	current = 0;
+
+	bool found = false;
+	if (fs->exists(path)) {
+		fs::File file = fs->open(path);
+		if (!file || file.isDirectory()) {
+			return false;
+		}
+
+		const size_t file_pages = std::min<size_t>(file.size() / HISTORY_PAGE_SIZE, pages);
+		history_page_header page_header;
+		uint32_t newest = 0;
+		for (uint16_t i = 0; i < file_pages; i++) {
+			if (!file.seek(i * HISTORY_PAGE_SIZE)
+					|| file.read((uint8_t*) &page_header, sizeof(page_header))
+							!= sizeof(page_header)) {
+				break;
+			}
+
+			if (page_header.magic == PAGE_MAGIC
+					&& (!found || page_header.sequence > newest)) {
+				newest = page_header.sequence;
+				current = i;
+				found = true;
+			}
+		}
+
+		if (found) {
+			file.seek(current * HISTORY_PAGE_SIZE);
+			if (file.read(buffer, HISTORY_PAGE_SIZE) != HISTORY_PAGE_SIZE
+					|| header()->used > HISTORY_PAGE_SIZE
+					|| header()->used < sizeof(history_page_header)) {
+				memset(buffer, 0, HISTORY_PAGE_SIZE);
+				header()->sequence = newest;
+				found = false;
+			}
+		}
+		file.close();
+	}
+
+	if (!found) {
+		const uint32_t sequence = header()->sequence + 1;
+		memset(buffer, 0, HISTORY_PAGE_SIZE);
+		header()->magic = PAGE_MAGIC;
+		header()->sequence = sequence;
+		header()->used = sizeof(history_page_header);
+	}
+
+	position = header()->used;
+	dirty = false;
+	initialized = true;
+	return true;
+}
+
+bool PinHistory::fits(const uint8_t pins) {
+	if (!begin()) {
+		return true;
+	}
+
+	return header()->records == 0
+			|| header()->used + 6 + pins * MAX_PIN_SIZE <= HISTORY_PAGE_SIZE;
+}
+
+bool PinHistory::beginRecord(const uint32_t time, const uint8_t pins) {
+	if (!begin()) {
+		return false;
+	}
+
+	if (!fits(pins)) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!writePage()) {
+			return false;
+		}
+		nextPage();
+	}
+
+	uint32_t last = header()->last;
+	if (header()->records == 0) {
+		header()->first = time;
+		last = time;
+	}
+
+	position = header()->used;
+	record_time = std::max(time, last);
+	writeVarint(record_time - last);
+	buffer[position++] = pins;
+	return true;
+}
+
+void PinHistory::appendPin(const uint8_t pin, const bool state,
+		const uint32_t changes, const uint32_t high_time) {
+	if (position + MAX_PIN_SIZE > HISTORY_PAGE_SIZE) {
+		return;
+	}
+
+	buffer[position++] = (pin & 0x7F) | (state ? 0x80 : 0);
+	writeVarint(changes);
+	writeVarint(high_time);
+}
+
+void PinHistory::endRecord() {
+	std::lock_guard<std::mutex> lock(mutex);
+	header()->used = position;
+	header()->last = record_time;
+	header()->records++;
+	dirty = true;
+}
+
+bool PinHistory::flush() {
+	if (!initialized || !dirty) {
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return writePage();
+}
+
+void PinHistory::setPath(const char *path) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (path == NULL || strlen(path) == 0) {
+		this->path = NULL;
+	} else {
+		this->path = path;
+	}
+	initialized = false;
+}
+
+const char* PinHistory::getPath() const {
+	return path;
+}
+
+const storage_backend_stats& PinHistory::getStats() const {
+	return stats;
+}
+
+void PinHistory::setFileSystem(fs::FS &file_system) {
+	std::lock_guard<std::mutex> lock(mutex);
+	fs = &file_system;
+	initialized = false;
+}
+
+history_page_header* PinHistory::header() {
+	return (history_page_header*) buffer;
+}
+
+bool PinHistory::writePage() {
+	if (path == NULL) {
+		return false;
+	}
+
+	const uint32_t start = StorageBackend::getTime();
+	stats.writes++;
+	// Pages are always written in full, so the file is never shorter than the offset to write at.
+	fs::File file = fs->open(path, fs->exists(path) ? "r+" : FILE_WRITE);
+	bool success = false;
+	if (file) {
+		success = file.seek(current * HISTORY_PAGE_SIZE)
+				&& file.write(buffer, HISTORY_PAGE_SIZE) == HISTORY_PAGE_SIZE;
+		file.close();
+	}
+
+	const uint32_t duration = StorageBackend::getTime() - start;
+	stats.write_time += duration;
+	if (duration > stats.max_write_time) {
+		stats.max_write_time = duration;
+	}
+
+	if (!success) {
+		return false;
+	}
+
+	stats.bytes_written += HISTORY_PAGE_SIZE;
+	dirty = false;
+	return true;
+}
+
+bool PinHistory::readPage(fs::File &file, const uint16_t index,
+		uint8_t *target) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (index == current) {
+			memcpy(target, buffer, HISTORY_PAGE_SIZE);
+			return true;
+		}
+	}
+
+	if (!file || !file.seek(index * HISTORY_PAGE_SIZE)) {
+		return false;
+	}
+
+	if (file.read(target, HISTORY_PAGE_SIZE) != HISTORY_PAGE_SIZE) {
+		return false;
+	}
+
+	return ((history_page_header*) target)->magic == PAGE_MAGIC;
+}
+
+void PinHistory::nextPage() {
+	const uint32_t sequence = header()->sequence + 1;
+	current = (current + 1) % pages;
+	memset(buffer, 0, HISTORY_PAGE_SIZE);
+	header()->magic = PAGE_MAGIC;
+	header()->sequence = sequence;
+	header()->used = sizeof(history_page_header);
+	position = header()->used;
+	dirty = false;
+}
+
+void PinHistory::writeVarint(uint32_t value) {
+	while (value >= 0x80) {
+		buffer[position++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	buffer[position++] = value;
+}
+
+bool PinHistory::readVarint(const uint8_t *page, size_t &pos,
+		const size_t end, uint32_t &value) {
+	value = 0;
+	for (uint8_t shift = 0; pos < end && shift < 35; shift += 7) {
+		const uint8_t byte = page[pos++];
+		value |= (uint32_t) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+PinHistory::Cursor::Cursor(PinHistory &history, const uint32_t from,
+		const uint32_t to, const uint8_t pin) :
+		history(&history), from(from), to(to), pin(pin) {
+	if (!history.begin()) {
+		done = true;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(history.mutex);
+		last_page = history.current;
+		last_sequence = history.header()->sequence;
+	}
+
+	if (history.fs->exists(history.path)) {
+		file = history.fs->open(history.path);
+	}
+}
+
+bool PinHistory::Cursor::next(history_record &record) {
+	while (!done) {
+		if (pins_left == 0 && pos >= used) {
+			if (!nextPage()) {
+				done = true;
+				return false;
+			}
+			continue;
+		}
+
+		uint32_t value;
+		if (pins_left == 0) {
+			if (!readVarint(page, pos, used, value) || pos >= used) {
+				pos = used;
+				continue;
+			}
+			time += value;
+			pins_left = page[pos++];
+
+			if (time > to) {
+				done = true;
+				return false;
+			}
+			continue;
+		}
+
+		if (pos >= used) {
+			pins_left = 0;
+			continue;
+		}
+
+		pins_left--;
+		const uint8_t pin_byte = page[pos++];
+		record.time = time;
+		record.pin = pin_byte & 0x7F;
+		record.state = (pin_byte & 0x80) != 0;
+		if (!readVarint(page, pos, used, record.changes)
+				|| !readVarint(page, pos, used, record.high_time)) {
+			pins_left = 0;
+			pos = used;
+			continue;
+		}
+
+		if (time >= from && (pin == UINT8_MAX || record.pin == pin)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool PinHistory::Cursor::nextPage() {
+	const uint16_t pages = history->pages;
+	while (pages_read < pages) {
+		pages_read++;
+		// The oldest page is the one after the last page, so start there.
+		const uint16_t index = (last_page + pages_read) % pages;
+		const uint32_t behind = pages - pages_read;
+		if (behind >= last_sequence) {
+			continue;
+		}
+
+		if (!history->readPage(file, index, page)) {
+			continue;
+		}
+
+		const history_page_header *page_header = (history_page_header*) page;
+		if (page_header->magic != PAGE_MAGIC
+				|| page_header->sequence != last_sequence - behind
+				|| page_header->records == 0
+				|| page_header->used > HISTORY_PAGE_SIZE) {
+			continue;
+		}
+
+		if (page_header->last < from) {
+			continue;
+		}
+
+		if (page_header->first > to) {
+			return false;
+		}
+
+		pos = sizeof(history_page_header);
+		used = page_header->used;
+		time = page_header->first;
+		pins_left = 0;
+		return true;
+	}
+	return false;
+}
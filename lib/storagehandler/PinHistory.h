@@ -0,0 +1,421 @@
+/*
+ * PinHistory.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_STORAGEHANDLER_PINHISTORY_H_
+#define LIB_STORAGEHANDLER_PINHISTORY_H_
+
+#include "StorageBackend.h"
+#include <FS.h>
+#include <mutex>
+
+/**
+ * The size of a single page of the history ring in bytes.
+ * Pages are the unit in which the history is written to the flash.
+ */
+static constexpr size_t HISTORY_PAGE_SIZE = 1024;
+
+/**
+ * The default number of pages in the history ring.
+ * 256 pages hold about a week of one minute intervals for five pins.
+ */
+static constexpr uint16_t HISTORY_DEFAULT_PAGES = 256;
+
+/**
+ * The header at the start of each page of the history ring.
+ */
+struct __attribute__((packed)) history_page_header {
+	/**
+	 * A constant value used to recognize initialized pages.
+	 */
+	uint32_t magic;
+
+	/**
+	 * The sequence number of this page.
+	 * Increases by one for every new page, used to find the newest page.
+	 */
+	uint32_t sequence;
+
+	/**
+	 * The time of the first record in this page, in seconds since the unix epoch.
+	 */
+	uint32_t first;
+
+	/**
+	 * The time of the last record in this page, in seconds since the unix epoch.
+	 */
+	uint32_t last;
+
+	/**
+	 * The number of bytes of this page used, including this header.
+	 */
+	uint16_t used;
+
+	/**
+	 * The number of interval records in this page.
+	 */
+	uint16_t records;
+};
+
+/**
+ * The aggregated values of a single pin for a single interval.
+ */
+struct history_record {
+	/**
+	 * The end time of the interval, in seconds since the unix epoch.
+	 */
+	uint32_t time;
+
+	/**
+	 * The hardware pin this record is for.
+	 */
+	uint8_t pin;
+
+	/**
+	 * The debounced state of the pin at the end of the interval.
+	 */
+	bool state;
+
+	/**
+	 * The number of state changes in this interval.
+	 */
+	uint32_t changes;
+
+	/**
+	 * The time in milliseconds the pin spent in the high state during this interval.
+	 */
+	uint32_t high_time;
+};
+
+/**
+ * A fixed size circular store of per-interval pin aggregates.
+ *
+ * Records are collected in a RAM page buffer, and only written to the flash once the page is full,
+ * or flush is called.
+ * Each interval is stored as a time delta to the previous interval in the same page,
+ * followed by the values for each pin, all encoded as variable length integers.
+ */
+class PinHistory {
+public:
+	/**
+	 * Creates a new PinHistory storing its pages in the given file.
+	 *
+	 * @param file_system	The file system on which to store the history file.
+	 * @param path			The path of the history file. NULL to disable the history.
+	 * @param pages			The number of pages the history file can hold.
+	 */
+	PinHistory(fs::FS &file_system, const char *path, const uint16_t pages =
+			HISTORY_DEFAULT_PAGES);
+
+	/**
+	 * Destroys this PinHistory.
+	 * Does NOT flush the current page.
+	 */
+	virtual ~PinHistory();
+
+	/**
+	 * Reads the page headers from the history file, to find where to continue appending.
+	 * Called automatically by the first append or query.
+	 *
+	 * @return	True if the history file could be used.
+	 */
+	bool begin();
+
+	/**
+	 * Starts a new interval record at the given time.
+	 * Has to be followed by exactly pins calls to appendPin, and a call to endRecord.
+	 * Writes the current page to the flash, and starts a new one, if the record might not fit.
+	 *
+	 * @param time	The end time of the interval, in seconds since the unix epoch.
+	 * @param pins	The number of pin values in this interval.
+	 * @return	False if the history is disabled, or writing a full page failed.
+	 */
+	bool beginRecord(const uint32_t time, const uint8_t pins);
+
+	/**
+	 * Appends the values of a single pin to the current interval record.
+	 *
+	 * @param pin		The hardware pin the values are for.
+	 * @param state		The state of the pin at the end of the interval.
+	 * @param changes	The number of state changes during the interval.
+	 * @param high_time	The time in milliseconds the pin was high during the interval.
+	 */
+	void appendPin(const uint8_t pin, const bool state, const uint32_t changes,
+			const uint32_t high_time);
+
+	/**
+	 * Finishes the current interval record.
+	 */
+	void endRecord();
+
+	/**
+	 * Checks whether a record with the given number of pin values is guaranteed to fit in the current page.
+	 * If it doesn't, the next beginRecord call will write the current page to the flash.
+	 *
+	 * @param pins	The number of pin values in the record.
+	 * @return	True if the record fits, or the history is disabled.
+	 */
+	bool fits(const uint8_t pins);
+
+	/**
+	 * Writes the current, partially filled, page to the flash.
+	 * Only writes if the page changed since it was last written.
+	 *
+	 * @return	True if nothing had to be written, or writing succeeded.
+	 */
+	bool flush();
+
+	/**
+	 * Sets the path of the file in which to store the history.
+	 * Does not delete the previous file, nor does it copy its content.
+	 * Setting this to NULL disables the history.
+	 *
+	 * @param path	The path of the new history file.
+	 */
+	void setPath(const char *path);
+
+	/**
+	 * Gets the path of the history file.
+	 *
+	 * @return	The current history file path.
+	 */
+	const char* getPath() const;
+
+	/**
+	 * Sets the file system on which to store the history file.
+	 *
+	 * @param file_system	The new file system to use.
+	 */
+	void setFileSystem(fs::FS &file_system);
+
+	/**
+	 * Gets the page write counters of this history.
+	 * Only the write related counters are used.
+	 *
+	 * @return	The stats of the page writes since startup.
+	 */
+	const storage_backend_stats& getStats() const;
+
+	/**
+	 * A cursor iterating over all the records in a time range.
+	 * Reads one page at a time, so its memory use doesn't depend on the size of the range.
+	 */
+	class Cursor {
+	public:
+		/**
+		 * Creates a new cursor for the records from the given history in the given time range.
+		 *
+		 * @param history	The history to read from.
+		 * @param from		The earliest interval end time to return, inclusive.
+		 * @param to		The latest interval end time to return, inclusive.
+		 * @param pin		The pin to return records for, or UINT8_MAX for all pins.
+		 */
+		Cursor(PinHistory &history, const uint32_t from, const uint32_t to,
+				const uint8_t pin = UINT8_MAX);
+
+		/**
+		 * Reads the next record in the range.
+		 *
+		 * @param record	The record to write the values to.
+		 * @return	False if there are no more records in the range.
+		 */
+		bool next(history_record &record);
+	private:
+		/**
+		 * The history this cursor reads.
+		 */
+		PinHistory *history;
+
+		/**
+		 * The earliest time to return records for.
+		 */
+		const uint32_t from;
+
+		/**
+		 * The latest time to return records for.
+		 */
+		const uint32_t to;
+
+		/**
+		 * The pin to return records for, or UINT8_MAX for all pins.
+		 */
+		const uint8_t pin;
+
+		/**
+		 * The history file to read the pages from.
+		 */
+		fs::File file;
+
+		/**
+		 * The index of the page that was being filled when this cursor was created.
+		 * This is the last page to read.
+		 */
+		uint16_t last_page = 0;
+
+		/**
+		 * The sequence number of the page that was being filled when this cursor was created.
+		 */
+		uint32_t last_sequence = 0;
+
+		/**
+		 * The number of pages already read.
+		 */
+		uint16_t pages_read = 0;
+
+		/**
+		 * The buffer containing the page currently being read.
+		 */
+		uint8_t page[HISTORY_PAGE_SIZE];
+
+		/**
+		 * The read position in the current page.
+		 */
+		size_t pos = 0;
+
+		/**
+		 * The number of used bytes in the current page.
+		 */
+		size_t used = 0;
+
+		/**
+		 * The time of the current interval record.
+		 */
+		uint32_t time = 0;
+
+		/**
+		 * The number of pins left in the current interval record.
+		 */
+		uint8_t pins_left = 0;
+
+		/**
+		 * Whether the cursor reached the end of the range.
+		 */
+		bool done = false;
+
+		/**
+		 * Loads the next page that contains records in the range.
+		 *
+		 * @return	False if there is no such page.
+		 */
+		bool nextPage();
+	};
+
+	/**
+	 * The magic number at the start of every initialized page.
+	 */
+	static constexpr uint32_t PAGE_MAGIC = 0x31524850;
+private:
+	/**
+	 * The file system on which the history file is stored.
+	 */
+	fs::FS *fs;
+
+	/**
+	 * The path of the history file. NULL if the history is disabled.
+	 */
+	const char *path;
+
+	/**
+	 * The number of pages in the history file.
+	 */
+	const uint16_t pages;
+
+	/**
+	 * Whether begin was already called successfully.
+	 */
+	bool initialized = false;
+
+	/**
+	 * The index of the page currently being filled.
+	 */
+	uint16_t current = 0;
+
+	/**
+	 * The page currently being filled.
+	 */
+	uint8_t buffer[HISTORY_PAGE_SIZE];
+
+	/**
+	 * Whether the current page changed since it was last written.
+	 */
+	bool dirty = false;
+
+	/**
+	 * The number and duration of the page writes.
+	 */
+	storage_backend_stats stats;
+
+	/**
+	 * The write position in the current page for the record currently being appended.
+	 */
+	size_t position = 0;
+
+	/**
+	 * The time of the record currently being appended.
+	 */
+	uint32_t record_time = 0;
+
+	/**
+	 * The mutex preventing the current page from being read while it is modified.
+	 */
+	std::mutex mutex;
+
+	/**
+	 * Gets the header of the page currently being filled.
+	 *
+	 * @return	A pointer to the header in the page buffer.
+	 */
+	history_page_header* header();
+
+	/**
+	 * Writes the current page to its index in the history file.
+	 *
+	 * @return	True if writing succeeded.
+	 */
+	bool writePage();
+
+	/**
+	 * Reads the page with the given index from the history file.
+	 * Copies the current RAM page instead if it is the page to read.
+	 *
+	 * @param file		The already open history file to read from.
+	 * @param index		The index of the page to read.
+	 * @param target	The buffer to write the page to. Has to be HISTORY_PAGE_SIZE bytes.
+	 * @return	True if the page could be read and was initialized.
+	 */
+	bool readPage(fs::File &file, const uint16_t index, uint8_t *target);
+
+	/**
+	 * Starts a new empty page after the current one.
+	 */
+	void nextPage();
+
+	/**
+	 * Writes the given value to the current page as a variable length integer.
+	 *
+	 * @param value	The value to write.
+	 */
+	void writeVarint(uint32_t value);
+
+	/**
+	 * Reads a variable length integer from the given page.
+	 *
+	 * @param page	The page to read from.
+	 * @param pos	The position to read at. Advanced past the read value.
+	 * @param end	The position after the last readable byte.
+	 * @param value	The variable to write the read value to.
+	 * @return	False if the value didn't end before the given end position.
+	 */
+	static bool readVarint(const uint8_t *page, size_t &pos, const size_t end,
+			uint32_t &value);
+
+	/**
+	 * The max number of bytes a single pin value can take up.
+	 */
+	static constexpr size_t MAX_PIN_SIZE = 1 + 5 + 5;
+};
+
+#endif /* LIB_STORAGEHANDLER_PINHISTORY_H_ */
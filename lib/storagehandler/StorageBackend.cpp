@@ -0,0 +1,323 @@
+/*
+ * StorageBackend.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "StorageBackend.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+storage_err_t StorageBackend::read(const char *path, std::string &target) {
+	if (path == NULL) {
+		return STORAGE_PATH_NULL;
+	}
+
+	simulateLatency(read_latency);
+	stats.reads++;
+	const storage_err_t err = readFile(path, target);
+	if (err == STORAGE_OK) {
+		stats.bytes_read += target.length();
+	}
+	return err;
+}
+
+storage_err_t StorageBackend::write(const char *path, const uint8_t *data,
+		const size_t length) {
+	if (path == NULL) {
+		return STORAGE_PATH_NULL;
+	}
+
+	const uint32_t start = getTime();
+	simulateLatency(write_latency);
+	stats.writes++;
+	const storage_err_t err = writeFile(path, data, length);
+	if (err == STORAGE_OK) {
+		stats.bytes_written += length;
+	}
+
+	const uint32_t duration = getTime() - start;
+	stats.write_time += duration;
+	if (duration > stats.max_write_time) {
+		stats.max_write_time = duration;
+	}
+	return err;
+}
+
+bool StorageBackend::exists(const char *path) {
+	if (path == NULL) {
+		return false;
+	}
+
+	simulateLatency(read_latency);
+	stats.lookups++;
+	return fileExists(path);
+}
+
+bool StorageBackend::remove(const char *path) {
+	if (path == NULL) {
+		return false;
+	}
+
+	simulateLatency(read_latency);
+	stats.lookups++;
+	return removeFile(path);
+}
+
+int StorageBackend::getWriteError() const {
+	return 0;
+}
+
+const storage_backend_stats& StorageBackend::getStats() const {
+	return stats;
+}
+
+void StorageBackend::resetStats() {
+	stats = storage_backend_stats();
+}
+
+void StorageBackend::setLatency(const uint32_t read_latency,
+		const uint32_t write_latency) {
+	this->read_latency = read_latency;
+	this->write_latency = write_latency;
+}
+
+void StorageBackend::simulateLatency(const uint32_t latency) {
+	if (latency == 0) {
+		return;
+	}
+
+#ifdef ARDUINO
+	// Busy wait, like a real flash access blocks the cpu.
+	delayMicroseconds(latency);
+#else
+	std::this_thread::sleep_for(std::chrono::microseconds(latency));
+#endif
+}
+
+uint32_t StorageBackend::getTime() {
+#ifdef ARDUINO
+	return micros();
+#else
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#ifdef ARDUINO
+FSStorageBackend::FSStorageBackend(fs::FS &file_system) :
+		fs(&file_system) {
+}
+
+int FSStorageBackend::getWriteError() const {
+	return write_error;
+}
+
+void FSStorageBackend::setFileSystem(fs::FS &file_system) {
+	fs = &file_system;
+}
+
+fs::FS& FSStorageBackend::getFileSystem() const {
+	return *fs;
+}
+
+storage_err_t FSStorageBackend::readFile(const char *path,
+		std::string &target) {
+	if (!fs->exists(path)) {
+		return STORAGE_NOT_FOUND;
+	}
+
+	fs::File file = fs->open(path);
+
+	if (!file) {
+		return STORAGE_OPEN_FAIL;
+	}
+
+	if (file.isDirectory()) {
+		return STORAGE_IS_DIR;
+	}
+
+	target.resize(file.size());
+	if (target.length() > 0) {
+		target.resize(file.read((uint8_t*) &target[0], target.length()));
+	}
+	file.close();
+	return STORAGE_OK;
+}
+
+storage_err_t FSStorageBackend::writeFile(const char *path,
+		const uint8_t *data, const size_t length) {
+	if (fs->exists(path)) {
+		fs::File file = fs->open(path);
+		if (file.isDirectory()) {
+			return STORAGE_IS_DIR;
+		}
+	}
+
+	fs::File file = fs->open(path, FILE_WRITE);
+
+	if (!file) {
+		return STORAGE_OPEN_FAIL;
+	}
+
+	file.write(data, length);
+
+	file.close();
+	write_error = file.getWriteError();
+
+	if (write_error == 0) {
+		return STORAGE_OK;
+	} else {
+#if CORE_DEBUG_LEVEL >= 3
+		Serial.print("Filesystem write error: ");
+		Serial.println(write_error);
+#endif
+		return STORAGE_WRITE_ERR;
+	}
+}
+
+bool FSStorageBackend::fileExists(const char *path) {
+	return fs->exists(path);
+}
+
+bool FSStorageBackend::removeFile(const char *path) {
+	return fs->remove(path);
+}
+#endif
+
+storage_err_t MemoryStorageBackend::readFile(const char *path,
+		std::string &target) {
+	std::map<std::string, std::string>::const_iterator file = files.find(path);
+	if (file == files.end()) {
+		return STORAGE_NOT_FOUND;
+	}
+
+	target = file->second;
+	return STORAGE_OK;
+}
+
+storage_err_t MemoryStorageBackend::writeFile(const char *path,
+		const uint8_t *data, const size_t length) {
+	files[path].assign((const char*) data, length);
+	return STORAGE_OK;
+}
+
+bool MemoryStorageBackend::fileExists(const char *path) {
+	return files.count(path) > 0;
+}
+
+bool MemoryStorageBackend::removeFile(const char *path) {
+	return files.erase(path) > 0;
+}
+
+PosixStorageBackend::PosixStorageBackend(const char *root) :
+		root(root == NULL ? "" : root) {
+}
+
+storage_err_t PosixStorageBackend::readFile(const char *path,
+		std::string &target) {
+	const std::string full_path = root + path;
+	struct stat info;
+	if (stat(full_path.c_str(), &info) != 0) {
+		return STORAGE_NOT_FOUND;
+	}
+
+	if (S_ISDIR(info.st_mode)) {
+		return STORAGE_IS_DIR;
+	}
+
+	FILE *file = fopen(full_path.c_str(), "rb");
+	if (file == NULL) {
+		return STORAGE_OPEN_FAIL;
+	}
+
+	target.resize(info.st_size);
+	if (target.length() > 0) {
+		target.resize(fread(&target[0], 1, target.length(), file));
+	}
+	fclose(file);
+	return STORAGE_OK;
+}
+
+storage_err_t PosixStorageBackend::writeFile(const char *path,
+		const uint8_t *data, const size_t length) {
+	const std::string full_path = root + path;
+	struct stat info;
+	if (stat(full_path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+		return STORAGE_IS_DIR;
+	}
+
+	FILE *file = fopen(full_path.c_str(), "wb");
+	if (file == NULL) {
+		return STORAGE_OPEN_FAIL;
+	}
+
+	const size_t written = length == 0 ? 0 : fwrite(data, 1, length, file);
+	if (fclose(file) != 0 || written != length) {
+		return STORAGE_WRITE_ERR;
+	}
+	return STORAGE_OK;
+}
+
+bool PosixStorageBackend::fileExists(const char *path) {
+	struct stat info;
+	return stat((root + path).c_str(), &info) == 0;
+}
+
+bool PosixStorageBackend::removeFile(const char *path) {
+	return ::remove((root + path).c_str()) == 0;
+}
+
+PartitionStorageBackend::PartitionStorageBackend(FlashPartition *partition) :
+		store(partition) {
+}
+
+void PartitionStorageBackend::setPartition(FlashPartition *partition) {
+	store.setPartition(partition);
+}
+
+FlashPartition* PartitionStorageBackend::getPartition() const {
+	return store.getPartition();
+}
+
+storage_err_t PartitionStorageBackend::readFile(const char *path,
+		std::string &target) {
+	if (!store.begin()) {
+		return STORAGE_OPEN_FAIL;
+	}
+
+	if (!store.read(target)) {
+		return STORAGE_NOT_FOUND;
+	}
+	return STORAGE_OK;
+}
+
+storage_err_t PartitionStorageBackend::writeFile(const char *path,
+		const uint8_t *data, const size_t length) {
+	if (!store.begin()) {
+		return STORAGE_OPEN_FAIL;
+	}
+
+	if (!store.write(data, length)) {
+#if CORE_DEBUG_LEVEL >= 3
+		Serial.println("Partition write error.");
+#endif
+		return STORAGE_WRITE_ERR;
+	}
+	return STORAGE_OK;
+}
+
+bool PartitionStorageBackend::fileExists(const char *path) {
+	return store.hasRecord();
+}
+
+bool PartitionStorageBackend::removeFile(const char *path) {
+	return false;
+}
@@ -0,0 +1,393 @@
+/*
+ * StorageBackend.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_STORAGEHANDLER_STORAGEBACKEND_H_
+#define LIB_STORAGEHANDLER_STORAGEBACKEND_H_
+
+#include "PartitionStore.h"
+#include <map>
+#include <string>
+#ifdef ARDUINO
+#include <FS.h>
+#endif
+
+/**
+ * The different return states(errors and OK) that can occur when interacting with the flash storage.
+ */
+enum storage_err_t {
+	STORAGE_OK,
+	STORAGE_PATH_NULL,
+	STORAGE_IS_DIR,
+	STORAGE_NOT_FOUND,
+	STORAGE_OPEN_FAIL,
+	STORAGE_WRITE_ERR,
+	STORAGE_TIME_UNSET
+};
+
+/**
+ * The number of operations and bytes a StorageBackend handled since its stats were last reset.
+ */
+struct storage_backend_stats {
+	/**
+	 * The number of read calls.
+	 */
+	uint32_t reads = 0;
+
+	/**
+	 * The number of write calls.
+	 */
+	uint32_t writes = 0;
+
+	/**
+	 * The number of exists and remove calls.
+	 */
+	uint32_t lookups = 0;
+
+	/**
+	 * The number of bytes returned by successful reads.
+	 */
+	uint64_t bytes_read = 0;
+
+	/**
+	 * The number of bytes given to successful writes.
+	 */
+	uint64_t bytes_written = 0;
+
+	/**
+	 * The total time spent in write calls, in microseconds.
+	 */
+	uint64_t write_time = 0;
+
+	/**
+	 * The longest time a single write call took, in microseconds.
+	 */
+	uint32_t max_write_time = 0;
+};
+
+/**
+ * An abstract storage location for whole files, like the pin storage csv.
+ *
+ * The public methods count the operations and bytes, and add the injected latency,
+ * before calling the protected implementation methods.
+ * This allows benchmarking and fuzzing the code using a backend with any implementation.
+ */
+class StorageBackend {
+public:
+	/**
+	 * Destroys this StorageBackend.
+	 */
+	virtual ~StorageBackend() {
+	}
+
+	/**
+	 * Reads the complete content of the file with the given path.
+	 *
+	 * @param path		The path of the file to read.
+	 * @param target	The string to write the file content to.
+	 * @return	What went wrong when trying to read the file.
+	 * 			STORAGE_OK if nothing went wrong.
+	 */
+	storage_err_t read(const char *path, std::string &target);
+
+	/**
+	 * Replaces the content of the file with the given path.
+	 * Creates the file if it doesn't exist.
+	 *
+	 * @param path		The path of the file to write.
+	 * @param data		The new content of the file.
+	 * @param length	The length of the new content.
+	 * @return	What went wrong when trying to write the file.
+	 * 			STORAGE_OK if nothing went wrong.
+	 */
+	storage_err_t write(const char *path, const uint8_t *data,
+			const size_t length);
+
+	/**
+	 * Checks whether a file with the given path exists.
+	 *
+	 * @param path	The path of the file to check.
+	 * @return	True if the file exists.
+	 */
+	bool exists(const char *path);
+
+	/**
+	 * Removes the file with the given path.
+	 *
+	 * @param path	The path of the file to remove.
+	 * @return	True if the file was removed.
+	 */
+	bool remove(const char *path);
+
+	/**
+	 * Gets the write error the underlying storage returned in the last write.
+	 * 0 if everything is ok, or the backend doesn't have write errors.
+	 *
+	 * @return	The write error from the last write call.
+	 */
+	virtual int getWriteError() const;
+
+	/**
+	 * Gets the operation and byte counters of this backend.
+	 *
+	 * @return	The stats since the last reset.
+	 */
+	const storage_backend_stats& getStats() const;
+
+	/**
+	 * Resets all operation and byte counters to 0.
+	 */
+	void resetStats();
+
+	/**
+	 * Sets an artificial latency to add to every operation.
+	 * Used to simulate slower storage.
+	 *
+	 * @param read_latency	The time in microseconds to add to every read, exists, and remove call.
+	 * @param write_latency	The time in microseconds to add to every write call.
+	 */
+	void setLatency(const uint32_t read_latency, const uint32_t write_latency);
+
+	/**
+	 * Gets a time in microseconds, to measure how long operations take.
+	 * Only the difference between two calls is meaningful.
+	 *
+	 * @return	The current time in microseconds.
+	 */
+	static uint32_t getTime();
+protected:
+	/**
+	 * Reads the complete content of the file with the given path.
+	 *
+	 * @param path		The path of the file to read. Never NULL.
+	 * @param target	The string to write the file content to.
+	 * @return	What went wrong when trying to read the file.
+	 */
+	virtual storage_err_t readFile(const char *path, std::string &target) = 0;
+
+	/**
+	 * Replaces the content of the file with the given path.
+	 *
+	 * @param path		The path of the file to write. Never NULL.
+	 * @param data		The new content of the file.
+	 * @param length	The length of the new content.
+	 * @return	What went wrong when trying to write the file.
+	 */
+	virtual storage_err_t writeFile(const char *path, const uint8_t *data,
+			const size_t length) = 0;
+
+	/**
+	 * Checks whether a file with the given path exists.
+	 *
+	 * @param path	The path of the file to check. Never NULL.
+	 * @return	True if the file exists.
+	 */
+	virtual bool fileExists(const char *path) = 0;
+
+	/**
+	 * Removes the file with the given path.
+	 *
+	 * @param path	The path of the file to remove. Never NULL.
+	 * @return	True if the file was removed.
+	 */
+	virtual bool removeFile(const char *path) = 0;
+private:
+	/**
+	 * The operation and byte counters of this backend.
+	 */
+	storage_backend_stats stats;
+
+	/**
+	 * The artificial latency of every read operation, in microseconds.
+	 */
+	uint32_t read_latency = 0;
+
+	/**
+	 * The artificial latency of every write operation, in microseconds.
+	 */
+	uint32_t write_latency = 0;
+
+	/**
+	 * Blocks for the given number of microseconds.
+	 *
+	 * @param latency	The time to block for.
+	 */
+	static void simulateLatency(const uint32_t latency);
+};
+
+#ifdef ARDUINO
+/**
+ * A StorageBackend storing files on an arduino file system, like SPIFFS or LittleFS.
+ */
+class FSStorageBackend: public StorageBackend {
+public:
+	/**
+	 * Creates a new FSStorageBackend using the given file system.
+	 *
+	 * @param file_system	The file system to store the files on.
+	 */
+	FSStorageBackend(fs::FS &file_system);
+
+	/**
+	 * Destroys this FSStorageBackend.
+	 */
+	virtual ~FSStorageBackend() {
+	}
+
+	int getWriteError() const override;
+
+	/**
+	 * Sets the file system to store the files on.
+	 *
+	 * @param file_system	The new file system to use.
+	 */
+	void setFileSystem(fs::FS &file_system);
+
+	/**
+	 * Gets the file system files are currently stored on.
+	 *
+	 * @return	The current file system.
+	 */
+	fs::FS& getFileSystem() const;
+protected:
+	storage_err_t readFile(const char *path, std::string &target) override;
+
+	storage_err_t writeFile(const char *path, const uint8_t *data,
+			const size_t length) override;
+
+	bool fileExists(const char *path) override;
+
+	bool removeFile(const char *path) override;
+private:
+	/**
+	 * The file system to store the files on.
+	 */
+	fs::FS *fs;
+
+	/**
+	 * The write error from the last write.
+	 */
+	int write_error = 0;
+};
+#endif
+
+/**
+ * A StorageBackend keeping all files in RAM.
+ * Used for tests and benchmarks, its content is lost on reset.
+ */
+class MemoryStorageBackend: public StorageBackend {
+public:
+	/**
+	 * Destroys this MemoryStorageBackend.
+	 */
+	virtual ~MemoryStorageBackend() {
+	}
+protected:
+	storage_err_t readFile(const char *path, std::string &target) override;
+
+	storage_err_t writeFile(const char *path, const uint8_t *data,
+			const size_t length) override;
+
+	bool fileExists(const char *path) override;
+
+	bool removeFile(const char *path) override;
+private:
+	/**
+	 * The content of all files, by their path.
+	 */
+	std::map<std::string, std::string> files;
+};
+
+/**
+ * A StorageBackend using the posix file api.
+ * Works on linux, as well as on the ESP32 virtual file system.
+ */
+class PosixStorageBackend: public StorageBackend {
+public:
+	/**
+	 * Creates a new PosixStorageBackend storing its files in the given directory.
+	 *
+	 * @param root	The directory to prepend to all paths. For example "/spiffs" on an ESP32.
+	 */
+	PosixStorageBackend(const char *root = "");
+
+	/**
+	 * Destroys this PosixStorageBackend.
+	 */
+	virtual ~PosixStorageBackend() {
+	}
+protected:
+	storage_err_t readFile(const char *path, std::string &target) override;
+
+	storage_err_t writeFile(const char *path, const uint8_t *data,
+			const size_t length) override;
+
+	bool fileExists(const char *path) override;
+
+	bool removeFile(const char *path) override;
+private:
+	/**
+	 * The directory to prepend to all paths.
+	 */
+	const std::string root;
+};
+
+/**
+ * A StorageBackend storing a single file directly in a raw flash partition.
+ * Uses a PartitionStore, so it ignores the path of the file.
+ */
+class PartitionStorageBackend: public StorageBackend {
+public:
+	/**
+	 * Creates a new PartitionStorageBackend using the given partition.
+	 *
+	 * @param partition	The partition to store the file in.
+	 */
+	PartitionStorageBackend(FlashPartition *partition = NULL);
+
+	/**
+	 * Destroys this PartitionStorageBackend.
+	 */
+	virtual ~PartitionStorageBackend() {
+	}
+
+	/**
+	 * Sets the partition to store the file in.
+	 * Does not copy the file from the previous partition.
+	 *
+	 * @param partition	The new partition to use.
+	 */
+	void setPartition(FlashPartition *partition);
+
+	/**
+	 * Gets the partition the file is stored in.
+	 *
+	 * @return	The current partition.
+	 */
+	FlashPartition* getPartition() const;
+protected:
+	storage_err_t readFile(const char *path, std::string &target) override;
+
+	storage_err_t writeFile(const char *path, const uint8_t *data,
+			const size_t length) override;
+
+	bool fileExists(const char *path) override;
+
+	/**
+	 * Raw partitions can't remove their data, since there is only ever one record.
+	 *
+	 * @param path	Ignored.
+	 * @return	Always false.
+	 */
+	bool removeFile(const char *path) override;
+private:
+	/**
+	 * The record log in which the file is stored.
+	 */
+	PartitionStore store;
+};
+
+#endif /* LIB_STORAGEHANDLER_STORAGEBACKEND_H_ */
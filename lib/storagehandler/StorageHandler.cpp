@@ -10,26 +10,29 @@
 StorageHandler storage_handler;
 
 StorageHandler::StorageHandler(fs::FS &file_system,
-		const char *pin_storage_path) :
-		fs(&file_system), pin_storage(pin_storage_path) {
+		const char *pin_storage_path, const char *history_path) :
+		pin_storage(pin_storage_path), fs_backend(file_system), backend(
+				&fs_backend), history(file_system, history_path) {
 }
 
-storage_err_t StorageHandler::storeGPIOHandler(GPIOHandler &handler) {
-	StorageHandler *storage = handler.getStorageHandler();
-	handler.setStorageHandler(NULL);
-	bool interrupts = handler.interrupsEnabled();
-	handler.disableInterrupts();
-	uint16_t debounce = handler.getDebounceTimeout();
-	handler.setDebounceTimeout(0);
+StorageHandler::StorageHandler(FlashPartition &partition, fs::FS &file_system,
+		const char *history_path) :
+		pin_storage("/pins.csv"), fs_backend(file_system), partition_backend(
+				&partition), backend(&partition_backend), history(file_system,
+				history_path) {
+}
 
-	storage_err_t err = storePins(handler.getWatchedPins());
+StorageHandler::StorageHandler(StorageBackend &backend,
+		const char *pin_storage_path, fs::FS &file_system,
+		const char *history_path) :
+		pin_storage(pin_storage_path), fs_backend(file_system), backend(
+				&backend), history(file_system, history_path) {
+}
 
-	handler.setStorageHandler(storage, false);
-	if (interrupts) {
-		handler.enableInterrupts();
-		handler.checkPins();
-	}
-	handler.setDebounceTimeout(debounce);
+storage_err_t StorageHandler::storeGPIOHandler(GPIOHandler &handler) {
+	const gpio_pause_state state = pauseGPIOHandler(handler);
+	storage_err_t err = storePins(handler.getWatchedPins());
+	resumeGPIOHandler(handler, state);
 	return err;
 }
 
@@ -38,70 +41,202 @@ storage_err_t StorageHandler::storePins(const std::vector<pin_state> &pins) {
 		return STORAGE_PATH_NULL;
 	}
 
-	if (fs->exists(pin_storage)) {
-		fs::File file = fs->open(pin_storage);
-		if (file.isDirectory()) {
-			return STORAGE_IS_DIR;
+	const std::string content = serializePins(pins);
+	return backend->write(pin_storage, (const uint8_t*) content.c_str(),
+			content.length());
+}
+
+storage_err_t StorageHandler::loadGPIOHandler(GPIOHandler &handler) const {
+	if (pin_storage == NULL) {
+		return STORAGE_PATH_NULL;
+	}
+
+	const gpio_pause_state pause_state = pauseGPIOHandler(handler);
+
+	std::string content;
+	const storage_err_t err = backend->read(pin_storage, content);
+	if (err != STORAGE_OK) {
+		resumeGPIOHandler(handler, pause_state);
+		return err;
+	}
+
+	const std::vector<pin_state> stored_pins = parsePins(content);
+	std::vector<pin_config> configs;
+	configs.reserve(stored_pins.size());
+	for (const pin_state &pin : stored_pins) {
+		configs.push_back( { pin.number, pin.name, pin.pull_up });
+	}
+
+	std::vector<gpio_err_t> results;
+	if (handler.configurePins(configs, &results) != GPIO_OK) {
+		// Skip invalid and duplicate pins rather than failing to load the valid ones.
+		std::vector<pin_config> valid;
+		for (size_t i = 0; i < configs.size(); i++) {
+			if (results[i] == GPIO_OK) {
+				valid.push_back(configs[i]);
+			}
+		}
+		handler.configurePins(valid);
+	}
+
+	for (size_t i = 0; i < stored_pins.size(); i++) {
+		if (results[i] != GPIO_OK) {
+			continue;
 		}
+
+		const pin_state &pin = stored_pins[i];
+		handler.setChanges(pin.number,
+				pin.state == handler.getState(pin.number) ?
+						pin.changes : pin.changes + 1);
 	}
 
-	fs::File storage_file = fs->open(pin_storage, FILE_WRITE);
+	resumeGPIOHandler(handler, pause_state);
+	return STORAGE_OK;
+}
 
-	if (!storage_file) {
-		return STORAGE_OPEN_FAIL;
+storage_err_t StorageHandler::recordHistory(GPIOHandler &handler) {
+	const time_t now = time(NULL);
+	if (now < MIN_VALID_TIME) {
+		return STORAGE_TIME_UNSET;
 	}
 
-	storage_file.println("Pin,Name,Resistor,State,Changes");
+	if (history.getPath() == NULL) {
+		return STORAGE_PATH_NULL;
+	}
 
-	for (pin_state state : pins) {
-		storage_file.printf("%hu,%s,%hu,%hu,%llu\n", state.number, state.name.c_str(),
-				state.pull_up, state.state, state.changes);
+	std::vector<pin_state> pins = handler.getWatchedPins();
+	std::map<uint8_t, std::pair<uint64_t, uint64_t>> interval_end;
+	uint8_t recorded = 0;
+	for (pin_state &pin : pins) {
+		interval_end[pin.number] = std::pair<uint64_t, uint64_t>(pin.changes,
+				handler.getHighTime(pin.number));
+		if (history_start.count(pin.number) > 0) {
+			recorded++;
+		}
 	}
 
-	storage_file.close();
-	write_error = storage_file.getWriteError();
+	storage_err_t err = STORAGE_OK;
+	if (recorded > 0) {
+		const bool write = !history.fits(recorded);
+		gpio_pause_state pause_state = { NULL, false, 0 };
+		if (write) {
+			pause_state = pauseGPIOHandler(handler);
+		}
 
-	if (write_error == 0) {
-		return STORAGE_OK;
-	} else {
-#if CORE_DEBUG_LEVEL >= 3
-		Serial.print("Filesystem write error: ");
-		Serial.println(write_error);
-#endif
-		return STORAGE_WRITE_ERR;
+		if (history.beginRecord(now, recorded)) {
+			for (pin_state &pin : pins) {
+				if (history_start.count(pin.number) == 0) {
+					continue;
+				}
+
+				const std::pair<uint64_t, uint64_t> &start = history_start[pin.number];
+				const std::pair<uint64_t, uint64_t> &end = interval_end[pin.number];
+				// Changes can be reset using setChanges, so don't assume they only increase.
+				const uint64_t changes = end.first >= start.first ? end.first - start.first : end.first;
+				const uint64_t high_time = end.second >= start.second ? end.second - start.second : 0;
+				history.appendPin(pin.number, pin.state, std::min<uint64_t>(changes, UINT32_MAX),
+						std::min<uint64_t>(high_time, UINT32_MAX));
+			}
+			history.endRecord();
+		} else {
+			err = STORAGE_WRITE_ERR;
+		}
+
+		if (write) {
+			resumeGPIOHandler(handler, pause_state);
+		}
 	}
+
+	history_start = interval_end;
+	return err;
 }
 
-storage_err_t StorageHandler::loadGPIOHandler(GPIOHandler &handler) const {
-	if (pin_storage == NULL) {
+storage_err_t StorageHandler::flushHistory(GPIOHandler &handler) {
+	if (history.getPath() == NULL) {
 		return STORAGE_PATH_NULL;
 	}
 
-	if (!fs->exists(pin_storage)) {
-		return STORAGE_NOT_FOUND;
+	const gpio_pause_state state = pauseGPIOHandler(handler);
+	const bool success = history.flush();
+	resumeGPIOHandler(handler, state);
+	return success ? STORAGE_OK : STORAGE_WRITE_ERR;
+}
+
+PinHistory& StorageHandler::getHistory() {
+	return history;
+}
+
+void StorageHandler::setPinStoragePath(const char *pin_storage_path) {
+	if (pin_storage_path == NULL || strlen(pin_storage_path) == 0) {
+		pin_storage = NULL;
+	} else {
+		pin_storage = pin_storage_path;
 	}
+}
 
-	fs::File storage_file = fs->open(pin_storage);
+const char* StorageHandler::getPinStoragePath() const {
+	return pin_storage;
+}
+
+void StorageHandler::setFileSystem(fs::FS &file_system) {
+	fs_backend.setFileSystem(file_system);
+	history.setFileSystem(file_system);
+}
+
+void StorageHandler::setBackend(StorageBackend *backend) {
+	this->backend = backend == NULL ? &fs_backend : backend;
+}
+
+StorageBackend& StorageHandler::getBackend() const {
+	return *backend;
+}
 
-	if (!storage_file) {
-		return STORAGE_OPEN_FAIL;
+void StorageHandler::setPartition(FlashPartition *partition) {
+	partition_backend.setPartition(partition);
+	if (partition == NULL) {
+		backend = &fs_backend;
+	} else {
+		backend = &partition_backend;
 	}
+}
+
+FlashPartition* StorageHandler::getPartition() const {
+	return backend == &partition_backend ? partition_backend.getPartition() : NULL;
+}
 
-	if (storage_file.isDirectory()) {
-		return STORAGE_IS_DIR;
+fs::FS& StorageHandler::getFileSystem() const {
+	return fs_backend.getFileSystem();
+}
+
+int StorageHandler::getWriteError() const {
+	return backend->getWriteError();
+}
+
+std::string StorageHandler::serializePins(const std::vector<pin_state> &pins) {
+	std::string content = "Pin,Name,Resistor,State,Changes\r\n";
+
+	char line[32];
+	for (const pin_state &state : pins) {
+		snprintf(line, sizeof(line), "%hu,", state.number);
+		content += line;
+		content += state.name.c_str();
+		snprintf(line, sizeof(line), ",%hu,%hu,%llu\n", state.pull_up,
+				state.state, state.changes);
+		content += line;
 	}
+	return content;
+}
 
-	StorageHandler *storage = handler.getStorageHandler();
-	handler.setStorageHandler(NULL);
-	bool interrupts = handler.interrupsEnabled();
-	handler.disableInterrupts();
-	uint16_t debounce = handler.getDebounceTimeout();
-	handler.setDebounceTimeout(0);
+std::vector<pin_state> StorageHandler::parsePins(const std::string &content) {
+	std::vector<pin_state> pins;
 
-	std::unordered_set<uint8_t> stored_pins;
+	for (size_t start = 0, end; start < content.length(); start = end + 1) {
+		end = content.find('\n', start);
+		if (end == std::string::npos) {
+			end = content.length();
+		}
 
-	for (String line; storage_file.available() > 0;) {
-		line = storage_file.readStringUntil('\n');
+		String line = content.substr(start, end - start).c_str();
 		if (line.length() == 0 || !isDigit(line[0])) {
 			continue;
 		}
@@ -134,53 +269,29 @@ storage_err_t StorageHandler::loadGPIOHandler(GPIOHandler &handler) const {
 			pos = end > 0 ? end + 1 : end;
 		}
 
-		if (handler.isWatched(number)) {
-			handler.updateGPIO(number, name, pull_up);
-		} else {
-			handler.registerGPIO(number, name, pull_up);
-		}
-		handler.setChanges(number,
-				state == handler.getState(number) ? changes : changes + 1);
-		stored_pins.insert(number);
+		pins.push_back(pin_state(NULL, number, name, pull_up, state, changes));
 	}
 
-	storage_file.close();
+	return pins;
+}
 
-	for (pin_state &pin : handler.getWatchedPins()) {
-		if (stored_pins.count(pin.number) == 0) {
-			handler.unregisterGPIO(pin.number);
-		}
-	}
+gpio_pause_state StorageHandler::pauseGPIOHandler(GPIOHandler &handler) {
+	gpio_pause_state state;
+	state.storage = handler.getStorageHandler();
+	handler.setStorageHandler(NULL);
+	state.interrupts = handler.interrupsEnabled();
+	handler.disableInterrupts();
+	state.debounce = handler.getDebounceTimeout();
+	handler.setDebounceTimeout(0);
+	return state;
+}
 
-	handler.setStorageHandler(storage, false);
-	if (interrupts) {
+void StorageHandler::resumeGPIOHandler(GPIOHandler &handler,
+		const gpio_pause_state &state) {
+	handler.setStorageHandler(state.storage, false);
+	if (state.interrupts) {
 		handler.enableInterrupts();
 		handler.checkPins();
 	}
-	handler.setDebounceTimeout(debounce);
-	return STORAGE_OK;
-}
-
-void StorageHandler::setPinStoragePath(const char *pin_storage_path) {
-	if (pin_storage_path == NULL || strlen(pin_storage_path) == 0) {
-		pin_storage = NULL;
-	} else {
-		pin_storage = pin_storage_path;
-	}
-}
-
-const char* StorageHandler::getPinStoragePath() const {
-	return pin_storage;
-}
-
-void StorageHandler::setFileSystem(fs::FS &file_system) {
-	fs = &file_system;
-}
-
-fs::FS& StorageHandler::getFileSystem() const {
-	return *fs;
-}
-
-int StorageHandler::getWriteError() const {
-	return write_error;
+	handler.setDebounceTimeout(state.debounce);
 }
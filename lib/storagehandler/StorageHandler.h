@@ -9,18 +9,28 @@
 #define LIB_STORAGEHANDLER_STORAGEHANDLER_H_
 
 #include "GPIOHandler.h"
+#include "PinHistory.h"
+#include "StorageBackend.h"
 #include <SPIFFS.h>
 
 /**
- * The different return states(errors and OK) that can occur when interacting with the flash storage.
+ * The state of a GPIOHandler before it was paused for a flash access.
  */
-enum storage_err_t {
-	STORAGE_OK,
-	STORAGE_PATH_NULL,
-	STORAGE_IS_DIR,
-	STORAGE_NOT_FOUND,
-	STORAGE_OPEN_FAIL,
-	STORAGE_WRITE_ERR
+struct gpio_pause_state {
+	/**
+	 * The StorageHandler the GPIOHandler used.
+	 */
+	StorageHandler *storage;
+
+	/**
+	 * Whether pin interrupts were enabled.
+	 */
+	bool interrupts;
+
+	/**
+	 * The debounce timeout of the GPIOHandler.
+	 */
+	uint16_t debounce;
 };
 
 class StorageHandler {
@@ -30,9 +40,35 @@ public:
 	 *
 	 * @param file_system		The filesystem on which to put the file storing the pin data.
 	 * @param pin_storage_path	The path to the file in which the pin data should be stored.
+	 * @param history_path		The path to the file in which the pin history should be stored.
 	 */
 	StorageHandler(fs::FS &file_system = SPIFFS, const char *pin_storage_path =
-			"/pins.csv");
+			"/pins.csv", const char *history_path = "/history.bin");
+
+	/**
+	 * Creates a new StorageHandler storing pin data directly in the given raw flash partition.
+	 * This bypasses the file system, and its metadata overhead, for the pin data.
+	 * The pin history is still stored on the given file system.
+	 *
+	 * @param partition		The partition in which the pin data should be stored.
+	 * @param file_system	The filesystem on which to put the file storing the pin history.
+	 * @param history_path	The path to the file in which the pin history should be stored.
+	 */
+	StorageHandler(FlashPartition &partition, fs::FS &file_system = SPIFFS,
+			const char *history_path = "/history.bin");
+
+	/**
+	 * Creates a new StorageHandler storing pin data using the given storage backend.
+	 * The pin history is still stored on the given file system.
+	 *
+	 * @param backend			The backend in which to store the pin data.
+	 * @param pin_storage_path	The path to the file in which the pin data should be stored.
+	 * @param file_system		The filesystem on which to put the file storing the pin history.
+	 * @param history_path		The path to the file in which the pin history should be stored.
+	 */
+	StorageHandler(StorageBackend &backend, const char *pin_storage_path =
+			"/pins.csv", fs::FS &file_system = SPIFFS,
+			const char *history_path = "/history.bin");
 
 	/**
 	 * Destroys this StorageHandler.
@@ -74,6 +110,37 @@ public:
 	 */
 	storage_err_t loadGPIOHandler(GPIOHandler &handler) const;
 
+	/**
+	 * Appends one interval record with the changes and time spent high of each pin
+	 * since the last call to the pin history.
+	 * The first call for a pin only records its current values as the start of the next interval.
+	 * Only writes to the flash if the current history page is full.
+	 * Disables pin interrupts while writing to the flash, to prevent crashes.
+	 *
+	 * @param handler	The GPIOHandler whose pins to record.
+	 * @return	What went wrong when trying to record the pin history.
+	 * 			STORAGE_OK if nothing went wrong.
+	 */
+	storage_err_t recordHistory(GPIOHandler &handler);
+
+	/**
+	 * Writes the current, partially filled, history page to the flash.
+	 * Disables pin interrupts while writing to the flash, to prevent crashes.
+	 *
+	 * @param handler	The GPIOHandler whose pin interrupts to disable while writing.
+	 * @return	What went wrong when trying to write the history page.
+	 * 			STORAGE_OK if nothing went wrong.
+	 */
+	storage_err_t flushHistory(GPIOHandler &handler);
+
+	/**
+	 * Gets the pin history this StorageHandler records to.
+	 * Can be used to query the recorded pin history.
+	 *
+	 * @return	The pin history.
+	 */
+	PinHistory& getHistory();
+
 	/**
 	 * Sets the path of the file in which to store the pin states in the future.
 	 * Does not delete the previous file, nor does it copy its content.
@@ -90,6 +157,39 @@ public:
 	 */
 	const char* getPinStoragePath() const;
 
+	/**
+	 * Sets the storage backend in which to store the pin states in the future.
+	 * Does not copy the content of the previous backend.
+	 * Setting this to NULL switches back to the file system backend.
+	 *
+	 * @param backend	The backend to store pin_state objects in.
+	 */
+	void setBackend(StorageBackend *backend);
+
+	/**
+	 * Gets the storage backend the pin states are currently stored in.
+	 *
+	 * @return	The current storage backend.
+	 */
+	StorageBackend& getBackend() const;
+
+	/**
+	 * Sets the raw flash partition in which to store the pin states in the future.
+	 * If set, the partition backend is used instead of the current backend.
+	 * Does not copy the content of the previous storage location.
+	 * Setting this to NULL switches back to the file system backend.
+	 *
+	 * @param partition	The partition to store pin_state objects in.
+	 */
+	void setPartition(FlashPartition *partition);
+
+	/**
+	 * Gets the raw flash partition the pin states are stored in.
+	 *
+	 * @return	The current partition, or NULL if the partition backend isn't used.
+	 */
+	FlashPartition* getPartition() const;
+
 	/**
 	 * Sets the file system on which to store and from which to load pin states.
 	 *
@@ -114,20 +214,77 @@ public:
 
 private:
 	/**
-	 * The file system to store the GPIO pin states onto.
-	 * Can never be NULL unless something major goes wrong.
+	 * The path of the file to store the pin states in.
 	 */
-	fs::FS *fs;
+	const char *pin_storage;
 
 	/**
-	 * The path of the file on the file system to store the pin states in.
+	 * The default backend storing the pin states on a file system.
 	 */
-	const char *pin_storage;
+	FSStorageBackend fs_backend;
+
+	/**
+	 * The backend storing the pin states directly in a raw flash partition.
+	 */
+	PartitionStorageBackend partition_backend;
+
+	/**
+	 * The backend currently used to store the pin states.
+	 * Can never be NULL.
+	 */
+	StorageBackend *backend;
+
+	/**
+	 * The circular store of per-interval pin aggregates.
+	 */
+	PinHistory history;
 
 	/**
-	 * The write error from the last time writing pin states to the flash.
+	 * The pin values at the end of the last history interval.
+	 * Used to calculate the values for the next interval.
+	 */
+	std::map<uint8_t, std::pair<uint64_t, uint64_t>> history_start;
+
+	/**
+	 * The earliest time, in seconds since the unix epoch, that is considered a valid current time.
+	 * Anything earlier means the time wasn't synchronized yet.
+	 */
+	static constexpr time_t MIN_VALID_TIME = 1640995200;
+
+	/**
+	 * Writes the given pins to a string in the pin storage csv format.
+	 *
+	 * @param pins	The pins to serialize.
+	 * @return	The csv representation of the given pins, including the header.
+	 */
+	static std::string serializePins(const std::vector<pin_state> &pins);
+
+	/**
+	 * Parses all pins from the given pin storage csv content.
+	 *
+	 * @param content	The pin storage csv content to parse.
+	 * @return	The pins stored in the content, with their stored state and number of changes.
+	 */
+	static std::vector<pin_state> parsePins(const std::string &content);
+
+	/**
+	 * Disables the storage handler, pin interrupts, and pin debouncing of the given GPIOHandler.
+	 * Required before accessing the flash, since a pin interrupt during a flash write causes a crash.
+	 *
+	 * @param handler	The GPIOHandler to pause.
+	 * @return	The previous state of the GPIOHandler, to be given to resumeGPIOHandler.
+	 */
+	static gpio_pause_state pauseGPIOHandler(GPIOHandler &handler);
+
+	/**
+	 * Restores the storage handler, pin interrupts, and pin debouncing of a GPIOHandler paused using pauseGPIOHandler.
+	 * Also checks all pin states, if pin interrupts were enabled, to detect changes while paused.
+	 *
+	 * @param handler	The GPIOHandler to resume.
+	 * @param state		The previous state of the GPIOHandler returned by pauseGPIOHandler.
 	 */
-	int write_error = 0;
+	static void resumeGPIOHandler(GPIOHandler &handler,
+			const gpio_pause_state &state);
 };
 
 extern StorageHandler storage_handler;
@@ -0,0 +1,107 @@
+/*
+ * AdmissionControl.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "AdmissionControl.h"
+#include <algorithm>
+
+const request_class AdmissionControl::ENDPOINT_CLASSES[ENDPOINT_COUNT] = {
+		REQUEST_CHEAP, REQUEST_PAGE, REQUEST_PAGE, REQUEST_API, REQUEST_API,
+		REQUEST_CHEAP, REQUEST_API, REQUEST_API, REQUEST_API, REQUEST_CHEAP,
+		REQUEST_CHEAP, REQUEST_API, REQUEST_CHEAP, REQUEST_CHEAP, REQUEST_CHEAP,
+		REQUEST_PAGE };
+
+const admission_limits AdmissionControl::DEFAULT_LIMITS[REQUEST_CLASS_COUNT] = {
+		{ 6, 16384, 4096 }, { 3, 32768, 8192 }, { UINT8_MAX, 0, 0 } };
+
+const char *const AdmissionControl::RESULT_NAMES[ADMISSION_RESULT_COUNT] = {
+		"accepted", "busy", "low_heap" };
+
+const uint8_t AdmissionControl::RETRY_AFTER[ADMISSION_RESULT_COUNT] = { 0, 1,
+		5 };
+
+AdmissionControl::AdmissionControl() :
+		active_renders(0), rejections() {
+	std::copy(DEFAULT_LIMITS, DEFAULT_LIMITS + REQUEST_CLASS_COUNT, limits);
+}
+
+admission_result AdmissionControl::admit(AsyncWebServerRequest *request,
+		const http_endpoint endpoint, const bool slot) {
+	if (endpoint >= ENDPOINT_COUNT
+			|| ENDPOINT_CLASSES[endpoint] == REQUEST_CHEAP) {
+		return ADMISSION_ACCEPTED;
+	}
+
+	const admission_limits &limit = limits[ENDPOINT_CLASSES[endpoint]];
+	admission_result result = ADMISSION_ACCEPTED;
+	if (slot && active_renders >= limit.max_renders) {
+		result = ADMISSION_BUSY;
+	} else if (ESP.getFreeHeap() < limit.min_free_heap
+			|| ESP.getMaxAllocHeap() < limit.min_free_block) {
+		result = ADMISSION_LOW_HEAP;
+	}
+
+	if (result != ADMISSION_ACCEPTED) {
+		rejections[endpoint][result]++;
+		return result;
+	}
+
+	if (slot) {
+		active_renders++;
+		request->onDisconnect([this]() {
+			if (active_renders > 0) {
+				active_renders--;
+			}
+		});
+	}
+	return ADMISSION_ACCEPTED;
+}
+
+void AdmissionControl::setLimits(const request_class type,
+		const admission_limits &limits) {
+	if (type < REQUEST_CLASS_COUNT) {
+		this->limits[type] = limits;
+	}
+}
+
+const admission_limits& AdmissionControl::getLimits(
+		const request_class type) const {
+	return limits[type];
+}
+
+uint8_t AdmissionControl::getActiveRenders() const {
+	return active_renders;
+}
+
+uint32_t AdmissionControl::getRejections(const http_endpoint endpoint,
+		const admission_result reason) const {
+	return rejections[endpoint][reason];
+}
+
+void AdmissionControl::appendMetrics(std::string &metrics) const {
+	char line[160];
+	metrics += "# HELP esp_http_active_renders The number of expensive responses currently in flight.\n";
+	metrics += "# TYPE esp_http_active_renders gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_http_active_renders %u\n",
+					active_renders)));
+
+	metrics += "# HELP esp_http_rejected_requests_total The number of requests answered with 503 by the admission control.\n";
+	metrics += "# TYPE esp_http_rejected_requests_total counter\n";
+	for (uint8_t i = 0; i < ENDPOINT_COUNT; i++) {
+		if (ENDPOINT_CLASSES[i] == REQUEST_CHEAP) {
+			continue;
+		}
+
+		for (uint8_t j = ADMISSION_BUSY; j < ADMISSION_RESULT_COUNT; j++) {
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_http_rejected_requests_total{endpoint=\"%s\",reason=\"%s\"} %u\n",
+							RequestStats::ENDPOINT_NAMES[i], RESULT_NAMES[j],
+							rejections[i][j])));
+		}
+	}
+}
@@ -0,0 +1,176 @@
+/*
+ * AdmissionControl.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_ADMISSIONCONTROL_H_
+#define LIB_WEBSERVERHANDLER_ADMISSIONCONTROL_H_
+
+#include "RequestStats.h"
+#include <ESPAsyncWebServer.h>
+#include <string>
+
+/**
+ * The request classes with separate admission limits.
+ * Classes with a lower value have a higher priority.
+ */
+enum request_class {
+	/**
+	 * Requests for the prometheus metrics and the machine readable pin states.
+	 */
+	REQUEST_API,
+
+	/**
+	 * Requests for rendered html pages.
+	 */
+	REQUEST_PAGE,
+
+	/**
+	 * Requests that don't allocate large buffers, like the static assets.
+	 * These are never rejected.
+	 */
+	REQUEST_CHEAP,
+	REQUEST_CLASS_COUNT
+};
+
+/**
+ * The reason a request was rejected.
+ */
+enum admission_result {
+	ADMISSION_ACCEPTED,
+	ADMISSION_BUSY,
+	ADMISSION_LOW_HEAP,
+	ADMISSION_RESULT_COUNT
+};
+
+/**
+ * The limits a request class has to stay below to be admitted.
+ */
+struct admission_limits {
+	/**
+	 * The max number of expensive responses that can be in flight when a request of this class is admitted.
+	 * This includes requests of other classes, so lower priority classes should have a lower limit.
+	 */
+	uint8_t max_renders;
+
+	/**
+	 * The minimum amount of free heap memory required to admit a request, in bytes.
+	 */
+	uint32_t min_free_heap;
+
+	/**
+	 * The minimum size of the largest allocatable heap block required to admit a request, in bytes.
+	 */
+	uint32_t min_free_block;
+};
+
+/**
+ * Decides whether the web server can afford to handle a request, based on the free heap and the number of responses in flight.
+ * Requests that are rejected should be answered with 503 Service Unavailable.
+ *
+ * A render slot is taken when a request is admitted, and released when its client disconnects.
+ * Not thread safe, since all request handlers run in the async tcp task.
+ */
+class AdmissionControl {
+public:
+	/**
+	 * The request class of each endpoint, indexed by their http_endpoint value.
+	 */
+	static const request_class ENDPOINT_CLASSES[ENDPOINT_COUNT];
+
+	/**
+	 * The default limits of each request class, indexed by their request_class value.
+	 */
+	static const admission_limits DEFAULT_LIMITS[REQUEST_CLASS_COUNT];
+
+	/**
+	 * The reason label values, indexed by their admission_result value.
+	 */
+	static const char *const RESULT_NAMES[ADMISSION_RESULT_COUNT];
+
+	/**
+	 * The value of the Retry-After header for rejected requests, in seconds, indexed by their admission_result value.
+	 */
+	static const uint8_t RETRY_AFTER[ADMISSION_RESULT_COUNT];
+
+	/**
+	 * Creates a new AdmissionControl object using the default limits.
+	 */
+	AdmissionControl();
+
+	/**
+	 * Checks whether a request for the given endpoint can be handled right now.
+	 * If it can, and the request isn't cheap, a render slot is taken until the client disconnects.
+	 * Rejections are counted per endpoint and reason.
+	 *
+	 * Takes over the disconnect handler of the request, so handlers that need their own have to be in the REQUEST_CHEAP class.
+	 *
+	 * @param request	The request to check.
+	 * @param endpoint	The endpoint that will handle the request.
+	 * @param slot		Whether the response needs a render slot.
+	 * 					Should be false for long-lived responses that don't hold a large buffer.
+	 * @return	Whether the request was accepted, or why it was rejected.
+	 */
+	admission_result admit(AsyncWebServerRequest *request,
+			const http_endpoint endpoint, const bool slot = true);
+
+	/**
+	 * Sets the limits of the given request class.
+	 *
+	 * @param type		The request class to set the limits for.
+	 * @param limits	The new limits of the request class.
+	 */
+	void setLimits(const request_class type, const admission_limits &limits);
+
+	/**
+	 * Gets the current limits of the given request class.
+	 *
+	 * @param type	The request class to get the limits of.
+	 * @return	The limits of the request class.
+	 */
+	const admission_limits& getLimits(const request_class type) const;
+
+	/**
+	 * Gets the number of render slots that are currently taken.
+	 *
+	 * @return	The number of expensive responses in flight.
+	 */
+	uint8_t getActiveRenders() const;
+
+	/**
+	 * Gets the number of requests for the given endpoint that were rejected for the given reason.
+	 *
+	 * @param endpoint	The endpoint to get the rejections for.
+	 * @param reason	The reason to get the rejections for.
+	 * @return	The number of rejected requests.
+	 */
+	uint32_t getRejections(const http_endpoint endpoint,
+			const admission_result reason) const;
+
+	/**
+	 * Appends the prometheus metrics for the render slots and rejected requests to the given string.
+	 *
+	 * @param metrics	The prometheus metrics to append to.
+	 */
+	void appendMetrics(std::string &metrics) const;
+private:
+	/**
+	 * The current limits of each request class.
+	 */
+	admission_limits limits[REQUEST_CLASS_COUNT];
+
+	/**
+	 * The number of render slots that are currently taken.
+	 */
+	uint8_t active_renders;
+
+	/**
+	 * The number of rejected requests per endpoint and reason.
+	 * The ADMISSION_ACCEPTED column is unused.
+	 */
+	uint32_t rejections[ENDPOINT_COUNT][ADMISSION_RESULT_COUNT];
+};
+
+#endif /* LIB_WEBSERVERHANDLER_ADMISSIONCONTROL_H_ */
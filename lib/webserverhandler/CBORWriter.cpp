@@ -0,0 +1,119 @@
+/*
+ * CBORWriter.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "CBORWriter.h"
+#include <string.h>
+
+CBORWriter::CBORWriter(uint8_t *buffer, const size_t size) :
+		buffer(buffer), size(size), pos(0), overflow(false) {
+}
+
+CBORWriter& CBORWriter::beginMap(const size_t pairs) {
+	writeHead(MAJOR_MAP, pairs);
+	return *this;
+}
+
+CBORWriter& CBORWriter::beginArray(const size_t elements) {
+	writeHead(MAJOR_ARRAY, elements);
+	return *this;
+}
+
+CBORWriter& CBORWriter::value(const uint64_t value) {
+	writeHead(MAJOR_UNSIGNED, value);
+	return *this;
+}
+
+CBORWriter& CBORWriter::value(const uint32_t value) {
+	writeHead(MAJOR_UNSIGNED, value);
+	return *this;
+}
+
+CBORWriter& CBORWriter::value(const int64_t value) {
+	if (value < 0) {
+		// Negative integers are encoded as -1 - n.
+		writeHead(MAJOR_NEGATIVE, -1 - value);
+	} else {
+		writeHead(MAJOR_UNSIGNED, value);
+	}
+	return *this;
+}
+
+CBORWriter& CBORWriter::value(const int32_t value) {
+	return this->value((int64_t) value);
+}
+
+CBORWriter& CBORWriter::value(const bool value) {
+	// The simple values false and true are 20 and 21.
+	writeHead(MAJOR_SIMPLE, value ? 21 : 20);
+	return *this;
+}
+
+CBORWriter& CBORWriter::value(const char *value) {
+	if (value == NULL) {
+		return null();
+	}
+
+	const size_t length = strlen(value);
+	writeHead(MAJOR_TEXT, length);
+	write((const uint8_t*) value, length);
+	return *this;
+}
+
+CBORWriter& CBORWriter::null() {
+	writeHead(MAJOR_SIMPLE, 22);
+	return *this;
+}
+
+size_t CBORWriter::length() const {
+	return pos;
+}
+
+bool CBORWriter::overflowed() const {
+	return overflow;
+}
+
+void CBORWriter::writeHead(const uint8_t major, const uint64_t argument) {
+	uint8_t head[9];
+	size_t length = 1;
+	if (argument < 24) {
+		head[0] = major << 5 | argument;
+	} else if (argument <= UINT8_MAX) {
+		head[0] = major << 5 | 24;
+		length = 2;
+	} else if (argument <= UINT16_MAX) {
+		head[0] = major << 5 | 25;
+		length = 3;
+	} else if (argument <= UINT32_MAX) {
+		head[0] = major << 5 | 26;
+		length = 5;
+	} else {
+		head[0] = major << 5 | 27;
+		length = 9;
+	}
+
+	// The argument is big endian.
+	for (size_t i = 1; i < length; i++) {
+		head[i] = argument >> ((length - i - 1) * 8);
+	}
+	write(head, length);
+}
+
+void CBORWriter::write(const uint8_t *data, const size_t length) {
+	if (overflow) {
+		return;
+	}
+
+	if (pos + length > size) {
+		memcpy(buffer + pos, data, size - pos);
+		pos = size;
+		overflow = true;
+		return;
+	}
+
+	memcpy(buffer + pos, data, length);
+	pos += length;
+}
@@ -0,0 +1,184 @@
+/*
+ * CBORWriter.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_CBORWRITER_H_
+#define LIB_WEBSERVERHANDLER_CBORWRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A minimal CBOR(RFC 8949) encoder writing directly to a fixed size buffer, without allocating any memory.
+ * Only supports definite length maps and arrays, so their size has to be known in advance.
+ * Integers are always encoded in the shortest possible form.
+ *
+ * If the buffer is too small, the output is cut off and overflowed returns true.
+ */
+class CBORWriter {
+public:
+	/**
+	 * Creates a new CBOR writer writing to the given buffer.
+	 *
+	 * @param buffer	The buffer to write to.
+	 * @param size		The size of the buffer.
+	 */
+	CBORWriter(uint8_t *buffer, const size_t size);
+
+	/**
+	 * Starts a map with the given number of key value pairs.
+	 *
+	 * @param pairs	The number of pairs in the map.
+	 * @return	This writer.
+	 */
+	CBORWriter& beginMap(const size_t pairs);
+
+	/**
+	 * Starts an array with the given number of elements.
+	 *
+	 * @param elements	The number of elements in the array.
+	 * @return	This writer.
+	 */
+	CBORWriter& beginArray(const size_t elements);
+
+	/**
+	 * Writes an unsigned integer.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	CBORWriter& value(const uint64_t value);
+
+	/**
+	 * Writes an unsigned integer.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	CBORWriter& value(const uint32_t value);
+
+	/**
+	 * Writes a signed integer.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	CBORWriter& value(const int64_t value);
+
+	/**
+	 * Writes a signed integer.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	CBORWriter& value(const int32_t value);
+
+	/**
+	 * Writes a boolean.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	CBORWriter& value(const bool value);
+
+	/**
+	 * Writes a UTF-8 text string.
+	 * Writes null if the value is NULL.
+	 *
+	 * @param value	The string to write.
+	 * @return	This writer.
+	 */
+	CBORWriter& value(const char *value);
+
+	/**
+	 * Writes a null value.
+	 *
+	 * @return	This writer.
+	 */
+	CBORWriter& null();
+
+	/**
+	 * Gets the number of bytes that were written to the buffer.
+	 *
+	 * @return	The length of the output.
+	 */
+	size_t length() const;
+
+	/**
+	 * Checks whether some of the output didn't fit in the buffer.
+	 *
+	 * @return	True if the output was cut off.
+	 */
+	bool overflowed() const;
+private:
+	/**
+	 * The CBOR major type of unsigned integers.
+	 */
+	static const uint8_t MAJOR_UNSIGNED = 0;
+
+	/**
+	 * The CBOR major type of negative integers.
+	 */
+	static const uint8_t MAJOR_NEGATIVE = 1;
+
+	/**
+	 * The CBOR major type of text strings.
+	 */
+	static const uint8_t MAJOR_TEXT = 3;
+
+	/**
+	 * The CBOR major type of arrays.
+	 */
+	static const uint8_t MAJOR_ARRAY = 4;
+
+	/**
+	 * The CBOR major type of maps.
+	 */
+	static const uint8_t MAJOR_MAP = 5;
+
+	/**
+	 * The CBOR major type of simple values like booleans.
+	 */
+	static const uint8_t MAJOR_SIMPLE = 7;
+
+	/**
+	 * The buffer to write to.
+	 */
+	uint8_t *buffer;
+
+	/**
+	 * The size of the buffer.
+	 */
+	const size_t size;
+
+	/**
+	 * The number of bytes written to the buffer.
+	 */
+	size_t pos;
+
+	/**
+	 * Whether some of the output didn't fit in the buffer.
+	 */
+	bool overflow;
+
+	/**
+	 * Writes the initial byte of a data item, followed by its argument.
+	 *
+	 * @param major		The major type of the data item.
+	 * @param argument	The argument, for example the value or length.
+	 */
+	void writeHead(const uint8_t major, const uint64_t argument);
+
+	/**
+	 * Writes the given bytes to the buffer.
+	 *
+	 * @param data		The bytes to write.
+	 * @param length	The number of bytes to write.
+	 */
+	void write(const uint8_t *data, const size_t length);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_CBORWRITER_H_ */
@@ -0,0 +1,151 @@
+/*
+ * EventStream.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "EventStream.h"
+#include "JSONWriter.h"
+#include <algorithm>
+
+EventStream::EventStream(const uint32_t timeout) :
+		timeout(timeout), dropped_clients(0) {
+}
+
+EventStream::~EventStream() {
+	closeAll();
+}
+
+AsyncWebServerResponse* EventStream::beginResponse(
+		AsyncWebServerRequest *request, const std::vector<pin_state> &pins) {
+	std::shared_ptr<client> cl = std::make_shared<client>();
+	cl->config_changed = false;
+	cl->offset = 0;
+	cl->pending_since = 0;
+	cl->closed = false;
+	for (const pin_state &pin : pins) {
+		cl->pending[pin.number] = {pin.number, pin.state, pin.changes, pin.last_change, pin.sequence};
+	}
+	if (!cl->pending.empty()) {
+		markPending(*cl);
+	}
+
+	AsyncWebServerResponse *response = request->beginChunkedResponse(
+			"text/event-stream",
+			[this, cl](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				return fill(*cl, buffer, max_len);
+			});
+	response->addHeader("Cache-Control", "no-cache");
+
+	request->onDisconnect([this, cl]() {
+		std::lock_guard<std::mutex> guard(lock);
+		clients.erase(std::remove(clients.begin(), clients.end(), cl),
+				clients.end());
+	});
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		clients.push_back(cl);
+	}
+	return response;
+}
+
+void EventStream::publish(const pin_change &change) {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::shared_ptr<client> &cl : clients) {
+		cl->pending[change.pin] = change;
+		markPending(*cl);
+	}
+}
+
+void EventStream::publishConfigChange() {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::shared_ptr<client> &cl : clients) {
+		cl->config_changed = true;
+		markPending(*cl);
+	}
+}
+
+void EventStream::checkClients() {
+	const uint64_t now = millis();
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::vector<std::shared_ptr<client>>::iterator it = clients.begin();
+			it != clients.end();) {
+		client &cl = **it;
+		if (cl.pending_since != 0 && now - cl.pending_since > timeout) {
+			// The response is ended the next time the web server tries to fill it.
+			cl.closed = true;
+			dropped_clients++;
+			it = clients.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+void EventStream::closeAll() {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::shared_ptr<client> &cl : clients) {
+		cl->closed = true;
+	}
+	clients.clear();
+}
+
+size_t EventStream::getClientCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return clients.size();
+}
+
+uint32_t EventStream::getDroppedClients() const {
+	return dropped_clients;
+}
+
+size_t EventStream::fill(client &cl, uint8_t *buffer, const size_t max_len) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (cl.closed) {
+		return 0;
+	}
+
+	size_t written = 0;
+	while (written < max_len) {
+		if (cl.offset >= cl.event.length()) {
+			cl.offset = 0;
+			if (cl.config_changed) {
+				cl.event = "event: config\ndata: {}\n\n";
+				cl.config_changed = false;
+			} else if (!cl.pending.empty()) {
+				cl.event = formatEvent(cl.pending.begin()->second);
+				cl.pending.erase(cl.pending.begin());
+			} else {
+				cl.event.clear();
+				cl.pending_since = 0;
+				break;
+			}
+		}
+
+		const size_t part = std::min(cl.event.length() - cl.offset,
+				max_len - written);
+		memcpy(buffer + written, cl.event.c_str() + cl.offset, part);
+		cl.offset += part;
+		written += part;
+	}
+
+	return written > 0 ? written : RESPONSE_TRY_AGAIN;
+}
+
+void EventStream::markPending(client &cl) {
+	if (cl.pending_since == 0) {
+		cl.pending_since = std::max<uint64_t>(millis(), 1);
+	}
+}
+
+std::string EventStream::formatEvent(const pin_change &change) {
+	char event[128];
+	JSONWriter json(event, sizeof(event));
+	json.raw("event: pin\ndata: ").beginObject().key("pin").value(
+			(uint32_t) change.pin).key("state").value(
+			change.state ? "High" : "Low").key("changes").value(change.changes).key(
+			"time").value(change.time).endObject().raw("\n\n");
+	return std::string(event, json.length());
+}
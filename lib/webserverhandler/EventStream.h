@@ -0,0 +1,180 @@
+/*
+ * EventStream.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_EVENTSTREAM_H_
+#define LIB_WEBSERVERHANDLER_EVENTSTREAM_H_
+
+#include "GPIOHandler.h"
+#include <ESPAsyncWebServer.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A Server-Sent Events stream sending debounced pin changes to all connected clients.
+ * Each client is a chunked response, that is filled whenever its TCP connection can send more data.
+ *
+ * Changes that weren't sent yet are coalesced per pin, so each client only keeps
+ * at most one pending event per pin, no matter how often the pin changes.
+ * Clients that don't receive their pending events within the timeout are dropped.
+ */
+class EventStream {
+public:
+	/**
+	 * The default time in milliseconds after which a client with unsent events is dropped.
+	 */
+	static const uint32_t DEFAULT_TIMEOUT = 10000;
+
+	/**
+	 * Creates a new event stream without any clients.
+	 *
+	 * @param timeout	The time in milliseconds after which a client with unsent events is dropped.
+	 */
+	EventStream(const uint32_t timeout = DEFAULT_TIMEOUT);
+
+	/**
+	 * Closes all clients.
+	 */
+	virtual ~EventStream();
+
+	/**
+	 * Creates a new event stream response for the given request.
+	 * Starts with a pin event for each of the given pins.
+	 * The caller has to send the response.
+	 *
+	 * @param request	The request to respond to.
+	 * @param pins		The current state of the watched pins.
+	 * @return	The created response.
+	 */
+	AsyncWebServerResponse* beginResponse(AsyncWebServerRequest *request,
+			const std::vector<pin_state> &pins);
+
+	/**
+	 * Adds a pin change to the pending events of all clients.
+	 * Replaces any pending event of the same pin.
+	 *
+	 * @param change	The change to send.
+	 */
+	void publish(const pin_change &change);
+
+	/**
+	 * Sends a config event to all clients, to notify them that the set of watched pins changed.
+	 */
+	void publishConfigChange();
+
+	/**
+	 * Drops all clients that had unsent events for longer than the timeout.
+	 * Should be called regularly.
+	 */
+	void checkClients();
+
+	/**
+	 * Closes all clients.
+	 */
+	void closeAll();
+
+	/**
+	 * Gets the number of currently connected clients.
+	 *
+	 * @return	The number of clients.
+	 */
+	size_t getClientCount() const;
+
+	/**
+	 * Gets the number of clients that were dropped because they were too slow.
+	 *
+	 * @return	The number of dropped clients.
+	 */
+	uint32_t getDroppedClients() const;
+private:
+	/**
+	 * The state of a single connected client.
+	 */
+	struct client {
+		/**
+		 * The pin changes that weren't sent to this client yet, by pin.
+		 */
+		std::map<uint8_t, pin_change> pending;
+
+		/**
+		 * Whether a config event has to be sent to this client.
+		 */
+		bool config_changed;
+
+		/**
+		 * The event that is currently being sent.
+		 */
+		std::string event;
+
+		/**
+		 * The number of bytes of the current event that were already sent.
+		 */
+		size_t offset;
+
+		/**
+		 * The time since which this client has unsent events, in milliseconds since boot.
+		 * Zero if everything was sent.
+		 */
+		uint64_t pending_since;
+
+		/**
+		 * Whether this client should be closed the next time it can send.
+		 */
+		bool closed;
+	};
+
+	/**
+	 * The time in milliseconds after which a client with unsent events is dropped.
+	 */
+	const uint32_t timeout;
+
+	/**
+	 * All currently connected clients.
+	 */
+	std::vector<std::shared_ptr<client>> clients;
+
+	/**
+	 * The mutex synchronizing access to the clients.
+	 * The clients are filled by the web server task, while changes are published from the main loop.
+	 */
+	mutable std::mutex lock;
+
+	/**
+	 * The number of clients that were dropped because they were too slow.
+	 */
+	uint32_t dropped_clients;
+
+	/**
+	 * Writes as much of the pending events of the given client to the given buffer as fits.
+	 *
+	 * @param cl		The client whose events to write.
+	 * @param buffer	The buffer to write to.
+	 * @param max_len	The size of the buffer.
+	 * @return	The number of bytes written, RESPONSE_TRY_AGAIN if there was nothing to send,
+	 * 			or zero to end the response.
+	 */
+	size_t fill(client &cl, uint8_t *buffer, const size_t max_len);
+
+	/**
+	 * Marks the given client as having unsent events, if it wasn't already.
+	 *
+	 * @param cl	The client to mark.
+	 */
+	static void markPending(client &cl);
+
+	/**
+	 * Formats a pin event for the given change.
+	 *
+	 * @param change	The change to format.
+	 * @return	The Server-Sent Event as a string.
+	 */
+	static std::string formatEvent(const pin_change &change);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_EVENTSTREAM_H_ */
@@ -0,0 +1,147 @@
+/*
+ * HTMLTemplate.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "HTMLTemplate.h"
+#include <string.h>
+#include <algorithm>
+
+HTMLTemplate::HTMLTemplate() :
+		literal_length(0) {
+}
+
+HTMLTemplate::HTMLTemplate(const char *source,
+		const char *const placeholders[], const size_t count) :
+		literal_length(0) {
+	parse(source, placeholders, count);
+}
+
+void HTMLTemplate::parse(const char *source, const char *const placeholders[],
+		const size_t count) {
+	segments.clear();
+	literal_length = 0;
+	if (source == NULL) {
+		return;
+	}
+
+	const char *literal = source;
+	const char *current = source;
+	while ((current = strchr(current, '$')) != NULL) {
+		int16_t placeholder = LITERAL;
+		size_t name_length = 0;
+		for (size_t i = 0; i < count; i++) {
+			const size_t length = strlen(placeholders[i]);
+			if (length > name_length
+					&& strncmp(current + 1, placeholders[i], length) == 0) {
+				placeholder = i;
+				name_length = length;
+			}
+		}
+
+		if (placeholder == LITERAL) {
+			current++;
+			continue;
+		}
+
+		if (current > literal) {
+			segments.push_back( { literal, (size_t) (current - literal), LITERAL });
+			literal_length += current - literal;
+		}
+
+		segments.push_back( { current, name_length + 1, placeholder });
+		current += name_length + 1;
+		literal = current;
+	}
+
+	const size_t remaining = strlen(literal);
+	if (remaining > 0) {
+		segments.push_back( { literal, remaining, LITERAL });
+		literal_length += remaining;
+	}
+}
+
+size_t HTMLTemplate::getLength(const char *const values[]) const {
+	size_t length = literal_length;
+	for (const segment &seg : segments) {
+		if (seg.placeholder == LITERAL) {
+			continue;
+		} else if (values[seg.placeholder] == NULL) {
+			length += seg.length;
+		} else {
+			length += strlen(values[seg.placeholder]);
+		}
+	}
+	return length;
+}
+
+size_t HTMLTemplate::render(std::string &out, const char *const values[],
+		const size_t start, const int16_t stop) const {
+	for (size_t i = start; i < segments.size(); i++) {
+		const segment &seg = segments[i];
+		if (seg.placeholder == LITERAL) {
+			out.append(seg.start, seg.length);
+		} else if (seg.placeholder == stop) {
+			return i + 1;
+		} else if (values[seg.placeholder] == NULL) {
+			out.append(seg.start, seg.length);
+		} else {
+			out.append(values[seg.placeholder]);
+		}
+	}
+	return segments.size();
+}
+
+std::string HTMLTemplate::render(const char *const values[]) const {
+	std::string out;
+	out.reserve(getLength(values));
+	render(out, values);
+	return out;
+}
+
+size_t HTMLTemplate::render(char *buffer, const size_t max_len,
+		const char *const values[], position &pos, const int16_t stop) const {
+	size_t written = 0;
+	while (written < max_len && pos.segment < segments.size()) {
+		const segment &seg = segments[pos.segment];
+		if (seg.placeholder != LITERAL && seg.placeholder == stop) {
+			break;
+		}
+
+		const char *text = seg.start;
+		size_t length = seg.length;
+		if (seg.placeholder != LITERAL && values[seg.placeholder] != NULL) {
+			text = values[seg.placeholder];
+			length = strlen(text);
+		}
+
+		const size_t part = std::min(length - pos.offset, max_len - written);
+		memcpy(buffer + written, text + pos.offset, part);
+		written += part;
+		pos.offset += part;
+		if (pos.offset >= length) {
+			skip(pos);
+		}
+	}
+	return written;
+}
+
+bool HTMLTemplate::isAt(const position &pos, const int16_t placeholder) const {
+	return pos.segment < segments.size() && pos.offset == 0
+			&& segments[pos.segment].placeholder == placeholder;
+}
+
+void HTMLTemplate::skip(position &pos) const {
+	pos.segment++;
+	pos.offset = 0;
+}
+
+bool HTMLTemplate::isDone(const position &pos) const {
+	return pos.segment >= segments.size();
+}
+
+size_t HTMLTemplate::getSegmentCount() const {
+	return segments.size();
+}
@@ -0,0 +1,188 @@
+/*
+ * HTMLTemplate.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_HTMLTEMPLATE_H_
+#define LIB_WEBSERVERHANDLER_HTMLTEMPLATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * A page template parsed into a list of literal and placeholder segments.
+ * The template is parsed once, and can then be rendered in a single pass.
+ *
+ * Placeholders are a '$' followed by one of the placeholder names given to parse.
+ * If multiple names match, the longest one is used.
+ * The template source isn't copied, so it has to stay valid as long as the template is used.
+ */
+class HTMLTemplate {
+public:
+	/**
+	 * The placeholder index of literal segments.
+	 */
+	static const int16_t LITERAL = -1;
+
+	/**
+	 * A position in a template, to render it in multiple parts.
+	 */
+	struct position {
+		/**
+		 * The index of the current segment.
+		 */
+		size_t segment;
+
+		/**
+		 * The number of bytes of the current segment that were already rendered.
+		 */
+		size_t offset;
+	};
+
+	/**
+	 * Creates a new empty template.
+	 * Use parse to set its content.
+	 */
+	HTMLTemplate();
+
+	/**
+	 * Creates a new template and parses the given source.
+	 *
+	 * @param source		The template text to parse.
+	 * @param placeholders	The names of the placeholders, without the '$'.
+	 * 						The index of a name is the index of its value when rendering.
+	 * @param count			The number of placeholder names.
+	 */
+	HTMLTemplate(const char *source, const char *const placeholders[],
+			const size_t count);
+
+	/**
+	 * Parses the given source, replacing the current content of this template.
+	 *
+	 * @param source		The template text to parse.
+	 * @param placeholders	The names of the placeholders, without the '$'.
+	 * 						The index of a name is the index of its value when rendering.
+	 * @param count			The number of placeholder names.
+	 */
+	void parse(const char *source, const char *const placeholders[],
+			const size_t count);
+
+	/**
+	 * Calculates the length of this template rendered with the given values.
+	 * Placeholders with a NULL value count with their own source text.
+	 *
+	 * @param values	The placeholder values, indexed like the names given to parse.
+	 * @return	The length of the rendered template.
+	 */
+	size_t getLength(const char *const values[]) const;
+
+	/**
+	 * Appends this template, with its placeholders replaced by the given values, to the given string.
+	 * Placeholders with a NULL value are left unchanged.
+	 * If stop is a placeholder index, rendering stops before the first occurrence of that placeholder.
+	 *
+	 * @param out		The string to append the rendered template to.
+	 * @param values	The placeholder values, indexed like the names given to parse.
+	 * @param start		The index of the segment to start rendering at.
+	 * @param stop		The placeholder before which to stop rendering.
+	 * @return	The index of the segment after the stop placeholder.
+	 * 			The number of segments if the template was rendered to the end.
+	 */
+	size_t render(std::string &out, const char *const values[],
+			const size_t start = 0, const int16_t stop = LITERAL) const;
+
+	/**
+	 * Renders this template with the given values into a new string.
+	 * The string is allocated with the exact length before rendering.
+	 *
+	 * @param values	The placeholder values, indexed like the names given to parse.
+	 * @return	The rendered template.
+	 */
+	std::string render(const char *const values[]) const;
+
+	/**
+	 * Renders as much of this template as fits into the given buffer, starting at the given position.
+	 * Placeholders with a NULL value are left unchanged.
+	 * Stops before the first occurrence of the stop placeholder, leaving the position pointing at it.
+	 * Use skip to continue rendering after it.
+	 *
+	 * @param buffer	The buffer to write the rendered template to.
+	 * @param max_len	The size of the buffer.
+	 * @param values	The placeholder values, indexed like the names given to parse.
+	 * @param pos		The position to start at. Updated to the position after the last written byte.
+	 * @param stop		The placeholder before which to stop rendering.
+	 * @return	The number of bytes written to the buffer.
+	 */
+	size_t render(char *buffer, const size_t max_len,
+			const char *const values[], position &pos,
+			const int16_t stop = LITERAL) const;
+
+	/**
+	 * Checks whether the given position is at the start of the given placeholder.
+	 *
+	 * @param pos			The position to check.
+	 * @param placeholder	The placeholder to check for.
+	 * @return	True if the position points to the given placeholder.
+	 */
+	bool isAt(const position &pos, const int16_t placeholder) const;
+
+	/**
+	 * Moves the given position to the start of the next segment.
+	 *
+	 * @param pos	The position to move.
+	 */
+	void skip(position &pos) const;
+
+	/**
+	 * Checks whether the given position is at the end of this template.
+	 *
+	 * @param pos	The position to check.
+	 * @return	True if there is nothing left to render.
+	 */
+	bool isDone(const position &pos) const;
+
+	/**
+	 * Gets the number of literal and placeholder segments in this template.
+	 *
+	 * @return	The number of segments.
+	 */
+	size_t getSegmentCount() const;
+private:
+	/**
+	 * A single literal or placeholder part of the template source.
+	 */
+	struct segment {
+		/**
+		 * The start of the source text of this segment.
+		 * Including the '$' for placeholders.
+		 */
+		const char *start;
+
+		/**
+		 * The length of the source text of this segment.
+		 */
+		size_t length;
+
+		/**
+		 * The index of the value of this placeholder, or LITERAL.
+		 */
+		int16_t placeholder;
+	};
+
+	/**
+	 * The segments of this template, in order.
+	 * Consecutive literal text is always a single segment.
+	 */
+	std::vector<segment> segments;
+
+	/**
+	 * The total length of all literal segments.
+	 */
+	size_t literal_length;
+};
+
+#endif /* LIB_WEBSERVERHANDLER_HTMLTEMPLATE_H_ */
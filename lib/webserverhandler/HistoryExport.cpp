@@ -0,0 +1,117 @@
+/*
+ * HistoryExport.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "HistoryExport.h"
+#include "JSONWriter.h"
+#include <algorithm>
+
+HistoryExport::HistoryExport(PinHistory &history, const uint32_t from,
+		const uint32_t to, const uint8_t pin, const uint32_t points,
+		const export_format format) :
+		cursor(history, from, to, pin), format(format), from(from), width(1) {
+	if (points > 0 && to >= from) {
+		const uint64_t range = (uint64_t) to - from + 1;
+		width = std::max<uint64_t>((range + points - 1) / points, 1);
+	}
+}
+
+HistoryExport::~HistoryExport() {
+
+}
+
+size_t HistoryExport::fill(uint8_t *buffer, const size_t max_len) {
+	size_t written = 0;
+	while (written < max_len) {
+		if (line.empty()) {
+			if (!header_written) {
+				header_written = true;
+				if (format == EXPORT_CSV) {
+					line = "Time,Pin,State,Records,Changes,High Time,Min Changes,Max Changes\n";
+				}
+				continue;
+			}
+
+			if (!nextLine()) {
+				break;
+			}
+		}
+
+		const size_t length = std::min(line.length(), max_len - written);
+		memcpy(buffer + written, line.c_str(), length);
+		line.erase(0, length);
+		written += length;
+	}
+	return written;
+}
+
+const char* HistoryExport::getContentType(const export_format format) {
+	return format == EXPORT_NDJSON ? "application/x-ndjson" : "text/csv";
+}
+
+bool HistoryExport::nextLine() {
+	history_record record;
+	while (!done) {
+		if (!cursor.next(record)) {
+			done = true;
+			break;
+		}
+
+		const uint32_t bucket = (record.time - from) / width;
+		std::map<uint8_t, point>::iterator it = open.find(record.pin);
+		const bool complete = it != open.end() && it->second.bucket != bucket;
+		if (complete) {
+			formatPoint(it->second);
+		}
+
+		if (it == open.end() || complete) {
+			const point p = { bucket, record.time, record.pin, record.state, 1,
+					record.changes, record.high_time, record.changes,
+					record.changes };
+			open[record.pin] = p;
+		} else {
+			point &p = it->second;
+			p.time = record.time;
+			p.state = record.state;
+			p.records++;
+			p.changes += record.changes;
+			p.high_time += record.high_time;
+			p.min_changes = std::min(p.min_changes, record.changes);
+			p.max_changes = std::max(p.max_changes, record.changes);
+		}
+
+		if (complete) {
+			return true;
+		}
+	}
+
+	if (open.empty()) {
+		return false;
+	}
+
+	formatPoint(open.begin()->second);
+	open.erase(open.begin());
+	return true;
+}
+
+void HistoryExport::formatPoint(const point &p) {
+	char buffer[160];
+	if (format == EXPORT_NDJSON) {
+		JSONWriter json(buffer, sizeof(buffer));
+		json.beginObject().key("time").value(p.time).key("pin").value(
+				(uint32_t) p.pin).key("state").value(p.state ? "High" : "Low").key(
+				"records").value(p.records).key("changes").value(p.changes).key(
+				"high_time").value(p.high_time).key("min_changes").value(
+				p.min_changes).key("max_changes").value(p.max_changes).endObject().raw(
+				"\n");
+		line.assign(buffer, json.length());
+	} else {
+		snprintf(buffer, sizeof(buffer), "%u,%hu,%hu,%u,%llu,%llu,%u,%u\n",
+				p.time, (uint16_t) p.pin, (uint16_t) p.state, p.records,
+				p.changes, p.high_time, p.min_changes, p.max_changes);
+		line.assign(buffer);
+	}
+}
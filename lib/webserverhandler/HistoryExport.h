@@ -0,0 +1,177 @@
+/*
+ * HistoryExport.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_HISTORYEXPORT_H_
+#define LIB_WEBSERVERHANDLER_HISTORYEXPORT_H_
+
+#include "PinHistory.h"
+#include <map>
+#include <string>
+
+/**
+ * The formats a HistoryExport can write.
+ */
+enum export_format {
+	EXPORT_CSV,
+	EXPORT_NDJSON
+};
+
+/**
+ * A streaming export of the recorded pin history, downsampled to a target number of points per pin.
+ *
+ * The time range is split into equally long buckets, and all the records of a pin in the same bucket
+ * are combined into a single point, containing their sums, and the min and max number of changes of a single record.
+ * This way short bursts of changes remain visible in charts of long time ranges.
+ *
+ * Records are read from the history one page at a time, and only the point currently being combined is kept for each pin,
+ * so the memory use doesn't depend on the length of the time range.
+ */
+class HistoryExport {
+public:
+	/**
+	 * Creates a new export of the records from the given history in the given time range.
+	 *
+	 * @param history	The history to read the records from.
+	 * @param from		The earliest interval end time to export, inclusive.
+	 * @param to		The latest interval end time to export, inclusive.
+	 * @param pin		The pin to export, or UINT8_MAX for all pins.
+	 * @param points	The max number of points per pin. Zero to export every record as its own point.
+	 * @param format	The format to write the points in.
+	 */
+	HistoryExport(PinHistory &history, const uint32_t from, const uint32_t to,
+			const uint8_t pin, const uint32_t points, const export_format format);
+
+	/**
+	 * Destroys this HistoryExport.
+	 */
+	virtual ~HistoryExport();
+
+	/**
+	 * Writes as much of the export to the given buffer as fits.
+	 * Only reads as many records as necessary to fill the buffer.
+	 *
+	 * @param buffer	The buffer to write to.
+	 * @param max_len	The size of the buffer.
+	 * @return	The number of bytes written, or zero if the export is complete.
+	 */
+	size_t fill(uint8_t *buffer, const size_t max_len);
+
+	/**
+	 * Gets the content type of the given export format.
+	 *
+	 * @param format	The format to get the content type for.
+	 * @return	The content type to send the export with.
+	 */
+	static const char* getContentType(const export_format format);
+private:
+	/**
+	 * The combined records of a single pin in a single bucket.
+	 */
+	struct point {
+		/**
+		 * The index of the bucket this point is for.
+		 */
+		uint32_t bucket;
+
+		/**
+		 * The end time of the newest interval in this point, in seconds since the unix epoch.
+		 */
+		uint32_t time;
+
+		/**
+		 * The hardware pin this point is for.
+		 */
+		uint8_t pin;
+
+		/**
+		 * The state of the pin at the end of the newest interval.
+		 */
+		bool state;
+
+		/**
+		 * The number of records combined into this point.
+		 */
+		uint32_t records;
+
+		/**
+		 * The total number of state changes of all combined records.
+		 */
+		uint64_t changes;
+
+		/**
+		 * The total time in milliseconds the pin spent high in all combined records.
+		 */
+		uint64_t high_time;
+
+		/**
+		 * The lowest number of changes of a single combined record.
+		 */
+		uint32_t min_changes;
+
+		/**
+		 * The highest number of changes of a single combined record.
+		 */
+		uint32_t max_changes;
+	};
+
+	/**
+	 * The cursor reading the records to export.
+	 */
+	PinHistory::Cursor cursor;
+
+	/**
+	 * The format to write the points in.
+	 */
+	const export_format format;
+
+	/**
+	 * The start of the time range, used as the start of the first bucket.
+	 */
+	const uint32_t from;
+
+	/**
+	 * The length of a single bucket in seconds.
+	 */
+	uint32_t width;
+
+	/**
+	 * The point currently being combined for each pin.
+	 */
+	std::map<uint8_t, point> open;
+
+	/**
+	 * The line currently being written.
+	 */
+	std::string line;
+
+	/**
+	 * Whether the header line, if the format has one, was already written.
+	 */
+	bool header_written = false;
+
+	/**
+	 * Whether the cursor has no more records.
+	 */
+	bool done = false;
+
+	/**
+	 * Reads records until a point is complete, and formats it as the next line.
+	 * Once all records are read, formats the remaining open points.
+	 *
+	 * @return	False if there are no more points.
+	 */
+	bool nextLine();
+
+	/**
+	 * Formats the given point as the current line.
+	 *
+	 * @param p	The point to format.
+	 */
+	void formatPoint(const point &p);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_HISTORYEXPORT_H_ */
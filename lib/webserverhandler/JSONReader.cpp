@@ -0,0 +1,424 @@
+/*
+ * JSONReader.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "JSONReader.h"
+#include <string.h>
+
+JSONReader::JSONReader(const char *json, const size_t length) :
+		json(json), length(json == NULL ? 0 : length), pos(0), error(false), first(
+				false), depth(0), objects(0) {
+}
+
+json_type JSONReader::peek() {
+	if (error) {
+		return JSON_INVALID;
+	}
+
+	const char c = skipWhitespace();
+	switch (c) {
+	case 'n':
+		return JSON_NULL;
+	case 't':
+	case 'f':
+		return JSON_BOOL;
+	case '"':
+		return JSON_STRING;
+	case '[':
+		return JSON_ARRAY;
+	case '{':
+		return JSON_OBJECT;
+	default:
+		if (c == '-' || (c >= '0' && c <= '9')) {
+			return JSON_NUMBER;
+		}
+		return JSON_INVALID;
+	}
+}
+
+bool JSONReader::beginObject() {
+	return open('{');
+}
+
+bool JSONReader::beginArray() {
+	return open('[');
+}
+
+bool JSONReader::hasNext() {
+	if (error) {
+		return false;
+	}
+
+	if (depth == 0) {
+		return fail();
+	}
+
+	const char c = skipWhitespace();
+	const bool object = objects & (1UL << (depth - 1));
+	if (c == (object ? '}' : ']')) {
+		pos++;
+		depth--;
+		first = false;
+		return false;
+	} else if (c == ',') {
+		if (first) {
+			return fail();
+		}
+		pos++;
+	} else if (!first || c == 0) {
+		return fail();
+	}
+
+	first = false;
+	return true;
+}
+
+bool JSONReader::readKey(char *buffer, const size_t size) {
+	if (!readString(buffer, size)) {
+		return false;
+	}
+
+	if (skipWhitespace() != ':') {
+		return fail();
+	}
+	pos++;
+	return true;
+}
+
+bool JSONReader::readString(char *buffer, const size_t size, size_t *length) {
+	if (error) {
+		return false;
+	}
+
+	if (skipWhitespace() != '"') {
+		return fail();
+	}
+	pos++;
+
+	size_t decoded = 0;
+	// Writes a single byte of the decoded string, if it still fits in the buffer.
+	auto put = [buffer, size, &decoded](const char c) {
+		if (decoded + 1 < size) {
+			buffer[decoded] = c;
+		}
+		decoded++;
+	};
+
+	while (true) {
+		if (pos >= this->length) {
+			return fail();
+		}
+
+		const char c = json[pos++];
+		if (c == '"') {
+			break;
+		} else if ((uint8_t) c < 0x20) {
+			return fail();
+		} else if (c != '\\') {
+			put(c);
+			continue;
+		}
+
+		if (pos >= this->length) {
+			return fail();
+		}
+
+		const char escape = json[pos++];
+		uint32_t code = 0;
+		switch (escape) {
+		case '"':
+		case '\\':
+		case '/':
+			put(escape);
+			continue;
+		case 'b':
+			put('\b');
+			continue;
+		case 'f':
+			put('\f');
+			continue;
+		case 'n':
+			put('\n');
+			continue;
+		case 'r':
+			put('\r');
+			continue;
+		case 't':
+			put('\t');
+			continue;
+		case 'u': {
+			uint16_t unit = 0;
+			if (!readHex(unit)) {
+				return false;
+			}
+			code = unit;
+			break;
+		}
+		default:
+			return fail();
+		}
+
+		if (code >= 0xDC00 && code <= 0xDFFF) {
+			// A low surrogate without a high surrogate.
+			return fail();
+		} else if (code >= 0xD800 && code <= 0xDBFF) {
+			uint16_t low = 0;
+			if (!consume("\\u") || !readHex(low) || low < 0xDC00
+					|| low > 0xDFFF) {
+				return fail();
+			}
+			code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+		}
+
+		if (code < 0x80) {
+			put(code);
+		} else if (code < 0x800) {
+			put(0xC0 | (code >> 6));
+			put(0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			put(0xE0 | (code >> 12));
+			put(0x80 | ((code >> 6) & 0x3F));
+			put(0x80 | (code & 0x3F));
+		} else {
+			put(0xF0 | (code >> 18));
+			put(0x80 | ((code >> 12) & 0x3F));
+			put(0x80 | ((code >> 6) & 0x3F));
+			put(0x80 | (code & 0x3F));
+		}
+	}
+
+	if (size > 0) {
+		buffer[decoded < size ? decoded : size - 1] = 0;
+	}
+	if (length != NULL) {
+		*length = decoded;
+	}
+	first = false;
+	return true;
+}
+
+bool JSONReader::readUnsigned(uint64_t &value) {
+	if (error) {
+		return false;
+	}
+
+	char c = skipWhitespace();
+	if (c < '0' || c > '9') {
+		return fail();
+	}
+
+	// Leading zeros aren't allowed in json.
+	if (c == '0' && pos + 1 < length && json[pos + 1] >= '0'
+			&& json[pos + 1] <= '9') {
+		return fail();
+	}
+
+	uint64_t result = 0;
+	while (pos < length && json[pos] >= '0' && json[pos] <= '9') {
+		const uint8_t digit = json[pos++] - '0';
+		if (result > (UINT64_MAX - digit) / 10) {
+			return fail();
+		}
+		result = result * 10 + digit;
+	}
+
+	if (pos < length
+			&& (json[pos] == '.' || json[pos] == 'e' || json[pos] == 'E')) {
+		return fail();
+	}
+
+	value = result;
+	first = false;
+	return true;
+}
+
+bool JSONReader::readBool(bool &value) {
+	if (error) {
+		return false;
+	}
+
+	skipWhitespace();
+	if (consume("true")) {
+		value = true;
+	} else if (consume("false")) {
+		value = false;
+	} else {
+		return fail();
+	}
+	first = false;
+	return true;
+}
+
+bool JSONReader::readNull() {
+	if (error) {
+		return false;
+	}
+
+	skipWhitespace();
+	if (!consume("null")) {
+		return fail();
+	}
+	first = false;
+	return true;
+}
+
+bool JSONReader::skipValue() {
+	bool ignored = false;
+	switch (peek()) {
+	case JSON_NULL:
+		return readNull();
+	case JSON_BOOL:
+		return readBool(ignored);
+	case JSON_NUMBER:
+		return skipNumber();
+	case JSON_STRING:
+		return readString(NULL, 0);
+	case JSON_ARRAY:
+		beginArray();
+		while (hasNext()) {
+			if (!skipValue()) {
+				return false;
+			}
+		}
+		return !error;
+	case JSON_OBJECT:
+		beginObject();
+		while (hasNext()) {
+			if (!readKey(NULL, 0) || !skipValue()) {
+				return false;
+			}
+		}
+		return !error;
+	default:
+		return fail();
+	}
+}
+
+bool JSONReader::finished() {
+	if (error || depth > 0) {
+		return false;
+	}
+
+	skipWhitespace();
+	return pos >= length;
+}
+
+bool JSONReader::failed() const {
+	return error;
+}
+
+char JSONReader::skipWhitespace() {
+	while (pos < length
+			&& (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n'
+					|| json[pos] == '\r')) {
+		pos++;
+	}
+	return pos < length ? json[pos] : 0;
+}
+
+bool JSONReader::fail() {
+	error = true;
+	return false;
+}
+
+bool JSONReader::open(const char bracket) {
+	if (error) {
+		return false;
+	}
+
+	if (skipWhitespace() != bracket || depth >= MAX_DEPTH) {
+		return fail();
+	}
+
+	pos++;
+	if (bracket == '{') {
+		objects |= 1UL << depth;
+	} else {
+		objects &= ~(1UL << depth);
+	}
+	depth++;
+	first = true;
+	return true;
+}
+
+bool JSONReader::consume(const char *literal) {
+	const size_t literal_length = strlen(literal);
+	if (length - pos < literal_length
+			|| strncmp(json + pos, literal, literal_length) != 0) {
+		return false;
+	}
+
+	pos += literal_length;
+	return true;
+}
+
+bool JSONReader::readHex(uint16_t &code) {
+	if (length - pos < 4) {
+		return fail();
+	}
+
+	code = 0;
+	for (uint8_t i = 0; i < 4; i++) {
+		const char c = json[pos++];
+		code <<= 4;
+		if (c >= '0' && c <= '9') {
+			code |= c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			code |= c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			code |= c - 'A' + 10;
+		} else {
+			return fail();
+		}
+	}
+	return true;
+}
+
+bool JSONReader::skipNumber() {
+	if (error) {
+		return false;
+	}
+
+	skipWhitespace();
+	if (pos < length && json[pos] == '-') {
+		pos++;
+	}
+
+	// Returns the number of digits that were skipped.
+	auto digits = [this]() -> size_t {
+		const size_t start = pos;
+		while (pos < length && json[pos] >= '0' && json[pos] <= '9') {
+			pos++;
+		}
+		return pos - start;
+	};
+
+	const size_t start = pos;
+	const size_t integer = digits();
+	if (integer == 0 || (integer > 1 && json[start] == '0')) {
+		return fail();
+	}
+
+	if (pos < length && json[pos] == '.') {
+		pos++;
+		if (digits() == 0) {
+			return fail();
+		}
+	}
+
+	if (pos < length && (json[pos] == 'e' || json[pos] == 'E')) {
+		pos++;
+		if (pos < length && (json[pos] == '+' || json[pos] == '-')) {
+			pos++;
+		}
+		if (digits() == 0) {
+			return fail();
+		}
+	}
+
+	first = false;
+	return true;
+}
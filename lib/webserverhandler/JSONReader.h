@@ -0,0 +1,231 @@
+/*
+ * JSONReader.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_JSONREADER_H_
+#define LIB_WEBSERVERHANDLER_JSONREADER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The type of the next json value.
+ */
+enum json_type {
+	JSON_INVALID,
+	JSON_NULL,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+};
+
+/**
+ * A small pull parser reading a json document from a buffer, without allocating any memory.
+ * The caller reads the values in document order, and skips the ones it isn't interested in.
+ *
+ * Objects and arrays are read like this:
+ * @code
+ * reader.beginArray();
+ * while (reader.hasNext()) {
+ * 	reader.readUnsigned(value);
+ * }
+ * @endcode
+ *
+ * Once a syntax error is found, all further reads fail, and failed returns true.
+ */
+class JSONReader {
+public:
+	/**
+	 * The max number of nested objects and arrays.
+	 */
+	static const uint8_t MAX_DEPTH = 32;
+
+	/**
+	 * Creates a new json reader reading the given buffer.
+	 *
+	 * @param json		The json document to read. Doesn't have to be null terminated.
+	 * @param length	The length of the document.
+	 */
+	JSONReader(const char *json, const size_t length);
+
+	/**
+	 * Gets the type of the next value, without consuming it.
+	 *
+	 * @return	The type of the next value, or JSON_INVALID if there is none.
+	 */
+	json_type peek();
+
+	/**
+	 * Reads the start of an object.
+	 *
+	 * @return	True if the next value was an object.
+	 */
+	bool beginObject();
+
+	/**
+	 * Reads the start of an array.
+	 *
+	 * @return	True if the next value was an array.
+	 */
+	bool beginArray();
+
+	/**
+	 * Checks whether the current object or array has another element, and consumes the separator before it.
+	 * Consumes the closing bracket if it doesn't.
+	 *
+	 * @return	True if there is another element to read.
+	 */
+	bool hasNext();
+
+	/**
+	 * Reads an object key, and the colon following it.
+	 *
+	 * @param buffer	The buffer to write the key to.
+	 * @param size		The size of the buffer, including the terminating null char.
+	 * @return	True if a key was read.
+	 * 			Keys that don't fit in the buffer are cut off.
+	 */
+	bool readKey(char *buffer, const size_t size);
+
+	/**
+	 * Reads a string value, and decodes its escape sequences.
+	 *
+	 * @param buffer	The buffer to write the string to.
+	 * @param size		The size of the buffer, including the terminating null char.
+	 * @param length	A pointer to write the full decoded length of the string to. Can be NULL.
+	 * 					Strings that don't fit in the buffer are cut off, but this is still their full length.
+	 * @return	True if the next value was a valid string.
+	 */
+	bool readString(char *buffer, const size_t size, size_t *length = NULL);
+
+	/**
+	 * Reads an unsigned integer value.
+	 *
+	 * @param value	The variable to write the value to.
+	 * @return	True if the next value was an integer fitting in 64 bits, without a sign, fraction, or exponent.
+	 */
+	bool readUnsigned(uint64_t &value);
+
+	/**
+	 * Reads a boolean value.
+	 *
+	 * @param value	The variable to write the value to.
+	 * @return	True if the next value was a boolean.
+	 */
+	bool readBool(bool &value);
+
+	/**
+	 * Reads a null value.
+	 *
+	 * @return	True if the next value was null.
+	 */
+	bool readNull();
+
+	/**
+	 * Skips the next value, including all values nested in it.
+	 *
+	 * @return	True if a valid value was skipped.
+	 */
+	bool skipValue();
+
+	/**
+	 * Checks whether the whole document was read, excluding trailing whitespace.
+	 *
+	 * @return	True if nothing but whitespace is left.
+	 */
+	bool finished();
+
+	/**
+	 * Checks whether a syntax error was found.
+	 *
+	 * @return	True if the document is invalid.
+	 */
+	bool failed() const;
+private:
+	/**
+	 * The json document to read.
+	 */
+	const char *json;
+
+	/**
+	 * The length of the json document.
+	 */
+	const size_t length;
+
+	/**
+	 * The current position in the document.
+	 */
+	size_t pos;
+
+	/**
+	 * Whether a syntax error was found.
+	 */
+	bool error;
+
+	/**
+	 * Whether the last thing read was an opening bracket, so the next element doesn't need a separator.
+	 */
+	bool first;
+
+	/**
+	 * The number of objects and arrays that are currently open.
+	 */
+	uint8_t depth;
+
+	/**
+	 * A bit mask with a bit per depth, set if the container at that depth is an object rather than an array.
+	 */
+	uint32_t objects;
+
+	/**
+	 * Skips all whitespace at the current position.
+	 *
+	 * @return	The next char, or 0 at the end of the document.
+	 */
+	char skipWhitespace();
+
+	/**
+	 * Marks the document as invalid.
+	 *
+	 * @return	Always false.
+	 */
+	bool fail();
+
+	/**
+	 * Opens a new object or array.
+	 *
+	 * @param bracket	The opening bracket to read.
+	 * @return	True if the bracket was read.
+	 */
+	bool open(const char bracket);
+
+	/**
+	 * Consumes the given literal, if it is at the current position.
+	 *
+	 * @param literal	The literal to consume.
+	 * @return	True if the literal was consumed.
+	 */
+	bool consume(const char *literal);
+
+	/**
+	 * Reads four hex digits of a unicode escape sequence.
+	 *
+	 * @param code	The variable to write the code unit to.
+	 * @return	True if four hex digits were read.
+	 */
+	bool readHex(uint16_t &code);
+
+	/**
+	 * Skips a number value, including its sign, fraction, and exponent.
+	 *
+	 * @return	True if a valid number was skipped.
+	 */
+	bool skipNumber();
+};
+
+#endif /* LIB_WEBSERVERHANDLER_JSONREADER_H_ */
@@ -0,0 +1,296 @@
+/*
+ * JSONWriter.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "JSONWriter.h"
+#include <string.h>
+
+/**
+ * The hex digits used for \u escapes.
+ */
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+JSONWriter::JSONWriter(char *buffer, const size_t size) :
+		buffer(buffer), size(size), pos(0), overflow(false), depth(0), members(
+				0), after_key(false), line_break(false) {
+	if (size > 0) {
+		buffer[0] = 0;
+	} else {
+		overflow = true;
+	}
+}
+
+JSONWriter& JSONWriter::beginObject() {
+	open('{');
+	return *this;
+}
+
+JSONWriter& JSONWriter::endObject() {
+	close('}');
+	return *this;
+}
+
+JSONWriter& JSONWriter::beginArray() {
+	open('[');
+	return *this;
+}
+
+JSONWriter& JSONWriter::endArray() {
+	close(']');
+	return *this;
+}
+
+JSONWriter& JSONWriter::resume(const bool has_members) {
+	if (depth < MAX_DEPTH - 1) {
+		depth++;
+		if (has_members) {
+			members |= 1UL << depth;
+		} else {
+			members &= ~(1UL << depth);
+		}
+	}
+	return *this;
+}
+
+JSONWriter& JSONWriter::lineBreak() {
+	line_break = true;
+	return *this;
+}
+
+JSONWriter& JSONWriter::key(const char *name) {
+	separate();
+	writeString(name == NULL ? "" : name);
+	write(": ", 2);
+	after_key = true;
+	return *this;
+}
+
+JSONWriter& JSONWriter::key(const uint64_t name) {
+	separate();
+	char digits[20];
+	write('"');
+	write(digits, formatUnsigned(digits, name));
+	write("\": ", 3);
+	after_key = true;
+	return *this;
+}
+
+JSONWriter& JSONWriter::value(const char *value) {
+	if (value == NULL) {
+		return null();
+	}
+
+	separate();
+	writeString(value);
+	return *this;
+}
+
+JSONWriter& JSONWriter::value(const bool value) {
+	separate();
+	if (value) {
+		write("true", 4);
+	} else {
+		write("false", 5);
+	}
+	return *this;
+}
+
+JSONWriter& JSONWriter::value(const uint64_t value) {
+	separate();
+	char digits[20];
+	write(digits, formatUnsigned(digits, value));
+	return *this;
+}
+
+JSONWriter& JSONWriter::value(const uint32_t value) {
+	return this->value((uint64_t) value);
+}
+
+JSONWriter& JSONWriter::value(const int64_t value) {
+	separate();
+	char digits[20];
+	uint64_t magnitude = value;
+	if (value < 0) {
+		write('-');
+		magnitude = -magnitude;
+	}
+	write(digits, formatUnsigned(digits, magnitude));
+	return *this;
+}
+
+JSONWriter& JSONWriter::value(const int32_t value) {
+	return this->value((int64_t) value);
+}
+
+JSONWriter& JSONWriter::value(const double value, const uint8_t decimals) {
+	// NaN and infinity aren't valid json.
+	if (value != value || value > 1e18 || value < -1e18) {
+		return null();
+	}
+
+	static const uint32_t SCALES[] = { 1, 10, 100, 1000, 10000, 100000,
+			1000000 };
+	const uint8_t digits = decimals > 6 ? 6 : decimals;
+	const uint64_t scale = SCALES[digits];
+	const bool negative = value < 0;
+	const uint64_t scaled = (uint64_t) ((negative ? -value : value) * scale
+			+ 0.5);
+
+	separate();
+	char number[20];
+	if (negative && scaled > 0) {
+		write('-');
+	}
+	write(number, formatUnsigned(number, scaled / scale));
+	if (digits > 0) {
+		write('.');
+		uint64_t fraction = scaled % scale;
+		for (uint8_t i = digits; i > 0; i--) {
+			number[i - 1] = '0' + fraction % 10;
+			fraction /= 10;
+		}
+		write(number, digits);
+	}
+	return *this;
+}
+
+JSONWriter& JSONWriter::null() {
+	separate();
+	write("null", 4);
+	return *this;
+}
+
+JSONWriter& JSONWriter::raw(const char *text) {
+	write(text, strlen(text));
+	return *this;
+}
+
+size_t JSONWriter::length() const {
+	return pos;
+}
+
+bool JSONWriter::overflowed() const {
+	return overflow;
+}
+
+size_t JSONWriter::formatUnsigned(char *buffer, uint64_t value) {
+	char digits[20];
+	size_t length = 0;
+	do {
+		digits[length++] = '0' + value % 10;
+		value /= 10;
+	} while (value > 0);
+
+	for (size_t i = 0; i < length; i++) {
+		buffer[i] = digits[length - i - 1];
+	}
+	return length;
+}
+
+void JSONWriter::separate() {
+	if (after_key) {
+		after_key = false;
+	} else if (members & (1UL << depth)) {
+		if (line_break) {
+			write(",\n", 2);
+		} else {
+			write(", ", 2);
+		}
+	} else if (line_break && depth > 0) {
+		write('\n');
+	}
+
+	line_break = false;
+	members |= 1UL << depth;
+}
+
+void JSONWriter::open(const char bracket) {
+	separate();
+	write(bracket);
+	if (depth < MAX_DEPTH - 1) {
+		depth++;
+		members &= ~(1UL << depth);
+	} else {
+		overflow = true;
+	}
+}
+
+void JSONWriter::close(const char bracket) {
+	if (depth > 0) {
+		depth--;
+	}
+	after_key = false;
+	line_break = false;
+	write(bracket);
+}
+
+void JSONWriter::write(const char *text, const size_t length) {
+	if (overflow) {
+		return;
+	}
+
+	if (pos + length >= size) {
+		const size_t part = size - pos - 1;
+		memcpy(buffer + pos, text, part);
+		pos += part;
+		buffer[pos] = 0;
+		overflow = true;
+		return;
+	}
+
+	memcpy(buffer + pos, text, length);
+	pos += length;
+	buffer[pos] = 0;
+}
+
+void JSONWriter::write(const char c) {
+	write(&c, 1);
+}
+
+void JSONWriter::writeString(const char *text) {
+	write('"');
+	const char *start = text;
+	for (; *text != 0; text++) {
+		const uint8_t c = *text;
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		// Write the chars that don't need escaping at once.
+		write(start, text - start);
+		start = text + 1;
+		switch (c) {
+		case '"':
+			write("\\\"", 2);
+			break;
+		case '\\':
+			write("\\\\", 2);
+			break;
+		case '\n':
+			write("\\n", 2);
+			break;
+		case '\r':
+			write("\\r", 2);
+			break;
+		case '\t':
+			write("\\t", 2);
+			break;
+		case '\b':
+			write("\\b", 2);
+			break;
+		case '\f':
+			write("\\f", 2);
+			break;
+		default:
+			const char escape[] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4],
+					HEX_DIGITS[c & 0xF] };
+			write(escape, sizeof(escape));
+			break;
+		}
+	}
+	write(start, text - start);
+	write('"');
+}
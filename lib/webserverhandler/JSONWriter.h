@@ -0,0 +1,281 @@
+/*
+ * JSONWriter.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_JSONWRITER_H_
+#define LIB_WEBSERVERHANDLER_JSONWRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A small json serializer writing directly to a fixed size buffer, without allocating any memory.
+ * Keeps track of the required commas, and escapes all strings.
+ * Elements are separated by ", ", and keys and values by ": ".
+ *
+ * If the buffer is too small, the output is cut off and overflowed returns true.
+ * The output is always null terminated, so at most size - 1 chars are written.
+ *
+ * To write a json document in multiple parts, for example one line per buffer,
+ * use resume to continue writing inside an object or array that was started in a previous buffer.
+ */
+class JSONWriter {
+public:
+	/**
+	 * The max number of nested objects and arrays.
+	 */
+	static const uint8_t MAX_DEPTH = 32;
+
+	/**
+	 * Creates a new json writer writing to the given buffer.
+	 *
+	 * @param buffer	The buffer to write to.
+	 * @param size		The size of the buffer, including the terminating null char.
+	 */
+	JSONWriter(char *buffer, const size_t size);
+
+	/**
+	 * Starts a new object.
+	 *
+	 * @return	This writer.
+	 */
+	JSONWriter& beginObject();
+
+	/**
+	 * Ends the current object.
+	 *
+	 * @return	This writer.
+	 */
+	JSONWriter& endObject();
+
+	/**
+	 * Starts a new array.
+	 *
+	 * @return	This writer.
+	 */
+	JSONWriter& beginArray();
+
+	/**
+	 * Ends the current array.
+	 *
+	 * @return	This writer.
+	 */
+	JSONWriter& endArray();
+
+	/**
+	 * Continues writing inside an object or array, whose start was written by a different writer.
+	 * Doesn't write anything itself.
+	 *
+	 * @param has_members	Whether the object or array already contains elements.
+	 * @return	This writer.
+	 */
+	JSONWriter& resume(const bool has_members);
+
+	/**
+	 * Separates the next element from the previous one using a line break instead of a space.
+	 *
+	 * @return	This writer.
+	 */
+	JSONWriter& lineBreak();
+
+	/**
+	 * Writes an object key.
+	 *
+	 * @param name	The key to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& key(const char *name);
+
+	/**
+	 * Writes a numeric object key as a string.
+	 *
+	 * @param name	The key to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& key(const uint64_t name);
+
+	/**
+	 * Writes an escaped string value.
+	 * Writes null if the value is NULL.
+	 *
+	 * @param value	The string to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const char *value);
+
+	/**
+	 * Writes a boolean value.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const bool value);
+
+	/**
+	 * Writes an unsigned integer value.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const uint64_t value);
+
+	/**
+	 * Writes an unsigned integer value.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const uint32_t value);
+
+	/**
+	 * Writes a signed integer value.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const int64_t value);
+
+	/**
+	 * Writes a signed integer value.
+	 *
+	 * @param value	The value to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const int32_t value);
+
+	/**
+	 * Writes a fixed point decimal value.
+	 *
+	 * @param value		The value to write.
+	 * @param decimals	The number of digits after the decimal point, at most 6.
+	 * @return	This writer.
+	 */
+	JSONWriter& value(const double value, const uint8_t decimals);
+
+	/**
+	 * Writes a null value.
+	 *
+	 * @return	This writer.
+	 */
+	JSONWriter& null();
+
+	/**
+	 * Writes the given text without escaping it or adding a separator.
+	 * Doesn't count as an element.
+	 *
+	 * @param text	The text to write.
+	 * @return	This writer.
+	 */
+	JSONWriter& raw(const char *text);
+
+	/**
+	 * Gets the number of chars that were written to the buffer.
+	 *
+	 * @return	The length of the output.
+	 */
+	size_t length() const;
+
+	/**
+	 * Checks whether some of the output didn't fit in the buffer.
+	 *
+	 * @return	True if the output was cut off.
+	 */
+	bool overflowed() const;
+
+	/**
+	 * Writes the given unsigned integer as decimal digits to the given buffer.
+	 * Doesn't null terminate the output.
+	 *
+	 * @param buffer	The buffer to write to. Has to have space for at least 20 chars.
+	 * @param value		The value to write.
+	 * @return	The number of digits written.
+	 */
+	static size_t formatUnsigned(char *buffer, uint64_t value);
+private:
+	/**
+	 * The buffer to write to.
+	 */
+	char *buffer;
+
+	/**
+	 * The size of the buffer, including the terminating null char.
+	 */
+	const size_t size;
+
+	/**
+	 * The number of chars written to the buffer.
+	 */
+	size_t pos;
+
+	/**
+	 * Whether some of the output didn't fit in the buffer.
+	 */
+	bool overflow;
+
+	/**
+	 * The number of objects and arrays that are currently open.
+	 */
+	uint8_t depth;
+
+	/**
+	 * A bit mask with a bit per depth, set if the object or array at that depth has an element.
+	 * Bit 0 is the top level.
+	 */
+	uint32_t members;
+
+	/**
+	 * Whether the last thing written was a key, so the next value doesn't need a separator.
+	 */
+	bool after_key;
+
+	/**
+	 * Whether the next separator should be a line break instead of a space.
+	 */
+	bool line_break;
+
+	/**
+	 * Writes the separator before a new element, if one is required.
+	 */
+	void separate();
+
+	/**
+	 * Opens a new object or array.
+	 *
+	 * @param bracket	The opening bracket.
+	 */
+	void open(const char bracket);
+
+	/**
+	 * Closes the current object or array.
+	 *
+	 * @param bracket	The closing bracket.
+	 */
+	void close(const char bracket);
+
+	/**
+	 * Writes the given chars to the buffer, without a separator.
+	 *
+	 * @param text		The chars to write.
+	 * @param length	The number of chars to write.
+	 */
+	void write(const char *text, const size_t length);
+
+	/**
+	 * Writes a single char to the buffer.
+	 *
+	 * @param c	The char to write.
+	 */
+	void write(const char c);
+
+	/**
+	 * Writes the given string in quotes, escaping it as required.
+	 *
+	 * @param text	The string to write.
+	 */
+	void writeString(const char *text);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_JSONWRITER_H_ */
@@ -0,0 +1,116 @@
+/*
+ * MetricsCache.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "MetricsCache.h"
+
+/**
+ * The help and type lines of the esp_pin_state metric.
+ */
+static const char STATE_HEADER[] =
+		"# HELP esp_pin_state The current digital state of an ESP GPIO/GPI pin.\n"
+		"# TYPE esp_pin_state gauge\n";
+
+/**
+ * The help and type lines of the esp_pin_state_changes metric.
+ */
+static const char CHANGES_HEADER[] =
+		"# HELP esp_pin_state_changes The number of times the state of the ESP GPIO/GPI pin changed its state.\n"
+		"# TYPE esp_pin_state_changes counter\n";
+
+MetricsCache::MetricsCache() :
+		labels_length(0), source(NULL), config_version(0), sequence(0) {
+}
+
+std::shared_ptr<const std::string> MetricsCache::get(const GPIOHandler &gpio) {
+	// Read the versions before the pins, so a change while copying them can't be missed.
+	const uint32_t current_config = gpio.getConfigVersion();
+	const uint32_t current_sequence = gpio.getChangeSequence();
+	if (isCurrent(&gpio, current_config, current_sequence)) {
+		return exposition;
+	}
+
+	return update(gpio.getWatchedPins(), &gpio, current_config,
+			current_sequence);
+}
+
+bool MetricsCache::isCurrent(const GPIOHandler *source,
+		const uint32_t config_version, const uint32_t sequence) const {
+	return exposition && this->source == source
+			&& this->config_version == config_version
+			&& this->sequence == sequence;
+}
+
+std::shared_ptr<const std::string> MetricsCache::update(
+		const std::vector<pin_state> &pins, const GPIOHandler *source,
+		const uint32_t config_version, const uint32_t sequence) {
+	if (isCurrent(source, config_version, sequence)) {
+		return exposition;
+	}
+
+	if (!exposition || this->source != source
+			|| this->config_version != config_version || !labelsMatch(pins)) {
+		renderLabels(pins);
+	}
+
+	this->source = source;
+	this->config_version = config_version;
+	this->sequence = sequence;
+
+	std::shared_ptr<std::string> text = std::make_shared<std::string>();
+	if (pins.empty()) {
+		exposition = text;
+		return exposition;
+	}
+
+	// Each value is at most 20 digits and a line break.
+	text->reserve(labels_length + pins.size() * 23);
+	text->append(STATE_HEADER, sizeof(STATE_HEADER) - 1);
+	for (size_t i = 0; i < pins.size(); i++) {
+		*text += labels[i].state_prefix;
+		*text += pins[i].state ? "1\n" : "0\n";
+	}
+
+	char changes[22];
+	text->append(CHANGES_HEADER, sizeof(CHANGES_HEADER) - 1);
+	for (size_t i = 0; i < pins.size(); i++) {
+		*text += labels[i].changes_prefix;
+		text->append(changes,
+				snprintf(changes, sizeof(changes), "%llu\n", pins[i].changes));
+	}
+
+	exposition = text;
+	return exposition;
+}
+
+void MetricsCache::renderLabels(const std::vector<pin_state> &pins) {
+	labels.clear();
+	labels.reserve(pins.size());
+	labels_length = sizeof(STATE_HEADER) + sizeof(CHANGES_HEADER) - 2;
+	for (const pin_state &pin : pins) {
+		char number[4];
+		snprintf(number, sizeof(number), "%hu", (uint16_t) pin.number);
+		std::string pin_labels = std::string("{pin=\"") + number + "\",name=\""
+				+ pin.name.c_str() + "\"} ";
+		labels.push_back( { pin.number, "esp_pin_state" + pin_labels,
+				"esp_pin_state_changes" + pin_labels });
+		labels_length += labels.back().state_prefix.length()
+				+ labels.back().changes_prefix.length();
+	}
+}
+
+bool MetricsCache::labelsMatch(const std::vector<pin_state> &pins) const {
+	if (labels.size() != pins.size()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < pins.size(); i++) {
+		if (labels[i].number != pins[i].number) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,134 @@
+/*
+ * MetricsCache.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_METRICSCACHE_H_
+#define LIB_WEBSERVERHANDLER_METRICSCACHE_H_
+
+#include "GPIOHandler.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A cache for the prometheus metrics of the watched pins.
+ *
+ * The metric names and labels of each pin are rendered once per pin configuration version.
+ * The full exposition is cached per change sequence number, so scrapes without a change
+ * just send the cached text, and scrapes after a change only format the new values.
+ */
+class MetricsCache {
+public:
+	/**
+	 * Creates a new empty metrics cache.
+	 */
+	MetricsCache();
+
+	/**
+	 * Gets the metrics for the pins of the given GPIOHandler.
+	 * Only copies the watched pins if they changed since the last call.
+	 *
+	 * @param gpio	The GPIOHandler to get the metrics for.
+	 * @return	The prometheus text exposition of the pin metrics.
+	 */
+	std::shared_ptr<const std::string> get(const GPIOHandler &gpio);
+
+	/**
+	 * Checks whether the cached metrics are for the given config version and change sequence number.
+	 *
+	 * @param source			The GPIOHandler the versions are from.
+	 * @param config_version	The current pin configuration version.
+	 * @param sequence			The current change sequence number.
+	 * @return	True if the cached metrics are up to date.
+	 */
+	bool isCurrent(const GPIOHandler *source, const uint32_t config_version,
+			const uint32_t sequence) const;
+
+	/**
+	 * Updates the cached metrics to the given pin states.
+	 * Returns the cached metrics without using the pins if they are current.
+	 * Only renders the labels of the pins again if the config version changed.
+	 * Metrics that are still in use keep their content.
+	 *
+	 * @param pins				The current pin states.
+	 * @param source			The GPIOHandler the pins are from.
+	 * @param config_version	The config version of the given pins.
+	 * @param sequence			The change sequence number of the given pins.
+	 * @return	The new prometheus text exposition of the pin metrics.
+	 */
+	std::shared_ptr<const std::string> update(
+			const std::vector<pin_state> &pins, const GPIOHandler *source,
+			const uint32_t config_version, const uint32_t sequence);
+private:
+	/**
+	 * The pre-rendered metric lines of a single pin, up to the value.
+	 */
+	struct pin_labels {
+		/**
+		 * The number of the pin these labels are for.
+		 */
+		uint8_t number;
+
+		/**
+		 * The esp_pin_state metric name and labels of this pin, followed by a space.
+		 */
+		std::string state_prefix;
+
+		/**
+		 * The esp_pin_state_changes metric name and labels of this pin, followed by a space.
+		 */
+		std::string changes_prefix;
+	};
+
+	/**
+	 * The pre-rendered labels of the watched pins, in the order of GPIOHandler::getWatchedPins.
+	 */
+	std::vector<pin_labels> labels;
+
+	/**
+	 * The length of all labels plus the help and type lines.
+	 * Used to reserve the exposition length in advance.
+	 */
+	size_t labels_length;
+
+	/**
+	 * The GPIOHandler the cached metrics are for.
+	 */
+	const GPIOHandler *source;
+
+	/**
+	 * The config version the labels were rendered for.
+	 */
+	uint32_t config_version;
+
+	/**
+	 * The change sequence number the exposition was rendered for.
+	 */
+	uint32_t sequence;
+
+	/**
+	 * The cached text exposition.
+	 * NULL if nothing was cached yet.
+	 */
+	std::shared_ptr<const std::string> exposition;
+
+	/**
+	 * Renders the labels of the given pins.
+	 *
+	 * @param pins	The pins to render the labels for.
+	 */
+	void renderLabels(const std::vector<pin_state> &pins);
+
+	/**
+	 * Checks whether the labels match the given pins.
+	 *
+	 * @param pins	The pins to check.
+	 * @return	True if there are labels for exactly the given pins, in the same order.
+	 */
+	bool labelsMatch(const std::vector<pin_state> &pins) const;
+};
+
+#endif /* LIB_WEBSERVERHANDLER_METRICSCACHE_H_ */
@@ -0,0 +1,292 @@
+/*
+ * PinSocket.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "PinSocket.h"
+#include "JSONWriter.h"
+#include <algorithm>
+#include <functional>
+
+PinSocket::PinSocket(const char *url, GPIOHandler &gpio,
+		const uint32_t timeout) :
+		socket(url), gpio(&gpio), timeout(timeout), dropped_clients(0) {
+	using namespace std::placeholders;
+	socket.onEvent(
+			std::bind(&PinSocket::onEvent, this, _1, _2, _3, _4, _5, _6));
+}
+
+PinSocket::~PinSocket() {
+	closeAll();
+}
+
+void PinSocket::setup(AsyncWebServer &server) {
+	server.addHandler(&socket);
+}
+
+void PinSocket::setGPIOHandler(GPIOHandler &gpio) {
+	this->gpio = &gpio;
+}
+
+void PinSocket::publish(const pin_change &change) {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::pair<const uint32_t, client> &entry : clients) {
+		client &cl = entry.second;
+		if ((cl.subscribed & (1ULL << change.pin)) == 0) {
+			continue;
+		}
+
+		cl.pending[change.pin] = change;
+		if (cl.pending_since == 0) {
+			cl.pending_since = std::max<uint64_t>(millis(), 1);
+		}
+	}
+}
+
+void PinSocket::flush() {
+	struct frame {
+		uint32_t id;
+		bool binary;
+		std::string data;
+	};
+
+	std::vector<frame> frames;
+	std::vector<uint32_t> dropped;
+	const uint64_t now = millis();
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		for (std::map<uint32_t, client>::iterator it = clients.begin();
+				it != clients.end();) {
+			client &cl = it->second;
+			AsyncWebSocketClient *ws_client = socket.client(it->first);
+			if (cl.pending.empty() || ws_client == NULL) {
+				it++;
+				continue;
+			}
+
+			// Keep coalescing changes until the client catches up, or close it if it doesn't.
+			if (ws_client->queueIsFull()) {
+				if (now - cl.pending_since > timeout) {
+					dropped.push_back(it->first);
+					dropped_clients++;
+					it = clients.erase(it);
+				} else {
+					it++;
+				}
+				continue;
+			}
+
+			frames.push_back( { it->first, cl.binary, std::string() });
+			std::string &data = frames.back().data;
+			if (cl.binary) {
+				data.reserve(cl.pending.size() * BINARY_CHANGE_SIZE);
+			} else {
+				data += '[';
+			}
+
+			for (const std::pair<const uint8_t, pin_change> &change : cl.pending) {
+				if (cl.binary) {
+					appendBinary(data, change.second);
+				} else {
+					if (data.length() > 1) {
+						data += ", ";
+					}
+					appendJson(data, change.second);
+				}
+			}
+
+			if (!cl.binary) {
+				data += ']';
+			}
+
+			cl.pending.clear();
+			cl.pending_since = 0;
+			it++;
+		}
+	}
+
+	// Send outside the lock, since sending can take a while.
+	for (const frame &fr : frames) {
+		AsyncWebSocketClient *ws_client = socket.client(fr.id);
+		if (ws_client == NULL) {
+			continue;
+		} else if (fr.binary) {
+			ws_client->binary(fr.data.c_str(), fr.data.length());
+		} else {
+			ws_client->text(fr.data.c_str(), fr.data.length());
+		}
+	}
+
+	for (const uint32_t id : dropped) {
+		AsyncWebSocketClient *ws_client = socket.client(id);
+		if (ws_client != NULL) {
+			ws_client->close(1008, "Too slow");
+		}
+	}
+
+	socket.cleanupClients();
+}
+
+void PinSocket::closeAll() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		clients.clear();
+	}
+	socket.closeAll();
+}
+
+std::vector<PinSocket::client_stats> PinSocket::getClientStats() {
+	std::vector<client_stats> stats;
+	std::lock_guard<std::mutex> guard(lock);
+	stats.reserve(clients.size());
+	for (const std::pair<const uint32_t, client> &entry : clients) {
+		AsyncWebSocketClient *ws_client = socket.client(entry.first);
+		stats.push_back( { entry.first,
+				ws_client == NULL ? 0 : ws_client->queueLen(),
+				entry.second.pending.size() });
+	}
+	return stats;
+}
+
+uint32_t PinSocket::getDroppedClients() const {
+	return dropped_clients;
+}
+
+void PinSocket::onEvent(AsyncWebSocket *server,
+		AsyncWebSocketClient *ws_client, AwsEventType type, void *arg,
+		uint8_t *data, size_t len) {
+	if (type == WS_EVT_CONNECT) {
+		std::lock_guard<std::mutex> guard(lock);
+		clients[ws_client->id()] = { 0, false, std::map<uint8_t, pin_change>(), 0 };
+	} else if (type == WS_EVT_DISCONNECT) {
+		std::lock_guard<std::mutex> guard(lock);
+		clients.erase(ws_client->id());
+	} else if (type == WS_EVT_DATA) {
+		// Commands are short, so only unfragmented text frames are accepted.
+		AwsFrameInfo *info = (AwsFrameInfo*) arg;
+		if (info->final && info->index == 0 && info->len == len
+				&& info->opcode == WS_TEXT) {
+			handleCommand(ws_client, std::string((char*) data, len));
+		} else {
+			ws_client->text("error Unsupported frame.");
+		}
+	}
+}
+
+void PinSocket::handleCommand(AsyncWebSocketClient *ws_client,
+		const std::string &command) {
+	const size_t separator = command.find(' ');
+	const std::string name = command.substr(0, separator);
+	const std::string argument =
+			separator == std::string::npos ?
+					std::string() : command.substr(separator + 1);
+
+	uint64_t mask = 0;
+	if ((name == "subscribe" || name == "unsubscribe")
+			&& !parsePins(argument, mask)) {
+		ws_client->text("error Invalid pin list.");
+		return;
+	} else if (name == "format" && argument != "json" && argument != "binary") {
+		ws_client->text("error Unknown format.");
+		return;
+	} else if (name != "subscribe" && name != "unsubscribe" && name != "format") {
+		ws_client->text("error Unknown command.");
+		return;
+	}
+
+	// Get the pin states before locking, since the GPIOHandler isn't synchronized with this.
+	std::vector<pin_state> pins;
+	if (name == "subscribe") {
+		pins = gpio->getWatchedPins();
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	std::map<uint32_t, client>::iterator it = clients.find(ws_client->id());
+	if (it == clients.end()) {
+		return;
+	}
+
+	client &cl = it->second;
+	if (name == "subscribe") {
+		const uint64_t added = mask & ~cl.subscribed;
+		cl.subscribed |= mask;
+		for (const pin_state &pin : pins) {
+			if (added & (1ULL << pin.number)) {
+				cl.pending[pin.number] = {pin.number, pin.state, pin.changes, pin.last_change, pin.sequence};
+			}
+		}
+		if (!cl.pending.empty() && cl.pending_since == 0) {
+			cl.pending_since = std::max<uint64_t>(millis(), 1);
+		}
+	} else if (name == "unsubscribe") {
+		cl.subscribed &= ~mask;
+		for (std::map<uint8_t, pin_change>::iterator change = cl.pending.begin();
+				change != cl.pending.end();) {
+			if (mask & (1ULL << change->first)) {
+				change = cl.pending.erase(change);
+			} else {
+				change++;
+			}
+		}
+	} else {
+		cl.binary = argument == "binary";
+	}
+}
+
+bool PinSocket::parsePins(const std::string &pins, uint64_t &mask) {
+	if (pins == "*") {
+		mask = UINT64_MAX;
+		return true;
+	}
+
+	mask = 0;
+	size_t start = 0;
+	while (start <= pins.length()) {
+		size_t end = pins.find(',', start);
+		if (end == std::string::npos) {
+			end = pins.length();
+		}
+
+		if (end == start || end - start > 2) {
+			return false;
+		}
+
+		uint8_t pin = 0;
+		for (size_t i = start; i < end; i++) {
+			if (pins[i] < '0' || pins[i] > '9') {
+				return false;
+			}
+			pin = pin * 10 + pins[i] - '0';
+		}
+
+		if (pin >= 64) {
+			return false;
+		}
+
+		mask |= 1ULL << pin;
+		start = end + 1;
+	}
+	return true;
+}
+
+void PinSocket::appendJson(std::string &frame, const pin_change &change) {
+	char json[96];
+	JSONWriter writer(json, sizeof(json));
+	writer.beginObject().key("pin").value((uint32_t) change.pin).key("state").value(
+			change.state ? "High" : "Low").key("changes").value(change.changes).key(
+			"time").value(change.time).endObject();
+	frame.append(json, writer.length());
+}
+
+void PinSocket::appendBinary(std::string &frame, const pin_change &change) {
+	frame += (char) change.pin;
+	frame += (char) change.state;
+	for (uint8_t i = 0; i < 8; i++) {
+		frame += (char) (change.changes >> (i * 8));
+	}
+	for (uint8_t i = 0; i < 8; i++) {
+		frame += (char) (change.time >> (i * 8));
+	}
+}
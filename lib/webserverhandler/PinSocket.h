@@ -0,0 +1,233 @@
+/*
+ * PinSocket.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_PINSOCKET_H_
+#define LIB_WEBSERVERHANDLER_PINSOCKET_H_
+
+#include "GPIOHandler.h"
+#include <ESPAsyncWebServer.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A WebSocket endpoint sending debounced pin changes to clients that subscribed to them.
+ *
+ * Clients send text commands to configure what they receive:
+ *  * "subscribe <pins>" subscribes to a comma separated list of pins, or all pins if pins is "*".
+ *    Sends the current state of the newly subscribed pins.
+ *  * "unsubscribe <pins>" unsubscribes from a comma separated list of pins, or all pins.
+ *  * "format json" or "format binary" sets the format of the change frames. Json is the default.
+ *
+ * All changes for a client are sent as a single frame per call to flush.
+ * Changes that couldn't be sent yet are coalesced per pin.
+ */
+class PinSocket {
+public:
+	/**
+	 * The default time in milliseconds after which a client that can't receive changes is closed.
+	 */
+	static const uint32_t DEFAULT_TIMEOUT = 10000;
+
+	/**
+	 * The size of a single change in a binary frame.
+	 * The pin number and state as one byte each, followed by the number of changes
+	 * and the time of the change as 64 bit little endian integers.
+	 */
+	static const size_t BINARY_CHANGE_SIZE = 18;
+
+	/**
+	 * The send queue stats of a single client, for the metrics endpoint.
+	 */
+	struct client_stats {
+		/**
+		 * The id of the client.
+		 */
+		uint32_t id;
+
+		/**
+		 * The number of frames queued in the web socket client, that weren't sent yet.
+		 */
+		size_t queue_length;
+
+		/**
+		 * The number of coalesced pin changes waiting to be sent in the next frame.
+		 */
+		size_t pending_changes;
+	};
+
+	/**
+	 * Creates a new pin socket for the given url.
+	 *
+	 * @param url		The url of the WebSocket endpoint.
+	 * @param gpio		The GPIOHandler to get the current state of newly subscribed pins from.
+	 * @param timeout	The time in milliseconds after which a client that can't receive changes is closed.
+	 */
+	PinSocket(const char *url, GPIOHandler &gpio, const uint32_t timeout =
+			DEFAULT_TIMEOUT);
+
+	/**
+	 * Closes all clients.
+	 */
+	virtual ~PinSocket();
+
+	/**
+	 * Adds the underlying web socket handler to the given web server.
+	 *
+	 * @param server	The web server to add the web socket to.
+	 */
+	void setup(AsyncWebServer &server);
+
+	/**
+	 * Sets the GPIOHandler to get the current state of newly subscribed pins from.
+	 *
+	 * @param gpio	The new GPIOHandler to use.
+	 */
+	void setGPIOHandler(GPIOHandler &gpio);
+
+	/**
+	 * Adds a pin change to the pending changes of all clients subscribed to its pin.
+	 * Replaces any pending change of the same pin.
+	 *
+	 * @param change	The change to send.
+	 */
+	void publish(const pin_change &change);
+
+	/**
+	 * Sends the pending changes of each client as a single frame.
+	 * Clients whose send queue is full keep their changes until the next call.
+	 * Clients that couldn't receive changes for longer than the timeout are closed.
+	 */
+	void flush();
+
+	/**
+	 * Closes all clients.
+	 */
+	void closeAll();
+
+	/**
+	 * Gets the send queue stats of all connected clients.
+	 *
+	 * @return	The stats of each client.
+	 */
+	std::vector<client_stats> getClientStats();
+
+	/**
+	 * Gets the number of clients that were closed because they couldn't receive changes.
+	 *
+	 * @return	The number of dropped clients.
+	 */
+	uint32_t getDroppedClients() const;
+
+	/**
+	 * Parses a comma separated list of pins to a pin bit mask.
+	 *
+	 * @param pins	The list of pins to parse, or "*" for all pins.
+	 * @param mask	The variable to write the parsed bit mask to.
+	 * @return	True if the list was valid.
+	 */
+	static bool parsePins(const std::string &pins, uint64_t &mask);
+private:
+	/**
+	 * The state of a single connected client.
+	 */
+	struct client {
+		/**
+		 * A bit mask of the pins this client is subscribed to.
+		 * The bit at the index of the pin number is set if the client is subscribed to it.
+		 */
+		uint64_t subscribed;
+
+		/**
+		 * Whether changes are sent as binary frames, rather than json text frames.
+		 */
+		bool binary;
+
+		/**
+		 * The pin changes that weren't sent to this client yet, by pin.
+		 */
+		std::map<uint8_t, pin_change> pending;
+
+		/**
+		 * The time since which this client has unsent changes, in milliseconds since boot.
+		 * Zero if everything was sent.
+		 */
+		uint64_t pending_since;
+	};
+
+	/**
+	 * The underlying web socket handler.
+	 */
+	AsyncWebSocket socket;
+
+	/**
+	 * The GPIOHandler to get the current state of newly subscribed pins from.
+	 */
+	GPIOHandler *gpio;
+
+	/**
+	 * The time in milliseconds after which a client that can't receive changes is closed.
+	 */
+	const uint32_t timeout;
+
+	/**
+	 * The state of all connected clients, by client id.
+	 */
+	std::map<uint32_t, client> clients;
+
+	/**
+	 * The mutex synchronizing access to the clients.
+	 * Client events are handled by the web server task, while changes are published from the main loop.
+	 */
+	std::mutex lock;
+
+	/**
+	 * The number of clients that were closed because they couldn't receive changes.
+	 */
+	uint32_t dropped_clients;
+
+	/**
+	 * Handles a web socket event.
+	 *
+	 * @param server	The web socket the event occurred on.
+	 * @param ws_client	The client the event is about.
+	 * @param type		The type of the event.
+	 * @param arg		The frame info for data events.
+	 * @param data		The received data.
+	 * @param len		The length of the received data.
+	 */
+	void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *ws_client,
+			AwsEventType type, void *arg, uint8_t *data, size_t len);
+
+	/**
+	 * Handles a single command received from a client.
+	 *
+	 * @param ws_client	The client that sent the command.
+	 * @param command	The received command.
+	 */
+	void handleCommand(AsyncWebSocketClient *ws_client,
+			const std::string &command);
+
+	/**
+	 * Appends the given pin change to a json array frame.
+	 *
+	 * @param frame		The frame to append to.
+	 * @param change	The change to append.
+	 */
+	static void appendJson(std::string &frame, const pin_change &change);
+
+	/**
+	 * Appends the given pin change to a binary frame.
+	 *
+	 * @param frame		The frame to append to.
+	 * @param change	The change to append.
+	 */
+	static void appendBinary(std::string &frame, const pin_change &change);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_PINSOCKET_H_ */
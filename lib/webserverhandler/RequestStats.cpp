@@ -0,0 +1,173 @@
+/*
+ * RequestStats.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "RequestStats.h"
+#include <algorithm>
+
+const char *const RequestStats::ENDPOINT_NAMES[ENDPOINT_COUNT] = {
+		"/index.html", "/settings.html", "/delete.html", "/pins.json",
+		"/pins.cbor", "/events", "/metrics", "/history.csv", "/api/pins",
+		"/api/wait", "/api/stats", "/api/history", "/main.css", "/index.js",
+		"/settings.js", "not_found" };
+
+const uint16_t RequestStats::STATUS_CODES[STATUS_COUNT] = { 200, 304, 400,
+		404, 500, 503, 0 };
+
+const uint32_t RequestStats::DURATION_BUCKETS[DURATION_BUCKET_COUNT] = {
+		1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000 };
+
+/**
+ * A response subclass that is never instantiated.
+ * Only used to read the protected fields of other responses, which ESPAsyncWebServer has no getters for.
+ */
+class ResponseFields: public AsyncWebServerResponse {
+public:
+	static int getCode(const AsyncWebServerResponse *response) {
+		return response->*(&ResponseFields::_code);
+	}
+
+	static size_t getContentLength(const AsyncWebServerResponse *response) {
+		if (response->*(&ResponseFields::_chunked)) {
+			return 0;
+		}
+		return response->*(&ResponseFields::_contentLength);
+	}
+};
+
+RequestStats::RequestStats() :
+		stats() {
+}
+
+void RequestStats::record(const http_endpoint endpoint, const uint16_t code,
+		const uint32_t duration, const size_t bytes,
+		const uint32_t heap_delta) {
+	if (endpoint >= ENDPOINT_COUNT) {
+		return;
+	}
+
+	endpoint_stats &endpoint_stats = stats[endpoint];
+	uint8_t status = 0;
+	while (status < STATUS_COUNT - 1 && STATUS_CODES[status] != code) {
+		status++;
+	}
+	endpoint_stats.requests[status]++;
+
+	uint8_t bucket = 0;
+	while (bucket < DURATION_BUCKET_COUNT
+			&& duration > DURATION_BUCKETS[bucket]) {
+		bucket++;
+	}
+	endpoint_stats.durations[bucket]++;
+	endpoint_stats.duration_sum += duration;
+	endpoint_stats.bytes += bytes;
+	endpoint_stats.peak_heap_delta = std::max(endpoint_stats.peak_heap_delta,
+			heap_delta);
+}
+
+uint32_t RequestStats::getRequests(const http_endpoint endpoint) const {
+	uint32_t requests = 0;
+	for (uint8_t i = 0; i < STATUS_COUNT; i++) {
+		requests += stats[endpoint].requests[i];
+	}
+	return requests;
+}
+
+void RequestStats::appendMetrics(std::string &metrics) const {
+	char line[160];
+	bool any = false;
+	for (uint8_t i = 0; i < ENDPOINT_COUNT; i++) {
+		if (getRequests((http_endpoint) i) > 0) {
+			any = true;
+			break;
+		}
+	}
+
+	if (!any) {
+		return;
+	}
+
+	metrics += "# HELP esp_http_requests_total The number of http requests handled per endpoint and status code.\n";
+	metrics += "# TYPE esp_http_requests_total counter\n";
+	for (uint8_t i = 0; i < ENDPOINT_COUNT; i++) {
+		for (uint8_t j = 0; j < STATUS_COUNT; j++) {
+			if (stats[i].requests[j] == 0) {
+				continue;
+			}
+
+			char code[6] = "other";
+			if (STATUS_CODES[j] != 0) {
+				snprintf(code, sizeof(code), "%u", STATUS_CODES[j]);
+			}
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_http_requests_total{endpoint=\"%s\",code=\"%s\"} %u\n",
+							ENDPOINT_NAMES[i], code, stats[i].requests[j])));
+		}
+	}
+
+	metrics += "# HELP esp_http_handler_duration_seconds The time the request handlers took, including rendering the first part of the response.\n";
+	metrics += "# TYPE esp_http_handler_duration_seconds histogram\n";
+	for (uint8_t i = 0; i < ENDPOINT_COUNT; i++) {
+		const uint32_t requests = getRequests((http_endpoint) i);
+		if (requests == 0) {
+			continue;
+		}
+
+		uint32_t cumulative = 0;
+		for (uint8_t j = 0; j < DURATION_BUCKET_COUNT; j++) {
+			cumulative += stats[i].durations[j];
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_http_handler_duration_seconds_bucket{endpoint=\"%s\",le=\"%u.%06u\"} %u\n",
+							ENDPOINT_NAMES[i], DURATION_BUCKETS[j] / 1000000,
+							DURATION_BUCKETS[j] % 1000000, cumulative)));
+		}
+		metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+				snprintf(line, sizeof(line),
+						"esp_http_handler_duration_seconds_bucket{endpoint=\"%s\",le=\"+Inf\"} %u\n",
+						ENDPOINT_NAMES[i], requests)));
+		metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+				snprintf(line, sizeof(line),
+						"esp_http_handler_duration_seconds_sum{endpoint=\"%s\"} %llu.%06u\n",
+						ENDPOINT_NAMES[i], stats[i].duration_sum / 1000000,
+						(uint32_t) (stats[i].duration_sum % 1000000))));
+		metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+				snprintf(line, sizeof(line),
+						"esp_http_handler_duration_seconds_count{endpoint=\"%s\"} %u\n",
+						ENDPOINT_NAMES[i], requests)));
+	}
+
+	metrics += "# HELP esp_http_response_bytes_total The content length of the responses per endpoint, excluding chunked responses.\n";
+	metrics += "# TYPE esp_http_response_bytes_total counter\n";
+	for (uint8_t i = 0; i < ENDPOINT_COUNT; i++) {
+		if (getRequests((http_endpoint) i) > 0) {
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_http_response_bytes_total{endpoint=\"%s\"} %llu\n",
+							ENDPOINT_NAMES[i], stats[i].bytes)));
+		}
+	}
+
+	metrics += "# HELP esp_http_handler_heap_peak_bytes The most heap memory used by a single request handler per endpoint.\n";
+	metrics += "# TYPE esp_http_handler_heap_peak_bytes gauge\n";
+	for (uint8_t i = 0; i < ENDPOINT_COUNT; i++) {
+		if (getRequests((http_endpoint) i) > 0) {
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_http_handler_heap_peak_bytes{endpoint=\"%s\"} %u\n",
+							ENDPOINT_NAMES[i], stats[i].peak_heap_delta)));
+		}
+	}
+}
+
+uint16_t RequestStats::getCode(const AsyncWebServerResponse *response) {
+	return ResponseFields::getCode(response);
+}
+
+size_t RequestStats::getContentLength(const AsyncWebServerResponse *response) {
+	return ResponseFields::getContentLength(response);
+}
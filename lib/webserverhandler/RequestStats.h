@@ -0,0 +1,160 @@
+/*
+ * RequestStats.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_REQUESTSTATS_H_
+#define LIB_WEBSERVERHANDLER_REQUESTSTATS_H_
+
+#include <ESPAsyncWebServer.h>
+#include <string>
+
+/**
+ * The endpoints whose requests are recorded separately.
+ * The value of an endpoint is its index in the RequestStats counters.
+ */
+enum http_endpoint {
+	ENDPOINT_INDEX,
+	ENDPOINT_SETTINGS,
+	ENDPOINT_DELETE,
+	ENDPOINT_PINS_JSON,
+	ENDPOINT_PINS_CBOR,
+	ENDPOINT_EVENTS,
+	ENDPOINT_METRICS,
+	ENDPOINT_HISTORY_CSV,
+	ENDPOINT_API_PINS,
+	ENDPOINT_API_WAIT,
+	ENDPOINT_API_STATS,
+	ENDPOINT_API_HISTORY,
+	ENDPOINT_MAIN_CSS,
+	ENDPOINT_INDEX_JS,
+	ENDPOINT_SETTINGS_JS,
+	ENDPOINT_NOT_FOUND,
+	ENDPOINT_COUNT
+};
+
+/**
+ * Records the number of requests, handler durations, response sizes, and heap usage of the web server.
+ *
+ * All counters are allocated once, as part of this object, so recording a request never allocates memory.
+ * Not thread safe, since all request handlers run in the async tcp task.
+ */
+class RequestStats {
+public:
+	/**
+	 * The number of status codes counted separately, including the one for all other codes.
+	 */
+	static const uint8_t STATUS_COUNT = 7;
+
+	/**
+	 * The number of handler duration histogram buckets, excluding the +Inf bucket.
+	 */
+	static const uint8_t DURATION_BUCKET_COUNT = 9;
+
+	/**
+	 * The endpoint label values, indexed by their http_endpoint value.
+	 */
+	static const char *const ENDPOINT_NAMES[ENDPOINT_COUNT];
+
+	/**
+	 * The status codes counted separately.
+	 * The last entry is 0, and counts all other status codes.
+	 */
+	static const uint16_t STATUS_CODES[STATUS_COUNT];
+
+	/**
+	 * The upper bounds of the handler duration histogram buckets, in microseconds.
+	 */
+	static const uint32_t DURATION_BUCKETS[DURATION_BUCKET_COUNT];
+
+	/**
+	 * Creates a new RequestStats object, with all counters set to 0.
+	 */
+	RequestStats();
+
+	/**
+	 * Records a handled request.
+	 *
+	 * @param endpoint		The endpoint that handled the request.
+	 * @param code			The status code of the response, or 0 if none was sent.
+	 * @param duration		The time the handler took, in microseconds.
+	 * @param bytes			The content length of the response.
+	 * @param heap_delta	The max amount of heap memory in use by the handler, in bytes.
+	 */
+	void record(const http_endpoint endpoint, const uint16_t code,
+			const uint32_t duration, const size_t bytes,
+			const uint32_t heap_delta);
+
+	/**
+	 * Gets the number of requests handled by the given endpoint.
+	 *
+	 * @param endpoint	The endpoint to get the number of requests for.
+	 * @return	The number of recorded requests.
+	 */
+	uint32_t getRequests(const http_endpoint endpoint) const;
+
+	/**
+	 * Appends the prometheus metrics for all endpoints that handled a request to the given string.
+	 *
+	 * @param metrics	The prometheus metrics to append to.
+	 */
+	void appendMetrics(std::string &metrics) const;
+
+	/**
+	 * Gets the status code of the given response.
+	 * ESPAsyncWebServer doesn't have a getter for it.
+	 *
+	 * @param response	The response to get the status code of.
+	 * @return	The status code of the response.
+	 */
+	static uint16_t getCode(const AsyncWebServerResponse *response);
+
+	/**
+	 * Gets the content length of the given response.
+	 * Returns 0 for chunked responses, since their length isn't known in advance.
+	 *
+	 * @param response	The response to get the content length of.
+	 * @return	The content length of the response.
+	 */
+	static size_t getContentLength(const AsyncWebServerResponse *response);
+private:
+	/**
+	 * The counters of a single endpoint.
+	 */
+	struct endpoint_stats {
+		/**
+		 * The number of requests per status code, indexed like STATUS_CODES.
+		 */
+		uint32_t requests[STATUS_COUNT];
+
+		/**
+		 * The number of requests per handler duration bucket.
+		 * Not cumulative, the last entry counts the requests exceeding all bucket bounds.
+		 */
+		uint32_t durations[DURATION_BUCKET_COUNT + 1];
+
+		/**
+		 * The sum of all handler durations, in microseconds.
+		 */
+		uint64_t duration_sum;
+
+		/**
+		 * The sum of the content lengths of all responses.
+		 */
+		uint64_t bytes;
+
+		/**
+		 * The largest heap delta of a single request.
+		 */
+		uint32_t peak_heap_delta;
+	};
+
+	/**
+	 * The counters of all endpoints, indexed by their http_endpoint value.
+	 */
+	endpoint_stats stats[ENDPOINT_COUNT];
+};
+
+#endif /* LIB_WEBSERVERHANDLER_REQUESTSTATS_H_ */
@@ -0,0 +1,217 @@
+/*
+ * SystemMetrics.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "SystemMetrics.h"
+#include "StorageHandler.h"
+#include <algorithm>
+
+const char *const SystemMetrics::RESET_REASON_NAMES[] = { "unknown", "poweron",
+		"external", "software", "panic", "interrupt_watchdog", "task_watchdog",
+		"watchdog", "deepsleep", "brownout", "sdio" };
+
+const uint8_t SystemMetrics::RESET_REASON_COUNT = sizeof(RESET_REASON_NAMES)
+		/ sizeof(char*);
+
+volatile uint32_t SystemMetrics::wifi_connects = 0;
+
+bool SystemMetrics::wifi_listening = false;
+
+SystemMetrics::SystemMetrics() :
+		snapshot() {
+}
+
+void SystemMetrics::begin() {
+	if (!wifi_listening) {
+		wifi_listening = true;
+		WiFi.onEvent(onWiFiConnected, SYSTEM_EVENT_STA_CONNECTED);
+		// The first connection may have happened before this was called.
+		if (WiFi.isConnected()) {
+			wifi_connects++;
+		}
+	}
+}
+
+const system_snapshot& SystemMetrics::update(const GPIOHandler &gpio) {
+	snapshot.uptime = millis();
+	snapshot.reset_reason = esp_reset_reason();
+
+	snapshot.free_heap = ESP.getFreeHeap();
+	snapshot.largest_free_block = ESP.getMaxAllocHeap();
+	snapshot.min_free_heap = ESP.getMinFreeHeap();
+
+	snapshot.wifi_connected = WiFi.isConnected();
+	snapshot.rssi = snapshot.wifi_connected ? WiFi.RSSI() : 0;
+	snapshot.wifi_reconnects = wifi_connects > 0 ? wifi_connects - 1 : 0;
+
+	snapshot.pin_interrupts = gpio.getPinInterrupts();
+	snapshot.timer_interrupts = gpio.getTimerInterrupts();
+
+	StorageHandler *storage = gpio.getStorageHandler();
+	snapshot.storage = storage != NULL;
+	if (storage != NULL) {
+		snapshot.pin_storage = storage->getBackend().getStats();
+		snapshot.history = storage->getHistory().getStats();
+	}
+
+	snapshot.total_runtime = 0;
+	snapshot.task_count = 0;
+#if configUSE_TRACE_FACILITY
+	const UBaseType_t tasks = uxTaskGetSystemState(task_states,
+			system_snapshot::MAX_TASKS, &snapshot.total_runtime);
+	for (UBaseType_t i = 0; i < tasks; i++) {
+		task_snapshot &task = snapshot.tasks[snapshot.task_count++];
+		strncpy(task.name, task_states[i].pcTaskName, sizeof(task.name) - 1);
+		task.name[sizeof(task.name) - 1] = 0;
+		task.stack_high_watermark = task_states[i].usStackHighWaterMark;
+#if configGENERATE_RUN_TIME_STATS
+		task.runtime = task_states[i].ulRunTimeCounter;
+#else
+		task.runtime = 0;
+#endif
+#if configTASKLIST_INCLUDE_COREID
+		task.core =
+				task_states[i].xCoreID == tskNO_AFFINITY ?
+						-1 : task_states[i].xCoreID;
+#else
+		task.core = -1;
+#endif
+	}
+#endif
+
+	return snapshot;
+}
+
+const system_snapshot& SystemMetrics::getSnapshot() const {
+	return snapshot;
+}
+
+void SystemMetrics::appendMetrics(std::string &metrics,
+		const system_snapshot &snapshot) {
+	char line[160];
+	metrics += "# HELP esp_uptime_seconds The time since the last reset.\n";
+	metrics += "# TYPE esp_uptime_seconds gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_uptime_seconds %llu.%03u\n",
+					snapshot.uptime / 1000,
+					(uint32_t) (snapshot.uptime % 1000))));
+
+	metrics += "# HELP esp_reset_reason The reason for the last reset.\n";
+	metrics += "# TYPE esp_reset_reason gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_reset_reason{reason=\"%s\"} 1\n",
+					snapshot.reset_reason < RESET_REASON_COUNT ?
+							RESET_REASON_NAMES[snapshot.reset_reason] :
+							"unknown")));
+
+	metrics += "# HELP esp_heap_free_bytes The amount of free heap memory.\n";
+	metrics += "# TYPE esp_heap_free_bytes gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_heap_free_bytes %u\n",
+					snapshot.free_heap)));
+	metrics += "# HELP esp_heap_largest_free_block_bytes The largest block of heap memory that can be allocated.\n";
+	metrics += "# TYPE esp_heap_largest_free_block_bytes gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line),
+					"esp_heap_largest_free_block_bytes %u\n",
+					snapshot.largest_free_block)));
+	metrics += "# HELP esp_heap_min_free_bytes The lowest amount of free heap memory since the last reset.\n";
+	metrics += "# TYPE esp_heap_min_free_bytes gauge\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_heap_min_free_bytes %u\n",
+					snapshot.min_free_heap)));
+
+	if (snapshot.task_count > 0) {
+		metrics += "# HELP esp_task_stack_high_watermark_bytes The least amount of stack space a task had left.\n";
+		metrics += "# TYPE esp_task_stack_high_watermark_bytes gauge\n";
+		for (uint8_t i = 0; i < snapshot.task_count; i++) {
+			const task_snapshot &task = snapshot.tasks[i];
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_task_stack_high_watermark_bytes{task=\"%s\",core=\"%d\"} %u\n",
+							task.name, task.core, task.stack_high_watermark)));
+		}
+	}
+
+	if (snapshot.total_runtime > 0) {
+		metrics += "# HELP esp_task_runtime_ticks_total The FreeRTOS run time counter of a task.\n";
+		metrics += "# TYPE esp_task_runtime_ticks_total counter\n";
+		for (uint8_t i = 0; i < snapshot.task_count; i++) {
+			const task_snapshot &task = snapshot.tasks[i];
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_task_runtime_ticks_total{task=\"%s\",core=\"%d\"} %u\n",
+							task.name, task.core, task.runtime)));
+		}
+		metrics += "# HELP esp_runtime_ticks_total The total FreeRTOS run time counter of all tasks.\n";
+		metrics += "# TYPE esp_runtime_ticks_total counter\n";
+		metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+				snprintf(line, sizeof(line), "esp_runtime_ticks_total %u\n",
+						snapshot.total_runtime)));
+	}
+
+	if (snapshot.wifi_connected) {
+		metrics += "# HELP esp_wifi_rssi_dbm The signal strength of the WiFi connection.\n";
+		metrics += "# TYPE esp_wifi_rssi_dbm gauge\n";
+		metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+				snprintf(line, sizeof(line), "esp_wifi_rssi_dbm %d\n",
+						snapshot.rssi)));
+	}
+	metrics += "# HELP esp_wifi_reconnects_total The number of times the WiFi connection was established again.\n";
+	metrics += "# TYPE esp_wifi_reconnects_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_wifi_reconnects_total %u\n",
+					snapshot.wifi_reconnects)));
+
+	metrics += "# HELP esp_pin_interrupts_total The number of pin interrupts of the watched pins.\n";
+	metrics += "# TYPE esp_pin_interrupts_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line), "esp_pin_interrupts_total %u\n",
+					snapshot.pin_interrupts)));
+	metrics += "# HELP esp_debounce_timer_interrupts_total The number of times the debounce timer fired.\n";
+	metrics += "# TYPE esp_debounce_timer_interrupts_total counter\n";
+	metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+			snprintf(line, sizeof(line),
+					"esp_debounce_timer_interrupts_total %u\n",
+					snapshot.timer_interrupts)));
+
+	if (snapshot.storage) {
+		const char *stores[] = { "pins", "history" };
+		const storage_backend_stats *stats[] = { &snapshot.pin_storage,
+				&snapshot.history };
+		metrics += "# HELP esp_storage_writes_total The number of storage writes.\n";
+		metrics += "# TYPE esp_storage_writes_total counter\n";
+		for (uint8_t i = 0; i < 2; i++) {
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_storage_writes_total{store=\"%s\"} %u\n",
+							stores[i], stats[i]->writes)));
+		}
+		metrics += "# HELP esp_storage_write_seconds_total The total time spent writing to the storage.\n";
+		metrics += "# TYPE esp_storage_write_seconds_total counter\n";
+		for (uint8_t i = 0; i < 2; i++) {
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_storage_write_seconds_total{store=\"%s\"} %llu.%06u\n",
+							stores[i], stats[i]->write_time / 1000000,
+							(uint32_t) (stats[i]->write_time % 1000000))));
+		}
+		metrics += "# HELP esp_storage_write_max_seconds The longest time a single storage write took.\n";
+		metrics += "# TYPE esp_storage_write_max_seconds gauge\n";
+		for (uint8_t i = 0; i < 2; i++) {
+			metrics.append(line, std::min<size_t>(sizeof(line) - 1,
+					snprintf(line, sizeof(line),
+							"esp_storage_write_max_seconds{store=\"%s\"} %u.%06u\n",
+							stores[i], stats[i]->max_write_time / 1000000,
+							stats[i]->max_write_time % 1000000)));
+		}
+	}
+}
+
+void SystemMetrics::onWiFiConnected(WiFiEvent_t event,
+		WiFiEventInfo_t eventInfo) {
+	wifi_connects++;
+}
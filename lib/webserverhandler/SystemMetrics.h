@@ -0,0 +1,222 @@
+/*
+ * SystemMetrics.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_SYSTEMMETRICS_H_
+#define LIB_WEBSERVERHANDLER_SYSTEMMETRICS_H_
+
+#include "GPIOHandler.h"
+#include "StorageBackend.h"
+#include <WiFi.h>
+#include <esp_system.h>
+#include <freertos/task.h>
+#include <string>
+
+/**
+ * The resource usage of a single FreeRTOS task.
+ */
+struct task_snapshot {
+	/**
+	 * The name of the task.
+	 */
+	char name[configMAX_TASK_NAME_LEN];
+
+	/**
+	 * The least amount of stack space the task had left, in bytes.
+	 */
+	uint32_t stack_high_watermark;
+
+	/**
+	 * The run time counter of the task.
+	 * Always 0 if the FreeRTOS run time stats are disabled.
+	 */
+	uint32_t runtime;
+
+	/**
+	 * The core the task is pinned to, or -1 if it can run on both.
+	 */
+	int8_t core;
+};
+
+/**
+ * A snapshot of the health and resource usage of the system.
+ * Only contains fixed size fields, so taking a snapshot doesn't allocate memory.
+ */
+struct system_snapshot {
+	/**
+	 * The max number of tasks whose stats are recorded.
+	 */
+	static const uint8_t MAX_TASKS = 24;
+
+	/**
+	 * The time since boot, in milliseconds.
+	 */
+	uint64_t uptime;
+
+	/**
+	 * The reason for the last reset.
+	 */
+	esp_reset_reason_t reset_reason;
+
+	/**
+	 * The amount of free heap memory, in bytes.
+	 */
+	uint32_t free_heap;
+
+	/**
+	 * The largest block of heap memory that can currently be allocated, in bytes.
+	 */
+	uint32_t largest_free_block;
+
+	/**
+	 * The lowest amount of free heap memory since boot, in bytes.
+	 */
+	uint32_t min_free_heap;
+
+	/**
+	 * Whether the WiFi station is currently connected.
+	 */
+	bool wifi_connected;
+
+	/**
+	 * The signal strength of the current WiFi connection, in dBm.
+	 */
+	int8_t rssi;
+
+	/**
+	 * The number of times the WiFi station connected again after the first connection.
+	 */
+	uint32_t wifi_reconnects;
+
+	/**
+	 * The number of pin interrupts of the GPIOHandler.
+	 */
+	uint32_t pin_interrupts;
+
+	/**
+	 * The number of debounce timer interrupts of the GPIOHandler.
+	 */
+	uint32_t timer_interrupts;
+
+	/**
+	 * Whether the GPIOHandler has a StorageHandler, and the storage stats are set.
+	 */
+	bool storage;
+
+	/**
+	 * The stats of the backend storing the pin states.
+	 */
+	storage_backend_stats pin_storage;
+
+	/**
+	 * The stats of the pin history page writes.
+	 */
+	storage_backend_stats history;
+
+	/**
+	 * The total run time counter of all tasks.
+	 * Always 0 if the FreeRTOS run time stats are disabled.
+	 */
+	uint32_t total_runtime;
+
+	/**
+	 * The number of tasks in the tasks array.
+	 */
+	uint8_t task_count;
+
+	/**
+	 * The resource usage of the tasks.
+	 */
+	task_snapshot tasks[MAX_TASKS];
+};
+
+/**
+ * Gathers the health and resource usage of the system, and formats it as prometheus metrics.
+ *
+ * Only counts WiFi reconnects after begin was called.
+ * Task stats are only available if the FreeRTOS trace facility is enabled,
+ * and their run time counters only if the FreeRTOS run time stats are enabled.
+ */
+class SystemMetrics {
+public:
+	/**
+	 * The names of the reset reasons, indexed by their esp_reset_reason_t value.
+	 */
+	static const char *const RESET_REASON_NAMES[];
+
+	/**
+	 * The number of entries in RESET_REASON_NAMES.
+	 */
+	static const uint8_t RESET_REASON_COUNT;
+
+	/**
+	 * Creates a new SystemMetrics object with an empty snapshot.
+	 */
+	SystemMetrics();
+
+	/**
+	 * Starts counting WiFi connections.
+	 * Counts the current connection, if there is one.
+	 */
+	void begin();
+
+	/**
+	 * Takes a new snapshot of the system state.
+	 *
+	 * @param gpio	The GPIOHandler whose interrupt counters and storage to include.
+	 * @return	The new snapshot.
+	 */
+	const system_snapshot& update(const GPIOHandler &gpio);
+
+	/**
+	 * Gets the last snapshot taken by update.
+	 *
+	 * @return	The last snapshot.
+	 */
+	const system_snapshot& getSnapshot() const;
+
+	/**
+	 * Appends the prometheus metrics for the given snapshot to the given string.
+	 *
+	 * @param metrics	The prometheus metrics to append to.
+	 * @param snapshot	The snapshot to format.
+	 */
+	static void appendMetrics(std::string &metrics,
+			const system_snapshot &snapshot);
+private:
+	/**
+	 * The last snapshot taken by update.
+	 */
+	system_snapshot snapshot;
+
+#if configUSE_TRACE_FACILITY
+	/**
+	 * The buffer uxTaskGetSystemState writes the task states to.
+	 * A member, so the task stack doesn't have to fit it.
+	 */
+	TaskStatus_t task_states[system_snapshot::MAX_TASKS];
+#endif
+
+	/**
+	 * The number of times the WiFi station connected since begin was first called.
+	 */
+	static volatile uint32_t wifi_connects;
+
+	/**
+	 * Whether the WiFi event handler was already registered.
+	 */
+	static bool wifi_listening;
+
+	/**
+	 * The WiFi event handler counting the WiFi connections.
+	 *
+	 * @param event		The id of the WiFi event to handle.
+	 * @param eventInfo	Additional context for the event to handle.
+	 */
+	static void onWiFiConnected(WiFiEvent_t event, WiFiEventInfo_t eventInfo);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_SYSTEMMETRICS_H_ */
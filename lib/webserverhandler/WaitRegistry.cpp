@@ -0,0 +1,139 @@
+/*
+ * WaitRegistry.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "WaitRegistry.h"
+#include "JSONWriter.h"
+#include <algorithm>
+
+WaitRegistry::WaitRegistry(const size_t max_waiters) :
+		max_waiters(max_waiters), rejected_waiters(0) {
+}
+
+WaitRegistry::~WaitRegistry() {
+	closeAll();
+}
+
+AsyncWebServerResponse* WaitRegistry::beginResponse(
+		AsyncWebServerRequest *request, const GPIOHandler &gpio,
+		const uint64_t pins, const uint32_t timeout) {
+	std::shared_ptr<waiter> w = add(gpio, pins, timeout, millis());
+	if (!w) {
+		return NULL;
+	}
+
+	// Use a chunked response, since the length isn't known until something changes.
+	AsyncWebServerResponse *response = request->beginChunkedResponse(
+			"application/json",
+			[this, w](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				return fill(w, buffer, max_len, millis());
+			});
+	response->addHeader("Cache-Control", "no-cache");
+
+	request->onDisconnect([this, w]() {
+		std::lock_guard<std::mutex> guard(lock);
+		waiters.erase(std::remove(waiters.begin(), waiters.end(), w),
+				waiters.end());
+	});
+	return response;
+}
+
+std::shared_ptr<WaitRegistry::waiter> WaitRegistry::add(
+		const GPIOHandler &gpio, const uint64_t pins, const uint32_t timeout,
+		const uint32_t start) {
+	std::shared_ptr<waiter> w = std::make_shared<waiter>();
+	w->gpio = &gpio;
+	w->pins = pins;
+	w->start = start;
+	w->timeout = timeout;
+	w->config_changed = false;
+	w->closed = false;
+	w->offset = 0;
+
+	std::lock_guard<std::mutex> guard(lock);
+	if (waiters.size() >= max_waiters) {
+		rejected_waiters++;
+		return NULL;
+	}
+	waiters.push_back(w);
+	return w;
+}
+
+void WaitRegistry::publish(const pin_change &change) {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::shared_ptr<waiter> &w : waiters) {
+		if (change.pin < 64 && (w->pins & (1ULL << change.pin)) != 0) {
+			w->changes[change.pin] = change;
+		}
+	}
+}
+
+void WaitRegistry::publishConfigChange() {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::shared_ptr<waiter> &w : waiters) {
+		w->config_changed = true;
+	}
+}
+
+void WaitRegistry::closeAll() {
+	std::lock_guard<std::mutex> guard(lock);
+	for (std::shared_ptr<waiter> &w : waiters) {
+		w->closed = true;
+	}
+	waiters.clear();
+}
+
+size_t WaitRegistry::getWaiterCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return waiters.size();
+}
+
+uint32_t WaitRegistry::getRejectedWaiters() const {
+	return rejected_waiters;
+}
+
+size_t WaitRegistry::fill(const std::shared_ptr<waiter> &w, uint8_t *buffer,
+		const size_t max_len, const uint32_t now) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (w->body.empty()) {
+		if (!w->closed && !w->config_changed && w->changes.empty()
+				&& now - w->start < w->timeout) {
+			return RESPONSE_TRY_AGAIN;
+		}
+
+		w->body = formatResponse(*w);
+		waiters.erase(std::remove(waiters.begin(), waiters.end(), w),
+				waiters.end());
+	}
+
+	const size_t length = std::min(w->body.length() - w->offset, max_len);
+	memcpy(buffer, w->body.c_str() + w->offset, length);
+	w->offset += length;
+	return length;
+}
+
+std::string WaitRegistry::formatResponse(const waiter &w) {
+	char line[128];
+	JSONWriter header(line, sizeof(line));
+	header.beginObject().key("config").value(w.gpio->getConfigVersion()).key(
+			"timeout").value(w.changes.empty() && !w.config_changed).key(
+			"pins").beginObject();
+	std::string json(line, header.length());
+
+	bool first = true;
+	for (const std::pair<const uint8_t, pin_change> &entry : w.changes) {
+		const pin_change &change = entry.second;
+		JSONWriter pin(line, sizeof(line));
+		pin.resume(!first).lineBreak().key((uint64_t) change.pin).beginObject().key(
+				"pin").value((uint32_t) change.pin).key("state").value(
+				change.state ? "High" : "Low").key("changes").value(
+				change.changes).key("time").value(change.time).endObject();
+		json.append(line, pin.length());
+		first = false;
+	}
+	json += "}}\n";
+	return json;
+}
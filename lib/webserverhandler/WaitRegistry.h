@@ -0,0 +1,199 @@
+/*
+ * WaitRegistry.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef LIB_WEBSERVERHANDLER_WAITREGISTRY_H_
+#define LIB_WEBSERVERHANDLER_WAITREGISTRY_H_
+
+#include "GPIOHandler.h"
+#include <ESPAsyncWebServer.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A bounded registry of parked long-poll requests, each waiting for a change of any of its selected pins.
+ * Each request is a chunked response, that isn't filled until one of its pins changes or its timeout expires.
+ * This way a waiting request doesn't block the web server, and doesn't hold any buffer.
+ *
+ * Changes that arrive before the response is sent are coalesced per pin,
+ * so the response only contains the latest change of each pin.
+ */
+class WaitRegistry {
+public:
+	/**
+	 * The state of a single waiting request.
+	 */
+	struct waiter {
+		/**
+		 * The GPIOHandler to get the configuration version from.
+		 */
+		const GPIOHandler *gpio;
+
+		/**
+		 * A bit mask of the pins this request waits for.
+		 */
+		uint64_t pins;
+
+		/**
+		 * The time at which the request was received, in milliseconds since boot.
+		 */
+		uint32_t start;
+
+		/**
+		 * The time in milliseconds after which to respond even if nothing changed.
+		 */
+		uint32_t timeout;
+
+		/**
+		 * The latest change of each selected pin since the request was received, by pin.
+		 */
+		std::map<uint8_t, pin_change> changes;
+
+		/**
+		 * Whether the set of watched pins changed since the request was received.
+		 */
+		bool config_changed;
+
+		/**
+		 * Whether this request should be answered the next time it can send.
+		 */
+		bool closed;
+
+		/**
+		 * The json to send. Empty until the request is woken.
+		 */
+		std::string body;
+
+		/**
+		 * The number of bytes of the body that were already sent.
+		 */
+		size_t offset;
+	};
+
+	/**
+	 * The default max number of requests that can wait at the same time.
+	 */
+	static const size_t DEFAULT_MAX_WAITERS = 8;
+
+	/**
+	 * Creates a new wait registry without any waiting requests.
+	 *
+	 * @param max_waiters	The max number of requests that can wait at the same time.
+	 */
+	WaitRegistry(const size_t max_waiters = DEFAULT_MAX_WAITERS);
+
+	/**
+	 * Ends all waiting requests.
+	 */
+	virtual ~WaitRegistry();
+
+	/**
+	 * Creates a new response waiting for a change of any of the given pins.
+	 * The caller has to send the response.
+	 *
+	 * @param request	The request to respond to.
+	 * @param gpio		The GPIOHandler to get the configuration version from.
+	 * @param pins		A bit mask of the pins to wait for.
+	 * @param timeout	The max time to wait for a change, in milliseconds.
+	 * @return	The created response, or NULL if too many requests are already waiting.
+	 */
+	AsyncWebServerResponse* beginResponse(AsyncWebServerRequest *request,
+			const GPIOHandler &gpio, const uint64_t pins,
+			const uint32_t timeout);
+
+	/**
+	 * Adds a new request waiting for a change of any of the given pins.
+	 * Used by beginResponse, which should be used instead for web requests.
+	 *
+	 * @param gpio		The GPIOHandler to get the configuration version from.
+	 * @param pins		A bit mask of the pins to wait for.
+	 * @param timeout	The max time to wait for a change, in milliseconds.
+	 * @param start		The time at which the request was received, in milliseconds since boot.
+	 * @return	The new waiting request, or NULL if too many requests are already waiting.
+	 */
+	std::shared_ptr<waiter> add(const GPIOHandler &gpio, const uint64_t pins,
+			const uint32_t timeout, const uint32_t start);
+
+	/**
+	 * Writes as much of the response of the given request to the given buffer as fits.
+	 * Generates the response once the request was woken, and removes it from the waiting requests.
+	 *
+	 * @param w			The request whose response to write.
+	 * @param buffer	The buffer to write to.
+	 * @param max_len	The size of the buffer.
+	 * @param now		The current time in milliseconds since boot.
+	 * @return	The number of bytes written, RESPONSE_TRY_AGAIN if the request is still waiting,
+	 * 			or zero to end the response.
+	 */
+	size_t fill(const std::shared_ptr<waiter> &w, uint8_t *buffer,
+			const size_t max_len, const uint32_t now);
+
+	/**
+	 * Adds a pin change to all requests waiting for the changed pin.
+	 * Replaces any earlier change of the same pin.
+	 *
+	 * @param change	The change to add.
+	 */
+	void publish(const pin_change &change);
+
+	/**
+	 * Wakes all waiting requests, to notify them that the set of watched pins changed.
+	 */
+	void publishConfigChange();
+
+	/**
+	 * Ends all waiting requests, with the changes they received so far.
+	 */
+	void closeAll();
+
+	/**
+	 * Gets the number of currently waiting requests.
+	 *
+	 * @return	The number of waiting requests.
+	 */
+	size_t getWaiterCount() const;
+
+	/**
+	 * Gets the number of requests that were rejected because too many requests were already waiting.
+	 *
+	 * @return	The number of rejected requests.
+	 */
+	uint32_t getRejectedWaiters() const;
+private:
+	/**
+	 * The max number of requests that can wait at the same time.
+	 */
+	const size_t max_waiters;
+
+	/**
+	 * All currently waiting requests.
+	 */
+	std::vector<std::shared_ptr<waiter>> waiters;
+
+	/**
+	 * The mutex synchronizing access to the waiting requests.
+	 * The responses are filled by the web server task, while changes are published from the main loop.
+	 */
+	mutable std::mutex lock;
+
+	/**
+	 * The number of requests that were rejected because too many requests were already waiting.
+	 */
+	uint32_t rejected_waiters;
+
+	/**
+	 * Formats the json response for the given request.
+	 *
+	 * @param w	The request to format the response for.
+	 * @return	The json response body.
+	 */
+	static std::string formatResponse(const waiter &w);
+};
+
+#endif /* LIB_WEBSERVERHANDLER_WAITREGISTRY_H_ */
@@ -6,12 +6,40 @@
  */
 
 #include "WebServerHandler.h"
+#include "StorageHandler.h"
+#include "PartitionStore.h"
 #include <ESPmDNS.h>
 #include <functional>
-#include <regex>
+#include <memory>
+#include <set>
+
+const char *const WebServerHandler::PLACEHOLDER_NAMES[PLACEHOLDER_COUNT] = {
+		"pin", "name", "pull_up", "state", "changes", "puc", "pdc",
+		"message_type", "message", "hidden", "confirm", "version" };
+
+const char *const WebServerHandler::GPIO_ERROR_NAMES[] = { "ok",
+		"pin_invalid", "name_invalid", "already_watched", "not_watched",
+		"flash_pin", "pin_duplicate" };
+
+const char WebServerHandler::STATIC_CACHE_CONTROL[] =
+		"public, max-age=31536000, immutable";
+
+const char WebServerHandler::PAGE_CACHE_CONTROL[] = "no-cache";
 
 WebServerHandler::WebServerHandler(const uint16_t port, GPIOHandler &gpio) :
-		_port(port), server(port), gpio(&gpio) {
+		_port(port), server(port), gpio(&gpio), pin_socket("/ws", gpio),
+		response_code(0), response_length(0),
+		main_css( { "text/css", STATIC_CACHE_CONTROL, MAIN_CSS_GZ_START,
+				MAIN_CSS_GZ_END, "" }),
+		index_js( { "text/javascript", STATIC_CACHE_CONTROL,
+				INDEX_JS_GZ_START, INDEX_JS_GZ_END, "" }),
+		settings_js( { "text/javascript", STATIC_CACHE_CONTROL,
+				SETTINGS_JS_GZ_START, SETTINGS_JS_GZ_END, "" }),
+		index_html( { "text/html", PAGE_CACHE_CONTROL, INDEX_HTML_GZ_START,
+				INDEX_HTML_GZ_END, "" }),
+		settings_html( { "text/html", PAGE_CACHE_CONTROL,
+				SETTINGS_HTML_GZ_START, SETTINGS_HTML_GZ_END, "" }),
+		asset_version(""), boot_id(0) {
 }
 
 WebServerHandler::~WebServerHandler() {
@@ -20,36 +48,99 @@ WebServerHandler::~WebServerHandler() {
 
 void WebServerHandler::setup() {
 	using namespace std::placeholders;
+	settings_template.parse(SETTINGS_HTML, PLACEHOLDER_NAMES,
+			PLACEHOLDER_COUNT);
+	delete_template.parse(DELETE_HTML, PLACEHOLDER_NAMES, PLACEHOLDER_COUNT);
+	not_found_template.parse(NOT_FOUND_HTML, PLACEHOLDER_NAMES,
+			PLACEHOLDER_COUNT);
+
+	uint32_t crc = initStaticAsset(main_css, 0);
+	crc = initStaticAsset(index_js, crc);
+	crc = initStaticAsset(settings_js, crc);
+	snprintf(asset_version, sizeof(asset_version), "%08x", crc);
+	// The pages contain the asset version, so they aren't part of it.
+	initStaticAsset(index_html, 0);
+	initStaticAsset(settings_html, 0);
+	boot_id = esp_random();
+	system_metrics.begin();
+
 	server.rewrite("/", "/index.html");
 
 	server.on("/index.html", HTTP_GET,
-			std::bind(&WebServerHandler::getIndex, this, _1));
+			instrument(ENDPOINT_INDEX,
+					std::bind(&WebServerHandler::getStaticAsset, this, _1,
+							std::cref(index_html))));
+
+	server.on("/settings.html", HTTP_GET,
+			instrument(ENDPOINT_SETTINGS,
+					std::bind(&WebServerHandler::getStaticAsset, this, _1,
+							std::cref(settings_html))));
 
-	server.on("/settings.html", HTTP_GET | HTTP_POST,
-			std::bind(&WebServerHandler::handleSettings, this, _1));
+	server.on("/settings.html", HTTP_POST,
+			instrument(ENDPOINT_SETTINGS,
+					std::bind(&WebServerHandler::handleSettings, this, _1)));
 
 	server.on("/delete.html", HTTP_POST,
-			std::bind(&WebServerHandler::postDelete, this, _1));
+			instrument(ENDPOINT_DELETE,
+					std::bind(&WebServerHandler::postDelete, this, _1)));
 
 	server.on("/pins.json", HTTP_GET,
-			std::bind(&WebServerHandler::getPinsJson, this, _1));
+			instrument(ENDPOINT_PINS_JSON,
+					std::bind(&WebServerHandler::getPinsJson, this, _1)));
+
+	server.on("/pins.cbor", HTTP_GET,
+			instrument(ENDPOINT_PINS_CBOR,
+					std::bind(&WebServerHandler::getPinsCbor, this, _1)));
+
+	pin_socket.setup(server);
+
+	server.on("/events", HTTP_GET,
+			instrument(ENDPOINT_EVENTS,
+					std::bind(&WebServerHandler::getEvents, this, _1)));
 
 	server.on("/metrics", HTTP_GET,
-			std::bind(&WebServerHandler::getMetrics, this, _1));
+			instrument(ENDPOINT_METRICS,
+					std::bind(&WebServerHandler::getMetrics, this, _1)));
+
+	server.on("/history.csv", HTTP_GET,
+			instrument(ENDPOINT_HISTORY_CSV,
+					std::bind(&WebServerHandler::getHistoryCsv, this, _1)));
+
+	server.on("/api/pins", HTTP_GET | HTTP_PUT | HTTP_PATCH | HTTP_DELETE,
+			instrument(ENDPOINT_API_PINS,
+					std::bind(&WebServerHandler::handleApiPins, this, _1)),
+			NULL, receiveApiBody);
+
+	server.on("/api/wait", HTTP_GET,
+			instrument(ENDPOINT_API_WAIT,
+					std::bind(&WebServerHandler::getApiWait, this, _1)));
+
+	server.on("/api/stats", HTTP_GET,
+			instrument(ENDPOINT_API_STATS,
+					std::bind(&WebServerHandler::getApiStats, this, _1)));
 
-	server.on("/main.css", HTTP_GET, [](AsyncWebServerRequest *request) {
-		request->send_P(200, "text/css", MAIN_CSS);
-	});
+	server.on("/api/history", HTTP_GET,
+			instrument(ENDPOINT_API_HISTORY,
+					std::bind(&WebServerHandler::getApiHistory, this, _1)));
 
-	server.on("/index.js", HTTP_GET, [](AsyncWebServerRequest *request) {
-		request->send_P(200, "text/javascript", INDEX_JS);
-	});
+	server.on("/main.css", HTTP_GET,
+			instrument(ENDPOINT_MAIN_CSS,
+					std::bind(&WebServerHandler::getStaticAsset, this, _1,
+							std::cref(main_css))));
 
-	server.on("/settings.js", HTTP_GET, [](AsyncWebServerRequest *request) {
-		request->send_P(200, "text/javascript", SETTINGS_JS);
-	});
+	server.on("/index.js", HTTP_GET,
+			instrument(ENDPOINT_INDEX_JS,
+					std::bind(&WebServerHandler::getStaticAsset, this, _1,
+							std::cref(index_js))));
 
-	server.onNotFound(std::bind(&WebServerHandler::onNotFound, this, _1));
+	server.on("/settings.js", HTTP_GET,
+			instrument(ENDPOINT_SETTINGS_JS,
+					std::bind(&WebServerHandler::getStaticAsset, this, _1,
+							std::cref(settings_js))));
+
+	server.onNotFound(
+			instrument(ENDPOINT_NOT_FOUND,
+					std::bind(&WebServerHandler::onNotFound, this, _1)));
 
 	server.begin();
 
@@ -61,6 +152,9 @@ void WebServerHandler::begin() {
 }
 
 void WebServerHandler::end() {
+	events.closeAll();
+	waits.closeAll();
+	pin_socket.closeAll();
 	server.end();
 
 	mdns_service_remove("http", "tcp");
@@ -68,225 +162,473 @@ void WebServerHandler::end() {
 
 void WebServerHandler::setGPIOHandler(GPIOHandler &gpio) {
 	this->gpio = &gpio;
+	pin_socket.setGPIOHandler(gpio);
 }
 
 GPIOHandler& WebServerHandler::getGPIOHandler() const {
 	return *gpio;
 }
 
-void WebServerHandler::getMetrics(AsyncWebServerRequest *request) const {
-	std::ostringstream stream;
+void WebServerHandler::publish(const pin_change &change) {
+	events.publish(change);
+	pin_socket.publish(change);
+	waits.publish(change);
+}
 
-	std::vector<pin_state> states = gpio->getWatchedPins();
-	if (states.size() > 0) {
-		stream	<< "# HELP esp_pin_state The current digital state of an ESP GPIO/GPI pin."
-				<< std::endl;
-		stream << "# TYPE esp_pin_state gauge" << std::endl;
+void WebServerHandler::publishConfigChange() {
+	events.publishConfigChange();
+	waits.publishConfigChange();
+}
 
-		for (pin_state &state : states) {
-			stream << "esp_pin_state{pin=\"" << (uint16_t) state.number
-					<< "\",name=\"" << state.name.c_str() << "\"} "
-					<< state.state << std::endl;
-		}
+void WebServerHandler::handle() {
+	pin_socket.flush();
+	events.checkClients();
+}
 
-		stream	<< "# HELP esp_pin_state_changes The number of times the state of the ESP GPIO/GPI pin changed its state."
-				<< std::endl;
-		stream << "# TYPE esp_pin_state_changes counter" << std::endl;
+void WebServerHandler::addMetricsAppender(const metrics_appender appender) {
+	metrics_appenders.push_back(appender);
+}
 
-		for (pin_state &state : states) {
-			stream << "esp_pin_state_changes{pin=\"" << (uint16_t) state.number
-					<< "\",name=\"" << state.name.c_str() << "\"} "
-					<< state.changes << std::endl;
+EventStream& WebServerHandler::getEventStream() {
+	return events;
+}
+
+WaitRegistry& WebServerHandler::getWaitRegistry() {
+	return waits;
+}
+
+const RequestStats& WebServerHandler::getRequestStats() const {
+	return request_stats;
+}
+
+AdmissionControl& WebServerHandler::getAdmissionControl() {
+	return admission;
+}
+
+ArRequestHandlerFunction WebServerHandler::instrument(
+		const http_endpoint endpoint, const ArRequestHandlerFunction handler) {
+	return [this, endpoint, handler](AsyncWebServerRequest *request) {
+		response_code = 0;
+		response_length = 0;
+		const uint32_t free_heap = ESP.getFreeHeap();
+		const uint32_t min_free_heap = ESP.getMinFreeHeap();
+		const uint32_t start = micros();
+		// Long-poll requests wait without holding a large buffer, so they don't need a render slot.
+		const admission_result admitted = admission.admit(request, endpoint,
+				endpoint != ENDPOINT_PINS_JSON || !request->hasParam("since"));
+		if (admitted == ADMISSION_ACCEPTED) {
+			handler(request);
+		} else {
+			sendUnavailable(request, admitted);
 		}
-	}
+		const uint32_t duration = micros() - start;
+
+		// The min free heap only shows the peak of this handler if it was a new all time low.
+		uint32_t lowest_free_heap = ESP.getFreeHeap();
+		const uint32_t new_min_free_heap = ESP.getMinFreeHeap();
+		if (new_min_free_heap < min_free_heap) {
+			lowest_free_heap = std::min(lowest_free_heap, new_min_free_heap);
+		}
+		request_stats.record(endpoint, response_code, duration,
+				response_length,
+				free_heap > lowest_free_heap ? free_heap - lowest_free_heap : 0);
+	};
+}
 
-	AsyncWebServerResponse *response = request->beginResponse(200, "text/plain",
-			stream.str().c_str());
+void WebServerHandler::sendUnavailable(AsyncWebServerRequest *request,
+		const admission_result reason) const {
+	AsyncWebServerResponse *response = request->beginResponse(503,
+			"text/plain", "Service Unavailable");
+	response->addHeader("Retry-After",
+			String(AdmissionControl::RETRY_AFTER[reason]));
 	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
+}
+
+void WebServerHandler::send(AsyncWebServerRequest *request,
+		AsyncWebServerResponse *response) const {
+	// Read these before sending, since an invalid response is deleted by send.
+	response_code = RequestStats::getCode(response);
+	response_length = RequestStats::getContentLength(response);
 	request->send(response);
 }
 
+void WebServerHandler::getMetrics(AsyncWebServerRequest *request) {
+	// Send the cached pin metrics as-is, followed by the metrics that change with every request.
+	const std::shared_ptr<const std::string> pin_metrics = metrics_cache.get(*gpio);
+	std::shared_ptr<std::string> metrics = std::make_shared<std::string>();
+	SystemMetrics::appendMetrics(*metrics, system_metrics.update(*gpio));
+	const std::vector<PinSocket::client_stats> sockets =
+			pin_socket.getClientStats();
+	if (!sockets.empty()) {
+		appendSocketMetrics(*metrics, sockets);
+	}
+	admission.appendMetrics(*metrics);
+	request_stats.appendMetrics(*metrics);
+	for (const metrics_appender &appender : metrics_appenders) {
+		appender(*metrics);
+	}
+
+	AsyncWebServerResponse *response = beginStringResponse(request,
+			"text/plain", pin_metrics, metrics);
+	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
+}
+
+void WebServerHandler::getStateETag(char etag[STATE_ETAG_SIZE],
+		const char *variant) const {
+	snprintf(etag, STATE_ETAG_SIZE, "W/\"%08x-%x-%x%s\"", boot_id,
+			gpio->getConfigVersion(), gpio->getChangeSequence(), variant);
+}
+
+bool WebServerHandler::sendNotModified(AsyncWebServerRequest *request,
+		const char *etag) const {
+	AsyncWebHeader *if_none_match = request->getHeader("If-None-Match");
+	// Weak comparison, so ignore the W/ prefix.
+	if (if_none_match == NULL
+			|| (if_none_match->value().indexOf(etag + 2) < 0
+					&& if_none_match->value() != "*")) {
+		return false;
+	}
+
+	AsyncWebServerResponse *response = request->beginResponse(304);
+	response->addHeader("ETag", etag);
+	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
+	return true;
+}
+
+void WebServerHandler::appendSocketMetrics(std::string &metrics,
+		const std::vector<PinSocket::client_stats> &sockets) {
+	char line[LINE_BUFFER_SIZE];
+	metrics += "# HELP esp_ws_client_queue_length The number of frames queued for a web socket client.\n";
+	metrics += "# TYPE esp_ws_client_queue_length gauge\n";
+	for (const PinSocket::client_stats &client : sockets) {
+		metrics.append(line, std::min<size_t>(LINE_BUFFER_SIZE - 1,
+				snprintf(line, LINE_BUFFER_SIZE,
+						"esp_ws_client_queue_length{client=\"%u\"} %u\n",
+						client.id, client.queue_length)));
+	}
+
+	metrics += "# HELP esp_ws_client_pending_changes The number of coalesced pin changes waiting to be sent to a web socket client.\n";
+	metrics += "# TYPE esp_ws_client_pending_changes gauge\n";
+	for (const PinSocket::client_stats &client : sockets) {
+		metrics.append(line, std::min<size_t>(LINE_BUFFER_SIZE - 1,
+				snprintf(line, LINE_BUFFER_SIZE,
+						"esp_ws_client_pending_changes{client=\"%u\"} %u\n",
+						client.id, client.pending_changes)));
+	}
+}
+
+AsyncWebServerResponse* WebServerHandler::beginStringResponse(
+		AsyncWebServerRequest *request, const char *content_type,
+		const std::shared_ptr<const std::string> content) {
+	if (content->empty()) {
+		return request->beginResponse(200, content_type, String());
+	}
+
+	return request->beginResponse(content_type, content->length(),
+			[content](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				const size_t length = std::min(content->length() - index, max_len);
+				memcpy(buffer, content->c_str() + index, length);
+				return length;
+			});
+}
+
+AsyncWebServerResponse* WebServerHandler::beginStringResponse(
+		AsyncWebServerRequest *request, const char *content_type,
+		const std::shared_ptr<const std::string> head,
+		const std::shared_ptr<const std::string> tail) {
+	if (head->empty() && tail->empty()) {
+		return request->beginResponse(200, content_type, String());
+	}
+
+	return request->beginResponse(content_type, head->length() + tail->length(),
+			[head, tail](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				size_t length = 0;
+				if (index < head->length()) {
+					length = std::min(head->length() - index, max_len);
+					memcpy(buffer, head->c_str() + index, length);
+				}
+
+				const size_t tail_index = index + length - head->length();
+				const size_t tail_length = std::min(tail->length() - tail_index,
+						max_len - length);
+				memcpy(buffer + length, tail->c_str() + tail_index, tail_length);
+				return length + tail_length;
+			});
+}
+
+AsyncWebServerResponse* WebServerHandler::beginLineResponse(
+		AsyncWebServerRequest *request, const char *content_type,
+		const size_t lines, const line_generator generator) {
+	std::shared_ptr<line_stream> stream = std::make_shared<line_stream>();
+	size_t length = 0;
+	for (size_t i = 0; i < lines; i++) {
+		length += std::min(generator(i, stream->buffer, LINE_BUFFER_SIZE),
+				LINE_BUFFER_SIZE - 1);
+	}
+
+	if (length == 0) {
+		return request->beginResponse(200, content_type, String());
+	}
+
+	stream->line = 0;
+	stream->offset = 0;
+	stream->length = 0;
+	return request->beginResponse(content_type, length,
+			[stream, lines, generator](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				size_t written = 0;
+				while (written < max_len) {
+					if (stream->offset >= stream->length) {
+						if (stream->line >= lines) {
+							break;
+						}
+
+						stream->length = std::min(generator(stream->line++,
+								stream->buffer, LINE_BUFFER_SIZE), LINE_BUFFER_SIZE - 1);
+						stream->offset = 0;
+					}
+
+					const size_t part = std::min(stream->length - stream->offset,
+							max_len - written);
+					memcpy(buffer + written, stream->buffer + stream->offset, part);
+					stream->offset += part;
+					written += part;
+				}
+				return written;
+			});
+}
+
+void WebServerHandler::getStaticAsset(AsyncWebServerRequest *request,
+		const static_asset &asset) const {
+	AsyncWebServerResponse *response = NULL;
+	AsyncWebHeader *if_none_match = request->getHeader("If-None-Match");
+	if (if_none_match != NULL
+			&& (if_none_match->value().indexOf(asset.etag) >= 0
+					|| if_none_match->value() == "*")) {
+		response = request->beginResponse(304);
+	} else {
+		response = request->beginResponse_P(200, asset.content_type,
+				asset.start, asset.end - asset.start);
+		response->addHeader("Content-Encoding", "gzip");
+	}
+
+	response->addHeader("ETag", asset.etag);
+	response->addHeader("Cache-Control", asset.cache_control);
+	send(request, response);
+}
+
+uint32_t WebServerHandler::initStaticAsset(static_asset &asset,
+		const uint32_t crc) {
+	const size_t length = asset.end - asset.start;
+	snprintf(asset.etag, sizeof(asset.etag), "\"%08x\"",
+			PartitionStore::crc32(0, asset.start, length));
+	return PartitionStore::crc32(crc, asset.start, length);
+}
+
 void WebServerHandler::onNotFound(AsyncWebServerRequest *request) const {
-	request->send_P(404, "text/html", NOT_FOUND_HTML);
-}
-
-void WebServerHandler::getIndex(AsyncWebServerRequest *request) const {
-	std::string response(INDEX_HTML);
-
-	std::vector<pin_state> watched_pins = gpio->getWatchedPins();
-	if (watched_pins.size() > 0) {
-		std::ostringstream converter;
-		std::string state_html;
-		std::regex pin("\\$pin");
-		std::regex name("\\$name");
-		std::regex pull_up("\\$pull_up");
-		std::regex state("\\$state");
-		std::regex changes("\\$changes");
-		std::regex end("[ \\t]*<!-- Pin states end -->");
-		for (pin_state &watched : watched_pins) {
-			state_html = INDEX_STATE_HTML;
-			converter << (uint16_t) watched.number;
-			state_html = std::regex_replace(state_html, pin, converter.str());
-			converter.str("");
-			converter.clear();
-			state_html = std::regex_replace(state_html, name,
-					watched.name.c_str());
-			state_html = std::regex_replace(state_html, pull_up,
-					watched.pull_up ? "Pull Up" : "Pull Down");
-			state_html = std::regex_replace(state_html, state,
-					watched.state ? "High" : "Low");
-			converter << watched.changes;
-			state_html = std::regex_replace(state_html, changes,
-					converter.str());
-			converter.str("");
-			converter.clear();
-			state_html += "<!-- Pin states end -->";
-			response = std::regex_replace(response, end, state_html);
+	const char *values[PLACEHOLDER_COUNT] = { NULL };
+	sendPage(request, 404, not_found_template, values);
+}
+
+void WebServerHandler::sendPage(AsyncWebServerRequest *request,
+		const int code, const HTMLTemplate &page,
+		const char *const page_values[]) const {
+	std::shared_ptr<page_stream> stream = std::make_shared<page_stream>();
+	stream->page = &page;
+
+	// Copy the values, since the page is rendered after this method returns.
+	for (size_t i = 0; i < PLACEHOLDER_COUNT; i++) {
+		if (page_values[i] != NULL) {
+			stream->page_values[i] = page_values[i];
+			stream->values[i] = stream->page_values[i].c_str();
+		} else {
+			stream->values[i] = NULL;
 		}
-	} else {
-		response.insert(response.find("<!-- Pin states end -->"),
-				"Currently no pin is registered to be watched.\n\t\t");
 	}
+	stream->values[PLACEHOLDER_VERSION] = asset_version;
+	stream->page_pos = { 0, 0 };
+
+	AsyncWebServerResponse *response = request->beginResponse("text/html",
+			page.getLength(stream->values),
+			[stream](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				return fillPage(*stream, (char*) buffer, max_len);
+			});
+	response->setCode(code);
+	send(request, response);
+}
+
+size_t WebServerHandler::fillPage(page_stream &stream, char *buffer,
+		const size_t max_len) {
+	return stream.page->render(buffer, max_len, stream.values,
+			stream.page_pos);
+}
 
-	request->send(200, "text/html", response.c_str());
+void WebServerHandler::getPinValues(const pin_state &pin, char number[4],
+		char changes[21], const char *values[]) {
+	snprintf(number, 4, "%hu", (uint16_t) pin.number);
+	snprintf(changes, 21, "%llu", pin.changes);
+	values[PLACEHOLDER_PIN] = number;
+	values[PLACEHOLDER_NAME] = pin.name.c_str();
+	values[PLACEHOLDER_PULL_UP] = pin.pull_up ? "Pull Up" : "Pull Down";
+	values[PLACEHOLDER_PULL_UP_CHECKED] = pin.pull_up ? "checked" : "";
+	values[PLACEHOLDER_PULL_DOWN_CHECKED] = pin.pull_up ? "" : "checked";
+	values[PLACEHOLDER_STATE] = pin.state ? "High" : "Low";
+	values[PLACEHOLDER_CHANGES] = changes;
 }
 
 void WebServerHandler::handleSettings(AsyncWebServerRequest *request) const {
-	std::string response(SETTINGS_HTML);
+	const char *values[PLACEHOLDER_COUNT] = { NULL };
+	values[PLACEHOLDER_HIDDEN] = " hidden";
 
 	bool error = false;
-	if (request->method() == HTTP_POST) {
-		String message = "";
-		String action, pin, name;
-		bool pull_up = false;
+	String message = "";
+	String action, pin, name;
+	bool pull_up = false;
 
-		if (!request->hasParam("action", true)) {
-			message = "Received a request missing the \"action\" parameter.";
-			error = true;
-		} else if (!request->hasParam("pin", true)) {
-			message = "Received a request missing the \"pin\" parameter.";
+	if (!request->hasParam("action", true)) {
+		message = "Received a request missing the \"action\" parameter.";
+		error = true;
+	} else if (request->getParam("action", true)->value() == "update_all") {
+		action = "update_all";
+		error = !updatePins(request, message);
+	} else if (!request->hasParam("pin", true)) {
+		message = "Received a request missing the \"pin\" parameter.";
+		error = true;
+	} else if (!request->hasParam("name", true)) {
+		message = "Received a request missing the \"name\" parameter.";
+		error = true;
+	} else if (!request->hasParam("resistor", true)) {
+		message = "Received a request missing the \"resistor\" parameter.";
+		error = true;
+	} else {
+		action = request->getParam("action", true)->value();
+		name = request->getParam("name", true)->value();
+		pin = request->getParam("pin", true)->value();
+		const String resistor =
+				request->getParam("resistor", true)->value();
+
+		if (resistor == "pull_up" || resistor == "Pull Up") {
+			pull_up = true;
+		} else if (resistor != "pull_down" && resistor != "Pull Down") {
+			message = "Received invalid resistor value \"" + resistor
+					+ "\".";
 			error = true;
-		} else if (!request->hasParam("name", true)) {
-			message = "Received a request missing the \"name\" parameter.";
+		}
+	}
+
+	if (!error && action != "update_all") {
+		gpio_err_t err = GPIO_OK;
+		if (action == "add") {
+			err = gpio->registerGPIO(atoi(pin.c_str()), name,
+					pull_up);
+			message = "Successfully added Pin to be watched.";
+		} else if (action == "update") {
+			err = gpio->updateGPIO(atoi(pin.c_str()), name, pull_up);
+			message = "Successfully updated watched Pin.";
+		} else if (action == "delete") {
+			err = gpio->unregisterGPIO(atoi(pin.c_str()));
+			message = "Successfully removed watched Pin.";
+		} else if (action != "cancel") {
+			message = "Received invalid action \"" + action + "\".";
 			error = true;
-		} else if (!request->hasParam("resistor", true)) {
-			message = "Received a request missing the \"resistor\" parameter.";
+		}
+
+		if (err != GPIO_OK) {
+			message = "Couldn't " + action + " pin " + pin + " because "
+					+ getErrorReason(err, name);
 			error = true;
-		} else {
-			action = request->getParam("action", true)->value();
-			name = request->getParam("name", true)->value();
-			pin = request->getParam("pin", true)->value();
-			const String resistor =
-					request->getParam("resistor", true)->value();
-
-			if (resistor == "pull_up" || resistor == "Pull Up") {
-				pull_up = true;
-			} else if (resistor != "pull_down" && resistor != "Pull Down") {
-				message = "Received invalid resistor value \"" + resistor
-						+ "\".";
-				error = true;
-			}
 		}
+	}
 
-		if (!error) {
-			gpio_err_t err = GPIO_OK;
-			if (action == "add") {
-				err = gpio->registerGPIO(atoi(pin.c_str()), name,
-						pull_up);
-				message = "Successfully added Pin to be watched.";
-			} else if (action == "update") {
-				err = gpio->updateGPIO(atoi(pin.c_str()), name, pull_up);
-				message = "Successfully updated watched Pin.";
-			} else if (action == "delete") {
-				err = gpio->unregisterGPIO(atoi(pin.c_str()));
-				message = "Successfully removed watched Pin.";
-			} else if (action != "cancel") {
-				message = "Received invalid action \"" + action + "\".";
-				error = true;
-			}
+	if (message != "") {
+		values[PLACEHOLDER_MESSAGE_TYPE] = error ? "error" : "success";
+		values[PLACEHOLDER_MESSAGE] = message.c_str();
+		values[PLACEHOLDER_HIDDEN] = "";
+	}
 
-			if (err != GPIO_OK) {
-				message = "Couldn't " + action + " pin " + pin + " because ";
-				error = true;
-
-				switch (err) {
-				case GPIO_PIN_INVALID:
-					message += "it isn't an input pin.";
-					break;
-				case GPIO_NAME_INVALID:
-					message += '"' + name + "\" isn't a valid pin name.";
-					break;
-				case GPIO_ALREADY_WATCHED:
-					message += "it is already being watched.";
-					break;
-				case GPIO_NOT_WATCHED:
-					message += "it isn't being watched.";
-					break;
-				case GPIO_FLASH_PIN:
-					message += "it is connected to the internal flash.";
-					break;
-				default:
-					message += "of an unknown error.";
-					Serial.print(
-							"WebServerHandler: A GPIOHandler action returned unknown error code ");
-					Serial.print(err);
-					Serial.println('.');
-					break;
-				}
+	sendPage(request, error ? 400 : 200, settings_template, values);
+}
+
+bool WebServerHandler::updatePins(AsyncWebServerRequest *request,
+		String &message) const {
+	// The parameters are expected as repeated pin, name, resistor groups.
+	std::vector<pin_config> configs;
+	for (size_t i = 0; i < request->params(); i++) {
+		AsyncWebParameter *param = request->getParam(i);
+		if (!param->isPost() || (configs.empty() && param->name() != "pin")) {
+			continue;
+		}
+
+		if (param->name() == "pin") {
+			configs.push_back( { (uint8_t) atoi(param->value().c_str()), "", false });
+		} else if (param->name() == "name") {
+			configs.back().name = param->value();
+		} else if (param->name() == "resistor") {
+			if (param->value() == "pull_up" || param->value() == "Pull Up") {
+				configs.back().pull_up = true;
+			} else if (param->value() != "pull_down" && param->value() != "Pull Down") {
+				message = "Received invalid resistor value \"" + param->value() + "\".";
+				return false;
 			}
 		}
+	}
 
-		if (message != "") {
-			response = std::regex_replace(response,
-					std::regex("\\$message_type\" hidden"),
-					error ? "error\"" : "success\"");
-			response = std::regex_replace(response, std::regex("\\$message"),
-					message.c_str());
+	if (configs.empty()) {
+		message = "Received a request without any pins to update.";
+		return false;
+	}
+
+	for (const pin_config &config : configs) {
+		if (!gpio->isWatched(config.number)) {
+			message = "Couldn't update pin " + String(config.number) + " because "
+					+ getErrorReason(GPIO_NOT_WATCHED, config.name);
+			return false;
 		}
 	}
 
-	std::vector<pin_state> watched_pins = gpio->getWatchedPins();
-	if (watched_pins.size() > 0) {
-		std::ostringstream converter;
-		std::string pin_html;
-		std::regex pin("\\$pin");
-		std::regex name("\\$name");
-		std::regex pull_up_checked("\\$puc");
-		std::regex pull_down_checked("\\$pdc");
-		std::regex state("\\$state");
-		std::regex changes("\\$changes");
-		std::regex end("[ \\t]*<!-- Pin states end -->");
-		for (pin_state &watched : watched_pins) {
-			pin_html = SETTINGS_PIN_HTML;
-			converter << (uint16_t) watched.number;
-			pin_html = std::regex_replace(pin_html, pin, converter.str());
-			converter.str("");
-			converter.clear();
-			pin_html = std::regex_replace(pin_html, name, watched.name.c_str());
-			pin_html = std::regex_replace(pin_html, pull_up_checked,
-					watched.pull_up ? "checked" : "");
-			pin_html = std::regex_replace(pin_html, pull_down_checked,
-					watched.pull_up ? "" : "checked");
-			pin_html = std::regex_replace(pin_html, state,
-					watched.state ? "High" : "Low");
-			converter << watched.changes;
-			pin_html = std::regex_replace(pin_html, changes, converter.str());
-			converter.str("");
-			converter.clear();
-			pin_html += "<!-- Pin states end -->";
-			response = std::regex_replace(response, end, pin_html);
+	std::vector<gpio_err_t> results;
+	if (gpio->configurePins(configs, &results, false) != GPIO_OK) {
+		message = "Couldn't update the pins because:";
+		for (size_t i = 0; i < configs.size(); i++) {
+			if (results[i] != GPIO_OK) {
+				message += " Pin " + String(configs[i].number) + ": "
+						+ getErrorReason(results[i], configs[i].name);
+			}
 		}
-	} else {
-		response.insert(response.find("<!-- Pin states end -->"),
-				"Currently no pin is registered to be watched.\n\t\t");
+		return false;
 	}
 
-	request->send(error ? 400 : 200, "text/html", response.c_str());
+	message = "Successfully updated " + String(configs.size()) + " watched Pins.";
+	return true;
 }
 
-void WebServerHandler::postDelete(AsyncWebServerRequest *request) const {
-	std::string response = DELETE_HTML;
+String WebServerHandler::getErrorReason(const gpio_err_t err,
+		const String &name) {
+	switch (err) {
+	case GPIO_PIN_INVALID:
+		return "it isn't an input pin.";
+	case GPIO_NAME_INVALID:
+		return '"' + name + "\" isn't a valid pin name.";
+	case GPIO_ALREADY_WATCHED:
+		return "it is already being watched.";
+	case GPIO_NOT_WATCHED:
+		return "it isn't being watched.";
+	case GPIO_FLASH_PIN:
+		return "it is connected to the internal flash.";
+	case GPIO_PIN_DUPLICATE:
+		return "it was given more than once.";
+	default:
+		Serial.print(
+				"WebServerHandler: A GPIOHandler action returned unknown error code ");
+		Serial.print(err);
+		Serial.println('.');
+		return "of an unknown error.";
+	}
+}
 
+void WebServerHandler::postDelete(AsyncWebServerRequest *request) const {
 	pin_state pin(NULL, 0, "", false, false);
 	String error;
 	if (request->hasParam("pin", true)) {
@@ -321,55 +663,676 @@ void WebServerHandler::postDelete(AsyncWebServerRequest *request) const {
 		error = "Didn't receive pin to delete.";
 	}
 
-	std::ostringstream converter;
-	converter << (uint16_t) pin.number;
-	response = std::regex_replace(response, std::regex("\\$pin"), converter.str());
-	converter.str("");
-	converter.clear();
-	response = std::regex_replace(response, std::regex("\\$name"), pin.name.c_str());
-	response = std::regex_replace(response, std::regex("\\$pull_up"),
-			pin.pull_up ? "Pull Up" : "Pull Down");
-	response = std::regex_replace(response, std::regex("\\$state"),
-			pin.state ? "High" : "Low");
-	converter << pin.changes;
-	response = std::regex_replace(response, std::regex("\\$changes"), converter.str());
-	converter.str("");
-	converter.clear();
+	const char *values[PLACEHOLDER_COUNT] = { NULL };
+	char number[4];
+	char changes[21];
+	getPinValues(pin, number, changes, values);
 
 	if (error.length() > 0) {
-		response = std::regex_replace(response, std::regex(" hidden>\\$message"), (String(">") + error).c_str());
-		response = std::regex_replace(response, std::regex("\\$confirm"), "hidden");
+		values[PLACEHOLDER_HIDDEN] = "";
+		values[PLACEHOLDER_MESSAGE] = error.c_str();
+		values[PLACEHOLDER_CONFIRM] = "hidden";
 	} else {
-		response = std::regex_replace(response, std::regex("\\$confirm"), "");
+		values[PLACEHOLDER_HIDDEN] = " hidden";
+		values[PLACEHOLDER_CONFIRM] = "";
 	}
 
-	request->send(error.length() > 0 ? 400 : 200, "text/html", response.c_str());
+	sendPage(request, error.length() > 0 ? 400 : 200, delete_template, values);
 }
 
 void WebServerHandler::getPinsJson(AsyncWebServerRequest *request) const {
-	std::ostringstream json;
-	json << '{';
+	if (request->hasParam("since")) {
+		char *end = NULL;
+		const String &since_param = request->getParam("since")->value();
+		uint32_t since = strtoul(since_param.c_str(), &end, 10);
+		uint32_t timeout = LONG_POLL_TIMEOUT;
+		if (request->hasParam("timeout")) {
+			timeout = std::min<uint32_t>(
+					request->getParam("timeout")->value().toInt(),
+					MAX_LONG_POLL_TIMEOUT);
+		}
 
-	bool first = true;
-	for (pin_state &state : gpio->getWatchedPins()) {
-		if (first) {
-			first = false;
+		if (since_param.length() == 0 || *end != 0) {
+			send(request,
+					request->beginResponse(400, "text/plain",
+							"Invalid since parameter."));
+			return;
+		}
+
+		// A sequence number ahead of the current one was received before a reboot.
+		const bool stale = since > gpio->getChangeSequence();
+		if (stale) {
+			since = 0;
+		}
+
+		AsyncWebServerResponse *response = NULL;
+		if (stale || gpio->getChangeSequence() > since || timeout == 0) {
+			response = request->beginResponse(200, "application/json",
+					getChangedPinsJson(*gpio, since).c_str());
 		} else {
-			json << ',' << std::endl;
+			// Use a chunked response, since the length isn't known until something changes.
+			std::shared_ptr<poll_stream> stream = std::make_shared<poll_stream>();
+			stream->since = since;
+			stream->start = millis();
+			stream->timeout = timeout * 1000;
+			stream->offset = 0;
+			const GPIOHandler *handler = gpio;
+			response = request->beginChunkedResponse("application/json",
+					[stream, handler](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+						if (stream->body.empty()) {
+							if (handler->getChangeSequence() <= stream->since
+									&& millis() - stream->start < stream->timeout) {
+								return RESPONSE_TRY_AGAIN;
+							}
+							stream->body = getChangedPinsJson(*handler, stream->since);
+						}
+
+						const size_t length = std::min(stream->body.length() - stream->offset, max_len);
+						memcpy(buffer, stream->body.c_str() + stream->offset, length);
+						stream->offset += length;
+						return length;
+					});
 		}
+		response->addHeader("Cache-Control", "no-cache");
+		send(request, response);
+		return;
+	}
 
-		json << '"' << (uint16_t) state.number << "\": ";
-		json << "{\"pin\": " << (uint16_t) state.number;
-		json << ", \"name\": \"" << state.name.c_str();
-		json << "\", \"pull_up\": " << (state.pull_up ? "true" : "false");
-		json << ", \"state\": \"" << (state.state ? "High" : "Low");
-		json << "\", \"changes\": " << state.changes;
-		json << '}';
+	AsyncWebHeader *accept = request->getHeader("Accept");
+	if (accept != NULL && accept->value().indexOf("application/cbor") >= 0) {
+		getPinsCbor(request);
+		return;
 	}
-	json << '}' << std::endl;
 
+	char etag[STATE_ETAG_SIZE];
+	getStateETag(etag);
+	if (sendNotModified(request, etag)) {
+		return;
+	}
+
+	std::shared_ptr<std::vector<pin_state>> states = std::make_shared<
+			std::vector<pin_state>>(gpio->getWatchedPins());
+	const size_t pins = states->size();
+
+	// One line per pin, and one for the closing bracket.
+	AsyncWebServerResponse *response = beginLineResponse(request,
+			"application/json", pins + 1,
+			[states, pins](const size_t line, char *buffer, const size_t size) -> size_t {
+				JSONWriter json(buffer, size);
+				if (line == 0) {
+					json.beginObject();
+				} else {
+					json.resume(true).lineBreak();
+				}
+
+				if (line == pins) {
+					json.endObject().raw("\n");
+				} else {
+					const pin_state &state = (*states)[line];
+					json.key((uint64_t) state.number);
+					writePin(json, state);
+				}
+				return json.length();
+			});
+	response->addHeader("ETag", etag);
+	response->addHeader("Cache-Control", "no-cache");
+	response->addHeader("Vary", "Accept");
+	send(request, response);
+}
+
+std::string WebServerHandler::getChangedPinsJson(const GPIOHandler &gpio,
+		const uint32_t since) {
+	// Get the sequence first, so a change while copying the pins can't be missed.
+	const uint32_t sequence = gpio.getChangeSequence();
+	const std::vector<pin_state> pins = gpio.getWatchedPins();
+
+	char line[LINE_BUFFER_SIZE];
+	JSONWriter header(line, LINE_BUFFER_SIZE);
+	header.beginObject().key("sequence").value(sequence).key("config").value(
+			gpio.getConfigVersion()).key("pins").beginObject();
+	std::string json(line, header.length());
+	bool first = true;
+	for (const pin_state &state : pins) {
+		if (state.sequence <= since) {
+			continue;
+		}
+
+		JSONWriter pin(line, LINE_BUFFER_SIZE);
+		pin.resume(!first).lineBreak().key((uint64_t) state.number);
+		writePin(pin, state);
+		json.append(line, pin.length());
+		first = false;
+	}
+	json += "}}\n";
+	return json;
+}
+
+void WebServerHandler::getPinsCbor(AsyncWebServerRequest *request) const {
+	const uint32_t config_version = gpio->getConfigVersion();
+	bool compact = false;
+	if (request->hasParam("config")) {
+		char *end = NULL;
+		const String &config_param = request->getParam("config")->value();
+		compact = config_param.length() > 0
+				&& strtoul(config_param.c_str(), &end, 10) == config_version
+				&& *end == 0;
+	}
+
+	char etag[STATE_ETAG_SIZE];
+	getStateETag(etag, compact ? "-cbor-compact" : "-cbor");
+	if (sendNotModified(request, etag)) {
+		return;
+	}
+
+	// Get the sequence first, so a change while copying the pins can't be missed.
+	const uint32_t sequence = gpio->getChangeSequence();
+	const std::vector<pin_state> pins = gpio->getWatchedPins();
+	// Send the full pins if the config changed while copying them.
+	compact = compact && gpio->getConfigVersion() == config_version;
+
+	AsyncWebServerResponse *response = beginStringResponse(request,
+			"application/cbor",
+			std::make_shared<const std::string>(
+					getPinsCborContent(pins, sequence, config_version,
+							compact)));
+	response->addHeader("ETag", etag);
+	response->addHeader("Cache-Control", "no-cache");
+	response->addHeader("Vary", "Accept");
+	send(request, response);
+}
+
+std::string WebServerHandler::getPinsCborContent(
+		const std::vector<pin_state> &pins, const uint32_t sequence,
+		const uint32_t config_version, const bool compact) {
+	// The top level map with its 32 bit values, and the head of the pins array.
+	size_t size = 18;
+	for (const pin_state &pin : pins) {
+		size += CBOR_PIN_SIZE + (compact ? 0 : pin.name.length());
+	}
+
+	std::string content(size, 0);
+	CBORWriter cbor((uint8_t*) &content[0], size);
+	cbor.beginMap(3).value((uint32_t) CBOR_KEY_SEQUENCE).value(sequence);
+	cbor.value((uint32_t) CBOR_KEY_CONFIG).value(config_version);
+	cbor.value((uint32_t) CBOR_KEY_PINS).beginArray(pins.size());
+	for (const pin_state &pin : pins) {
+		cbor.beginMap(compact ? 3 : 5);
+		cbor.value((uint32_t) CBOR_PIN_NUMBER).value((uint32_t) pin.number);
+		cbor.value((uint32_t) CBOR_PIN_STATE).value((bool) pin.state);
+		cbor.value((uint32_t) CBOR_PIN_CHANGES).value((uint64_t) pin.changes);
+		if (!compact) {
+			cbor.value((uint32_t) CBOR_PIN_PULL_UP).value((bool) pin.pull_up);
+			cbor.value((uint32_t) CBOR_PIN_NAME).value(pin.name.c_str());
+		}
+	}
+	content.resize(cbor.length());
+	return content;
+}
+
+void WebServerHandler::writePin(JSONWriter &json, const pin_state &pin) {
+	json.beginObject().key("pin").value((uint32_t) pin.number).key("name").value(
+			pin.name.c_str()).key("pull_up").value(pin.pull_up).key("state").value(
+			pin.state ? "High" : "Low").key("changes").value(
+			(uint64_t) pin.changes).endObject();
+}
+
+void WebServerHandler::handleApiPins(AsyncWebServerRequest *request) const {
+	if (request->method() == HTTP_GET) {
+		const std::vector<pin_state> pins = gpio->getWatchedPins();
+		char line[LINE_BUFFER_SIZE];
+		std::shared_ptr<std::string> json = std::make_shared<std::string>("[");
+		for (size_t i = 0; i < pins.size(); i++) {
+			JSONWriter pin(line, LINE_BUFFER_SIZE);
+			pin.resume(i > 0).lineBreak();
+			writePin(pin, pins[i]);
+			json->append(line, pin.length());
+		}
+		*json += "]\n";
+
+		AsyncWebServerResponse *response = beginStringResponse(request,
+				"application/json", json);
+		response->addHeader("Cache-Control", "no-cache");
+		send(request, response);
+		return;
+	}
+
+	if (request->contentLength() > MAX_API_BODY_SIZE) {
+		sendApiError(request, 413, "The request body is too large.");
+		return;
+	} else if (request->_tempObject == NULL) {
+		sendApiError(request, 400, "The request body is missing.");
+		return;
+	}
+
+	JSONReader json((const char*) request->_tempObject,
+			request->contentLength());
+	std::vector<pin_config> configs;
+	std::vector<gpio_err_t> results;
+	if (request->method() != HTTP_DELETE) {
+		String error;
+		if (!parsePinConfigs(json, configs, error)) {
+			sendApiError(request, 400, error.c_str());
+			return;
+		}
+
+		const bool applied = gpio->configurePins(configs, &results,
+				request->method() == HTTP_PUT) == GPIO_OK;
+		sendApiResults(request, configs, results, applied);
+		return;
+	}
+
+	// DELETE expects an array of pin numbers.
+	bool valid = json.beginArray();
+	while (valid && json.hasNext()) {
+		uint64_t number = 0;
+		valid = json.readUnsigned(number) && number <= UINT8_MAX;
+		if (valid) {
+			configs.push_back( { (uint8_t) number, "", false });
+		}
+	}
+	if (!valid || !json.finished()) {
+		sendApiError(request, 400,
+				"The request body isn't a json array of pin numbers.");
+		return;
+	}
+
+	bool applied = true;
+	std::set<uint8_t> removed;
+	for (const pin_config &config : configs) {
+		gpio_err_t err = GPIOHandler::isValidPin(config.number);
+		if (err == GPIO_OK && removed.count(config.number) > 0) {
+			err = GPIO_PIN_DUPLICATE;
+		} else if (err == GPIO_OK && !gpio->isWatched(config.number)) {
+			err = GPIO_NOT_WATCHED;
+		}
+
+		if (err == GPIO_OK) {
+			removed.insert(config.number);
+		}
+		results.push_back(err);
+		applied = applied && err == GPIO_OK;
+	}
+
+	if (applied) {
+		// Apply the remaining pins as a single transaction, so all pins are removed with a single storage write.
+		std::vector<pin_config> remaining;
+		for (const pin_state &pin : gpio->getWatchedPins()) {
+			if (removed.count(pin.number) == 0) {
+				remaining.push_back( { pin.number, pin.name, pin.pull_up });
+			}
+		}
+		applied = gpio->configurePins(remaining) == GPIO_OK;
+	}
+	sendApiResults(request, configs, results, applied);
+}
+
+void WebServerHandler::receiveApiBody(AsyncWebServerRequest *request,
+		uint8_t *data, size_t len, size_t index, size_t total) {
+	if (total > MAX_API_BODY_SIZE) {
+		return;
+	}
+
+	// The temp object is freed by the request destructor.
+	if (index == 0 && request->_tempObject == NULL) {
+		request->_tempObject = malloc(total);
+	}
+
+	if (request->_tempObject != NULL && index + len <= total) {
+		memcpy((uint8_t*) request->_tempObject + index, data, len);
+	}
+}
+
+bool WebServerHandler::parsePinConfigs(JSONReader &json,
+		std::vector<pin_config> &configs, String &error) const {
+	if (!json.beginArray()) {
+		error = "The request body isn't a json array.";
+		return false;
+	}
+
+	const std::vector<pin_state> watched = gpio->getWatchedPins();
+	char key[16];
+	char name[64];
+	while (json.hasNext()) {
+		if (!json.beginObject()) {
+			error = "Pin " + String(configs.size()) + " isn't a json object.";
+			return false;
+		}
+
+		bool has_number = false;
+		bool has_name = false;
+		bool has_pull_up = false;
+		pin_config config = { 0, "", false };
+		while (json.hasNext()) {
+			if (!json.readKey(key, sizeof(key))) {
+				break;
+			}
+
+			if (strcmp(key, "pin") == 0) {
+				uint64_t number = 0;
+				if (!json.readUnsigned(number) || number > UINT8_MAX) {
+					error = "Pin " + String(configs.size())
+							+ " has an invalid pin number.";
+					return false;
+				}
+				config.number = number;
+				has_number = true;
+			} else if (strcmp(key, "name") == 0) {
+				// Names that don't fit are cut off, which still makes them invalid.
+				if (!json.readString(name, sizeof(name))) {
+					error = "Pin " + String(configs.size())
+							+ " has an invalid name.";
+					return false;
+				}
+				config.name = name;
+				has_name = true;
+			} else if (strcmp(key, "pull_up") == 0) {
+				if (!json.readBool(config.pull_up)) {
+					error = "Pin " + String(configs.size())
+							+ " has an invalid pull_up value.";
+					return false;
+				}
+				has_pull_up = true;
+			} else {
+				json.skipValue();
+			}
+		}
+
+		if (json.failed()) {
+			break;
+		} else if (!has_number) {
+			error = "Pin " + String(configs.size()) + " has no pin number.";
+			return false;
+		}
+
+		for (const pin_state &pin : watched) {
+			if (pin.number == config.number) {
+				if (!has_name) {
+					config.name = pin.name;
+				}
+				if (!has_pull_up) {
+					config.pull_up = pin.pull_up;
+				}
+			}
+		}
+		configs.push_back(config);
+	}
+
+	if (!json.finished()) {
+		error = "The request body isn't valid json.";
+		return false;
+	}
+	return true;
+}
+
+void WebServerHandler::sendApiResults(AsyncWebServerRequest *request,
+		const std::vector<pin_config> &configs,
+		const std::vector<gpio_err_t> &results,
+		const bool applied) const {
+	char line[LINE_BUFFER_SIZE];
+	JSONWriter header(line, LINE_BUFFER_SIZE);
+	header.beginObject().key("applied").value(applied).key("config").value(
+			gpio->getConfigVersion()).key("results").beginArray();
+	std::shared_ptr<std::string> json = std::make_shared<std::string>(line,
+			header.length());
+	for (size_t i = 0; i < configs.size(); i++) {
+		const pin_config &config = configs[i];
+		const gpio_err_t err = i < results.size() ? results[i] : GPIO_OK;
+
+		JSONWriter pin(line, LINE_BUFFER_SIZE);
+		pin.resume(i > 0).lineBreak().beginObject().key("pin").value(
+				(uint32_t) config.number).key("result").value(
+				GPIO_ERROR_NAMES[err]);
+		if (err != GPIO_OK) {
+			pin.key("message").value(
+					("Couldn't configure pin " + String(config.number)
+							+ " because " + getErrorReason(err, config.name)).c_str());
+		}
+		pin.endObject();
+		json->append(line, pin.length());
+	}
+	*json += "]}\n";
+
+	AsyncWebServerResponse *response = beginStringResponse(request,
+			"application/json", json);
+	response->setCode(applied ? 200 : 400);
+	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
+}
+
+void WebServerHandler::sendApiError(AsyncWebServerRequest *request,
+		const int code, const char *error) const {
+	char buffer[LINE_BUFFER_SIZE];
+	JSONWriter json(buffer, LINE_BUFFER_SIZE);
+	json.beginObject().key("applied").value(false).key("error").value(error).endObject().raw(
+			"\n");
+	AsyncWebServerResponse *response = request->beginResponse(code,
+			"application/json", buffer);
+	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
+}
+
+void WebServerHandler::getEvents(AsyncWebServerRequest *request) {
+	send(request, events.beginResponse(request, gpio->getWatchedPins()));
+}
+
+void WebServerHandler::getApiWait(AsyncWebServerRequest *request) {
+	uint64_t pins = UINT64_MAX;
+	if (request->hasParam("pins")
+			&& !PinSocket::parsePins(request->getParam("pins")->value().c_str(),
+					pins)) {
+		send(request,
+				request->beginResponse(400, "text/plain",
+						"Invalid pins parameter."));
+		return;
+	}
+
+	uint32_t timeout = LONG_POLL_TIMEOUT;
+	if (request->hasParam("timeout")) {
+		timeout = std::min<uint32_t>(
+				request->getParam("timeout")->value().toInt(),
+				MAX_LONG_POLL_TIMEOUT);
+	}
+
+	AsyncWebServerResponse *response = waits.beginResponse(request, *gpio,
+			pins, timeout * 1000);
+	if (response == NULL) {
+		sendUnavailable(request, ADMISSION_BUSY);
+		return;
+	}
+	send(request, response);
+}
+
+void WebServerHandler::getApiStats(AsyncWebServerRequest *request) const {
+	char *end = NULL;
+	long pin = -1;
+	if (request->hasParam("pin")) {
+		const char *value = request->getParam("pin")->value().c_str();
+		pin = strtol(value, &end, 10);
+		if (end == value || *end != 0) {
+			pin = -1;
+		}
+	}
+
+	if (pin < 0 || pin > UINT8_MAX) {
+		send(request,
+				request->beginResponse(400, "text/plain",
+						"Invalid pin parameter."));
+		return;
+	}
+
+	uint32_t window = DEFAULT_STATS_WINDOW;
+	if (request->hasParam("window")) {
+		window = std::min<uint32_t>(
+				std::max<long>(request->getParam("window")->value().toInt(), 0),
+				PinStats::MAX_WINDOW / 1000);
+	}
+
+	pin_stats stats;
+	if (gpio->getStats(pin, window * 1000, stats) != GPIO_OK) {
+		send(request,
+				request->beginResponse(404, "text/plain",
+						"Pin " + String(pin) + " isn't watched."));
+		return;
+	}
+
+	char buffer[LINE_BUFFER_SIZE];
+	JSONWriter json(buffer, LINE_BUFFER_SIZE);
+	json.beginObject().key("pin").value((uint32_t) pin).key("start").value(
+			stats.start).key("duration").value(stats.duration).key("rising").value(
+			stats.rising).key("falling").value(stats.falling).key("high_time").value(
+			stats.high_time).key("duty_cycle").value(
+			stats.duration == 0 ? 0.0 : (double) stats.high_time / stats.duration,
+			4).endObject().raw("\n");
 	AsyncWebServerResponse *response = request->beginResponse(200,
-			"application/json", json.str().c_str());
+			"application/json", buffer);
 	response->addHeader("Cache-Control", "no-cache");
-	request->send(response);
+	send(request, response);
+}
+
+bool WebServerHandler::parseUnsignedParam(AsyncWebServerRequest *request,
+		const char *name, uint32_t &value, const uint32_t max) {
+	if (!request->hasParam(name)) {
+		return true;
+	}
+
+	const char *param = request->getParam(name)->value().c_str();
+	if (!isdigit(param[0])) {
+		return false;
+	}
+
+	char *end = NULL;
+	const unsigned long long parsed = strtoull(param, &end, 10);
+	if (*end != 0 || parsed > max) {
+		return false;
+	}
+
+	value = parsed;
+	return true;
+}
+
+bool WebServerHandler::parseHistoryRange(AsyncWebServerRequest *request,
+		uint32_t &from, uint32_t &to, uint8_t &pin) const {
+	const char *error = NULL;
+	to = time(NULL);
+	uint32_t pin_param = UINT8_MAX;
+	if (!parseUnsignedParam(request, "to", to, UINT32_MAX)) {
+		error = "Invalid to parameter.";
+	} else {
+		from = to > 86400 ? to - 86400 : 0;
+		if (!parseUnsignedParam(request, "from", from, UINT32_MAX)) {
+			error = "Invalid from parameter.";
+		} else if (from > to) {
+			error = "The from parameter is after the to parameter.";
+		} else if (!parseUnsignedParam(request, "pin", pin_param, UINT8_MAX - 1)) {
+			error = "Invalid pin parameter.";
+		}
+	}
+
+	if (error != NULL) {
+		send(request, request->beginResponse(400, "text/plain", error));
+		return false;
+	}
+
+	pin = pin_param;
+	return true;
+}
+
+void WebServerHandler::getHistoryCsv(AsyncWebServerRequest *request) const {
+	StorageHandler *storage = gpio->getStorageHandler();
+	if (storage == NULL || storage->getHistory().getPath() == NULL) {
+		send(request,
+				request->beginResponse(404, "text/plain",
+						"Pin history is disabled."));
+		return;
+	}
+
+	uint32_t from;
+	uint32_t to;
+	uint8_t pin;
+	if (!parseHistoryRange(request, from, to, pin)) {
+		return;
+	}
+
+	std::shared_ptr<PinHistory::Cursor> cursor = std::make_shared<
+			PinHistory::Cursor>(storage->getHistory(), from, to, pin);
+	std::shared_ptr<std::string> line = std::make_shared<std::string>(
+			"Time,Pin,State,Changes,High Time\n");
+
+	// Only ever keeps a single line in memory, so the size of the range doesn't matter.
+	AsyncWebServerResponse *response = request->beginChunkedResponse("text/csv",
+			[cursor, line](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				size_t written = 0;
+				history_record record;
+				char record_line[64];
+				while (written < max_len) {
+					if (line->empty()) {
+						if (!cursor->next(record)) {
+							break;
+						}
+
+						snprintf(record_line, sizeof(record_line), "%u,%hu,%hu,%u,%u\n",
+								record.time, (uint16_t) record.pin, (uint16_t) record.state,
+								record.changes, record.high_time);
+						line->assign(record_line);
+					}
+
+					const size_t length = std::min(line->length(), max_len - written);
+					memcpy(buffer + written, line->c_str(), length);
+					line->erase(0, length);
+					written += length;
+				}
+				return written;
+			});
+	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
+}
+
+void WebServerHandler::getApiHistory(AsyncWebServerRequest *request) const {
+	StorageHandler *storage = gpio->getStorageHandler();
+	if (storage == NULL || storage->getHistory().getPath() == NULL) {
+		send(request,
+				request->beginResponse(404, "text/plain",
+						"Pin history is disabled."));
+		return;
+	}
+
+	export_format format = EXPORT_CSV;
+	if (request->hasParam("format")) {
+		const String &value = request->getParam("format")->value();
+		if (value == "ndjson") {
+			format = EXPORT_NDJSON;
+		} else if (value != "csv") {
+			send(request,
+					request->beginResponse(400, "text/plain",
+							"Invalid format parameter."));
+			return;
+		}
+	}
+
+	uint32_t from;
+	uint32_t to;
+	uint8_t pin;
+	if (!parseHistoryRange(request, from, to, pin)) {
+		return;
+	}
+
+	uint32_t points = 0;
+	if (!parseUnsignedParam(request, "points", points, UINT32_MAX)) {
+		send(request,
+				request->beginResponse(400, "text/plain",
+						"Invalid points parameter."));
+		return;
+	}
+
+	std::shared_ptr<HistoryExport> history = std::make_shared<HistoryExport>(
+			storage->getHistory(), from, to, pin, points, format);
+
+	// Only ever keeps a single point per pin in memory, so the size of the range doesn't matter.
+	AsyncWebServerResponse *response = request->beginChunkedResponse(
+			HistoryExport::getContentType(format),
+			[history](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+				return history->fill(buffer, max_len);
+			});
+	response->addHeader("Cache-Control", "no-cache");
+	send(request, response);
 }
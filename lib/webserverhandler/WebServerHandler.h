@@ -9,22 +9,109 @@
 #define LIB_WEBSERVERHANDLER_H_
 
 #include "GPIOHandler.h"
+#include "HTMLTemplate.h"
+#include "EventStream.h"
+#include "PinSocket.h"
+#include "WaitRegistry.h"
+#include "HistoryExport.h"
+#include "MetricsCache.h"
+#include "JSONWriter.h"
+#include "JSONReader.h"
+#include "CBORWriter.h"
+#include "RequestStats.h"
+#include "SystemMetrics.h"
+#include "AdmissionControl.h"
 #include <ESPAsyncWebServer.h>
 
 #define HTML_BINARY "_binary_lib_webserverhandler_html_"
 
-extern const char INDEX_HTML[] asm(HTML_BINARY "index_html_start");
-extern const char INDEX_STATE_HTML[] asm(HTML_BINARY "index_state_html_start");
 extern const char SETTINGS_HTML[] asm(HTML_BINARY "settings_html_start");
-extern const char SETTINGS_PIN_HTML[] asm(HTML_BINARY "settings_pin_html_start");
 extern const char DELETE_HTML[] asm(HTML_BINARY "delete_html_start");
 extern const char NOT_FOUND_HTML[] asm(HTML_BINARY "not_found_html_start");
-extern const char MAIN_CSS[] asm(HTML_BINARY "main_css_start");
-extern const char INDEX_JS[] asm(HTML_BINARY "index_js_start");
-extern const char SETTINGS_JS[] asm(HTML_BINARY "settings_js_start");
+
+#define GZIP_BINARY "_binary_lib_webserverhandler_html_gzip_"
+
+extern const uint8_t MAIN_CSS_GZ_START[] asm(GZIP_BINARY "main_css_gz_start");
+extern const uint8_t MAIN_CSS_GZ_END[] asm(GZIP_BINARY "main_css_gz_end");
+extern const uint8_t INDEX_JS_GZ_START[] asm(GZIP_BINARY "index_js_gz_start");
+extern const uint8_t INDEX_JS_GZ_END[] asm(GZIP_BINARY "index_js_gz_end");
+extern const uint8_t SETTINGS_JS_GZ_START[] asm(GZIP_BINARY "settings_js_gz_start");
+extern const uint8_t SETTINGS_JS_GZ_END[] asm(GZIP_BINARY "settings_js_gz_end");
+extern const uint8_t INDEX_HTML_GZ_START[] asm(GZIP_BINARY "index_html_gz_start");
+extern const uint8_t INDEX_HTML_GZ_END[] asm(GZIP_BINARY "index_html_gz_end");
+extern const uint8_t SETTINGS_HTML_GZ_START[] asm(GZIP_BINARY "settings_html_gz_start");
+extern const uint8_t SETTINGS_HTML_GZ_END[] asm(GZIP_BINARY "settings_html_gz_end");
+
+/**
+ * The placeholders used in the html page templates.
+ * The value of a placeholder is the index of its value when rendering a template.
+ */
+enum template_placeholder {
+	PLACEHOLDER_PIN,
+	PLACEHOLDER_NAME,
+	PLACEHOLDER_PULL_UP,
+	PLACEHOLDER_STATE,
+	PLACEHOLDER_CHANGES,
+	PLACEHOLDER_PULL_UP_CHECKED,
+	PLACEHOLDER_PULL_DOWN_CHECKED,
+	PLACEHOLDER_MESSAGE_TYPE,
+	PLACEHOLDER_MESSAGE,
+	PLACEHOLDER_HIDDEN,
+	PLACEHOLDER_CONFIRM,
+	PLACEHOLDER_VERSION,
+	PLACEHOLDER_COUNT
+};
+
+/**
+ * The integer keys of the top level map of pins.cbor.
+ */
+enum pins_cbor_key {
+	CBOR_KEY_SEQUENCE,
+	CBOR_KEY_CONFIG,
+	CBOR_KEY_PINS
+};
+
+/**
+ * The integer keys of the map representing a single pin in pins.cbor.
+ * The name and pull up keys are omitted if the client already knows the current configuration.
+ */
+enum pin_cbor_key {
+	CBOR_PIN_NUMBER,
+	CBOR_PIN_STATE,
+	CBOR_PIN_CHANGES,
+	CBOR_PIN_PULL_UP,
+	CBOR_PIN_NAME
+};
 
 class WebServerHandler {
 public:
+	/**
+	 * A function appending additional prometheus metrics to the given string.
+	 */
+	typedef std::function<void(std::string &metrics)> metrics_appender;
+
+	/**
+	 * The names of the html template placeholders, indexed by their template_placeholder value.
+	 */
+	static const char *const PLACEHOLDER_NAMES[PLACEHOLDER_COUNT];
+
+	/**
+	 * The result names used by the pin api, indexed by their gpio_err_t value.
+	 */
+	static const char *const GPIO_ERROR_NAMES[];
+
+	/**
+	 * The Cache-Control header value for the static assets.
+	 * They can be cached forever, since the pages reference them with their version.
+	 */
+	static const char STATIC_CACHE_CONTROL[];
+
+	/**
+	 * The Cache-Control header value for the static html pages.
+	 * Their urls don't change on updates, so they have to be revalidated using their ETag.
+	 */
+	static const char PAGE_CACHE_CONTROL[];
+
 	/**
 	 * The default constructor for creating a new WebServerHandler.
 	 *
@@ -70,6 +157,62 @@ public:
 	 * @return	The current GPIOHandler.
 	 */
 	GPIOHandler& getGPIOHandler() const;
+
+	/**
+	 * Sends a pin change to the event stream and web socket clients, and the waiting requests.
+	 * Web socket clients receive all changes since the last call to handle as a single frame.
+	 *
+	 * @param change	The pin change to send.
+	 */
+	void publish(const pin_change &change);
+
+	/**
+	 * Notifies the event stream clients and waiting requests that the pin configuration changed.
+	 */
+	void publishConfigChange();
+
+	/**
+	 * Sends the web socket frames of the changes published since the last call, and drops event stream clients that are too slow.
+	 * Has to be called regularly from the main loop.
+	 */
+	void handle();
+
+	/**
+	 * Adds a function appending additional metrics to the prometheus metrics endpoint.
+	 * Appenders are called for every request, after the built-in metrics.
+	 *
+	 * @param appender	The function appending to the metrics.
+	 */
+	void addMetricsAppender(const metrics_appender appender);
+
+	/**
+	 * Gets the event stream sending pin changes to the clients of the /events endpoint.
+	 *
+	 * @return	The event stream of this web server.
+	 */
+	EventStream& getEventStream();
+
+	/**
+	 * Gets the registry of the requests to /api/wait that are waiting for a pin change.
+	 *
+	 * @return	The wait registry of this web server.
+	 */
+	WaitRegistry& getWaitRegistry();
+
+	/**
+	 * Gets the stats of the requests handled by this web server.
+	 *
+	 * @return	The request stats of this web server.
+	 */
+	const RequestStats& getRequestStats() const;
+
+	/**
+	 * Gets the admission control deciding which requests are answered with 503 Service Unavailable.
+	 * Its limits can be changed to fit the available memory.
+	 *
+	 * @return	The admission control of this web server.
+	 */
+	AdmissionControl& getAdmissionControl();
 private:
 	/**
 	 * The port on which this web server listens to http requests.
@@ -87,35 +230,475 @@ private:
 	 */
 	GPIOHandler *gpio;
 
+	/**
+	 * The Server-Sent Events stream for the /events endpoint.
+	 */
+	EventStream events;
+
+	/**
+	 * The web socket endpoint sending pin changes to the clients subscribed to them.
+	 */
+	PinSocket pin_socket;
+
+	/**
+	 * The long-poll requests of the /api/wait endpoint waiting for a pin change.
+	 */
+	WaitRegistry waits;
+
+	/**
+	 * The cache for the pin metrics of the prometheus metrics endpoint.
+	 */
+	MetricsCache metrics_cache;
+
+	/**
+	 * The functions appending additional metrics to the prometheus metrics endpoint.
+	 */
+	std::vector<metrics_appender> metrics_appenders;
+
+	/**
+	 * The number of requests, handler durations, response sizes, and heap usage per endpoint.
+	 */
+	RequestStats request_stats;
+
+	/**
+	 * The system health and resource usage metrics.
+	 */
+	SystemMetrics system_metrics;
+
+	/**
+	 * The admission control rejecting expensive requests while the heap is low, or too many responses are in flight.
+	 */
+	AdmissionControl admission;
+
+	/**
+	 * The status code of the response sent by the current request handler, or 0 if none was sent yet.
+	 * Only one handler runs at a time, since they all run in the async tcp task.
+	 */
+	mutable uint16_t response_code;
+
+	/**
+	 * The content length of the response sent by the current request handler.
+	 */
+	mutable size_t response_length;
+
+	/**
+	 * A gzip compressed static file embedded in the firmware.
+	 */
+	struct static_asset {
+		/**
+		 * The content type of the uncompressed file.
+		 */
+		const char *content_type;
+
+		/**
+		 * The Cache-Control header to send with the file.
+		 */
+		const char *cache_control;
+
+		/**
+		 * The start of the compressed file content.
+		 */
+		const uint8_t *start;
+
+		/**
+		 * The end of the compressed file content.
+		 */
+		const uint8_t *end;
+
+		/**
+		 * The quoted hex CRC32 of the compressed content, used as its ETag.
+		 */
+		char etag[11];
+	};
+
+	/**
+	 * The gzip compressed main.css file.
+	 */
+	static_asset main_css;
+
+	/**
+	 * The gzip compressed index.js file.
+	 */
+	static_asset index_js;
+
+	/**
+	 * The gzip compressed settings.js file.
+	 */
+	static_asset settings_js;
+
+	/**
+	 * The gzip compressed index.html page, without any pins.
+	 * The pins are rendered by index.js.
+	 */
+	static_asset index_html;
+
+	/**
+	 * The gzip compressed settings.html page, without any pins or message.
+	 * The pins are rendered by settings.js.
+	 */
+	static_asset settings_html;
+
+	/**
+	 * The hex CRC32 of all static assets.
+	 * Appended to the asset urls in the html pages, so browsers load the new version after an update.
+	 */
+	char asset_version[9];
+
+	/**
+	 * A random number generated on startup.
+	 * Part of the pin state ETags, since the change sequence number restarts on reboot.
+	 */
+	uint32_t boot_id;
+
+	/**
+	 * The parsed settings.html page template.
+	 * Only used to show the result of a form submission.
+	 */
+	HTMLTemplate settings_template;
+
+	/**
+	 * The parsed delete.html page template.
+	 */
+	HTMLTemplate delete_template;
+
+	/**
+	 * The parsed not_found.html page template.
+	 */
+	HTMLTemplate not_found_template;
+
+	/**
+	 * The state of a html page that is being sent to a client.
+	 */
+	struct page_stream {
+		/**
+		 * The page template to render.
+		 */
+		const HTMLTemplate *page;
+
+		/**
+		 * Copies of the page placeholder values.
+		 */
+		std::string page_values[PLACEHOLDER_COUNT];
+
+		/**
+		 * The page placeholder values, pointing to page_values, or NULL.
+		 */
+		const char *values[PLACEHOLDER_COUNT];
+
+		/**
+		 * The current position in the page template.
+		 */
+		HTMLTemplate::position page_pos;
+	};
+
+	/**
+	 * The max length of a single line of a response generated using beginLineResponse.
+	 * Including the terminating null character.
+	 */
+	static const size_t LINE_BUFFER_SIZE = 160;
+
+	/**
+	 * A function writing a single line of a response to the given buffer.
+	 * Has to return the same line every time it is called with the same index.
+	 *
+	 * @param line		The index of the line to generate.
+	 * @param buffer	The buffer to write the line to.
+	 * @param size		The size of the buffer.
+	 * @return	The length of the line, like snprintf.
+	 */
+	typedef std::function<size_t(const size_t line, char *buffer, const size_t size)> line_generator;
+
+	/**
+	 * The size of a weak pin state ETag, including the terminating null char.
+	 */
+	static const size_t STATE_ETAG_SIZE = 48;
+
+	/**
+	 * The max number of bytes a single pin can take up in pins.cbor, excluding its name.
+	 */
+	static const size_t CBOR_PIN_SIZE = 24;
+
+	/**
+	 * The max size of a request body sent to the pin api, in bytes.
+	 */
+	static const size_t MAX_API_BODY_SIZE = 4096;
+
+	/**
+	 * The default time in seconds a pins.json long-poll request waits for a change.
+	 */
+	static const uint32_t LONG_POLL_TIMEOUT = 20;
+
+	/**
+	 * The max time in seconds a client can make a pins.json long-poll request wait for a change.
+	 */
+	static const uint32_t MAX_LONG_POLL_TIMEOUT = 60;
+
+	/**
+	 * The default window in seconds of an /api/stats request.
+	 */
+	static const uint32_t DEFAULT_STATS_WINDOW = 60;
+
+	/**
+	 * The state of a pins.json long-poll response.
+	 */
+	struct poll_stream {
+		/**
+		 * The change sequence number after which changes should be sent.
+		 */
+		uint32_t since;
+
+		/**
+		 * The time at which the request was received, in milliseconds since boot.
+		 */
+		uint32_t start;
+
+		/**
+		 * The time in milliseconds after which to respond even if nothing changed.
+		 */
+		uint32_t timeout;
+
+		/**
+		 * The json to send. Empty until something changed, or the timeout expired.
+		 */
+		std::string body;
+
+		/**
+		 * The number of bytes of the body that were already sent.
+		 */
+		size_t offset;
+	};
+
+	/**
+	 * The state of a line by line generated response.
+	 */
+	struct line_stream {
+		/**
+		 * The index of the next line to generate.
+		 */
+		size_t line;
+
+		/**
+		 * The number of bytes of the current line that were already sent.
+		 */
+		size_t offset;
+
+		/**
+		 * The length of the current line.
+		 */
+		size_t length;
+
+		/**
+		 * The buffer containing the current line.
+		 */
+		char buffer[LINE_BUFFER_SIZE];
+	};
+
+	/**
+	 * Sends a page template.
+	 * The page is rendered directly into the send buffer while it is being sent,
+	 * so the full page is never kept in memory.
+	 *
+	 * @param request		The request to respond to.
+	 * @param code			The http status code to respond with.
+	 * @param page			The page template to render.
+	 * @param page_values	The placeholder values for the page template.
+	 */
+	void sendPage(AsyncWebServerRequest *request, const int code,
+			const HTMLTemplate &page, const char *const page_values[]) const;
+
+	/**
+	 * Renders the next part of a page that is being sent.
+	 *
+	 * @param stream	The state of the page to render.
+	 * @param buffer	The buffer to write the page to.
+	 * @param max_len	The size of the buffer.
+	 * @return	The number of bytes written to the buffer.
+	 */
+	static size_t fillPage(page_stream &stream, char *buffer,
+			const size_t max_len);
+
+	/**
+	 * Creates a response that is generated line by line while being sent.
+	 * Generates each line once in advance, to calculate the content length.
+	 * Only a single line is kept in memory at a time.
+	 *
+	 * @param request		The request to create the response for.
+	 * @param content_type	The content type of the response.
+	 * @param lines			The number of lines of the response.
+	 * @param generator		The function generating the lines.
+	 * @return	The created response.
+	 */
+	static AsyncWebServerResponse* beginLineResponse(
+			AsyncWebServerRequest *request, const char *content_type,
+			const size_t lines, const line_generator generator);
+
+	/**
+	 * Writes a weak ETag for the current pin states to the given buffer.
+	 * The ETag is derived from the GPIOHandler change sequence number and config version,
+	 * so it changes whenever a pin changes its state or configuration.
+	 *
+	 * @param etag		The buffer to write the ETag to.
+	 * @param variant	A suffix for representations of the pin states other than the default one.
+	 */
+	void getStateETag(char etag[STATE_ETAG_SIZE],
+			const char *variant = "") const;
+
+	/**
+	 * Checks whether the If-None-Match header of the given request matches the given weak ETag.
+	 * If it does, responds with 304 Not Modified.
+	 *
+	 * @param request	The request to check.
+	 * @param etag		The current weak ETag of the requested resource.
+	 * @return	True if the request was answered with 304 Not Modified.
+	 */
+	bool sendNotModified(AsyncWebServerRequest *request,
+			const char *etag) const;
+
+	/**
+	 * Wraps the given request handler, to record its requests in the request stats.
+	 * Records the handler duration, the status code and content length of its response,
+	 * and how much heap memory it used.
+	 * Requests rejected by the admission control are answered with 503 Service Unavailable instead of calling the handler.
+	 *
+	 * @param endpoint	The endpoint to record the requests for.
+	 * @param handler	The request handler to wrap.
+	 * @return	The wrapped request handler.
+	 */
+	ArRequestHandlerFunction instrument(const http_endpoint endpoint,
+			const ArRequestHandlerFunction handler);
+
+	/**
+	 * Responds with 503 Service Unavailable and a Retry-After header.
+	 *
+	 * @param request	The request to respond to.
+	 * @param reason	The reason the admission control rejected the request.
+	 */
+	void sendUnavailable(AsyncWebServerRequest *request,
+			const admission_result reason) const;
+
+	/**
+	 * Sends the given response, and remembers its status code and content length for the request stats.
+	 * All responses of the instrumented handlers have to be sent using this method.
+	 *
+	 * @param request	The request to respond to.
+	 * @param response	The response to send.
+	 */
+	void send(AsyncWebServerRequest *request,
+			AsyncWebServerResponse *response) const;
+
+	/**
+	 * Creates a response sending the given string.
+	 * The string is shared with the response, rather than copied.
+	 *
+	 * @param request		The request to create the response for.
+	 * @param content_type	The content type of the response.
+	 * @param content		The content to send.
+	 * @return	The created response.
+	 */
+	static AsyncWebServerResponse* beginStringResponse(
+			AsyncWebServerRequest *request, const char *content_type,
+			const std::shared_ptr<const std::string> content);
+
+	/**
+	 * Creates a response sending the given head string, followed by the given tail string.
+	 * Both strings are shared with the response, rather than concatenated.
+	 *
+	 * @param request		The request to create the response for.
+	 * @param content_type	The content type of the response.
+	 * @param head			The first part of the content to send.
+	 * @param tail			The rest of the content to send.
+	 * @return	The created response.
+	 */
+	static AsyncWebServerResponse* beginStringResponse(
+			AsyncWebServerRequest *request, const char *content_type,
+			const std::shared_ptr<const std::string> head,
+			const std::shared_ptr<const std::string> tail);
+
+	/**
+	 * Appends the send queue metrics of the given web socket clients to the given metrics.
+	 *
+	 * @param metrics	The prometheus metrics to append to.
+	 * @param sockets	The stats of the web socket clients.
+	 */
+	static void appendSocketMetrics(std::string &metrics,
+			const std::vector<PinSocket::client_stats> &sockets);
+
+	/**
+	 * Writes the placeholder values for the given pin to the given values array.
+	 *
+	 * @param pin		The pin to get the values for.
+	 * @param number	A buffer of at least 4 chars to write the pin number to.
+	 * @param changes	A buffer of at least 21 chars to write the number of changes to.
+	 * @param values	The placeholder values array to write to.
+	 */
+	static void getPinValues(const pin_state &pin, char number[4],
+			char changes[21], const char *values[]);
+
 	/**
 	 * The method responding to http requests for the prometheus metrics endpoint.
+	 * The pin metrics are only generated again if a pin changed since the last request.
+	 * Includes the system health and resource usage, the send queue length of each web socket client,
+	 * if there are any, the admission control stats, and the request stats of all endpoints that handled a request.
 	 *
 	 * @param request	The request to handle.
 	 */
-	void getMetrics(AsyncWebServerRequest *request) const;
+	void getMetrics(AsyncWebServerRequest *request);
 
 	/**
-	 * The method handling requests to pages that don't exist.
+	 * Sends a gzip compressed static asset.
+	 * Responds with 304 Not Modified if the request contains its ETag in an If-None-Match header.
 	 *
 	 * @param request	The request to handle.
+	 * @param asset		The asset to send.
 	 */
-	void onNotFound(AsyncWebServerRequest *request) const;
+	void getStaticAsset(AsyncWebServerRequest *request,
+			const static_asset &asset) const;
 
 	/**
-	 * The method generating final the index.html page and sending it to the client.
+	 * Calculates the ETag of the given static asset.
 	 *
-	 * @param request	The http request to handle.
+	 * @param asset	The asset whose ETag to set.
+	 * @param crc	The CRC32 of the previous assets, to calculate the asset version.
+	 * @return	The CRC32 of the given asset, continuing the given CRC32.
 	 */
-	void getIndex(AsyncWebServerRequest *request) const;
+	static uint32_t initStaticAsset(static_asset &asset, const uint32_t crc);
 
 	/**
-	 * The method generating the final settings.html page and sending it to the client.
-	 * As well as handling changes requested by the client.
+	 * The method handling requests to pages that don't exist.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void onNotFound(AsyncWebServerRequest *request) const;
+
+	/**
+	 * The method handling changes to the pins submitted using the settings.html forms.
+	 * Responds with the settings.html page showing the result, but without any pins.
+	 * The pins are rendered by settings.js, like for the static page.
 	 *
 	 * @param request	The web request to handle.
 	 */
 	void handleSettings(AsyncWebServerRequest *request) const;
 
+	/**
+	 * Updates multiple watched pins at once, using GPIOHandler::configurePins.
+	 * Expects the post parameters to contain a "pin", "name", and "resistor" parameter for each pin.
+	 * Either all the given pins are updated, or none of them.
+	 *
+	 * @param request	The settings request containing the new pin configurations.
+	 * @param message	The string to write the message for the user to.
+	 * @return	True if all pins were updated successfully.
+	 */
+	bool updatePins(AsyncWebServerRequest *request, String &message) const;
+
+	/**
+	 * Gets the user facing reason for a GPIOHandler error.
+	 *
+	 * @param err	The error to describe.
+	 * @param name	The pin name that was given to the failed action.
+	 * @return	A sentence describing why the action failed.
+	 */
+	static String getErrorReason(const gpio_err_t err, const String &name);
+
 	/**
 	 * The method responding to http requests for the confim pin deletion page.
 	 *
@@ -125,10 +708,192 @@ private:
 
 	/**
 	 * The method for handling get requests for the pins.json file.
+	 * If the request has a "since" parameter, only the pins that changed after that sequence number are sent.
+	 * If none did, the response is delayed until one does, or the timeout given as the "timeout" parameter expires.
+	 * A sequence number ahead of the current one, for example from before a reboot, returns all pins immediately.
+	 * Otherwise sends pins.cbor instead, if the Accept header asks for CBOR.
 	 *
 	 * @param request	The request to handle.
 	 */
 	void getPinsJson(AsyncWebServerRequest *request) const;
+
+	/**
+	 * Generates the incremental pins.json for the given sequence number.
+	 * Contains the current change sequence number, the configuration version,
+	 * and the pins whose last change has a higher sequence number than the given one.
+	 *
+	 * @param gpio	The GPIOHandler to get the pins from.
+	 * @param since	The sequence number after which changes should be included.
+	 * @return	The generated json.
+	 */
+	static std::string getChangedPinsJson(const GPIOHandler &gpio,
+			const uint32_t since);
+
+	/**
+	 * The method for handling get requests for the pins.cbor file.
+	 * Sends the current pin states as a CBOR map, using the integer keys from pins_cbor_key and pin_cbor_key.
+	 * If the "config" parameter matches the current config version, the pin names and resistors are omitted.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void getPinsCbor(AsyncWebServerRequest *request) const;
+
+	/**
+	 * Encodes the given pins as the CBOR representation used by pins.cbor.
+	 *
+	 * @param pins				The pins to encode.
+	 * @param sequence			The change sequence number of the given pins.
+	 * @param config_version	The config version of the given pins.
+	 * @param compact			Whether to omit the names and resistors of the pins.
+	 * @return	The encoded pins.
+	 */
+	static std::string getPinsCborContent(const std::vector<pin_state> &pins,
+			const uint32_t sequence, const uint32_t config_version,
+			const bool compact);
+
+	/**
+	 * Writes the json object representing the given pin.
+	 *
+	 * @param json	The json writer to write the pin to.
+	 * @param pin	The pin to write.
+	 */
+	static void writePin(JSONWriter &json, const pin_state &pin);
+
+	/**
+	 * The method handling requests to the pin api on /api/pins.
+	 * GET returns a json array of all watched pins.
+	 * PUT replaces all watched pins with the pins in the json array body,
+	 * PATCH adds or updates the given pins, and DELETE unregisters the pins whose numbers are in the body.
+	 * Each change request is applied as a single transaction with a single storage write,
+	 * and answered with the result for each given pin.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void handleApiPins(AsyncWebServerRequest *request) const;
+
+	/**
+	 * Collects the body of a pin api request in the temp object of the request.
+	 * Bodies larger than MAX_API_BODY_SIZE are dropped.
+	 *
+	 * @param request	The request whose body was received.
+	 * @param data		The received part of the body.
+	 * @param len		The length of the received part.
+	 * @param index		The offset of the received part in the body.
+	 * @param total		The total length of the body.
+	 */
+	static void receiveApiBody(AsyncWebServerRequest *request, uint8_t *data,
+			size_t len, size_t index, size_t total);
+
+	/**
+	 * Parses a json array of pin configurations, as sent to the pin api.
+	 * Each object has to contain the pin number as "pin", and can contain its "name" and "pull_up" setting.
+	 * Missing values are taken from the currently watched pin, unknown keys are ignored.
+	 *
+	 * @param json		The reader to read the pins from.
+	 * @param configs	The vector to write the parsed pins to.
+	 * @param error		The string to write the reason to if the json is invalid.
+	 * @return	True if the whole body was a valid pin configuration array.
+	 */
+	bool parsePinConfigs(JSONReader &json, std::vector<pin_config> &configs,
+			String &error) const;
+
+	/**
+	 * Sends the response to a pin api change request.
+	 * Contains whether the change was applied, the new config version, and the result for each given pin.
+	 *
+	 * @param request	The request to respond to.
+	 * @param configs	The pins given in the request, in request order.
+	 * @param results	The result for each given pin, in request order.
+	 * @param applied	Whether the change was applied.
+	 */
+	void sendApiResults(AsyncWebServerRequest *request,
+			const std::vector<pin_config> &configs,
+			const std::vector<gpio_err_t> &results,
+			const bool applied) const;
+
+	/**
+	 * Sends a pin api error response, for requests that couldn't be parsed.
+	 *
+	 * @param request	The request to respond to.
+	 * @param code		The http status code to respond with.
+	 * @param error		The reason the request was rejected.
+	 */
+	void sendApiError(AsyncWebServerRequest *request, const int code,
+			const char *error) const;
+
+	/**
+	 * The method starting a new Server-Sent Events stream of pin changes.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void getEvents(AsyncWebServerRequest *request);
+
+	/**
+	 * The method parking a request until one of the selected pins changes.
+	 * Accepts the optional parameters "pins", a comma separated list of pins to wait for,
+	 * and "timeout", the max time to wait in seconds.
+	 * Waits for all pins if no pins are given.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void getApiWait(AsyncWebServerRequest *request);
+
+	/**
+	 * The method responding with the edge counts and duty cycle of a single pin over a recent window.
+	 * Requires the parameter "pin", and accepts the optional parameter "window" in seconds.
+	 * The window is rounded up to whole buckets, and limited to the length of the bucket ring.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void getApiStats(AsyncWebServerRequest *request) const;
+
+	/**
+	 * Parses an optional unsigned integer request parameter.
+	 * Leaves the value unchanged if the request doesn't have the parameter.
+	 *
+	 * @param request	The request to get the parameter from.
+	 * @param name		The name of the parameter.
+	 * @param value		The variable to write the parsed value to.
+	 * @param max		The max valid value of the parameter.
+	 * @return	False if the parameter isn't a valid number, or is larger than max.
+	 */
+	static bool parseUnsignedParam(AsyncWebServerRequest *request,
+			const char *name, uint32_t &value, const uint32_t max);
+
+	/**
+	 * Parses the "from", "to", and "pin" parameters of a pin history request.
+	 * Defaults to the last 24 hours of all pins, using UINT8_MAX as the pin to select all pins.
+	 * Sends a 400 response if a parameter is invalid, or from is after to.
+	 *
+	 * @param request	The request to parse the parameters of.
+	 * @param from		The variable to write the first time to export to.
+	 * @param to		The variable to write the last time to export to.
+	 * @param pin		The variable to write the pin to export to.
+	 * @return	False if a parameter was invalid, and the error response was sent.
+	 */
+	bool parseHistoryRange(AsyncWebServerRequest *request, uint32_t &from,
+			uint32_t &to, uint8_t &pin) const;
+
+	/**
+	 * The method streaming the recorded pin history as a csv file.
+	 * Accepts the optional parameters "from" and "to" as seconds since the unix epoch,
+	 * and "pin" to only return the history of a single pin.
+	 * Defaults to the last 24 hours of all pins.
+	 * Responds with status code 400 if a parameter isn't a valid number, or from is after to.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void getHistoryCsv(AsyncWebServerRequest *request) const;
+
+	/**
+	 * The method streaming the recorded pin history, downsampled to a target number of points per pin.
+	 * Accepts the same optional parameters as getHistoryCsv, as well as "points",
+	 * the max number of points per pin, and "format", either "csv" or "ndjson".
+	 * Exports every record as its own point if no point count is given.
+	 *
+	 * @param request	The request to handle.
+	 */
+	void getApiHistory(AsyncWebServerRequest *request) const;
 };
 
 #endif /* LIB_WEBSERVERHANDLER_H_ */
@@ -1,71 +1,117 @@
 let pins = {}
 let changed = []
-let any_changed = false
 
 function init() {
-	let pin_states = document.getElementsByClassName('state')
-	for (let i = 0; i < pin_states.length; i++) {
-		let pin = pin_states[i]
-
-		pin.addEventListener('change', onChange, false)
-		pin.name.addEventListener('input', onChange, false)
+	document.getElementById('save_all').addEventListener('click', saveAll, false)
+	update()
+	if (typeof EventSource !== 'undefined') {
+		let events = new EventSource('events')
+		events.addEventListener('pin', onPinEvent, false)
+		events.addEventListener('config', update, false)
+	} else {
+		window.setInterval(update, 5000)
+	}
+}
 
-		if (pin.attributes.name == undefined || pin.attributes.name.value != "add") {
-			let number = Number(pin.pin.value)
-			pins[number] = pin
-		}
+function onPinEvent(event) {
+	let entry = JSON.parse(event.data)
+	if (!(entry.pin in pins)) {
+		update()
+		return
 	}
-	window.setInterval(update, 5000)
+
+	setState(pins[entry.pin], entry)
 }
 
 function update() {
 	fetch('pins.json', { method: 'get' })
 		.then(res => res.json())
-		.then(data => {
-			let missing = Object.keys(pins)
-			let new_pins = Object.keys(data)
-			for (let i = 0; i < new_pins.length; i++) {
-				let pin = new_pins[i]
-				let entry = data[pin]
-				if (pin in pins && missing.includes(pin)) {
-					let pin_html = pins[pin]
-					missing.splice(missing.indexOf(pin), 1)
-
-					if (!changed.includes(pin)) {
-						pin_html.name.value = entry.name
-						pin_html.resistor[entry.pull_up == true ? 0 : 1].checked = true
-					}
-
-					pin_html.querySelector('output[name="state"]').innerText = entry.state
-					pin_html.querySelector('output[name="state"]').className = entry.state + "color"
-					pin_html.querySelector('output[name="changes"]').innerText = entry.changes
-				} else if (!(pin in pins) && !missing.includes(pin)) {
-					missing.push(pin)
-				} else {
-					console.log('Error:', 'Pins on index page or pins in pins json contain a duplicate!')
-				}
-			}
-
-			if (!any_changed && missing.length > 0) {
-				window.location.href = window.location.href
-			}
-		}).catch((error) => {
+		.then(render)
+		.catch((error) => {
 			console.log('Error:', error)
 		})
 }
 
-function onChange(event) {
-	any_changed = true
-	let form = event.target.parentNode.parentNode
+function render(data) {
+	let container = document.getElementById('pins')
+	let template = document.getElementById('pin_template')
 
-	if (form.attributes.name != undefined && form.attributes.name.value == "add") {
-		return
+	let removed = Object.keys(pins)
+	for (let i = 0; i < removed.length; i++) {
+		let pin = removed[i]
+		if (!(pin in data)) {
+			container.removeChild(pins[pin])
+			delete pins[pin]
+			if (changed.includes(pin)) {
+				changed.splice(changed.indexOf(pin), 1)
+			}
+		}
+	}
+
+	let new_pins = Object.keys(data)
+	for (let i = 0; i < new_pins.length; i++) {
+		let pin = new_pins[i]
+		let entry = data[pin]
+		if (!(pin in pins)) {
+			let pin_html = template.content.firstElementChild.cloneNode(true)
+			pin_html.addEventListener('change', onChange, false)
+			pin_html.name.addEventListener('input', onChange, false)
+			pin_html.pin.value = entry.pin
+			pins[pin] = pin_html
+			container.appendChild(pin_html)
+		}
+
+		let pin_html = pins[pin]
+		if (!changed.includes(pin)) {
+			pin_html.name.value = entry.name
+			pin_html.resistor[entry.pull_up == true ? 0 : 1].checked = true
+		}
+		setState(pin_html, entry)
 	}
 
+	document.getElementById('no_pins').hidden = new_pins.length > 0
+	document.getElementById('save_all').hidden = changed.length < 2
+}
+
+function setState(pin_html, entry) {
+	pin_html.querySelector('output[name="state"]').innerText = entry.state
+	pin_html.querySelector('output[name="state"]').className = entry.state + "color"
+	pin_html.querySelector('output[name="changes"]').innerText = entry.changes
+}
+
+function onChange(event) {
+	let form = event.target.form
 	let pin = form.pin.value
 	if (!changed.includes(pin)) {
 		changed.push(pin)
 	}
+
+	if (changed.length > 1) {
+		document.getElementById('save_all').hidden = false
+	}
+}
+
+function saveAll() {
+	let form = document.createElement('form')
+	form.method = 'post'
+	form.action = '/settings.html'
+	addInput(form, 'action', 'update_all')
+	for (let i = 0; i < changed.length; i++) {
+		let pin = pins[changed[i]]
+		addInput(form, 'pin', pin.pin.value)
+		addInput(form, 'name', pin.name.value)
+		addInput(form, 'resistor', pin.resistor.value)
+	}
+	document.body.appendChild(form)
+	form.submit()
+}
+
+function addInput(form, name, value) {
+	let input = document.createElement('input')
+	input.type = 'hidden'
+	input.name = name
+	input.value = value
+	form.appendChild(input)
 }
 
 window.onload = init
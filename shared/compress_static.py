@@ -0,0 +1,77 @@
+#!/usr/bin/python
+Import ("env")
+import gzip
+import os
+import zlib
+
+def compress(content, output):
+    # A fixed mtime, so the output, and with it the ETag, only changes if the input does.
+    with open(output, "wb") as f:
+        with gzip.GzipFile(filename="", mode="wb", compresslevel=9, fileobj=f, mtime=0) as gz:
+            gz.write(content)
+
+def main():
+    input_dir = os.path.join(env.subst("$PROJECT_DIR"), "lib", "webserverhandler", "html")
+    output_dir = os.path.join(input_dir, "gzip")
+    assets = ["main.css", "index.js", "settings.js"]
+
+    # The html pages served as static shells, and the values of their placeholders.
+    # The version is the same CRC32 of the compressed assets the WebServerHandler calculates on startup.
+    pages = {
+        "index.html": {},
+        "settings.html": { "message_type": "", "message": "", "hidden": " hidden" }
+    }
+
+    if not os.path.exists(output_dir):
+        os.makedirs(output_dir)
+
+    for asset in assets:
+        input = os.path.join(input_dir, asset)
+        output = os.path.join(output_dir, asset + ".gz")
+
+        if not os.path.exists(input) or not os.path.isfile(input):
+            print(f"Error: {input} does not exist.")
+            env.Exit(1)
+
+        if os.path.exists(output) and os.path.getmtime(output) >= os.path.getmtime(input):
+            continue
+
+        with open(input, "rb") as f:
+            content = f.read()
+
+        compress(content, output)
+
+        print(f"Compressed {asset} from {len(content)} to {os.path.getsize(output)} bytes.")
+
+    version = 0
+    newest_asset = 0
+    for asset in assets:
+        output = os.path.join(output_dir, asset + ".gz")
+        with open(output, "rb") as f:
+            version = zlib.crc32(f.read(), version)
+        newest_asset = max(newest_asset, os.path.getmtime(output))
+
+    for page, values in pages.items():
+        input = os.path.join(input_dir, page)
+        output = os.path.join(output_dir, page + ".gz")
+
+        if not os.path.exists(input) or not os.path.isfile(input):
+            print(f"Error: {input} does not exist.")
+            env.Exit(1)
+
+        if os.path.exists(output) and os.path.getmtime(output) >= max(os.path.getmtime(input), newest_asset):
+            continue
+
+        with open(input, "r", encoding="utf-8") as f:
+            content = f.read()
+
+        # Replaced longest name first, so no placeholder replaces the start of another.
+        values = dict(values, version=f"{version:08x}")
+        for name in sorted(values, key=len, reverse=True):
+            content = content.replace("$" + name, values[name])
+
+        compress(content.encode("utf-8"), output)
+
+        print(f"Compressed {page} from {len(content)} to {os.path.getsize(output)} bytes.")
+
+main()
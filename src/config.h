@@ -58,4 +58,81 @@ static const uint64_t PIN_CHECK_INTERVAL = 300000;
  */
 static const uint16_t PIN_DEBOUNCE_TIMEOUT = 10;
 
+/**
+ * The length of a single interval of the pin history.
+ * At the end of each interval the number of state changes and the time spent high
+ * during the interval is recorded for each pin.
+ * The history is written to the flash with the manual pin checks, or once a history page is full.
+ * In milliseconds.
+ * Default is 1 minute.(60 * 1000 = 60000)
+ */
+static const uint64_t HISTORY_INTERVAL = 60000;
+
+/**
+ * The NTP server to get the current time from.
+ * The current time is required for the pin history.
+ */
+static constexpr char NTP_SERVER[] = "pool.ntp.org";
+
+/**
+ * Whether to store files on LittleFS instead of SPIFFS.
+ * LittleFS is faster for small writes, and supports directories.
+ * Both use the same partition, so switching to LittleFS formats it.
+ * The pin storage file is migrated automatically when switching, the pin history and all other files are lost.
+ * Disabled by default, so updating existing devices doesn't format their file system.
+ */
+static const bool USE_LITTLEFS = false;
+
+/**
+ * The label of the data partition to store the pin states in directly, bypassing the file system.
+ * Requires a partition table containing a data partition with this label,
+ * for example the partitions_pinstore.csv in the root of this repository.
+ * Set to NULL to store the pin states in a file instead.
+ * Falls back to a file if the partition doesn't exist.
+ */
+static constexpr const char *PIN_STORAGE_PARTITION = NULL;
+
+/**
+ * The host name or ip address of the MQTT broker to publish the pin states to.
+ * Set to NULL to disable MQTT.
+ * The topics are prefixed with the HOSTNAME.
+ */
+static constexpr const char *MQTT_BROKER = NULL;
+
+/**
+ * The port of the MQTT broker.
+ */
+static const uint16_t MQTT_PORT = 1883;
+
+/**
+ * The quality of service level to publish the pin states with.
+ * 0 is at most once, 1 at least once, and 2 exactly once.
+ */
+static const uint8_t MQTT_QOS = 1;
+
+/**
+ * The user to log in to the MQTT broker with.
+ * Set to NULL if the broker doesn't require a login.
+ */
+static constexpr const char *MQTT_USER = NULL;
+
+/**
+ * The password to log in to the MQTT broker with.
+ */
+static constexpr const char *MQTT_PASS = NULL;
+
+/**
+ * The write url of the InfluxDB server to push the pin changes to.
+ * For example "http://influx:8086/api/v2/write?org=home&bucket=gpio" for InfluxDB 2,
+ * or "http://influx:8086/write?db=gpio" for InfluxDB 1.
+ * Set to NULL to disable the InfluxDB export.
+ */
+static constexpr const char *INFLUX_URL = NULL;
+
+/**
+ * The api token to write to the InfluxDB server with.
+ * Set to NULL if the server doesn't require authentication.
+ */
+static constexpr const char *INFLUX_TOKEN = NULL;
+
 #endif /* SRC_CONFIG_H_ */
@@ -10,8 +10,10 @@
 #include "StorageHandler.h"
 #include <ArduinoOTA.h>
 #include <ESPmDNS.h>
+#include <LITTLEFS.h>
 
 void setup() {
+	using namespace std::placeholders;
 	start = millis();
 	Serial.begin(115200);
 
@@ -34,21 +36,55 @@ void setup() {
 
 	WiFi.begin(WIFI_SSID, WIFI_PASS);
 
+	configTime(0, 0, NTP_SERVER);
+
 	gpio_handler.setDebounceTimeout(PIN_DEBOUNCE_TIMEOUT);
 
-	bool spiffs = SPIFFS.begin(true);
-	if (!spiffs) {
-		Serial.println("Warning: Initializing SPIFFS failed, persistent storage will not be available!");
+	bool file_system = setupFileSystem();
+	if (!file_system) {
+		Serial.println("Warning: Initializing the file system failed, persistent storage will not be available!");
+	}
+
+	bool partition = pin_partition.begin();
+	if (partition) {
+		storage_handler.setPartition(&pin_partition);
+	} else if (PIN_STORAGE_PARTITION != NULL) {
+		Serial.println("Warning: Pin storage partition not found, falling back to the file system.");
 	}
 
-	if (spiffs) {
+	if (file_system || partition) {
 		storage_handler.loadGPIOHandler(gpio_handler);
-	} else {
-		storage_handler.setPinStoragePath(NULL);
+	}
+
+	if (!file_system) {
+		if (!partition) {
+			storage_handler.setPinStoragePath(NULL);
+		}
+		storage_handler.getHistory().setPath(NULL);
 	}
 
 	setupOTA();
 	server.setup();
+	dispatcher.onChange(std::bind(&WebServerHandler::publish, &server, _1));
+	dispatcher.onConfigChange(
+			std::bind(&WebServerHandler::publishConfigChange, &server));
+
+	if (MQTT_BROKER != NULL) {
+		mqtt.setQoS(MQTT_QOS);
+		mqtt.begin(MQTT_BROKER, MQTT_PORT, HOSTNAME, MQTT_USER, MQTT_PASS);
+		dispatcher.onChange(std::bind(&MQTTHandler::publish, &mqtt, _1));
+		dispatcher.onConfigChange(
+				std::bind(&MQTTHandler::publishConfigChange, &mqtt));
+		server.addMetricsAppender(
+				std::bind(&MQTTHandler::appendMetrics, &mqtt, _1));
+	}
+
+	if (INFLUX_URL != NULL) {
+		influx.begin(INFLUX_URL, HOSTNAME, INFLUX_TOKEN);
+		dispatcher.onChange(std::bind(&InfluxExporter::record, &influx, _1));
+		server.addMetricsAppender(
+				std::bind(&InfluxExporter::appendMetrics, &influx, _1));
+	}
 
 	bool wifiReady = ready != 0;
 	ready = millis();
@@ -64,12 +100,22 @@ void loop() {
 	delay(20);
 
 	ArduinoOTA.handle();
+	dispatcher.dispatch();
+	server.handle();
+	mqtt.handle();
+	influx.handle();
 
 	uint64_t now = millis();
+	if (now - last_history_record > HISTORY_INTERVAL) {
+		last_history_record = now;
+		storage_handler.recordHistory(gpio_handler);
+	}
+
 	if (now - last_pin_check > PIN_CHECK_INTERVAL) {
 		last_pin_check = now;
 		gpio_handler.checkPins();
 		gpio_handler.writeToStorageHandler();
+		storage_handler.flushHistory(gpio_handler);
 	}
 }
 
@@ -79,6 +125,7 @@ void setupOTA() {
 
 	ArduinoOTA.onStart([]() {
 		Serial.println("Start updating sketch.");
+		storage_handler.flushHistory(gpio_handler);
 		gpio_handler.disableInterrupts();
 	});
 
@@ -108,6 +155,43 @@ void setupOTA() {
 	ArduinoOTA.begin();
 }
 
+bool setupFileSystem() {
+	if (!USE_LITTLEFS) {
+		return SPIFFS.begin(true);
+	}
+
+	if (LITTLEFS.begin(false)) {
+		storage_handler.setFileSystem(LITTLEFS);
+		return true;
+	}
+
+	// LittleFS and SPIFFS share the partition, so the pin storage has to be read to RAM before formatting it.
+	const char *pin_storage = storage_handler.getPinStoragePath();
+	std::string pins;
+	bool migrate = false;
+	if (pin_storage != NULL && SPIFFS.begin(false)) {
+		FSStorageBackend spiffs(SPIFFS);
+		migrate = spiffs.read(pin_storage, pins) == STORAGE_OK;
+		SPIFFS.end();
+	}
+
+	if (!LITTLEFS.begin(true)) {
+		return false;
+	}
+	storage_handler.setFileSystem(LITTLEFS);
+
+	if (migrate) {
+		FSStorageBackend littlefs(LITTLEFS);
+		if (littlefs.write(pin_storage, (const uint8_t*) pins.c_str(),
+				pins.length()) == STORAGE_OK) {
+			Serial.println("Migrated the pin storage from SPIFFS to LittleFS.");
+		} else {
+			Serial.println("Warning: Migrating the pin storage from SPIFFS to LittleFS failed!");
+		}
+	}
+	return true;
+}
+
 void onWiFiStart(WiFiEvent_t event, WiFiEventInfo_t eventInfo) {
 	WiFi.setHostname(HOSTNAME);
 }
@@ -10,6 +10,10 @@
 
 #include "config.h"
 #include "WebServerHandler.h"
+#include "ChangeDispatcher.h"
+#include "MQTTHandler.h"
+#include "InfluxExporter.h"
+#include "FlashPartition.h"
 
 extern const char WIFI_SSID[] asm("_binary_wifissid_txt_start");
 extern const char WIFI_PASS[] asm("_binary_wifipass_txt_start");
@@ -30,6 +34,15 @@ void loop();
  */
 void setupOTA();
 
+/**
+ * Mounts the file system to store files on, and makes the StorageHandler use it.
+ * If LittleFS is enabled but the partition still contains SPIFFS,
+ * the pin storage file is copied to the newly formatted LittleFS.
+ *
+ * @return	True if a file system was mounted successfully.
+ */
+bool setupFileSystem();
+
 /**
  * A callback handling everything to be done when the WiFi station is starting.
  *
@@ -75,14 +88,39 @@ uint64_t ready = 0;
  */
 uint64_t last_pin_check = 0;
 
+/**
+ * The time of the end of the last pin history interval.
+ */
+uint64_t last_history_record = 0;
+
 /**
  * The local IPv4 address of this ESP.
  */
 IPAddress localhost;
 
+/**
+ * The raw flash partition to store the pin states in, if PIN_STORAGE_PARTITION is set.
+ */
+EspFlashPartition pin_partition(PIN_STORAGE_PARTITION);
+
+/**
+ * The dispatcher forwarding the pin changes to the web server, and the MQTT and InfluxDB clients.
+ */
+ChangeDispatcher dispatcher;
+
 /**
  * The web server used to view the current pin states and configure pins to watch.
  */
 WebServerHandler server(WEBSERVER_PORT);
 
+/**
+ * The MQTT client publishing the pin states to the MQTT_BROKER, if it is set.
+ */
+MQTTHandler mqtt;
+
+/**
+ * The exporter writing the pin changes to the INFLUX_URL, if it is set.
+ */
+InfluxExporter influx;
+
 #endif /* SRC_MAIN_H_ */
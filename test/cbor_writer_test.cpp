@@ -0,0 +1,177 @@
+/*
+ * cbor_writer_test.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "cbor_writer_test.h"
+#include "test_main.h"
+#include <unity.h>
+#include <Arduino.h>
+
+uint8_t read_cbor_head(const std::string &data, size_t &pos,
+		uint64_t &argument) {
+	TEST_ASSERT_LESS_THAN_MESSAGE(data.length(), pos,
+			"The CBOR data ended before a data item.");
+	const uint8_t initial = data[pos++];
+	const uint8_t info = initial & 0x1F;
+	if (info < 24) {
+		argument = info;
+		return initial >> 5;
+	}
+
+	TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(27, info,
+			"The CBOR data contained an unsupported argument size.");
+	const size_t length = 1 << (info - 24);
+	TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(data.length(), pos + length,
+			"The CBOR data ended inside a head.");
+	argument = 0;
+	for (size_t i = 0; i < length; i++) {
+		argument = argument << 8 | (uint8_t) data[pos++];
+	}
+	return initial >> 5;
+}
+
+uint64_t read_cbor_unsigned(const std::string &data, size_t &pos) {
+	uint64_t value = 0;
+	TEST_ASSERT_EQUAL_MESSAGE(0, read_cbor_head(data, pos, value),
+			"The CBOR data item wasn't an unsigned integer.");
+	return value;
+}
+
+void run_cbor_writer_tests() {
+	RUN_TEST(test_cbor_values);
+	RUN_TEST(test_cbor_structure);
+	RUN_TEST(fuzz_cbor_overflow);
+}
+
+void check_cbor_output(const CBORWriter &cbor, const uint8_t *buffer,
+		const uint8_t *expected, const size_t length, const char *name) {
+	TEST_ASSERT_FALSE_MESSAGE(cbor.overflowed(),
+			(String("The CBORWriter overflowed while encoding ") + name + '.').c_str());
+	TEST_ASSERT_EQUAL_MESSAGE(length, cbor.length(),
+			(String("The CBORWriter encoded ") + name + " with the wrong length.").c_str());
+	TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, buffer, length,
+			(String("The CBORWriter encoded ") + name + " incorrectly.").c_str());
+}
+
+void test_cbor_values() {
+	uint8_t buffer[16];
+	const uint8_t small[] = { 0x00, 0x17, 0x18, 0x18 };
+	CBORWriter small_cbor(buffer, sizeof(buffer));
+	small_cbor.value((uint32_t) 0).value((uint32_t) 23).value((uint32_t) 24);
+	check_cbor_output(small_cbor, buffer, small, sizeof(small),
+			"0, 23, and 24");
+
+	const uint8_t medium[] = { 0x19, 0x03, 0xE8, 0x1A, 0x00, 0x0F, 0x42, 0x40 };
+	CBORWriter medium_cbor(buffer, sizeof(buffer));
+	medium_cbor.value((uint32_t) 1000).value((uint32_t) 1000000);
+	check_cbor_output(medium_cbor, buffer, medium, sizeof(medium),
+			"1000 and 1000000");
+
+	const uint8_t large[] = { 0x1B, 0x00, 0x00, 0x00, 0xE8, 0xD4, 0xA5, 0x10,
+			0x00 };
+	CBORWriter large_cbor(buffer, sizeof(buffer));
+	large_cbor.value((uint64_t) 1000000000000ULL);
+	check_cbor_output(large_cbor, buffer, large, sizeof(large),
+			"1000000000000");
+
+	const uint8_t negative[] = { 0x20, 0x39, 0x03, 0xE7 };
+	CBORWriter negative_cbor(buffer, sizeof(buffer));
+	negative_cbor.value((int32_t) -1).value((int64_t) -1000);
+	check_cbor_output(negative_cbor, buffer, negative, sizeof(negative),
+			"-1 and -1000");
+
+	const uint8_t simple[] = { 0xF4, 0xF5, 0xF6, 0xF6 };
+	CBORWriter simple_cbor(buffer, sizeof(buffer));
+	simple_cbor.value(false).value(true).null().value((const char*) NULL);
+	check_cbor_output(simple_cbor, buffer, simple, sizeof(simple),
+			"false, true, and null");
+
+	const uint8_t text[] = { 0x60, 0x64, 'I', 'E', 'T', 'F' };
+	CBORWriter text_cbor(buffer, sizeof(buffer));
+	text_cbor.value("").value("IETF");
+	check_cbor_output(text_cbor, buffer, text, sizeof(text), "text strings");
+}
+
+void test_cbor_structure() {
+	uint8_t buffer[64];
+	const uint8_t empty[] = { 0xA0, 0x80 };
+	CBORWriter empty_cbor(buffer, sizeof(buffer));
+	empty_cbor.beginMap(0).beginArray(0);
+	check_cbor_output(empty_cbor, buffer, empty, sizeof(empty),
+			"an empty map and array");
+
+	// {1: 2, 3: [4, 5]}
+	const uint8_t nested[] = { 0xA2, 0x01, 0x02, 0x03, 0x82, 0x04, 0x05 };
+	CBORWriter nested_cbor(buffer, sizeof(buffer));
+	nested_cbor.beginMap(2).value((uint32_t) 1).value((uint32_t) 2);
+	nested_cbor.value((uint32_t) 3).beginArray(2).value((uint32_t) 4).value(
+			(uint32_t) 5);
+	check_cbor_output(nested_cbor, buffer, nested, sizeof(nested),
+			"a nested map");
+
+	// An array with 25 elements needs a one byte length argument.
+	CBORWriter cbor(buffer, sizeof(buffer));
+	cbor.beginArray(25);
+	for (uint8_t i = 0; i < 25; i++) {
+		cbor.value((uint32_t) i);
+	}
+	const std::string data((const char*) buffer, cbor.length());
+	size_t pos = 0;
+	uint64_t length = 0;
+	TEST_ASSERT_EQUAL_MESSAGE(4, read_cbor_head(data, pos, length),
+			"The CBORWriter didn't encode an array as an array.");
+	TEST_ASSERT_EQUAL_MESSAGE(25, length,
+			"The CBORWriter encoded the wrong array length.");
+	for (uint8_t i = 0; i < 25; i++) {
+		TEST_ASSERT_EQUAL_MESSAGE(i, read_cbor_unsigned(data, pos),
+				"The CBORWriter encoded the wrong array element.");
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(data.length(), pos,
+			"The CBORWriter wrote data after the end of the array.");
+}
+
+void fuzz_cbor_overflow() {
+	randomSeed(4321);
+	const size_t guard = 16;
+	uint8_t buffer[64 + guard];
+	for (uint16_t i = 0; i < CBOR_FUZZ_ITERATIONS; i++) {
+		const size_t size = random(64);
+		memset(buffer, 0xAA, sizeof(buffer));
+
+		CBORWriter cbor(buffer, size);
+		size_t written = 0;
+		for (uint8_t j = 0; j < 20; j++) {
+			switch (random(5)) {
+			case 0:
+				cbor.beginArray(random(300));
+				break;
+			case 1:
+				cbor.value((uint64_t) random(INT32_MAX) << random(32));
+				break;
+			case 2:
+				cbor.value((int64_t) random(-100000, 100000));
+				break;
+			case 3:
+				cbor.value("Some string");
+				break;
+			default:
+				cbor.value(random(2) == 0);
+				break;
+			}
+
+			TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(written, cbor.length(),
+					"The CBORWriter output got shorter.");
+			written = cbor.length();
+		}
+
+		for (size_t j = size; j < sizeof(buffer); j++) {
+			TEST_ASSERT_EQUAL_MESSAGE(0xAA, buffer[j],
+					"The CBORWriter wrote past the end of its buffer.");
+		}
+		TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(size, cbor.length(),
+				"The CBORWriter wrote more bytes than fit in its buffer.");
+	}
+}
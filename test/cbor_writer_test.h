@@ -0,0 +1,68 @@
+/*
+ * cbor_writer_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_CBOR_WRITER_TEST_H_
+#define TEST_CBOR_WRITER_TEST_H_
+
+#include "CBORWriter.h"
+#include <string>
+
+/**
+ * The number of random documents generated by the overflow fuzz test.
+ */
+const uint16_t CBOR_FUZZ_ITERATIONS = 2000;
+
+/**
+ * Reads the head of a CBOR data item, the way a CBOR parser would.
+ * Fails the current test if the data ends before the end of the head.
+ *
+ * @param data		The CBOR data to read from.
+ * @param pos		The position of the head. Set to the position after the head.
+ * @param argument	The variable to write the argument of the head to.
+ * @return	The major type of the data item.
+ */
+uint8_t read_cbor_head(const std::string &data, size_t &pos,
+		uint64_t &argument);
+
+/**
+ * Reads a CBOR unsigned integer, and fails the current test if the data item isn't one.
+ *
+ * @param data	The CBOR data to read from.
+ * @param pos	The position of the integer. Set to the position after the integer.
+ * @return	The value of the integer.
+ */
+uint64_t read_cbor_unsigned(const std::string &data, size_t &pos);
+
+/**
+ * Checks whether the given CBORWriter wrote exactly the expected bytes, without overflowing.
+ *
+ * @param cbor		The writer to check.
+ * @param buffer	The buffer the writer wrote to.
+ * @param expected	The expected output.
+ * @param length	The length of the expected output.
+ * @param name		A description of the encoded values, for the failure messages.
+ */
+void check_cbor_output(const CBORWriter &cbor, const uint8_t *buffer,
+		const uint8_t *expected, const size_t length, const char *name);
+
+/**
+ * Tests whether integers, booleans, strings, and null are encoded like the examples from RFC 8949.
+ */
+void test_cbor_values();
+
+/**
+ * Tests whether maps and arrays are encoded correctly.
+ */
+void test_cbor_structure();
+
+/**
+ * Writes random documents to buffers of random sizes,
+ * and makes sure the writer never writes past the end of the buffer.
+ */
+void fuzz_cbor_overflow();
+
+#endif /* TEST_CBOR_WRITER_TEST_H_ */
@@ -0,0 +1,98 @@
+/*
+ * change_dispatcher_test.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "change_dispatcher_test.h"
+#include "test_main.h"
+#include <unity.h>
+#include <string>
+#include <vector>
+
+void run_change_dispatcher_tests() {
+	RUN_TEST(test_dispatch_changes);
+	RUN_TEST(test_dispatch_config_changes);
+}
+
+void test_dispatch_changes() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+
+	ChangeDispatcher dispatcher(gpio_handler);
+	// Drop the changes queued by earlier tests.
+	dispatcher.dispatch();
+
+	std::vector<std::string> calls;
+	dispatcher.onChange([&calls](const pin_change &change) {
+		calls.push_back(std::string("first ") + (change.state ? "High" : "Low"));
+	});
+	dispatcher.onChange([&calls](const pin_change &change) {
+		calls.push_back(std::string("second ") + (change.state ? "High" : "Low"));
+	});
+
+	// Make sure the change is passed to both listeners, in order.
+	digitalWrite(OUT_PIN, HIGH);
+	size_t dispatched = 0;
+	const uint64_t start = millis();
+	while (dispatched == 0 && millis() - start < 1000) {
+		delay(10);
+		gpio_handler.checkPins();
+		dispatched = dispatcher.dispatch();
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(1, dispatched,
+			"The ChangeDispatcher didn't dispatch the pin change.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, calls.size(),
+			"The pin change wasn't passed to each listener once.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("first High", calls[0].c_str(),
+			"The first listener wasn't called first.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("second High", calls[1].c_str(),
+			"The second listener didn't receive the pin change.");
+
+	// Make sure the change isn't dispatched again.
+	TEST_ASSERT_EQUAL_MESSAGE(0, dispatcher.dispatch(),
+			"The ChangeDispatcher dispatched a change twice.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, calls.size(),
+			"The listeners were called without a new pin change.");
+
+	// Make sure removed listeners aren't called anymore.
+	dispatcher.clearListeners();
+	digitalWrite(OUT_PIN, LOW);
+	delay(50);
+	gpio_handler.checkPins();
+	dispatcher.dispatch();
+	TEST_ASSERT_EQUAL_MESSAGE(2, calls.size(),
+			"A removed listener was called.");
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_dispatch_config_changes() {
+	ChangeDispatcher dispatcher(gpio_handler);
+	uint32_t config_changes = 0;
+	dispatcher.onConfigChange([&config_changes]() {
+		config_changes++;
+	});
+
+	// Make sure the first dispatch reports the current configuration.
+	dispatcher.dispatch();
+	TEST_ASSERT_EQUAL_MESSAGE(1, config_changes,
+			"The first dispatch didn't call the config listener.");
+
+	dispatcher.dispatch();
+	TEST_ASSERT_EQUAL_MESSAGE(1, config_changes,
+			"The config listener was called without a configuration change.");
+
+	// Make sure registering a pin calls the config listener.
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	dispatcher.dispatch();
+	TEST_ASSERT_EQUAL_MESSAGE(2, config_changes,
+			"Registering a pin didn't call the config listener.");
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+	dispatcher.dispatch();
+	TEST_ASSERT_EQUAL_MESSAGE(3, config_changes,
+			"Unregistering a pin didn't call the config listener.");
+}
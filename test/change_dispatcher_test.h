@@ -0,0 +1,23 @@
+/*
+ * change_dispatcher_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_CHANGE_DISPATCHER_TEST_H_
+#define TEST_CHANGE_DISPATCHER_TEST_H_
+
+#include "ChangeDispatcher.h"
+
+/**
+ * Tests whether every pin change is passed to each change listener once, in the order they were added.
+ */
+void test_dispatch_changes();
+
+/**
+ * Tests whether the config listeners are only called when the pin configuration changed.
+ */
+void test_dispatch_config_changes();
+
+#endif /* TEST_CHANGE_DISPATCHER_TEST_H_ */
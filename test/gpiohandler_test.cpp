@@ -32,6 +32,7 @@ void run_gpiohandler_tests() {
 	// Disable pin flash persistence, since that has its own tests.
 	gpio_handler.setStorageHandler(NULL);
 	RUN_TEST(test_gpiohandler_methods);
+	RUN_TEST(test_configure_pins);
 	RUN_TEST(test_pins_connected);
 	RUN_TEST(test_pin_raw_state_with_interrupt);
 	RUN_TEST(test_pin_raw_state_without_interrupt);
@@ -39,6 +40,7 @@ void run_gpiohandler_tests() {
 	RUN_TEST(test_pin_state_without_interrupt);
 	RUN_TEST(test_pin_state_with_interrupt_without_debounce);
 	RUN_TEST(test_pin_state_without_interrupt_without_debounce);
+	RUN_TEST(test_pin_stats);
 }
 
 void test_gpiohandler_methods() {
@@ -262,6 +264,70 @@ void test_gpiohandler_methods() {
 			"After unregistering the only watched pin the number of watched pins was not 0.");
 }
 
+void test_configure_pins() {
+	// Make sure a configuration containing an invalid pin doesn't change anything.
+	std::vector<pin_config> pins;
+	pins.push_back( { IN_PIN, "Test Pin", false });
+	pins.push_back( { 28, "Invalid Pin", false });
+	std::vector<gpio_err_t> results;
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_PIN_INVALID,
+			gpio_handler.configurePins(pins, &results),
+			"Configuring an invalid pin didn't return the invalid pin error.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, gpio_handler.getWatchedPins().size(),
+			"Configuring an invalid pin registered the valid pin anyway.");
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, results[0],
+			"The result for the valid pin was not OK.");
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_PIN_INVALID, results[1],
+			"The result for the invalid pin was not the invalid pin error.");
+
+	// Make sure pins can't be given twice.
+	pins[1] = {IN_PIN, "Test Pin 2", true};
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_PIN_DUPLICATE,
+			gpio_handler.configurePins(pins, &results),
+			"Configuring the same pin twice didn't return the duplicate pin error.");
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, results[0],
+			"The duplicate pin error overwrote the result of the first entry.");
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_PIN_DUPLICATE, results[1],
+			"The result for the second entry was not the duplicate pin error.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, gpio_handler.getWatchedPins().size(),
+			"Configuring a duplicate pin registered it anyway.");
+
+	// Test registering two pins at once.
+	pins[1] = {IN_PIN_2, "Test Pin 2", true};
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, gpio_handler.configurePins(pins),
+			"Configuring two valid pins failed.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, gpio_handler.getWatchedPins().size(),
+			"After configuring two pins the number of watched pins was not 2.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("Test Pin 2",
+			gpio_handler.getName(IN_PIN_2).c_str(),
+			"The name of a configured pin didn't match the given name.");
+
+	// Test updating one pin and removing the other.
+	pins.pop_back();
+	pins[0].name = "New Name";
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, gpio_handler.configurePins(pins),
+			"Updating and removing pins failed.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, gpio_handler.getWatchedPins().size(),
+			"Removing a missing pin didn't unregister it.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("New Name",
+			gpio_handler.getName(IN_PIN).c_str(),
+			"Updating the name of a pin didn't work.");
+
+	// Test that pins aren't removed if remove_missing is false.
+	pins[0] = {IN_PIN_2, "Test Pin 2", false};
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, gpio_handler.configurePins(pins, NULL, false),
+			"Configuring a pin without removing the others failed.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, gpio_handler.getWatchedPins().size(),
+			"Configuring a pin with remove_missing false removed the other pin.");
+
+	// Remove all pins again.
+	pins.clear();
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, gpio_handler.configurePins(pins),
+			"Removing all pins failed.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, gpio_handler.getWatchedPins().size(),
+			"Configuring an empty pin list didn't unregister all pins.");
+}
+
 void test_pins_connected() {
 	pinMode(OUT_PIN, OUTPUT);
 	pinMode(IN_PIN, INPUT_PULLDOWN);
@@ -513,3 +579,89 @@ void test_pin_state(bool raw, bool interrupt, bool debounce) {
 	gpio_handler.enableInterrupts();
 	gpio_handler.setDebounceTimeout(10);
 }
+
+void test_pin_stats() {
+	// Make sure changes are summed up per bucket, and the high time is split at bucket boundaries.
+	PinStats stats(false, 0);
+	stats.recordChange(true, 1000);
+	stats.recordChange(false, 4000);
+	stats.recordChange(true, 14000);
+	stats.recordChange(false, 16000);
+	pin_stats result = stats.getStats(30000, 20000);
+	TEST_ASSERT_EQUAL_MESSAGE(0, result.start,
+			"The window of two buckets didn't start at the first bucket.");
+	TEST_ASSERT_EQUAL_MESSAGE(20000, result.duration,
+			"The window of two buckets had the wrong duration.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, result.rising,
+			"The window of two buckets had the wrong number of rising edges.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, result.falling,
+			"The window of two buckets had the wrong number of falling edges.");
+	TEST_ASSERT_EQUAL_MESSAGE(5000, result.high_time,
+			"The window of two buckets had the wrong high time.");
+
+	result = stats.getStats(15000, 20000);
+	TEST_ASSERT_EQUAL_MESSAGE(15000, result.start,
+			"The window of one bucket didn't start at the current bucket.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, result.rising,
+			"The window of one bucket contained an edge of the previous bucket.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, result.falling,
+			"The window of one bucket had the wrong number of falling edges.");
+	TEST_ASSERT_EQUAL_MESSAGE(1000, result.high_time,
+			"The high time wasn't split at the bucket boundary.");
+
+	// Make sure the time since the last change is included if the pin is high.
+	stats.recordChange(true, 18000);
+	result = stats.getStats(15000, 20000);
+	TEST_ASSERT_EQUAL_MESSAGE(1, result.rising,
+			"The window had the wrong number of rising edges after a new change.");
+	TEST_ASSERT_EQUAL_MESSAGE(3000, result.high_time,
+			"The high time didn't include the time since the last change.");
+
+	// Make sure buckets older than the ring are dropped.
+	const uint64_t now = 18000 + PinStats::MAX_WINDOW + 15000;
+	result = stats.getStats(PinStats::MAX_WINDOW * 2, now);
+	TEST_ASSERT_EQUAL_MESSAGE(PinStats::MAX_WINDOW - 12000, result.duration,
+			"The window wasn't limited to the bucket ring.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, result.rising,
+			"The window contained edges older than the bucket ring.");
+	TEST_ASSERT_EQUAL_MESSAGE(result.duration, result.high_time,
+			"A pin high for the entire window didn't have a duty cycle of one.");
+
+	stats.recordChange(false, now);
+	result = stats.getStats(PinStats::MAX_WINDOW, now);
+	TEST_ASSERT_EQUAL_MESSAGE(1, result.falling,
+			"The window had the wrong number of falling edges after a long high time.");
+	TEST_ASSERT_EQUAL_MESSAGE(result.duration, result.high_time,
+			"The long high time wasn't added to all buckets of the ring.");
+
+	// Make sure the buckets continue across a millis wraparound, and the time before registration isn't high.
+	PinStats wrapped(true, UINT32_MAX - 5000);
+	wrapped.recordChange(false, 10000);
+	result = wrapped.getStats(60000, 20000);
+	TEST_ASSERT_EQUAL_MESSAGE(1, result.falling,
+			"The change after the millis wraparound wasn't recorded.");
+	TEST_ASSERT_EQUAL_MESSAGE(15001, result.high_time,
+			"The high time across the millis wraparound was wrong.");
+
+	// Make sure the GPIOHandler records the changes of watched pins.
+	pin_stats pin_result;
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.unregisterGPIO(IN_PIN);
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_NOT_WATCHED, gpio_handler.getStats(IN_PIN, 60000, pin_result),
+			"Getting the stats of an unwatched pin didn't fail.");
+	gpio_handler.registerGPIO(IN_PIN, "Test", false);
+	digitalWrite(OUT_PIN, HIGH);
+	delay(50);
+	digitalWrite(OUT_PIN, LOW);
+	delay(20);
+	TEST_ASSERT_EQUAL_MESSAGE(GPIO_OK, gpio_handler.getStats(IN_PIN, 60000, pin_result),
+			"Getting the stats of a watched pin failed.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, pin_result.rising,
+			"The GPIOHandler didn't record the rising edge.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, pin_result.falling,
+			"The GPIOHandler didn't record the falling edge.");
+	TEST_ASSERT_INT_WITHIN_MESSAGE(15, 50, pin_result.high_time,
+			"The GPIOHandler recorded the wrong high time.");
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
@@ -29,6 +29,12 @@ void bounce_pin(const uint8_t pin, const uint8_t max_bounce_time,
  */
 void test_gpiohandler_methods();
 
+/**
+ * Tests configuring multiple pins at once using GPIOHandler::configurePins.
+ * Makes sure an invalid configuration doesn't change anything.
+ */
+void test_configure_pins();
+
 /**
  * Tests whether the input and output pin are connected.
  */
@@ -90,4 +96,10 @@ void test_pin_state_without_interrupt_without_debounce();
  */
 void test_pin_state(bool raw, bool interrupt, bool debounce);
 
+/**
+ * Tests whether the PinStats buckets aggregate changes correctly, and whether the GPIOHandler records changes in them.
+ * Expects pins test_main.IN_PIN and test_main.OUT_PIN to be connected.
+ */
+void test_pin_stats();
+
 #endif /* TEST_GPIOHANDLER_TEST_H_ */
@@ -0,0 +1,312 @@
+/*
+ * influx_exporter_test.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "influx_exporter_test.h"
+#include "test_main.h"
+#include <unity.h>
+#include <WiFi.h>
+
+AsyncWebServer influx_stand_in(INFLUX_TEST_PORT);
+std::vector<influx_request> influx_requests;
+std::mutex influx_requests_lock;
+volatile int influx_status = 204;
+
+/**
+ * The body of the request currently being received by the stand-in server.
+ */
+static std::string influx_body;
+
+void run_influx_tests() {
+	init_influx_stand_in();
+
+	RUN_TEST(test_influx_line_format);
+	RUN_TEST(test_influx_batching);
+	RUN_TEST(test_influx_retry);
+	RUN_TEST(test_influx_spill_limit);
+	RUN_TEST(test_influx_non_blocking);
+
+	influx_stand_in.end();
+	WiFi.disconnect(1, 1);
+}
+
+void init_influx_stand_in() {
+	WiFi.disconnect(1);
+
+	WiFi.mode(WIFI_AP);
+
+	WiFi.softAP("ESP WiFi GPIO Monitor Test", "This password doesn't matter.");
+
+	influx_stand_in.on("/write", HTTP_POST, [](AsyncWebServerRequest *request) {
+		influx_request received;
+		received.body = influx_body;
+		received.precision = request->arg("precision").c_str();
+		if (request->hasHeader("Authorization")) {
+			received.authorization = request->getHeader("Authorization")->value().c_str();
+		}
+		{
+			std::lock_guard<std::mutex> guard(influx_requests_lock);
+			influx_requests.push_back(received);
+		}
+		influx_body.clear();
+		request->send(influx_status);
+	}, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+		if (index == 0) {
+			influx_body.clear();
+		}
+		influx_body.append((char*) data, len);
+	});
+	influx_stand_in.begin();
+}
+
+size_t get_influx_request_count() {
+	std::lock_guard<std::mutex> guard(influx_requests_lock);
+	return influx_requests.size();
+}
+
+void handle_influx(InfluxExporter &exporter) {
+	exporter.handle();
+	const uint64_t start = millis();
+	while (exporter.isWriting()
+			&& millis() - start < InfluxExporter::WRITE_TIMEOUT * 2 + 500) {
+		delay(5);
+	}
+}
+
+void test_influx_line_format() {
+	{
+		std::lock_guard<std::mutex> guard(influx_requests_lock);
+		influx_requests.clear();
+	}
+	influx_status = 204;
+	gpio_handler.unregisterGPIO(IN_PIN_2);
+
+	InfluxExporter exporter(gpio_handler);
+	exporter.setSnapshotInterval(0);
+	exporter.setFlushInterval(0);
+	const pin_change change = { IN_PIN_2, true, 3, millis(), 1 };
+
+	// Make sure changes are ignored without a server.
+	exporter.record(change);
+	TEST_ASSERT_EQUAL_MESSAGE(0, exporter.getBufferedLines(),
+			"A change was recorded without a server.");
+
+	exporter.begin(INFLUX_TEST_URL, "esp test", "secret");
+	exporter.record(change);
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getBufferedLines(),
+			"The change wasn't recorded.");
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(1, get_influx_request_count(),
+			"The recorded line wasn't written.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getSuccessfulWrites(),
+			"The write wasn't counted as successful.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, exporter.getBufferedLines(),
+			"The written line wasn't removed from the buffer.");
+
+	std::lock_guard<std::mutex> guard(influx_requests_lock);
+	const influx_request &request = influx_requests.front();
+	const std::string expected = std::string("gpio_change,host=esp\\ test,pin=")
+			+ std::to_string(IN_PIN_2) + " state=1i,changes=3i";
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(expected.c_str(),
+			request.body.substr(0, expected.length()).c_str(),
+			"The change line didn't match the expected tags and fields.");
+	TEST_ASSERT_EQUAL_MESSAGE('\n', request.body.back(),
+			"The line wasn't terminated by a line feed.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("ms", request.precision.c_str(),
+			"The precision wasn't added to the url.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("Token secret", request.authorization.c_str(),
+			"The api token wasn't sent.");
+	exporter.end();
+}
+
+void test_influx_batching() {
+	{
+		std::lock_guard<std::mutex> guard(influx_requests_lock);
+		influx_requests.clear();
+	}
+	influx_status = 204;
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+
+	InfluxExporter exporter(gpio_handler);
+	exporter.setFlushInterval(500);
+	exporter.begin(INFLUX_TEST_URL, "esp-test");
+
+	// The first call records a snapshot, but doesn't write it yet.
+	handle_influx(exporter);
+	const pin_change change = { IN_PIN, true, 1, millis(), 1 };
+	for (uint8_t i = 0; i < 4; i++) {
+		exporter.record(change);
+	}
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(0, get_influx_request_count(),
+			"Lines were written before the flush interval expired.");
+
+	delay(600);
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(1, get_influx_request_count(),
+			"The buffered lines weren't written in a single request.");
+
+	std::lock_guard<std::mutex> guard(influx_requests_lock);
+	const std::string &body = influx_requests.front().body;
+	size_t changes = 0;
+	size_t start = 0;
+	bool snapshot = false;
+	while (start < body.length()) {
+		const size_t end = body.find('\n', start);
+		TEST_ASSERT_TRUE_MESSAGE(end != std::string::npos,
+				"A line wasn't terminated by a line feed.");
+		const std::string line = body.substr(start, end - start);
+		if (line.find("gpio_change,") == 0) {
+			changes++;
+		} else if (line.find("gpio_pin,host=esp-test,pin=" + std::to_string(IN_PIN)
+				+ ",name=Test\\ Pin state=") == 0) {
+			snapshot = true;
+		}
+		start = end + 1;
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(4, changes,
+			"The request didn't contain all recorded changes.");
+	TEST_ASSERT_TRUE_MESSAGE(snapshot,
+			"The request didn't contain a snapshot of the registered pin.");
+
+	exporter.end();
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_influx_retry() {
+	{
+		std::lock_guard<std::mutex> guard(influx_requests_lock);
+		influx_requests.clear();
+	}
+	influx_status = 503;
+
+	InfluxExporter exporter(gpio_handler);
+	exporter.setSnapshotInterval(0);
+	exporter.setFlushInterval(0);
+	exporter.begin(INFLUX_TEST_URL, "esp-test");
+
+	const pin_change change = { IN_PIN_2, false, 4, millis(), 1 };
+	exporter.record(change);
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(1, get_influx_request_count(),
+			"The line wasn't written.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getFailedWrites(),
+			"The failed write wasn't counted.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, exporter.getSpillSize(),
+			"The failed batch wasn't moved to the spill buffer.");
+
+	// Make sure the exporter waits before retrying.
+	exporter.record(change);
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(1, get_influx_request_count(),
+			"The failed write was retried without a delay.");
+
+	influx_status = 204;
+	delay(InfluxExporter::MIN_RETRY_DELAY + 100);
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(2, get_influx_request_count(),
+			"The failed write wasn't retried.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, exporter.getSpillSize(),
+			"The retried batch wasn't removed from the spill buffer.");
+	{
+		std::lock_guard<std::mutex> guard(influx_requests_lock);
+		TEST_ASSERT_EQUAL_STRING_MESSAGE(influx_requests[0].body.c_str(),
+				influx_requests[1].body.c_str(),
+				"The retried request didn't contain the failed batch.");
+	}
+
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(3, get_influx_request_count(),
+			"The line recorded while waiting wasn't written after the retry.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, exporter.getSuccessfulWrites(),
+			"The successful writes weren't counted.");
+
+	// Make sure lines rejected as invalid aren't retried.
+	influx_status = 400;
+	exporter.record(change);
+	handle_influx(exporter);
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getDroppedLines(),
+			"The rejected line wasn't dropped.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, exporter.getSpillSize(),
+			"The rejected line was moved to the spill buffer.");
+
+	influx_status = 204;
+	exporter.end();
+}
+
+void test_influx_spill_limit() {
+	InfluxExporter exporter(gpio_handler, 256, 512);
+	exporter.setSnapshotInterval(0);
+	exporter.setFlushInterval(60000);
+	exporter.begin(INFLUX_TEST_URL, "esp-test");
+
+	// Fill the line buffer multiple times, without ever writing it.
+	const pin_change change = { IN_PIN_2, true, 5, millis(), 1 };
+	for (uint8_t i = 0; i < 40; i++) {
+		exporter.record(change);
+	}
+	TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(512, exporter.getSpillSize(),
+			"The spill buffer grew past its max size.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, exporter.getSpillSize(),
+			"The full line buffer wasn't moved to the spill buffer.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, exporter.getDroppedLines(),
+			"The oldest spilled lines weren't dropped.");
+
+	std::string metrics;
+	exporter.appendMetrics(metrics);
+	const std::string dropped = "esp_influx_dropped_lines_total "
+			+ std::to_string(exporter.getDroppedLines()) + "\n";
+	TEST_ASSERT_TRUE_MESSAGE(metrics.find(dropped) != std::string::npos,
+			"The metrics didn't contain the dropped lines.");
+
+	exporter.end();
+	TEST_ASSERT_EQUAL_MESSAGE(0, exporter.getSpillSize(),
+			"Ending the exporter didn't clear the spill buffer.");
+}
+
+void test_influx_non_blocking() {
+	InfluxExporter exporter(gpio_handler);
+	exporter.setSnapshotInterval(0);
+	exporter.setFlushInterval(0);
+	// Use an address that is reserved for documentation, so it is never reachable.
+	exporter.begin(INFLUX_UNREACHABLE_URL, "esp-test");
+
+	// Make sure handle returns while the write request is still waiting for the server.
+	const pin_change change = { IN_PIN_2, true, 6, millis(), 1 };
+	exporter.record(change);
+	const uint32_t start = micros();
+	exporter.handle();
+	const uint32_t duration = micros() - start;
+	TEST_ASSERT_TRUE_MESSAGE(exporter.isWriting(),
+			"The write request wasn't started.");
+	TEST_ASSERT_LESS_THAN_MESSAGE(INFLUX_MAX_HANDLE_TIME, duration,
+			"Handle waited for the write request.");
+
+	// Make sure changes can be recorded while writing.
+	exporter.record(change);
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getBufferedLines(),
+			"The change wasn't recorded while writing.");
+	exporter.handle();
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getBufferedLines(),
+			"A second write request was started while writing.");
+
+	// Make sure the failed batch is kept for the next attempt.
+	const uint64_t wait_start = millis();
+	while (exporter.isWriting()
+			&& millis() - wait_start < InfluxExporter::WRITE_TIMEOUT * 2 + 500) {
+		delay(10);
+	}
+	TEST_ASSERT_FALSE_MESSAGE(exporter.isWriting(),
+			"The write request to the unreachable server didn't time out.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, exporter.getFailedWrites(),
+			"The failed write wasn't counted.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, exporter.getSpillSize(),
+			"The failed batch wasn't moved to the spill buffer.");
+
+	exporter.end();
+	TEST_ASSERT_FALSE_MESSAGE(exporter.isWriting(),
+			"Ending the exporter didn't stop the writer task.");
+}
@@ -0,0 +1,125 @@
+/*
+ * influx_exporter_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_INFLUX_EXPORTER_TEST_H_
+#define TEST_INFLUX_EXPORTER_TEST_H_
+
+#include "InfluxExporter.h"
+#include <ESPAsyncWebServer.h>
+#include <mutex>
+#include <vector>
+
+/**
+ * The port of the local http server standing in for the InfluxDB server.
+ */
+const uint16_t INFLUX_TEST_PORT = 8086;
+
+/**
+ * The write url of the local stand-in server.
+ */
+const char INFLUX_TEST_URL[] = "http://localhost:8086/write?db=test";
+
+/**
+ * A write url that is never reachable, since it uses an address reserved for documentation.
+ */
+const char INFLUX_UNREACHABLE_URL[] = "http://192.0.2.1:8086/write?db=test";
+
+/**
+ * The max time in microseconds a call to InfluxExporter::handle may take while the server is unreachable.
+ */
+const uint32_t INFLUX_MAX_HANDLE_TIME = 50000;
+
+/**
+ * A write request received by the stand-in server.
+ */
+struct influx_request {
+	/**
+	 * The lines sent in the request body.
+	 */
+	std::string body;
+
+	/**
+	 * The value of the precision parameter.
+	 */
+	std::string precision;
+
+	/**
+	 * The value of the Authorization header.
+	 */
+	std::string authorization;
+};
+
+/**
+ * The local http server standing in for the InfluxDB server.
+ * Records all write requests, and answers them with influx_status.
+ */
+extern AsyncWebServer influx_stand_in;
+
+/**
+ * The write requests received by the stand-in server, oldest first.
+ */
+extern std::vector<influx_request> influx_requests;
+
+/**
+ * The mutex synchronizing access to influx_requests.
+ */
+extern std::mutex influx_requests_lock;
+
+/**
+ * The status code the stand-in server answers write requests with.
+ */
+extern volatile int influx_status;
+
+/**
+ * Starts the test access point, and the stand-in server.
+ */
+void init_influx_stand_in();
+
+/**
+ * Gets the number of write requests received by the stand-in server.
+ *
+ * @return	The number of recorded requests.
+ */
+size_t get_influx_request_count();
+
+/**
+ * Calls handle on the given exporter, and waits for the write request it started to finish.
+ *
+ * @param exporter	The exporter to handle.
+ */
+void handle_influx(InfluxExporter &exporter);
+
+/**
+ * Tests whether pin changes are formatted as valid line protocol, and sent with the expected parameters and headers.
+ */
+void test_influx_line_format();
+
+/**
+ * Tests whether lines are combined into a single request until the flush interval expires,
+ * and whether pin state snapshots are recorded.
+ * Expects pin test_main.IN_PIN to be registrable.
+ */
+void test_influx_batching();
+
+/**
+ * Tests whether failed writes are moved to the spill buffer and retried after a delay,
+ * and whether rejected lines are dropped.
+ */
+void test_influx_retry();
+
+/**
+ * Tests whether the spill buffer size is limited, by dropping the oldest batches.
+ */
+void test_influx_spill_limit();
+
+/**
+ * Tests whether handle returns without waiting for a write request to an unreachable server,
+ * and whether changes can be recorded while a request is in progress.
+ */
+void test_influx_non_blocking();
+
+#endif /* TEST_INFLUX_EXPORTER_TEST_H_ */
@@ -0,0 +1,212 @@
+/*
+ * json_reader_test.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "json_reader_test.h"
+#include "test_main.h"
+#include "JSONWriter.h"
+#include <unity.h>
+#include <Arduino.h>
+
+void run_json_reader_tests() {
+	RUN_TEST(test_json_reader_structure);
+	RUN_TEST(test_json_reader_values);
+	RUN_TEST(test_json_reader_invalid);
+	RUN_TEST(fuzz_json_reader_strings);
+	RUN_TEST(fuzz_json_reader_truncated);
+}
+
+bool is_valid_json(const char *json) {
+	JSONReader reader(json, strlen(json));
+	return reader.skipValue() && reader.finished();
+}
+
+void test_json_reader_structure() {
+	const char json[] = " [{\"pin\": 4, \"skip\": {\"a\": [1, -2.5e3, null]}},\n{\"pin\": 5}, {}] ";
+	JSONReader reader(json, strlen(json));
+	TEST_ASSERT_EQUAL_MESSAGE(JSON_ARRAY, reader.peek(),
+			"The document wasn't detected as an array.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.beginArray(),
+			"Reading the start of the array failed.");
+
+	uint64_t pins[3] = { 0, 0, 0 };
+	uint8_t objects = 0;
+	char key[8];
+	while (reader.hasNext()) {
+		TEST_ASSERT_LESS_THAN_MESSAGE(3, objects,
+				"The array contained too many elements.");
+		TEST_ASSERT_TRUE_MESSAGE(reader.beginObject(),
+				"Reading the start of an object failed.");
+		while (reader.hasNext()) {
+			TEST_ASSERT_TRUE_MESSAGE(reader.readKey(key, sizeof(key)),
+					"Reading an object key failed.");
+			if (strcmp(key, "pin") == 0) {
+				TEST_ASSERT_TRUE_MESSAGE(reader.readUnsigned(pins[objects]),
+						"Reading a pin number failed.");
+			} else {
+				TEST_ASSERT_EQUAL_STRING_MESSAGE("skip", key,
+						"Read an unexpected object key.");
+				TEST_ASSERT_TRUE_MESSAGE(reader.skipValue(),
+						"Skipping a nested object failed.");
+			}
+		}
+		objects++;
+	}
+
+	TEST_ASSERT_FALSE_MESSAGE(reader.failed(),
+			"Reading a valid document failed.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.finished(),
+			"The reader didn't reach the end of the document.");
+	TEST_ASSERT_EQUAL_MESSAGE(3, objects,
+			"The array didn't contain the right number of objects.");
+	TEST_ASSERT_EQUAL_MESSAGE(4, pins[0], "The first pin number was wrong.");
+	TEST_ASSERT_EQUAL_MESSAGE(5, pins[1], "The second pin number was wrong.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, pins[2],
+			"The empty object contained a pin number.");
+}
+
+void test_json_reader_values() {
+	const char json[] = "[\"a\\\"\\\\\\/\\n\\u00e9\\ud83d\\ude00\", \"too long\", 18446744073709551615, true, false, null]";
+	JSONReader reader(json, strlen(json));
+	TEST_ASSERT_TRUE_MESSAGE(reader.beginArray(),
+			"Reading the start of the array failed.");
+
+	char buffer[16];
+	size_t length = 0;
+	TEST_ASSERT_TRUE_MESSAGE(reader.hasNext(), "The array was empty.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.readString(buffer, sizeof(buffer), &length),
+			"Reading an escaped string failed.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("a\"\\/\n\xc3\xa9\xf0\x9f\x98\x80", buffer,
+			"An escaped string was decoded incorrectly.");
+	TEST_ASSERT_EQUAL_MESSAGE(11, length,
+			"The length of an escaped string was wrong.");
+
+	TEST_ASSERT_TRUE_MESSAGE(reader.hasNext(), "The array ended early.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.readString(buffer, 4, &length),
+			"Reading a string that doesn't fit the buffer failed.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("too", buffer,
+			"A string that doesn't fit the buffer wasn't cut off correctly.");
+	TEST_ASSERT_EQUAL_MESSAGE(8, length,
+			"The full length of a cut off string was wrong.");
+
+	uint64_t number = 0;
+	TEST_ASSERT_TRUE_MESSAGE(reader.hasNext(), "The array ended early.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.readUnsigned(number),
+			"Reading the max unsigned integer failed.");
+	TEST_ASSERT_TRUE_MESSAGE(number == UINT64_MAX,
+			"The max unsigned integer was read incorrectly.");
+
+	bool value = false;
+	TEST_ASSERT_TRUE_MESSAGE(reader.hasNext(), "The array ended early.");
+	TEST_ASSERT_EQUAL_MESSAGE(JSON_BOOL, reader.peek(),
+			"A boolean wasn't detected as such.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.readBool(value), "Reading true failed.");
+	TEST_ASSERT_TRUE_MESSAGE(value, "True was read as false.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.hasNext(), "The array ended early.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.readBool(value), "Reading false failed.");
+	TEST_ASSERT_FALSE_MESSAGE(value, "False was read as true.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.hasNext(), "The array ended early.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.readNull(), "Reading null failed.");
+	TEST_ASSERT_FALSE_MESSAGE(reader.hasNext(),
+			"The array didn't end after the last value.");
+	TEST_ASSERT_TRUE_MESSAGE(reader.finished(),
+			"The reader didn't reach the end of the document.");
+
+	// Make sure reading the wrong type fails, and the reader stays failed.
+	const char string[] = "\"1\"";
+	JSONReader mismatch(string, strlen(string));
+	TEST_ASSERT_FALSE_MESSAGE(mismatch.readUnsigned(number),
+			"Reading a string as a number succeeded.");
+	TEST_ASSERT_TRUE_MESSAGE(mismatch.failed(),
+			"Reading the wrong type didn't mark the reader as failed.");
+	TEST_ASSERT_FALSE_MESSAGE(mismatch.readString(buffer, sizeof(buffer)),
+			"Reading from a failed reader succeeded.");
+}
+
+void test_json_reader_invalid() {
+	const char *valid[] = { "[]", "{}", "0", "\"\"", "-0.5E-2", "[[[]], {\"a\": {}}]",
+			" null " };
+	for (const char *json : valid) {
+		TEST_ASSERT_TRUE_MESSAGE(is_valid_json(json),
+				(String("Valid json \"") + json + "\" was rejected.").c_str());
+	}
+
+	const char *invalid[] = { "", "[", "[1,]", "[,1]", "[1 2]", "[1}",
+			"{\"a\"}", "{\"a\": 1,}", "{1: 2}", "01", "1.", "-", "tru",
+			"[1]]", "\"\\x\"", "\"\\udc00\"", "\"\\ud800\"", "\"a\nb\"",
+			"\"unterminated" };
+	for (const char *json : invalid) {
+		TEST_ASSERT_FALSE_MESSAGE(is_valid_json(json),
+				(String("Invalid json \"") + json + "\" was accepted.").c_str());
+	}
+
+	// Make sure nesting deeper than MAX_DEPTH is rejected.
+	char nested[2 * JSONReader::MAX_DEPTH + 3];
+	memset(nested, '[', JSONReader::MAX_DEPTH + 1);
+	memset(nested + JSONReader::MAX_DEPTH + 1, ']', JSONReader::MAX_DEPTH + 1);
+	nested[2 * JSONReader::MAX_DEPTH + 2] = 0;
+	TEST_ASSERT_FALSE_MESSAGE(is_valid_json(nested),
+			"Json nested deeper than MAX_DEPTH was accepted.");
+	nested[2 * JSONReader::MAX_DEPTH + 1] = 0;
+	TEST_ASSERT_TRUE_MESSAGE(is_valid_json(nested + 1),
+			"Json nested exactly MAX_DEPTH levels deep was rejected.");
+
+	// Make sure numbers that don't fit in 64 bits are rejected.
+	const char large[] = "18446744073709551616";
+	JSONReader reader(large, strlen(large));
+	uint64_t number = 0;
+	TEST_ASSERT_FALSE_MESSAGE(reader.readUnsigned(number),
+			"A number larger than 64 bits was accepted.");
+}
+
+void fuzz_json_reader_strings() {
+	randomSeed(2345);
+	char input[64];
+	char json[6 * sizeof(input) + 3];
+	char output[sizeof(input)];
+	for (uint16_t i = 0; i < JSON_READER_FUZZ_ITERATIONS; i++) {
+		const size_t length = random(sizeof(input));
+		for (size_t j = 0; j < length; j++) {
+			// Avoid null chars, since they end the string.
+			input[j] = random(1, 256);
+		}
+		input[length] = 0;
+
+		JSONWriter writer(json, sizeof(json));
+		writer.value(input);
+		JSONReader reader(json, writer.length());
+		size_t read = 0;
+		TEST_ASSERT_TRUE_MESSAGE(reader.readString(output, sizeof(output), &read),
+				"Reading a string written by the JSONWriter failed.");
+		TEST_ASSERT_EQUAL_MESSAGE(length, read,
+				"A string written by the JSONWriter was read with the wrong length.");
+		TEST_ASSERT_EQUAL_STRING_MESSAGE(input, output,
+				"A string written by the JSONWriter didn't decode to the original string.");
+		TEST_ASSERT_TRUE_MESSAGE(reader.finished(),
+				"The reader didn't reach the end of a string.");
+	}
+}
+
+void fuzz_json_reader_truncated() {
+	randomSeed(5432);
+	const char json[] = "{\"pins\": [{\"pin\": 4, \"name\": \"Door \\u00e9\", \"pull_up\": true}, {\"pin\": 16, \"changes\": -1.5e2, \"x\": null}]}";
+	const size_t guard = 16;
+	char buffer[sizeof(json) + guard];
+	for (uint16_t i = 0; i < JSON_READER_FUZZ_ITERATIONS; i++) {
+		const size_t length = random(sizeof(json) - 1);
+		memset(buffer, '[', sizeof(buffer));
+		memcpy(buffer, json, length);
+
+		// The chars after the end are a valid continuation, so reading them would be noticed.
+		JSONReader reader(buffer, length);
+		TEST_ASSERT_FALSE_MESSAGE(reader.skipValue() && reader.finished(),
+				"A truncated document was accepted.");
+	}
+
+	JSONReader reader(json, strlen(json));
+	TEST_ASSERT_TRUE_MESSAGE(reader.skipValue() && reader.finished(),
+			"The full document was rejected.");
+}
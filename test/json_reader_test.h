@@ -0,0 +1,51 @@
+/*
+ * json_reader_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_JSON_READER_TEST_H_
+#define TEST_JSON_READER_TEST_H_
+
+#include "JSONReader.h"
+
+/**
+ * The number of random inputs generated by each JSONReader fuzz test.
+ */
+const uint16_t JSON_READER_FUZZ_ITERATIONS = 2000;
+
+/**
+ * Checks whether the given document is valid json, by skipping it with a JSONReader.
+ *
+ * @param json	The document to check.
+ * @return	True if the whole document was skipped without errors.
+ */
+bool is_valid_json(const char *json);
+
+/**
+ * Tests whether nested objects and arrays are read correctly.
+ */
+void test_json_reader_structure();
+
+/**
+ * Tests whether strings, integers, booleans, and null are read correctly.
+ */
+void test_json_reader_values();
+
+/**
+ * Tests whether invalid documents are rejected.
+ */
+void test_json_reader_invalid();
+
+/**
+ * Writes random strings using a JSONWriter, and makes sure the JSONReader decodes them to the original string.
+ */
+void fuzz_json_reader_strings();
+
+/**
+ * Reads random prefixes of a valid document, and makes sure they are rejected without reading past their end.
+ */
+void fuzz_json_reader_truncated();
+
+#endif /* TEST_JSON_READER_TEST_H_ */
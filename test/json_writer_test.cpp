@@ -0,0 +1,280 @@
+/*
+ * json_writer_test.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "json_writer_test.h"
+#include "test_main.h"
+#include <unity.h>
+#include <Arduino.h>
+#include <sstream>
+
+std::string decode_json_string(const std::string &json) {
+	TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(2, json.length(),
+			"The json string was too short.");
+	TEST_ASSERT_EQUAL_MESSAGE('"', json[0],
+			"The json string didn't start with a quote.");
+	TEST_ASSERT_EQUAL_MESSAGE('"', json[json.length() - 1],
+			"The json string didn't end with a quote.");
+
+	std::string decoded;
+	for (size_t i = 1; i < json.length() - 1; i++) {
+		const uint8_t c = json[i];
+		TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(0x20, c,
+				"The json string contained an unescaped control char.");
+		TEST_ASSERT_NOT_EQUAL_MESSAGE('"', c,
+				"The json string contained an unescaped quote.");
+		if (c != '\\') {
+			decoded += (char) c;
+			continue;
+		}
+
+		TEST_ASSERT_LESS_THAN_MESSAGE(json.length() - 1, ++i,
+				"The json string ended with a backslash.");
+		switch (json[i]) {
+		case '"':
+		case '\\':
+			decoded += json[i];
+			break;
+		case 'n':
+			decoded += '\n';
+			break;
+		case 'r':
+			decoded += '\r';
+			break;
+		case 't':
+			decoded += '\t';
+			break;
+		case 'b':
+			decoded += '\b';
+			break;
+		case 'f':
+			decoded += '\f';
+			break;
+		case 'u':
+			TEST_ASSERT_LESS_THAN_MESSAGE(json.length() - 1, i + 4,
+					"The json string contained an incomplete unicode escape.");
+			decoded += (char) strtoul(json.substr(i + 1, 4).c_str(), NULL, 16);
+			i += 4;
+			break;
+		default:
+			TEST_FAIL_MESSAGE("The json string contained an invalid escape.");
+		}
+	}
+	return decoded;
+}
+
+void run_json_writer_tests() {
+	RUN_TEST(test_json_structure);
+	RUN_TEST(test_json_values);
+	RUN_TEST(test_json_escaping);
+	RUN_TEST(test_json_resume);
+	RUN_TEST(fuzz_json_strings);
+	RUN_TEST(fuzz_json_overflow);
+	RUN_TEST(benchmark_json_pin);
+}
+
+void test_json_structure() {
+	char buffer[128];
+	JSONWriter json(buffer, sizeof(buffer));
+	json.beginObject().key("a").beginArray().value(1u).value(2u).beginObject().endObject().endArray();
+	json.key("b").beginObject().key("c").beginArray().endArray().endObject().endObject();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("{\"a\": [1, 2, {}], \"b\": {\"c\": []}}",
+			buffer, "The JSONWriter wrote an invalid structure.");
+	TEST_ASSERT_EQUAL_MESSAGE(strlen(buffer), json.length(),
+			"The JSONWriter returned the wrong length.");
+	TEST_ASSERT_FALSE_MESSAGE(json.overflowed(),
+			"The JSONWriter overflowed a large enough buffer.");
+
+	JSONWriter lines(buffer, sizeof(buffer));
+	lines.beginArray().value(1u).lineBreak().value(2u).endArray();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("[1,\n2]", buffer,
+			"The JSONWriter didn't separate the elements using a line break.");
+}
+
+void test_json_values() {
+	char buffer[256];
+	JSONWriter json(buffer, sizeof(buffer));
+	json.beginArray().value(true).value(false).null().value((uint32_t) 0);
+	json.value(UINT64_MAX).value(INT64_MIN).value((int32_t) -42);
+	json.value(1.5, 2).value(-0.25, 1).value(0.001, 2).value(12.0, 0).endArray();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(
+			"[true, false, null, 0, 18446744073709551615, -9223372036854775808, -42, 1.50, -0.3, 0.00, 12]",
+			buffer, "The JSONWriter wrote a value incorrectly.");
+
+	char digits[20];
+	for (uint64_t value = 1; value < UINT64_MAX / 7; value = value * 7 + 3) {
+		const size_t length = JSONWriter::formatUnsigned(digits, value);
+		char expected[21];
+		snprintf(expected, sizeof(expected), "%llu", value);
+		TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(expected, digits, length,
+				"formatUnsigned didn't match snprintf.");
+		TEST_ASSERT_EQUAL_MESSAGE(strlen(expected), length,
+				"formatUnsigned returned the wrong length.");
+	}
+}
+
+void test_json_escaping() {
+	char buffer[128];
+	JSONWriter json(buffer, sizeof(buffer));
+	json.value("Quote\" Backslash\\ Newline\n Tab\t Bell\x07 Unicode \xC3\xA4");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(
+			"\"Quote\\\" Backslash\\\\ Newline\\n Tab\\t Bell\\u0007 Unicode \xC3\xA4\"",
+			buffer, "The JSONWriter didn't escape a string correctly.");
+
+	JSONWriter keys(buffer, sizeof(buffer));
+	keys.beginObject().key("a\"b").value((const char*) NULL).key((uint64_t) 34).value("").endObject();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("{\"a\\\"b\": null, \"34\": \"\"}", buffer,
+			"The JSONWriter didn't write keys correctly.");
+}
+
+void test_json_resume() {
+	char full[128];
+	JSONWriter json(full, sizeof(full));
+	json.beginObject().key("a").value(1u).lineBreak().key("b").value(2u).lineBreak().key(
+			"c").value(3u).endObject();
+
+	std::string parts;
+	char buffer[32];
+	JSONWriter first(buffer, sizeof(buffer));
+	first.beginObject().key("a").value(1u);
+	parts += buffer;
+	JSONWriter second(buffer, sizeof(buffer));
+	second.resume(true).lineBreak().key("b").value(2u);
+	parts += buffer;
+	JSONWriter third(buffer, sizeof(buffer));
+	third.resume(true).lineBreak().key("c").value(3u).endObject();
+	parts += buffer;
+
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(full, parts.c_str(),
+			"Writing a document in multiple parts didn't match writing it at once.");
+}
+
+void fuzz_json_strings() {
+	randomSeed(1234);
+	char input[64];
+	char output[6 * sizeof(input) + 3];
+	for (uint16_t i = 0; i < JSON_FUZZ_ITERATIONS; i++) {
+		const size_t length = random(sizeof(input));
+		for (size_t j = 0; j < length; j++) {
+			// Avoid null chars, since they end the string.
+			input[j] = random(1, 256);
+		}
+		input[length] = 0;
+
+		JSONWriter json(output, sizeof(output));
+		json.value(input);
+		TEST_ASSERT_FALSE_MESSAGE(json.overflowed(),
+				"Escaping a string needed more than 6 chars per input char.");
+		TEST_ASSERT_EQUAL_STRING_MESSAGE(input,
+				decode_json_string(std::string(output, json.length())).c_str(),
+				"A written json string didn't decode to the original string.");
+	}
+}
+
+void fuzz_json_overflow() {
+	randomSeed(4321);
+	const size_t guard = 16;
+	char buffer[128 + guard];
+	for (uint16_t i = 0; i < JSON_FUZZ_ITERATIONS; i++) {
+		const size_t size = random(128);
+		memset(buffer, 'X', sizeof(buffer));
+
+		JSONWriter json(buffer, size);
+		uint8_t depth = 0;
+		for (uint8_t j = 0; j < 20; j++) {
+			switch (random(6)) {
+			case 0:
+				json.beginArray();
+				depth++;
+				break;
+			case 1:
+				if (depth > 0) {
+					json.endArray();
+					depth--;
+				}
+				break;
+			case 2:
+				json.value((uint64_t) random(INT32_MAX));
+				break;
+			case 3:
+				json.value("Some \"string\"\n");
+				break;
+			case 4:
+				json.value(random(2) == 0);
+				break;
+			default:
+				json.lineBreak().value(random(-1000, 1000) / 7.0, 3);
+				break;
+			}
+		}
+
+		for (size_t j = size; j < sizeof(buffer); j++) {
+			TEST_ASSERT_EQUAL_MESSAGE('X', buffer[j],
+					"The JSONWriter wrote past the end of its buffer.");
+		}
+
+		if (size > 0) {
+			TEST_ASSERT_EQUAL_MESSAGE(json.length(), strlen(buffer),
+					"The JSONWriter output wasn't null terminated after its length.");
+			TEST_ASSERT_LESS_THAN_MESSAGE(size, json.length() + 1,
+					"The JSONWriter wrote more chars than fit in its buffer.");
+		} else {
+			TEST_ASSERT_TRUE_MESSAGE(json.overflowed(),
+					"The JSONWriter didn't overflow a buffer of size 0.");
+		}
+	}
+}
+
+void benchmark_json_pin() {
+	const char *name = "Benchmark Pin";
+	size_t stream_length = 0;
+	uint64_t start = micros();
+	for (uint16_t i = 0; i < JSON_BENCHMARK_ITERATIONS; i++) {
+		std::ostringstream stream;
+		stream << '"' << i % 40 << "\": {\"pin\": " << i % 40;
+		stream << ", \"name\": \"" << name;
+		stream << "\", \"pull_up\": " << (i % 2 == 0 ? "true" : "false");
+		stream << ", \"state\": \"" << (i % 3 == 0 ? "High" : "Low");
+		stream << "\", \"changes\": " << i * 1234567ull << '}';
+		stream_length += stream.str().length();
+	}
+	const uint64_t stream_time = micros() - start;
+
+	char buffer[160];
+	size_t snprintf_length = 0;
+	start = micros();
+	for (uint16_t i = 0; i < JSON_BENCHMARK_ITERATIONS; i++) {
+		snprintf_length += snprintf(buffer, sizeof(buffer),
+				"\"%hu\": {\"pin\": %hu, \"name\": \"%s\", \"pull_up\": %s, \"state\": \"%s\", \"changes\": %llu}",
+				(uint16_t) (i % 40), (uint16_t) (i % 40), name,
+				i % 2 == 0 ? "true" : "false", i % 3 == 0 ? "High" : "Low",
+				i * 1234567ull);
+	}
+	const uint64_t snprintf_time = micros() - start;
+
+	size_t writer_length = 0;
+	start = micros();
+	for (uint16_t i = 0; i < JSON_BENCHMARK_ITERATIONS; i++) {
+		JSONWriter json(buffer, sizeof(buffer));
+		json.key((uint64_t) (i % 40)).beginObject().key("pin").value(
+				(uint32_t) (i % 40)).key("name").value(name).key("pull_up").value(
+				i % 2 == 0).key("state").value(i % 3 == 0 ? "High" : "Low").key(
+				"changes").value((uint64_t) (i * 1234567ull)).endObject();
+		writer_length += json.length();
+	}
+	const uint64_t writer_time = micros() - start;
+
+	char message[160];
+	snprintf(message, sizeof(message),
+			"%hu pins: ostringstream %lluus, snprintf %lluus, JSONWriter %lluus",
+			JSON_BENCHMARK_ITERATIONS, stream_time, snprintf_time, writer_time);
+	TEST_MESSAGE(message);
+
+	TEST_ASSERT_EQUAL_MESSAGE(stream_length, snprintf_length,
+			"snprintf didn't generate the same output length as std::ostringstream.");
+	TEST_ASSERT_EQUAL_MESSAGE(stream_length, writer_length,
+			"The JSONWriter didn't generate the same output length as std::ostringstream.");
+}
@@ -0,0 +1,69 @@
+/*
+ * json_writer_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_JSON_WRITER_TEST_H_
+#define TEST_JSON_WRITER_TEST_H_
+
+#include "JSONWriter.h"
+#include <string>
+
+/**
+ * The number of random inputs generated by each fuzz test.
+ */
+const uint16_t JSON_FUZZ_ITERATIONS = 2000;
+
+/**
+ * The number of times each serializer is run per benchmark.
+ */
+const uint16_t JSON_BENCHMARK_ITERATIONS = 1000;
+
+/**
+ * Decodes a single json string, the way a json parser would.
+ * Only accepts the escapes the JSONWriter generates, and fails the current test for invalid strings.
+ *
+ * @param json	The json string to decode, including the quotes.
+ * @return	The decoded string.
+ */
+std::string decode_json_string(const std::string &json);
+
+/**
+ * Tests whether objects, arrays, and separators are written correctly.
+ */
+void test_json_structure();
+
+/**
+ * Tests whether integers, booleans, decimals, and null are written correctly.
+ */
+void test_json_values();
+
+/**
+ * Tests whether strings are escaped correctly.
+ */
+void test_json_escaping();
+
+/**
+ * Tests whether writing a document in multiple parts using resume generates the same output.
+ */
+void test_json_resume();
+
+/**
+ * Writes random strings, and makes sure they are decoded to the original string.
+ */
+void fuzz_json_strings();
+
+/**
+ * Writes random documents to buffers of random sizes,
+ * and makes sure the writer never writes past the end of the buffer.
+ */
+void fuzz_json_overflow();
+
+/**
+ * Compares the time it takes to serialize a pin using std::ostringstream, snprintf, and the JSONWriter.
+ */
+void benchmark_json_pin();
+
+#endif /* TEST_JSON_WRITER_TEST_H_ */
@@ -0,0 +1,131 @@
+/*
+ * metrics_benchmark.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "metrics_benchmark_test.h"
+#include "template_benchmark_test.h"
+#include "test_main.h"
+#include <unity.h>
+
+std::string render_metrics_uncached(const std::vector<pin_state> &pins) {
+	std::string metrics;
+	char line[160];
+	metrics += "# HELP esp_pin_state The current digital state of an ESP GPIO/GPI pin.\n";
+	metrics += "# TYPE esp_pin_state gauge\n";
+	for (const pin_state &state : pins) {
+		snprintf(line, sizeof(line), "esp_pin_state{pin=\"%hu\",name=\"%s\"} %hu\n",
+				(uint16_t) state.number, state.name.c_str(), (uint16_t) state.state);
+		metrics += line;
+	}
+
+	metrics += "# HELP esp_pin_state_changes The number of times the state of the ESP GPIO/GPI pin changed its state.\n";
+	metrics += "# TYPE esp_pin_state_changes counter\n";
+	for (const pin_state &state : pins) {
+		snprintf(line, sizeof(line), "esp_pin_state_changes{pin=\"%hu\",name=\"%s\"} %llu\n",
+				(uint16_t) state.number, state.name.c_str(), state.changes);
+		metrics += line;
+	}
+	return metrics;
+}
+
+uint64_t measure_uncached_scrape() {
+	const std::vector<pin_state> pins = create_benchmark_pins(METRICS_PINS);
+	size_t length = 0;
+	const uint64_t start = micros();
+	for (uint16_t i = 0; i < METRICS_ITERATIONS; i++) {
+		// The WebServerHandler copied the watched pins for every scrape.
+		const std::vector<pin_state> copy = pins;
+		length += render_metrics_uncached(copy).length();
+	}
+	const uint64_t time = (micros() - start) / METRICS_ITERATIONS;
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, length,
+			"The uncached metrics were empty.");
+	return time;
+}
+
+uint64_t measure_cached_scrape(const bool value_change,
+		const bool config_change) {
+	std::vector<pin_state> pins = create_benchmark_pins(METRICS_PINS);
+	MetricsCache cache;
+	uint32_t config_version = 1;
+	uint32_t sequence = 1;
+	cache.update(pins, NULL, config_version, sequence);
+
+	size_t length = 0;
+	const uint64_t start = micros();
+	for (uint16_t i = 0; i < METRICS_ITERATIONS; i++) {
+		if (config_change) {
+			config_version++;
+		}
+		if (value_change || config_change) {
+			pin_state &pin = pins[i % METRICS_PINS];
+			pin.state = !pin.state;
+			pin.changes++;
+			sequence++;
+		}
+
+		// Like MetricsCache::get, only copies the pins if something changed.
+		if (cache.isCurrent(NULL, config_version, sequence)) {
+			length += cache.update(pins, NULL, config_version, sequence)->length();
+		} else {
+			const std::vector<pin_state> copy = pins;
+			length += cache.update(copy, NULL, config_version, sequence)->length();
+		}
+	}
+	const uint64_t time = (micros() - start) / METRICS_ITERATIONS;
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, length, "The cached metrics were empty.");
+	return time;
+}
+
+void run_metrics_benchmarks() {
+	RUN_TEST(test_metrics_cache_output);
+	RUN_TEST(benchmark_metrics_30_pins);
+}
+
+void test_metrics_cache_output() {
+	std::vector<pin_state> pins = create_benchmark_pins(METRICS_PINS);
+	MetricsCache cache;
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(render_metrics_uncached(pins).c_str(),
+			cache.update(pins, NULL, 1, 1)->c_str(),
+			"The cached metrics differ from the uncached ones.");
+
+	// Make sure a value change without a config change updates the values.
+	pins[3].state = !pins[3].state;
+	pins[3].changes++;
+	TEST_ASSERT_FALSE_MESSAGE(cache.isCurrent(NULL, 1, 2),
+			"The metrics cache was current after a sequence change.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(render_metrics_uncached(pins).c_str(),
+			cache.update(pins, NULL, 1, 2)->c_str(),
+			"The cached metrics weren't updated after a value change.");
+
+	// Make sure removing a pin without a config version change still updates the labels.
+	pins.pop_back();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(render_metrics_uncached(pins).c_str(),
+			cache.update(pins, NULL, 1, 3)->c_str(),
+			"The cached metrics weren't updated after removing a pin.");
+
+	// Make sure there are no metrics without pins.
+	TEST_ASSERT_EQUAL_MESSAGE(0,
+			cache.update(std::vector<pin_state>(), NULL, 2, 4)->length(),
+			"The cached metrics weren't empty without pins.");
+}
+
+void benchmark_metrics_30_pins() {
+	const uint64_t uncached = measure_uncached_scrape();
+	const uint64_t unchanged = measure_cached_scrape(false, false);
+	const uint64_t value_change = measure_cached_scrape(true, false);
+	const uint64_t config_change = measure_cached_scrape(true, true);
+
+	char message[200];
+	snprintf(message, sizeof(message),
+			"%hu pins: uncached %lluus, cached unchanged %lluus, value change %lluus, config change %lluus",
+			(uint16_t) METRICS_PINS, uncached, unchanged, value_change,
+			config_change);
+	TEST_MESSAGE(message);
+
+	TEST_ASSERT_LESS_THAN_MESSAGE(uncached, unchanged,
+			"An unchanged cached scrape wasn't faster than an uncached one.");
+}
@@ -0,0 +1,60 @@
+/*
+ * metrics_benchmark_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_METRICS_BENCHMARK_TEST_H_
+#define TEST_METRICS_BENCHMARK_TEST_H_
+
+#include "GPIOHandler.h"
+#include "MetricsCache.h"
+#include <string>
+
+/**
+ * The number of scrapes measured per benchmark.
+ */
+const uint16_t METRICS_ITERATIONS = 50;
+
+/**
+ * The number of pins to generate the metrics for.
+ */
+const uint8_t METRICS_PINS = 30;
+
+/**
+ * Generates the pin metrics line by line, the way the WebServerHandler did before caching them.
+ *
+ * @param pins	The pins to generate the metrics for.
+ * @return	The generated metrics.
+ */
+std::string render_metrics_uncached(const std::vector<pin_state> &pins);
+
+/**
+ * Measures the average time it takes to generate the metrics for 30 pins without caching.
+ *
+ * @return	The average time per scrape, in microseconds.
+ */
+uint64_t measure_uncached_scrape();
+
+/**
+ * Measures the average time of a cached scrape.
+ *
+ * @param value_change	Whether a pin value changes before each scrape.
+ * @param config_change	Whether the pin configuration changes before each scrape.
+ * @return	The average time per scrape, in microseconds.
+ */
+uint64_t measure_cached_scrape(const bool value_change,
+		const bool config_change);
+
+/**
+ * Makes sure the cached metrics are identical to the uncached ones.
+ */
+void test_metrics_cache_output();
+
+/**
+ * Compares the scrape time with and without the metrics cache for 30 pins.
+ */
+void benchmark_metrics_30_pins();
+
+#endif /* TEST_METRICS_BENCHMARK_TEST_H_ */
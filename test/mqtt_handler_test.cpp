@@ -0,0 +1,194 @@
+/*
+ * mqtt_handler_test.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "mqtt_handler_test.h"
+#include "test_main.h"
+#include <unity.h>
+#include <WiFi.h>
+#include <vector>
+
+void run_mqtt_tests() {
+	init_mqtt_access_point();
+
+	RUN_TEST(test_mqtt_offline_queue);
+	RUN_TEST(test_mqtt_metrics);
+	RUN_TEST(test_mqtt_broker);
+
+	WiFi.disconnect(1, 1);
+}
+
+void init_mqtt_access_point() {
+	WiFi.disconnect(1);
+
+	WiFi.mode(WIFI_AP);
+
+	WiFi.softAP("ESP WiFi GPIO Monitor Test", "This password doesn't matter.");
+}
+
+/**
+ * Forwards the queued changes of the global GPIOHandler to the given MQTTHandler,
+ * and lets it send them, for the given time.
+ *
+ * @param handler	The MQTTHandler to forward the changes to.
+ * @param duration	The time in milliseconds to keep forwarding.
+ */
+static void pump_mqtt(MQTTHandler &handler, const uint32_t duration) {
+	const uint64_t start = millis();
+	pin_change change;
+	do {
+		while (gpio_handler.getNextChange(change)) {
+			handler.publish(change);
+		}
+		handler.handle();
+		delay(10);
+	} while (millis() - start < duration);
+}
+
+void test_mqtt_offline_queue() {
+	MQTTHandler handler(gpio_handler, 4);
+	const pin_change change = { IN_PIN, true, 1, millis(), 1 };
+
+	// Make sure changes are ignored without a broker.
+	handler.publish(change);
+	TEST_ASSERT_EQUAL_MESSAGE(0, handler.getQueueLength(),
+			"A change was queued without a broker.");
+
+	// Use an address that is reserved for documentation, so it is never reachable.
+	handler.begin("192.0.2.1", 1883, MQTT_TEST_PREFIX);
+	TEST_ASSERT_FALSE_MESSAGE(handler.isConnected(),
+			"The MQTTHandler connected to an unreachable broker.");
+	for (uint8_t i = 0; i < 6; i++) {
+		handler.publish(change);
+	}
+	handler.handle();
+	TEST_ASSERT_EQUAL_MESSAGE(4, handler.getQueueLength(),
+			"The offline queue wasn't limited to its max length.");
+	TEST_ASSERT_EQUAL_MESSAGE(2, handler.getDroppedChanges(),
+			"The changes that didn't fit in the queue weren't counted as dropped.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, handler.getPublishedMessages(),
+			"The MQTTHandler published messages without a broker connection.");
+
+	// Make sure ending the connection clears the queue.
+	handler.end();
+	TEST_ASSERT_EQUAL_MESSAGE(0, handler.getQueueLength(),
+			"Ending the MQTT connection didn't clear the queue.");
+}
+
+void test_mqtt_metrics() {
+	MQTTHandler handler(gpio_handler, 2);
+	handler.begin("192.0.2.1", 1883, MQTT_TEST_PREFIX);
+	const pin_change change = { IN_PIN, false, 2, millis(), 2 };
+	for (uint8_t i = 0; i < 3; i++) {
+		handler.publish(change);
+	}
+
+	std::string metrics;
+	handler.appendMetrics(metrics);
+	TEST_ASSERT_TRUE_MESSAGE(metrics.find("esp_mqtt_connected 0\n") != std::string::npos,
+			"The metrics didn't report the broker as disconnected.");
+	TEST_ASSERT_TRUE_MESSAGE(metrics.find("esp_mqtt_queue_length 2\n") != std::string::npos,
+			"The metrics didn't contain the queue length.");
+	TEST_ASSERT_TRUE_MESSAGE(metrics.find("esp_mqtt_dropped_changes_total 1\n") != std::string::npos,
+			"The metrics didn't contain the dropped changes.");
+	TEST_ASSERT_TRUE_MESSAGE(metrics.find("# TYPE esp_mqtt_publish_latency_seconds summary\n") != std::string::npos,
+			"The metrics didn't contain the publish latency.");
+	handler.end();
+}
+
+void test_mqtt_broker() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.unregisterGPIO(IN_PIN);
+
+	MQTTHandler handler(gpio_handler);
+	handler.setBatchInterval(200);
+	handler.begin(MQTT_TEST_BROKER, 1883, MQTT_TEST_PREFIX);
+	const uint64_t start = millis();
+	while (!handler.isConnected() && millis() - start < 15000) {
+		pump_mqtt(handler, 100);
+	}
+
+	if (!handler.isConnected()) {
+		handler.end();
+		TEST_IGNORE_MESSAGE("The test MQTT broker couldn't be reached.");
+	}
+
+	// Subscribe to the topics of the test pin using a second client.
+	std::mutex messages_lock;
+	std::vector<std::pair<std::string, std::string>> messages;
+	AsyncMqttClient subscriber;
+	subscriber.setServer(MQTT_TEST_BROKER, 1883);
+	subscriber.setClientId("esp-test-subscriber");
+	subscriber.onMessage([&messages_lock, &messages](char *topic, char *payload,
+			AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
+		std::lock_guard<std::mutex> guard(messages_lock);
+		messages.push_back(std::pair<std::string, std::string>(topic, std::string(payload, len)));
+	});
+	subscriber.connect();
+	while (!subscriber.connected() && millis() - start < 20000) {
+		delay(10);
+	}
+	TEST_ASSERT_TRUE_MESSAGE(subscriber.connected(),
+			"The subscriber couldn't connect to the test MQTT broker.");
+	const std::string state_topic = std::string(MQTT_TEST_PREFIX) + "/pins/"
+			+ std::to_string(IN_PIN) + "/state";
+	const std::string changes_topic = std::string(MQTT_TEST_PREFIX) + "/pins/"
+			+ std::to_string(IN_PIN) + "/changes";
+	subscriber.subscribe((std::string(MQTT_TEST_PREFIX) + "/pins/#").c_str(), 1);
+
+	// Make sure registering a pin publishes its initial state.
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	handler.publishConfigChange();
+	pump_mqtt(handler, 500);
+	size_t state_messages = 0;
+	{
+		std::lock_guard<std::mutex> guard(messages_lock);
+		for (const std::pair<std::string, std::string> &message : messages) {
+			if (message.first == state_topic) {
+				state_messages++;
+				TEST_ASSERT_EQUAL_STRING_MESSAGE("Low", message.second.c_str(),
+						"The initial pin state wasn't published correctly.");
+			}
+		}
+	}
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, state_messages,
+			"The state of the newly registered pin wasn't published.");
+
+	// Make sure rapid changes are combined into a single message per topic.
+	digitalWrite(OUT_PIN, HIGH);
+	delay(20);
+	digitalWrite(OUT_PIN, LOW);
+	delay(20);
+	digitalWrite(OUT_PIN, HIGH);
+	pump_mqtt(handler, 1000);
+	{
+		std::lock_guard<std::mutex> guard(messages_lock);
+		size_t new_state_messages = 0;
+		std::string last_state;
+		std::string last_changes;
+		for (const std::pair<std::string, std::string> &message : messages) {
+			if (message.first == state_topic) {
+				new_state_messages++;
+				last_state = message.second;
+			} else if (message.first == changes_topic) {
+				last_changes = message.second;
+			}
+		}
+		TEST_ASSERT_EQUAL_MESSAGE(state_messages + 1, new_state_messages,
+				"The rapid pin changes weren't combined into a single message.");
+		TEST_ASSERT_EQUAL_STRING_MESSAGE("High", last_state.c_str(),
+				"The latest pin state wasn't published.");
+		TEST_ASSERT_EQUAL_STRING_MESSAGE("3", last_changes.c_str(),
+				"The latest change counter wasn't published.");
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(0, handler.getQueueLength(),
+			"The published changes weren't removed from the queue.");
+
+	subscriber.disconnect();
+	handler.end();
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
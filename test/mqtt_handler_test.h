@@ -0,0 +1,50 @@
+/*
+ * mqtt_handler_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_MQTT_HANDLER_TEST_H_
+#define TEST_MQTT_HANDLER_TEST_H_
+
+#include "MQTTHandler.h"
+
+/**
+ * The address of the MQTT broker to use for the broker tests.
+ * Expected to be a Linux machine connected to the test access point, running a broker like mosquitto,
+ * that allows anonymous clients. For example using "mosquitto -c test.conf",
+ * with a config containing "listener 1883" and "allow_anonymous true".
+ * The broker tests are ignored if it can't be reached.
+ */
+const char MQTT_TEST_BROKER[] = "192.168.4.2";
+
+/**
+ * The topic prefix used by the MQTTHandler under test.
+ */
+const char MQTT_TEST_PREFIX[] = "esp-test";
+
+/**
+ * Starts the test access point the broker machine connects to.
+ */
+void init_mqtt_access_point();
+
+/**
+ * Tests whether changes are queued while the broker is unreachable,
+ * and the oldest changes are dropped once the queue is full.
+ */
+void test_mqtt_offline_queue();
+
+/**
+ * Tests whether the queue length, dropped changes, and connection state are reported in the metrics.
+ */
+void test_mqtt_metrics();
+
+/**
+ * Tests whether pin changes are published to the broker, with rapid changes combined into a single message.
+ * Ignored if the MQTT_TEST_BROKER can't be reached.
+ * Expects pins test_main.IN_PIN and test_main.OUT_PIN to be connected.
+ */
+void test_mqtt_broker();
+
+#endif /* TEST_MQTT_HANDLER_TEST_H_ */
@@ -0,0 +1,135 @@
+/*
+ * storage_benchmark.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "storage_benchmark_test.h"
+#include "test_main.h"
+#include "StorageHandler.h"
+#include <unity.h>
+#include <LITTLEFS.h>
+#include <SPIFFS.h>
+
+storage_benchmark_result run_storage_workload(StorageBackend &backend) {
+	StorageHandler storage(backend, benchmark_path, SPIFFS, NULL);
+	storage_benchmark_result result = { 0, 0, 0, 0, 0 };
+
+	// Only input pins, so registering them while loading has no side effects.
+	std::vector<pin_state> pins;
+	pins.push_back(pin_state(NULL, IN_PIN, "Benchmark Pin 1", false, false, 0));
+	pins.push_back(pin_state(NULL, IN_PIN_2, "Benchmark Pin 2", true, false, 0));
+	pins.push_back(pin_state(NULL, 35, "Benchmark Pin 3", false, false, 0));
+	pins.push_back(pin_state(NULL, 36, "Benchmark Pin 4", false, false, 0));
+	pins.push_back(pin_state(NULL, 39, "Benchmark Pin 5", false, false, 0));
+
+	backend.resetStats();
+	for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		for (pin_state &pin : pins) {
+			pin.changes += i * 17;
+		}
+
+		const uint64_t start = micros();
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, storage.storePins(pins),
+				"Storing pins failed during the benchmark.");
+		result.store_time += micros() - start;
+	}
+	result.bytes_written = backend.getStats().bytes_written;
+
+	for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		const uint64_t start = micros();
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, storage.loadGPIOHandler(gpio_handler),
+				"Loading pins failed during the benchmark.");
+		result.load_time += micros() - start;
+	}
+
+	for (pin_state &pin : gpio_handler.getWatchedPins()) {
+		gpio_handler.unregisterGPIO(pin.number);
+	}
+
+	result.store_time /= BENCHMARK_ITERATIONS;
+	result.load_time /= BENCHMARK_ITERATIONS;
+	return result;
+}
+
+void print_storage_benchmark(const char *name,
+		const storage_benchmark_result &result) {
+	char message[200];
+	snprintf(message, sizeof(message),
+			"%s: store %lluus, load %lluus, %llu bytes stored, %llu bytes on flash, mount %lluus",
+			name, result.store_time, result.load_time, result.bytes_written,
+			result.flash_bytes, result.mount_time);
+	TEST_MESSAGE(message);
+}
+
+void run_storage_benchmarks() {
+	StorageHandler *previous = gpio_handler.getStorageHandler();
+	gpio_handler.setStorageHandler(NULL);
+
+	RUN_TEST(benchmark_littlefs);
+	RUN_TEST(benchmark_spiffs);
+	RUN_TEST(benchmark_flash_simulator);
+
+	// SPIFFS is mounted again by benchmark_spiffs, but its previous content is lost.
+	gpio_handler.setStorageHandler(previous, false);
+}
+
+void benchmark_littlefs() {
+	SPIFFS.end();
+	TEST_ASSERT_MESSAGE(LITTLEFS.format(), "Formatting LittleFS failed.");
+	TEST_ASSERT_MESSAGE(LITTLEFS.begin(false), "Mounting LittleFS failed.");
+	LITTLEFS.mkdir("/bench");
+
+	FSStorageBackend backend(LITTLEFS);
+	const size_t used = LITTLEFS.usedBytes();
+	storage_benchmark_result result = run_storage_workload(backend);
+	result.flash_bytes = LITTLEFS.usedBytes() - used;
+
+	LITTLEFS.end();
+	const uint64_t start = micros();
+	TEST_ASSERT_MESSAGE(LITTLEFS.begin(false), "Remounting LittleFS failed.");
+	result.mount_time = micros() - start;
+	LITTLEFS.end();
+
+	print_storage_benchmark("LittleFS", result);
+}
+
+void benchmark_spiffs() {
+	TEST_ASSERT_MESSAGE(SPIFFS.format(), "Formatting SPIFFS failed.");
+	TEST_ASSERT_MESSAGE(SPIFFS.begin(false), "Mounting SPIFFS failed.");
+
+	FSStorageBackend backend(SPIFFS);
+	const size_t used = SPIFFS.usedBytes();
+	storage_benchmark_result result = run_storage_workload(backend);
+	result.flash_bytes = SPIFFS.usedBytes() - used;
+
+	SPIFFS.end();
+	const uint64_t start = micros();
+	TEST_ASSERT_MESSAGE(SPIFFS.begin(false), "Remounting SPIFFS failed.");
+	result.mount_time = micros() - start;
+	SPIFFS.remove(benchmark_path);
+
+	print_storage_benchmark("SPIFFS", result);
+}
+
+void benchmark_flash_simulator() {
+	MemoryFlashPartition flash(16 * 4096);
+	CountingFlashPartition counter(flash);
+	PartitionStorageBackend backend(&counter);
+	storage_benchmark_result result = run_storage_workload(backend);
+	result.flash_bytes = counter.getBytesWritten();
+
+	// A new backend has to scan the partition again, which is the equivalent of mounting it.
+	PartitionStorageBackend rescan(&counter);
+	std::string content;
+	const uint64_t start = micros();
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, rescan.read(benchmark_path, content),
+			"Reading the simulated partition failed after rescanning it.");
+	result.mount_time = micros() - start;
+
+	char name[50];
+	snprintf(name, sizeof(name), "Flash simulator(%u sectors erased)",
+			counter.getSectorsErased());
+	print_storage_benchmark(name, result);
+}
@@ -0,0 +1,89 @@
+/*
+ * storage_benchmark_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_STORAGE_BENCHMARK_TEST_H_
+#define TEST_STORAGE_BENCHMARK_TEST_H_
+
+#include "StorageBackend.h"
+
+/**
+ * The number of store and load operations per benchmark.
+ */
+const uint16_t BENCHMARK_ITERATIONS = 50;
+
+/**
+ * The path of the pin storage file to use for the benchmarks.
+ */
+const char benchmark_path[] = "/bench/pins.csv";
+
+/**
+ * The results of a single storage benchmark.
+ */
+struct storage_benchmark_result {
+	/**
+	 * The average time a storePins call took, in microseconds.
+	 */
+	uint64_t store_time;
+
+	/**
+	 * The average time a loadGPIOHandler call took, in microseconds.
+	 */
+	uint64_t load_time;
+
+	/**
+	 * The total number of bytes the StorageHandler gave to the backend.
+	 */
+	uint64_t bytes_written;
+
+	/**
+	 * The number of bytes physically written to the flash.
+	 * For file systems this is the increase in used bytes, since the actual flash writes can't be counted.
+	 */
+	uint64_t flash_bytes;
+
+	/**
+	 * The time it took to mount the file system, or scan the partition, in microseconds.
+	 */
+	uint64_t mount_time;
+};
+
+/**
+ * Runs the identical store and load workload on the given backend.
+ * Does not measure the mount time.
+ *
+ * @param backend	The backend to benchmark.
+ * @return	The measured results.
+ */
+storage_benchmark_result run_storage_workload(StorageBackend &backend);
+
+/**
+ * Prints the results of a benchmark using TEST_MESSAGE.
+ *
+ * @param name		The name of the benchmarked storage.
+ * @param result	The results to print.
+ */
+void print_storage_benchmark(const char *name,
+		const storage_benchmark_result &result);
+
+/**
+ * Benchmarks storing pins on LittleFS.
+ * Formats the shared file system partition.
+ */
+void benchmark_littlefs();
+
+/**
+ * Benchmarks storing pins on SPIFFS.
+ * Formats the shared file system partition, and leaves SPIFFS mounted.
+ */
+void benchmark_spiffs();
+
+/**
+ * Benchmarks storing pins in a raw flash partition simulated in RAM.
+ */
+void benchmark_flash_simulator();
+
+#endif /* TEST_STORAGE_BENCHMARK_TEST_H_ */
@@ -71,6 +71,13 @@ void run_storagehandler_tests() {
 	RUN_TEST(test_store);
 	RUN_TEST(test_load);
 	RUN_TEST(test_gpiohandler);
+	RUN_TEST(test_history);
+	RUN_TEST(test_history_week);
+	RUN_TEST(test_history_export);
+	RUN_TEST(test_partition);
+	RUN_TEST(test_raw_partition);
+	RUN_TEST(test_backends);
+	RUN_TEST(test_backend_fuzz);
 }
 
 void test_store() {
@@ -263,6 +270,16 @@ void test_load() {
 	check_pin_state(gpio_handler, IN_PIN_2, "Some Other Test Pin 2", true, true, 32715893);
 	check_pin_state(gpio_handler, 12, "III", false, false, 0);
 
+	// Test a pin stored twice only loading its first entry, instead of being removed.
+	storage_file = SPIFFS.open(storage_path, FILE_APPEND);
+	storage_file.printf("%hu,%s,%hu,%hu,%llu\n", IN_PIN, "Duplicate Pin", 1, 0, (uint64_t) 77);
+	storage_file.close();
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, storage.loadGPIOHandler(gpio_handler),
+			"Trying to load a file containing a duplicate pin returned an invalid status.");
+	TEST_ASSERT_EQUAL_MESSAGE(3, gpio_handler.getWatchedPins().size(),
+			"Loading a file containing a duplicate pin didn't keep watching three pins.");
+	check_pin_state(gpio_handler, IN_PIN, "Test Pin", false, false, 12);
+
 	// Remove registered pins for future tests.
 	gpio_handler.unregisterGPIO(IN_PIN);
 	gpio_handler.unregisterGPIO(IN_PIN_2);
@@ -390,3 +407,390 @@ void test_gpiohandler() {
 			file->at(0).c_str(),
 			"The first line of the storage file did not match the expected csv header.");
 }
+
+void test_history() {
+	// Delete the history file if it exists.
+	if (SPIFFS.exists(history_path)) {
+		SPIFFS.remove(history_path);
+	}
+
+	// Test querying an empty history.
+	PinHistory history(SPIFFS, history_path, 4);
+	history_record record;
+	PinHistory::Cursor empty(history, 0, UINT32_MAX);
+	TEST_ASSERT_FALSE_MESSAGE(empty.next(record),
+			"Querying an empty history returned a record.");
+
+	// Test querying records from the RAM page.
+	const uint32_t start = 1700000000;
+	for (uint32_t i = 0; i < 10; i++) {
+		TEST_ASSERT_MESSAGE(history.beginRecord(start + i * 60, 2),
+				"Starting a history record failed.");
+		history.appendPin(IN_PIN, i % 2, i, i * 1000);
+		history.appendPin(IN_PIN_2, false, 0, 0);
+		history.endRecord();
+	}
+	PinHistory::Cursor ram(history, start + 60, start + 120, IN_PIN);
+	TEST_ASSERT_MESSAGE(ram.next(record), "Querying the RAM page returned no record.");
+	TEST_ASSERT_EQUAL_MESSAGE(start + 60, record.time, "The first record in the range had the wrong time.");
+	TEST_ASSERT_EQUAL_MESSAGE(IN_PIN, record.pin, "The record was for the wrong pin.");
+	TEST_ASSERT_EQUAL_MESSAGE(true, record.state, "The record had the wrong state.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, record.changes, "The record had the wrong number of changes.");
+	TEST_ASSERT_EQUAL_MESSAGE(1000, record.high_time, "The record had the wrong high time.");
+	TEST_ASSERT_MESSAGE(ram.next(record), "Querying the RAM page returned only one record.");
+	TEST_ASSERT_EQUAL_MESSAGE(start + 120, record.time, "The second record in the range had the wrong time.");
+	TEST_ASSERT_FALSE_MESSAGE(ram.next(record), "Querying the RAM page returned a record outside the range.");
+
+	// Test reading the flushed page after reloading the history.
+	TEST_ASSERT_MESSAGE(history.flush(), "Flushing the history failed.");
+	PinHistory reloaded(SPIFFS, history_path, 4);
+	PinHistory::Cursor flushed(reloaded, 0, UINT32_MAX, IN_PIN_2);
+	uint32_t count = 0;
+	while (flushed.next(record)) {
+		TEST_ASSERT_EQUAL_MESSAGE(IN_PIN_2, record.pin, "The pin filter returned a record for another pin.");
+		count++;
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(10, count, "The reloaded history didn't contain all records.");
+
+	// Test wrapping around, only the newest pages should be kept.
+	uint32_t time = start + 10 * 60;
+	for (uint32_t i = 0; i < 1000; i++) {
+		TEST_ASSERT_MESSAGE(reloaded.beginRecord(time, 1),
+				"Starting a history record failed.");
+		reloaded.appendPin(IN_PIN, false, 100000, 60000);
+		reloaded.endRecord();
+		time += 60;
+	}
+	PinHistory::Cursor wrapped(reloaded, 0, UINT32_MAX);
+	uint32_t last = 0;
+	count = 0;
+	while (wrapped.next(record)) {
+		TEST_ASSERT_GREATER_THAN_MESSAGE(last, record.time, "The history records weren't returned in order.");
+		last = record.time;
+		count++;
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(time - 60, last, "The newest record wasn't returned last.");
+	TEST_ASSERT_LESS_THAN_MESSAGE(1000, count, "The history didn't drop old records when wrapping around.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, count, "The history didn't return any records after wrapping around.");
+
+	SPIFFS.remove(history_path);
+}
+
+void test_history_week() {
+	if (SPIFFS.exists(history_path)) {
+		SPIFFS.remove(history_path);
+	}
+
+	// Record a week of one minute intervals, which needs about 90 pages.
+	PinHistory history(SPIFFS, history_path, 128);
+	const uint32_t start = 1700000000;
+	for (uint32_t i = 0; i < HISTORY_WEEK_RECORDS; i++) {
+		TEST_ASSERT_MESSAGE(history.beginRecord(start + i * 60, 1),
+				"Starting a history record failed.");
+		history.appendPin(IN_PIN, i % 2, i, (i % 60) * 1000);
+		history.endRecord();
+	}
+	TEST_ASSERT_MESSAGE(history.flush(), "Flushing the history failed.");
+
+	// Query the entire week, reading every page from the flash.
+	history_record record;
+	uint32_t count = 0;
+	const uint64_t query_start = micros();
+	PinHistory::Cursor week(history, start,
+			start + (HISTORY_WEEK_RECORDS - 1) * 60, IN_PIN);
+	while (week.next(record)) {
+		count++;
+	}
+	const uint64_t query_time = micros() - query_start;
+
+	TEST_ASSERT_EQUAL_MESSAGE(HISTORY_WEEK_RECORDS, count,
+			"Querying a week didn't return every record.");
+	char message[80];
+	snprintf(message, sizeof(message), "Querying %u records took %lluus.",
+			count, query_time);
+	TEST_MESSAGE(message);
+	TEST_ASSERT_LESS_THAN_MESSAGE(HISTORY_WEEK_MAX_QUERY_TIME, query_time,
+			"Querying a week of history records took too long.");
+
+	SPIFFS.remove(history_path);
+}
+
+String read_export(HistoryExport &history_export) {
+	// Use a small buffer, so points are split across multiple chunks.
+	uint8_t buffer[16];
+	String result;
+	size_t length;
+	while ((length = history_export.fill(buffer, sizeof(buffer))) > 0) {
+		result.concat((const char*) buffer, length);
+	}
+	return result;
+}
+
+void test_history_export() {
+	if (SPIFFS.exists(history_path)) {
+		SPIFFS.remove(history_path);
+	}
+
+	PinHistory history(SPIFFS, history_path, 4);
+	const uint32_t start = 1700000000;
+	for (uint32_t i = 0; i < 10; i++) {
+		TEST_ASSERT_MESSAGE(history.beginRecord(start + i * 60, 2),
+				"Starting a history record failed.");
+		history.appendPin(IN_PIN, i % 2, i, i * 1000);
+		history.appendPin(IN_PIN_2, false, 0, 0);
+		history.endRecord();
+	}
+
+	// Make sure every record is its own point without a point count.
+	HistoryExport raw(history, start, start + 599, IN_PIN, 0, EXPORT_CSV);
+	String csv = read_export(raw);
+	TEST_ASSERT_TRUE_MESSAGE(csv.startsWith("Time,Pin,State,Records,Changes,High Time,Min Changes,Max Changes\n"),
+			"The csv export didn't start with its header.");
+	uint32_t lines = 0;
+	for (size_t i = 0; i < csv.length(); i++) {
+		if (csv[i] == '\n') {
+			lines++;
+		}
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(11, lines, "The export without a point count didn't contain every record.");
+	TEST_ASSERT_TRUE_MESSAGE(csv.indexOf(String(start + 540) + "," + IN_PIN + ",1,1,9,9000,9,9\n") >= 0,
+			"The export without a point count didn't contain the last record.");
+
+	// Make sure pairs of records are combined into a single point, keeping the min and max changes.
+	HistoryExport downsampled(history, start, start + 599, UINT8_MAX, 5, EXPORT_CSV);
+	csv = read_export(downsampled);
+	lines = 0;
+	for (size_t i = 0; i < csv.length(); i++) {
+		if (csv[i] == '\n') {
+			lines++;
+		}
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(11, lines, "The downsampled export didn't contain five points per pin.");
+	TEST_ASSERT_TRUE_MESSAGE(csv.indexOf(String(start + 60) + "," + IN_PIN + ",1,2,1,1000,0,1\n") >= 0,
+			"The first downsampled point didn't combine the first two records.");
+	TEST_ASSERT_TRUE_MESSAGE(csv.indexOf(String(start + 540) + "," + IN_PIN + ",1,2,17,17000,8,9\n") >= 0,
+			"The last downsampled point didn't combine the last two records.");
+
+	// Make sure the ndjson export contains one object per line.
+	HistoryExport ndjson(history, start, start + 599, IN_PIN, 1, EXPORT_NDJSON);
+	const String json = read_export(ndjson);
+	TEST_ASSERT_TRUE_MESSAGE(json.startsWith("{"), "The ndjson export didn't start with an object.");
+	TEST_ASSERT_EQUAL_MESSAGE(json.length() - 1, json.indexOf('\n'),
+			"The ndjson export with a single point contained more than one line.");
+	TEST_ASSERT_TRUE_MESSAGE(json.indexOf("\"records\": 10") >= 0,
+			"The single ndjson point didn't combine all records.");
+	TEST_ASSERT_TRUE_MESSAGE(json.indexOf("\"max_changes\": 9") >= 0,
+			"The single ndjson point had the wrong max changes.");
+
+	SPIFFS.remove(history_path);
+}
+
+void test_partition() {
+	// Delete the image file if it exists.
+	// The SPIFFS path is the virtual file system path without the "/spiffs" mount point.
+	SPIFFS.remove(partition_path + 7);
+
+	std::vector<pin_state> pins;
+	uint64_t partition_time = 0;
+	{
+		FileFlashPartition partition(partition_path, 4 * 4096);
+		StorageHandler partition_storage(partition, SPIFFS, NULL);
+
+		// Test loading from an empty partition.
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_NOT_FOUND,
+				partition_storage.loadGPIOHandler(gpio_handler),
+				"Loading pins from an empty partition returned an invalid status.");
+
+		// Test storing and loading pins.
+		digitalWrite(OUT_PIN, LOW);
+		pins.push_back(pin_state(NULL, IN_PIN, "Test Pin", false, false, 12));
+		pins.push_back(pin_state(NULL, IN_PIN_2, "Some Other Test Pin", true, true, 32715893));
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, partition_storage.storePins(pins),
+				"Storing pins to the partition failed.");
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, partition_storage.loadGPIOHandler(gpio_handler),
+				"Loading pins from the partition failed.");
+		TEST_ASSERT_EQUAL_MESSAGE(2, gpio_handler.getWatchedPins().size(),
+				"Loading two pins from the partition didn't cause the GPIOHandler to watch two pins.");
+		check_pin_state(gpio_handler, IN_PIN, "Test Pin", false, false, 12);
+		check_pin_state(gpio_handler, IN_PIN_2, "Some Other Test Pin", true, true, 32715893);
+
+		// Test rotating through all sectors, and measure the write latency.
+		pins.pop_back();
+		for (uint16_t i = 0; i < 400; i++) {
+			pins[0].changes = i;
+			const uint64_t start = micros();
+			TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, partition_storage.storePins(pins),
+					"Storing pins to the partition failed while rotating sectors.");
+			partition_time += micros() - start;
+		}
+	}
+
+	// Test the newest record surviving reopening the partition.
+	FileFlashPartition reopened(partition_path, 4 * 4096);
+	StorageHandler reopened_storage(reopened, SPIFFS, NULL);
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, reopened_storage.loadGPIOHandler(gpio_handler),
+			"Loading pins from the reopened partition failed.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, gpio_handler.getWatchedPins().size(),
+			"Loading the newest record didn't remove the second pin.");
+	check_pin_state(gpio_handler, IN_PIN, "Test Pin", false, false, 399);
+
+	uint64_t file_time = 0;
+	storage.setPinStoragePath(storage_path);
+	for (uint16_t i = 0; i < 400; i++) {
+		pins[0].changes = i;
+		const uint64_t start = micros();
+		storage.storePins(pins);
+		file_time += micros() - start;
+	}
+
+	char message[120];
+	snprintf(message, sizeof(message), "Average store latency: partition image on SPIFFS %lluus, SPIFFS file %lluus",
+			partition_time / 400, file_time / 400);
+	TEST_MESSAGE(message);
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+	SPIFFS.remove(partition_path + 7);
+	SPIFFS.remove(storage_path);
+}
+
+void test_raw_partition() {
+	EspFlashPartition partition(raw_partition_label);
+	if (!partition.begin()) {
+		TEST_IGNORE_MESSAGE("The raw pin storage partition doesn't exist in the partition table.");
+	}
+
+	StorageHandler partition_storage(partition, SPIFFS, NULL);
+	std::vector<pin_state> pins;
+	pins.push_back(pin_state(NULL, IN_PIN, "Test Pin", false, false, 0));
+
+	// Measure the write latency, rotating through all sectors.
+	uint64_t partition_time = 0;
+	for (uint16_t i = 0; i < 400; i++) {
+		pins[0].changes = i;
+		const uint64_t start = micros();
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, partition_storage.storePins(pins),
+				"Storing pins to the raw partition failed.");
+		partition_time += micros() - start;
+	}
+
+	digitalWrite(OUT_PIN, LOW);
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, partition_storage.loadGPIOHandler(gpio_handler),
+			"Loading pins from the raw partition failed.");
+	check_pin_state(gpio_handler, IN_PIN, "Test Pin", false, false, 399);
+
+	char message[80];
+	snprintf(message, sizeof(message), "Average store latency: raw partition %lluus",
+			partition_time / 400);
+	TEST_MESSAGE(message);
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+	TEST_ASSERT_TRUE_MESSAGE(partition.erase(0, partition.size()),
+			"Erasing the raw partition failed.");
+}
+
+void test_backends() {
+	MemoryStorageBackend memory;
+	StorageHandler memory_storage(memory, storage_path, SPIFFS, NULL);
+
+	// Test loading from an empty backend.
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_NOT_FOUND,
+			memory_storage.loadGPIOHandler(gpio_handler),
+			"Loading pins from an empty memory backend returned an invalid status.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, memory.getStats().reads,
+			"The failed read wasn't counted.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, memory.getStats().bytes_read,
+			"The failed read counted read bytes.");
+
+	// Test the write counters.
+	std::vector<pin_state> pins;
+	pins.push_back(pin_state(NULL, IN_PIN, "Test Pin", false, false, 12));
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, memory_storage.storePins(pins),
+			"Storing pins to the memory backend failed.");
+	std::string content;
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, memory.read(storage_path, content),
+			"Reading the stored file from the memory backend failed.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("Pin,Name,Resistor,State,Changes\r\n34,Test Pin,0,0,12\n",
+			content.c_str(), "The memory backend contained unexpected content.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, memory.getStats().writes,
+			"The write wasn't counted.");
+	TEST_ASSERT_EQUAL_MESSAGE(content.length(), memory.getStats().bytes_written,
+			"The written bytes weren't counted correctly.");
+	TEST_ASSERT_EQUAL_MESSAGE(content.length(), memory.getStats().bytes_read,
+			"The read bytes weren't counted correctly.");
+
+	// Test loading from the memory backend.
+	digitalWrite(OUT_PIN, LOW);
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, memory_storage.loadGPIOHandler(gpio_handler),
+			"Loading pins from the memory backend failed.");
+	check_pin_state(gpio_handler, IN_PIN, "Test Pin", false, false, 12);
+	gpio_handler.unregisterGPIO(IN_PIN);
+
+	// Test the injected latency.
+	memory.resetStats();
+	TEST_ASSERT_EQUAL_MESSAGE(0, memory.getStats().writes,
+			"Resetting the stats didn't reset the write counter.");
+	memory.setLatency(0, 5000);
+	uint64_t start = micros();
+	memory_storage.storePins(pins);
+	TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(5000, micros() - start,
+			"Storing pins to a backend with a write latency was faster than the latency.");
+	memory.setLatency(0, 0);
+
+	// Test the posix backend writing the same file as the SPIFFS backend.
+	SPIFFS.remove(storage_path);
+	PosixStorageBackend posix("/spiffs");
+	StorageHandler posix_storage(posix, storage_path, SPIFFS, NULL);
+	TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, posix_storage.storePins(pins),
+			"Storing pins using the posix backend failed.");
+	std::unique_ptr<std::vector<String>> file = read_file(SPIFFS, storage_path);
+	TEST_ASSERT_EQUAL_MESSAGE(2, file->size(),
+			"The number of lines of the storage file did not match what it should have been.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("Pin,Name,Resistor,State,Changes",
+			file->at(0).c_str(),
+			"The first line of the storage file did not match the expected csv header.");
+	check_pin_line(file->at(1).c_str(), &pins[0]);
+	TEST_ASSERT_MESSAGE(posix.remove(storage_path), "Removing the storage file using the posix backend failed.");
+	TEST_ASSERT_FALSE_MESSAGE(SPIFFS.exists(storage_path), "The storage file existed after removing it.");
+}
+
+void test_backend_fuzz() {
+	MemoryStorageBackend memory;
+	StorageHandler memory_storage(memory, storage_path, SPIFFS, NULL);
+	const char name_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-";
+	const uint8_t pin_numbers[] = { IN_PIN, IN_PIN_2 };
+
+	digitalWrite(OUT_PIN, LOW);
+	randomSeed(12345);
+	for (uint16_t i = 0; i < 100; i++) {
+		std::vector<pin_state> pins;
+		for (uint8_t pin : pin_numbers) {
+			if (random(3) == 0) {
+				continue;
+			}
+
+			String name;
+			const long length = random(3, 33);
+			for (long j = 0; j < length; j++) {
+				name += name_chars[random(sizeof(name_chars) - 1)];
+			}
+			const uint64_t changes = ((uint64_t) random(INT32_MAX) << 31) | random(INT32_MAX);
+			pins.push_back(pin_state(NULL, pin, name, random(2), random(2), changes));
+		}
+
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, memory_storage.storePins(pins),
+				"Storing random pins to the memory backend failed.");
+		TEST_ASSERT_EQUAL_MESSAGE(STORAGE_OK, memory_storage.loadGPIOHandler(gpio_handler),
+				"Loading random pins from the memory backend failed.");
+		TEST_ASSERT_EQUAL_MESSAGE(pins.size(), gpio_handler.getWatchedPins().size(),
+				"Loading random pins didn't cause the GPIOHandler to watch the stored number of pins.");
+		for (pin_state &pin : pins) {
+			const bool state = gpio_handler.getState(pin.number);
+			check_pin_state(gpio_handler, pin.number, pin.name.c_str(), pin.pull_up,
+					state, pin.state == state ? pin.changes : pin.changes + 1);
+		}
+	}
+
+	for (pin_state &pin : gpio_handler.getWatchedPins()) {
+		gpio_handler.unregisterGPIO(pin.number);
+	}
+}
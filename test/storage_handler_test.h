@@ -9,12 +9,28 @@
 #define TEST_STORAGE_HANDLER_TEST_H_
 
 #include "StorageHandler.h"
+#include "HistoryExport.h"
 
 /**
  * The path of the file to use for testing pin storage.
  */
 const char storage_path[] = "/test/pins.csv";
 
+/**
+ * The path of the file to use for testing the pin history.
+ */
+const char history_path[] = "/test/history.bin";
+
+/**
+ * The virtual file system path of the image file emulating a raw flash partition.
+ */
+const char partition_path[] = "/spiffs/test/flash.img";
+
+/**
+ * The label of the raw flash partition to test, from partitions_pinstore.csv.
+ */
+const char raw_partition_label[] = "pinstore";
+
 /**
  * The storage handler used for these unit tests.
  */
@@ -63,4 +79,64 @@ void test_load();
  */
 void test_gpiohandler();
 
+/**
+ * Tests appending to and querying the pin history ring, including wrapping around.
+ */
+void test_history();
+
+/**
+ * The number of one minute history records in a week.
+ */
+const uint32_t HISTORY_WEEK_RECORDS = 7 * 24 * 60;
+
+/**
+ * The max time in microseconds querying a week of history records may take.
+ */
+const uint32_t HISTORY_WEEK_MAX_QUERY_TIME = 500000;
+
+/**
+ * Tests whether querying a week of one minute history records from the flash takes well under a second.
+ */
+void test_history_week();
+
+/**
+ * Reads the entire given history export into a string.
+ *
+ * @param history_export	The export to read.
+ * @return	The content of the export.
+ */
+String read_export(HistoryExport &history_export);
+
+/**
+ * Tests exporting the pin history as csv and ndjson, with and without downsampling.
+ */
+void test_history_export();
+
+/**
+ * Tests storing and loading pins in a raw flash partition, emulated using an image file on SPIFFS.
+ * Also prints the write latency of the image file compared to storing the pins in a SPIFFS file.
+ * Neither says anything about the latency of a real raw partition, which is measured by test_raw_partition.
+ */
+void test_partition();
+
+/**
+ * Tests storing and loading pins in the real raw flash partition, and prints its write latency.
+ * Ignored if the partition table doesn't contain a partition labeled raw_partition_label,
+ * for example because the tests weren't built using partitions_pinstore.csv.
+ * Erases the partition afterwards.
+ */
+void test_raw_partition();
+
+/**
+ * Tests the storage backend counters and latency injection,
+ * and the posix backend writing the same file as the SPIFFS backend.
+ */
+void test_backends();
+
+/**
+ * Stores and loads randomly generated pin sets using an in-memory backend,
+ * and makes sure the loaded pins match the stored ones.
+ */
+void test_backend_fuzz();
+
 #endif /* TEST_STORAGE_HANDLER_TEST_H_ */
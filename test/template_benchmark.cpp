@@ -0,0 +1,250 @@
+/*
+ * template_benchmark.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#include "template_benchmark_test.h"
+#include "test_main.h"
+#include "HTMLTemplate.h"
+#include <unity.h>
+#include <regex>
+#include <sstream>
+
+/**
+ * The index.html page template, as it was before the pins were rendered by index.js.
+ */
+static const char BENCHMARK_PAGE_HTML[] =
+		"<!DOCTYPE html>\n"
+		"<html lang=\"en\">\n"
+		"<head>\n"
+		"<meta charset=\"utf-8\">\n"
+		"<meta name=\"author\" content=\"ToMe25\">\n"
+		"<meta name=\"description\"\n"
+		"\tcontent=\"A service to monitor the state of ESP GPIO/GPI pins.\">\n"
+		"<meta name=\"viewport\" content=\"width=device-width\">\n"
+		"<title>ESP WiFi GPIO Monitor</title>\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" href=\"/main.css?v=$version\">\n"
+		"<script type=\"text/javascript\" src=\"/index.js?v=$version\" defer></script>\n"
+		"</head>\n"
+		"<body>\n"
+		"\t<div class=\"main\">\n"
+		"\t\t<h1>ESP Pin States</h1>\n"
+		"\t\t<!-- Pin states start -->\n"
+		"\t\t$pins<!-- Pin states end -->\n"
+		"\t\t<h2>Settings</h2>\n"
+		"\t\t<span>Want to add or edit pins?</span><br />\n"
+		"\t\t<form action=\"/settings.html\">\n"
+		"\t\t\t<label>Click here: </label>\n"
+		"\t\t\t<button type=\"submit\">Settings</button>\n"
+		"\t\t</form>\n"
+		"\t</div>\n"
+		"</body>\n"
+		"</html>\n";
+
+/**
+ * The template for a single pin on the benchmark page.
+ */
+static const char BENCHMARK_PIN_HTML[] =
+		"<div class=\"state\">\n"
+		"\t<span class=\"value\">Name: <output name=\"name\">$name</output></span>\n"
+		"\t<span class=\"value\">Pin: <output name=\"pin\">$pin</output></span>\n"
+		"\t<span class=\"value\">Resistor: <output name=\"resistor\">$pull_up</output></span><br />\n"
+		"\t<span class=\"value\">State: <output name=\"state\" class=\"$statecolor\">$state</output></span>\n"
+		"\t<span class=\"value\">Changes: <output name=\"changes\">$changes</output></span>\n"
+		"</div>\n";
+
+/**
+ * The names of the benchmark template placeholders, indexed by their benchmark_placeholder value.
+ */
+static const char *const BENCHMARK_PLACEHOLDER_NAMES[BENCHMARK_PLACEHOLDER_COUNT] =
+		{ "pin", "name", "pull_up", "state", "changes", "pins", "version" };
+
+/**
+ * The task whose allocations are currently sampled, or NULL.
+ */
+static volatile TaskHandle_t tracked_task = NULL;
+
+/**
+ * The free heap when tracking was started.
+ */
+static size_t start_free_heap = 0;
+
+/**
+ * The lowest free heap seen since tracking was started.
+ */
+static size_t min_free_heap = 0;
+
+/**
+ * Only replaces the throwing operator new, and allocates using malloc without any header,
+ * so memory from any other operator new variant can still be freed by the default operator delete.
+ */
+void* operator new(size_t size) {
+	void *ptr = malloc(size);
+	if (ptr == NULL) {
+		abort();
+	}
+
+	if (tracked_task != NULL && tracked_task == xTaskGetCurrentTaskHandle()) {
+		min_free_heap = std::min<size_t>(min_free_heap, ESP.getFreeHeap());
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void start_allocation_tracking() {
+	start_free_heap = ESP.getFreeHeap();
+	min_free_heap = start_free_heap;
+	tracked_task = xTaskGetCurrentTaskHandle();
+}
+
+size_t stop_allocation_tracking() {
+	tracked_task = NULL;
+	return start_free_heap - min_free_heap;
+}
+
+std::vector<pin_state> create_benchmark_pins(const uint8_t count) {
+	std::vector<pin_state> pins;
+	char name[32];
+	for (uint8_t i = 0; i < count; i++) {
+		snprintf(name, sizeof(name), "Benchmark Pin %hu", (uint16_t) i);
+		pins.push_back(pin_state(NULL, i, name, i % 2 == 0, i % 3 == 0, i * 1234567ull));
+	}
+	return pins;
+}
+
+std::string render_index_regex(const std::vector<pin_state> &pins) {
+	std::string response(BENCHMARK_PAGE_HTML);
+
+	std::ostringstream converter;
+	std::string state_html;
+	std::regex pin("\\$pin");
+	std::regex name("\\$name");
+	std::regex pull_up("\\$pull_up");
+	std::regex state("\\$state");
+	std::regex changes("\\$changes");
+	std::regex end("[ \\t]*\\$pins<!-- Pin states end -->");
+	for (const pin_state &watched : pins) {
+		state_html = BENCHMARK_PIN_HTML;
+		converter << (uint16_t) watched.number;
+		state_html = std::regex_replace(state_html, pin, converter.str());
+		converter.str("");
+		converter.clear();
+		state_html = std::regex_replace(state_html, name, watched.name.c_str());
+		state_html = std::regex_replace(state_html, pull_up,
+				watched.pull_up ? "Pull Up" : "Pull Down");
+		state_html = std::regex_replace(state_html, state,
+				watched.state ? "High" : "Low");
+		converter << watched.changes;
+		state_html = std::regex_replace(state_html, changes, converter.str());
+		converter.str("");
+		converter.clear();
+		state_html += "$pins<!-- Pin states end -->";
+		response = std::regex_replace(response, end, state_html);
+	}
+	response.erase(response.find("$pins"), 5);
+
+	return response;
+}
+
+void set_pin_values(const pin_state &pin, char number[4], char changes[21],
+		const char *values[]) {
+	snprintf(number, 4, "%hu", (uint16_t) pin.number);
+	snprintf(changes, 21, "%llu", pin.changes);
+	values[BENCHMARK_PIN] = number;
+	values[BENCHMARK_NAME] = pin.name.c_str();
+	values[BENCHMARK_PULL_UP] = pin.pull_up ? "Pull Up" : "Pull Down";
+	values[BENCHMARK_STATE] = pin.state ? "High" : "Low";
+	values[BENCHMARK_CHANGES] = changes;
+}
+
+std::string render_index_template(const std::vector<pin_state> &pins) {
+	// Parsed once, like the templates of the WebServerHandler.
+	static const HTMLTemplate page(BENCHMARK_PAGE_HTML,
+			BENCHMARK_PLACEHOLDER_NAMES, BENCHMARK_PLACEHOLDER_COUNT);
+	static const HTMLTemplate pin_template(BENCHMARK_PIN_HTML,
+			BENCHMARK_PLACEHOLDER_NAMES, BENCHMARK_PLACEHOLDER_COUNT);
+
+	const char *page_values[BENCHMARK_PLACEHOLDER_COUNT] = { NULL };
+	const char *values[BENCHMARK_PLACEHOLDER_COUNT] = { NULL };
+	char number[4];
+	char changes[21];
+
+	size_t length = page.getLength(page_values);
+	for (const pin_state &pin : pins) {
+		set_pin_values(pin, number, changes, values);
+		length += pin_template.getLength(values);
+	}
+
+	std::string response;
+	response.reserve(length);
+	const size_t next = page.render(response, page_values, 0, BENCHMARK_PINS);
+	for (const pin_state &pin : pins) {
+		set_pin_values(pin, number, changes, values);
+		pin_template.render(response, values);
+	}
+	page.render(response, page_values, next);
+
+	return response;
+}
+
+template_benchmark_result run_template_workload(
+		std::string (*renderer)(const std::vector<pin_state>&),
+		const uint8_t pins) {
+	const std::vector<pin_state> states = create_benchmark_pins(pins);
+	template_benchmark_result result = { 0, 0, 0 };
+
+	// Render once before measuring, to parse the static templates.
+	result.length = renderer(states).length();
+
+	start_allocation_tracking();
+	const uint64_t start = micros();
+	for (uint16_t i = 0; i < TEMPLATE_ITERATIONS; i++) {
+		TEST_ASSERT_EQUAL_MESSAGE(result.length, renderer(states).length(),
+				"Rendering the same page twice resulted in different lengths.");
+	}
+	result.render_time = (micros() - start) / TEMPLATE_ITERATIONS;
+	result.peak_heap = stop_allocation_tracking();
+
+	return result;
+}
+
+void compare_renderers(const uint8_t pins) {
+	const template_benchmark_result regex = run_template_workload(
+			render_index_regex, pins);
+	const template_benchmark_result templ = run_template_workload(
+			render_index_template, pins);
+
+	char message[200];
+	snprintf(message, sizeof(message),
+			"%hu pins: regex %lluus %u bytes peak heap, template %lluus %u bytes peak heap, %u bytes page",
+			(uint16_t) pins, regex.render_time, regex.peak_heap,
+			templ.render_time, templ.peak_heap, templ.length);
+	TEST_MESSAGE(message);
+
+	// The regex renderer removes the indentation before the first pin.
+	TEST_ASSERT_EQUAL_MESSAGE(regex.length + 2, templ.length,
+			"The template renderer didn't generate the same page as the regex renderer.");
+}
+
+void run_template_benchmarks() {
+	RUN_TEST(benchmark_render_1_pin);
+	RUN_TEST(benchmark_render_10_pins);
+	RUN_TEST(benchmark_render_30_pins);
+}
+
+void benchmark_render_1_pin() {
+	compare_renderers(1);
+}
+
+void benchmark_render_10_pins() {
+	compare_renderers(10);
+}
+
+void benchmark_render_30_pins() {
+	compare_renderers(30);
+}
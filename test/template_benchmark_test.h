@@ -0,0 +1,135 @@
+/*
+ * template_benchmark_test.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ToMe25
+ */
+
+#ifndef TEST_TEMPLATE_BENCHMARK_TEST_H_
+#define TEST_TEMPLATE_BENCHMARK_TEST_H_
+
+#include "GPIOHandler.h"
+#include <string>
+
+/**
+ * The placeholders used in the benchmark templates.
+ */
+enum benchmark_placeholder {
+	BENCHMARK_PIN,
+	BENCHMARK_NAME,
+	BENCHMARK_PULL_UP,
+	BENCHMARK_STATE,
+	BENCHMARK_CHANGES,
+	BENCHMARK_PINS,
+	BENCHMARK_VERSION,
+	BENCHMARK_PLACEHOLDER_COUNT
+};
+
+/**
+ * The number of times each page is rendered per benchmark.
+ */
+const uint16_t TEMPLATE_ITERATIONS = 20;
+
+/**
+ * The results of rendering a page using one renderer.
+ */
+struct template_benchmark_result {
+	/**
+	 * The average time it took to render the page, in microseconds.
+	 */
+	uint64_t render_time;
+
+	/**
+	 * The maximum number of heap bytes in use at the same time while rendering the page, including allocator overhead.
+	 */
+	size_t peak_heap;
+
+	/**
+	 * The length of the rendered page.
+	 */
+	size_t length;
+};
+
+/**
+ * Starts measuring the peak heap use of the current task.
+ * The free heap is sampled after every allocation of the current task using operator new.
+ */
+void start_allocation_tracking();
+
+/**
+ * Stops measuring the peak heap use.
+ *
+ * @return	The largest drop of the free heap since tracking was started, in bytes.
+ */
+size_t stop_allocation_tracking();
+
+/**
+ * Creates the given number of pin states to render.
+ *
+ * @param count	The number of pins to create.
+ * @return	The created pin states.
+ */
+std::vector<pin_state> create_benchmark_pins(const uint8_t count);
+
+/**
+ * Writes the index page placeholder values for the given pin to the given values array.
+ *
+ * @param pin		The pin to get the values for.
+ * @param number	A buffer of at least 4 chars to write the pin number to.
+ * @param changes	A buffer of at least 21 chars to write the number of changes to.
+ * @param values	The placeholder values array to write to.
+ */
+void set_pin_values(const pin_state &pin, char number[4], char changes[21],
+		const char *values[]);
+
+/**
+ * Renders the index page using std::regex, the way the WebServerHandler used to.
+ *
+ * @param pins	The pins to render.
+ * @return	The rendered page.
+ */
+std::string render_index_regex(const std::vector<pin_state> &pins);
+
+/**
+ * Renders the index page using pre-parsed HTMLTemplates, the way the WebServerHandler renders its pages.
+ *
+ * @param pins	The pins to render.
+ * @return	The rendered page.
+ */
+std::string render_index_template(const std::vector<pin_state> &pins);
+
+/**
+ * Measures the render time and peak heap usage of a renderer for the given number of pins.
+ *
+ * @param renderer	The render function to measure.
+ * @param pins		The number of pins to render.
+ * @return	The measured results.
+ */
+template_benchmark_result run_template_workload(
+		std::string (*renderer)(const std::vector<pin_state>&),
+		const uint8_t pins);
+
+/**
+ * Compares rendering the index page for the given number of pins using both renderers.
+ * Prints the results using TEST_MESSAGE.
+ *
+ * @param pins	The number of pins to render.
+ */
+void compare_renderers(const uint8_t pins);
+
+/**
+ * Compares the renderers for a single pin.
+ */
+void benchmark_render_1_pin();
+
+/**
+ * Compares the renderers for 10 pins.
+ */
+void benchmark_render_10_pins();
+
+/**
+ * Compares the renderers for 30 pins.
+ */
+void benchmark_render_30_pins();
+
+#endif /* TEST_TEMPLATE_BENCHMARK_TEST_H_ */
@@ -14,8 +14,17 @@ void setup() {
 	UNITY_BEGIN();
 
 	run_gpiohandler_tests();
+	run_change_dispatcher_tests();
 	run_webserver_tests();
 	run_storagehandler_tests();
+	run_json_writer_tests();
+	run_json_reader_tests();
+	run_cbor_writer_tests();
+	run_mqtt_tests();
+	run_influx_tests();
+	run_template_benchmarks();
+	run_metrics_benchmarks();
+	run_storage_benchmarks();
 
 	UNITY_END();
 }
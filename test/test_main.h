@@ -44,6 +44,11 @@ void loop();
  */
 void run_gpiohandler_tests();
 
+/**
+ * The method running the ChangeDispatcher tests.
+ */
+void run_change_dispatcher_tests();
+
 /**
  * The method running all the WebServerHandler tests.
  */
@@ -54,4 +59,45 @@ void run_webserver_tests();
  */
 void run_storagehandler_tests();
 
+/**
+ * The method running the JSONWriter tests and benchmark.
+ */
+void run_json_writer_tests();
+
+/**
+ * The method running the JSONReader tests.
+ */
+void run_json_reader_tests();
+
+/**
+ * The method running the CBORWriter tests.
+ */
+void run_cbor_writer_tests();
+
+/**
+ * The method running the MQTTHandler tests.
+ */
+void run_mqtt_tests();
+
+/**
+ * The method running the InfluxExporter tests.
+ */
+void run_influx_tests();
+
+/**
+ * The method running the html template rendering benchmarks.
+ */
+void run_template_benchmarks();
+
+/**
+ * The method running the metrics cache benchmarks.
+ */
+void run_metrics_benchmarks();
+
+/**
+ * The method running the storage backend benchmarks.
+ * Has to run after all other tests, since it formats the file system partition.
+ */
+void run_storage_benchmarks();
+
 #endif /* TEST_TEST_MAIN_H_ */
@@ -8,11 +8,15 @@
 #include "web_server_test.h"
 #include "test_main.h"
 #include "GPIOHandler.h"
+#include "StorageHandler.h"
+#include "cbor_writer_test.h"
 #include <unity.h>
 #include <ESPmDNS.h>
+#include <SPIFFS.h>
 #include <HTTPClient.h> // Somehow this include is required for the one in the header to work
 
 WebServerHandler web_server;
+ChangeDispatcher web_dispatcher;
 HTTPClient client;
 
 std::unique_ptr<std::vector<std::string>> split_lines(const char *page) {
@@ -162,167 +166,22 @@ void check_index_pin_line(const std::string *line, const char *line_type,
 					" line for the given pin was not correct.").c_str());
 }
 
-void check_index_pin(const char *index_page, const uint8_t pin_nr,
-		const char *pin_name, const bool pull_up, const bool state,
-		const uint64_t changes) {
-	// Split page into its lines.
-	const std::unique_ptr<std::vector<std::string>> lines = split_lines(
-			index_page);
-
-	size_t i = 0;
-	for (; i < lines->size(); i++) {
-		if (lines->at(i) == "<div class=\"state\">") {
-			// Confirm there being enough lines left for a valid pin section.
-			TEST_ASSERT_LESS_THAN_MESSAGE(lines->size(), i + 6,
-					"There are not enough lines left in the index.html page after the start of a pin section.");
-
-			// Test that the second line is a pin number line.
-			const char *pin_nr_pattern = "<span class=\"value\">Pin: <output name=\"pin\">D</output></span>";
-			const char *pin_nr_line = lines->at(i + 2).c_str();
-			for (size_t i = 0; i < strlen(pin_nr_pattern) && i < strlen(pin_nr_line); i++) {
-				if (pin_nr_pattern[i] != *pin_nr_line) {
-					if (pin_nr_pattern[i] == 'D' && isDigit(*pin_nr_line)) {
-						if (isDigit(pin_nr_line[1])) {
-							pin_nr_line++;
-						}
-					} else {
-						TEST_FAIL_MESSAGE(
-								"The second line after the start of the pin section was not a pin number line.");
-					}
-				}
-				pin_nr_line++;
-			}
-
-			// Make sure this pin section is for the correct pin.
-			std::unique_ptr<std::ostringstream> str(new std::ostringstream());
-			*str << "<span class=\"value\">Pin: <output name=\"pin\">";
-			*str << (uint16_t) pin_nr << "</output></span>";
-			if (str->str() == lines->at(i + 2)) {
-				// Make sure all lines are generated correctly.
-				check_index_pin_line(&lines->at(++i), "Name", pin_name);
-				check_index_pin_line(&lines->at(++i), "Pin", (uint64_t) pin_nr);
-				check_index_pin_line(&lines->at(++i), "Resistor",
-						pull_up ? "Pull Up" : "Pull Down");
-				check_index_pin_line(&lines->at(++i), "State",
-						state ? "High" : "Low");
-				check_index_pin_line(&lines->at(++i), "Changes", changes);
-
-				return;
-			} else {
-				continue;
-			}
-		}
-	}
-
-	std::unique_ptr<std::ostringstream> str(new std::ostringstream());
-	*str << "The pin section for pin ";
-	*str << (uint16_t) pin_nr;
-	*str << " could not be found in the given index.html page.";
-	TEST_FAIL_MESSAGE(str->str().c_str());
-}
-
-void check_settings_pin(const char *settings_page, const uint8_t pin_nr,
-		const char *name, const bool pull_up, const bool state,
-		const uint64_t changes) {
-	// Split page into its lines.
-	const std::unique_ptr<std::vector<std::string>> lines = split_lines(
-			settings_page);
-
-	// The correct lines for all those lines that do not contain dynamic info.
-	std::unique_ptr<std::vector<std::string>> correct_lines = split_lines(
-			SETTINGS_PIN_HTML);
-
-	// Check for the pin block for the given pin.
-	size_t i = 0;
-	for (; i < lines->size(); i++) {
-		if (lines->at(i)
-				== "<form class=\"state\" method=\"post\" action=\"/settings.html\">") {
-			// Confirm there being enough lines left for a valid pin section.
-			TEST_ASSERT_LESS_THAN_MESSAGE(lines->size(), i + 21,
-					"There are not enough lines left in the settings.html page after the start of a pin section.");
-
-			// Make sure this pin section is for the correct pin.
-			std::unique_ptr<std::ostringstream> str(new std::ostringstream());
-			*str << "name=\"pin\" value=\"";
-			*str << (uint16_t) pin_nr;
-			*str
-					<< "\" max=\"39\" min=\"0\" title=\"The hardware pin to watch.\"";
-			if (str->str() == lines->at(i + 7)) {
-				for (uint8_t j = 1; j < 22; j++) {
-					std::string line;
-					switch (j) {
-					case 2:
-						*str = std::ostringstream();
-						*str << "name=\"name\" value=\"";
-						*str << name << '"';
-						line = str->str();
-						break;
-					case 7:
-						*str = std::ostringstream();
-						*str << "name=\"pin\" value=\"";
-						*str << (uint16_t) pin_nr;
-						*str
-								<< "\" max=\"39\" min=\"0\" title=\"The hardware pin to watch.\"";
-						line = str->str();
-						break;
-					case 12:
-						*str = std::ostringstream();
-						*str
-								<< "alt=\"The pin will use an internal pull up resistor.\" ";
-						if (pull_up) {
-							*str << "checked";
-						}
-						*str << "><label>Pull";
-						line = str->str();
-						break;
-					case 15:
-						*str = std::ostringstream();
-						*str
-								<< "alt=\"The pin will use an internal pull down resistor.\" ";
-						if (!pull_up) {
-							*str << "checked";
-						}
-						*str << "><label>Pull";
-						line = str->str();
-						break;
-					case 17:
-						*str = std::ostringstream();
-						*str
-								<< "<span class=\"value\">State: <output name=\"state\" class=\"";
-						*str << (state ? "High" : "Low");
-						*str << "color\">";
-						*str << (state ? "High" : "Low");
-						*str << "</output></span>";
-						line = str->str();
-						break;
-					case 18:
-						*str = std::ostringstream();
-						*str
-								<< "<span class=\"value\">Changes: <output name=\"changes\">";
-						*str << changes;
-						*str << "</output></span><br />";
-						line = str->str();
-						break;
-					default:
-						line = correct_lines->at(j);
-					}
-
-					TEST_ASSERT_EQUAL_STRING_MESSAGE(line.c_str(),
-							lines->at(i + j).c_str(),
-							"The current line in the pin section didn't match what it should have been.");
-				}
-
-				return;
-			} else {
-				continue;
-			}
+void check_watched_pin(const uint8_t pin_nr, const char *name,
+		const bool pull_up) {
+	for (const pin_state &pin : gpio_handler.getWatchedPins()) {
+		if (pin.number == pin_nr) {
+			TEST_ASSERT_EQUAL_STRING_MESSAGE(name, pin.name.c_str(),
+					"A watched pin had the wrong name.");
+			TEST_ASSERT_EQUAL_MESSAGE(pull_up, pin.pull_up,
+					"A watched pin had the wrong resistor.");
+			return;
 		}
 	}
 
 	std::unique_ptr<std::ostringstream> str(new std::ostringstream());
-	*str << "The pin section for pin ";
+	*str << "Pin ";
 	*str << (uint16_t) pin_nr;
-	*str << " could not be found in the given settings.html page.";
+	*str << " isn't being watched.";
 	TEST_FAIL_MESSAGE(str->str().c_str());
 }
 
@@ -416,14 +275,33 @@ void init_web_server() {
 	MDNS.begin("esp-test");
 
 	web_server.setup();
+	web_dispatcher.onChange(
+			std::bind(&WebServerHandler::publish, &web_server,
+					std::placeholders::_1));
+	web_dispatcher.onConfigChange(
+			std::bind(&WebServerHandler::publishConfigChange, &web_server));
 }
 
 void run_webserver_tests() {
 	init_web_server();
 
 	RUN_TEST(test_static_pages);
+	RUN_TEST(test_static_caching);
 	RUN_TEST(test_metrics_endpoint);
+	RUN_TEST(test_request_stats);
+	RUN_TEST(test_system_metrics);
+	RUN_TEST(test_admission_control);
+	RUN_TEST(test_api_pins);
 	RUN_TEST(test_pins_json);
+	RUN_TEST(test_pins_json_since);
+	RUN_TEST(test_pins_cbor);
+	RUN_TEST(test_state_etags);
+	RUN_TEST(test_events);
+	RUN_TEST(test_web_socket);
+	RUN_TEST(test_api_wait);
+	RUN_TEST(test_wait_wraparound);
+	RUN_TEST(test_api_stats);
+	RUN_TEST(test_history_endpoints);
 	RUN_TEST(test_index_html);
 	RUN_TEST(test_settings_html);
 	RUN_TEST(test_delete_html);
@@ -469,6 +347,54 @@ void test_static_pages() {
 	client.end();
 }
 
+void test_static_caching() {
+	// Make sure main.css is sent gzip compressed, with an ETag.
+	client.begin("http://localhost/main.css");
+	const char *headerkeys[] = { "Content-Encoding", "ETag", "Cache-Control" };
+	const size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
+	client.collectHeaders(headerkeys, headerkeyssize);
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /main.css did not return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("gzip",
+			client.header("Content-Encoding").c_str(),
+			"Get /main.css did not return content encoding gzip.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			client.header("Cache-Control").indexOf("max-age=") >= 0,
+			"Get /main.css did not return a max age cache control header.");
+	const String etag = client.header("ETag");
+	TEST_ASSERT_EQUAL_MESSAGE(10, etag.length(),
+			"Get /main.css did not return a valid ETag.");
+	client.end();
+
+	// Make sure requesting main.css with its ETag returns not modified.
+	client.begin("http://localhost/main.css");
+	client.collectHeaders(headerkeys, headerkeyssize);
+	client.addHeader("If-None-Match", etag);
+	TEST_ASSERT_EQUAL_MESSAGE(304, client.GET(),
+			"Get /main.css with a matching ETag did not return http status code 304.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(etag.c_str(), client.header("ETag").c_str(),
+			"Get /main.css with a matching ETag returned a different ETag.");
+	client.end();
+
+	// Make sure requesting main.css with a different ETag returns the file.
+	client.begin("http://localhost/main.css");
+	client.addHeader("If-None-Match", "\"00000000\"");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /main.css with an outdated ETag did not return http status code 200.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, client.getString().length(),
+			"Get /main.css with an outdated ETag returned an empty page.");
+	client.end();
+
+	// Make sure the ETags of different files are different.
+	client.begin("http://localhost/index.js");
+	client.collectHeaders(headerkeys, headerkeyssize);
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /index.js did not return http status code 200.");
+	TEST_ASSERT_FALSE_MESSAGE(etag == client.header("ETag"),
+			"/index.js has the same ETag as /main.css.");
+	client.end();
+}
+
 void test_metrics_endpoint() {
 	// Init http client and output pin.
 	const char *url = "http://localhost/metrics";
@@ -485,9 +411,10 @@ void test_metrics_endpoint() {
 			client.header("Content-Type").c_str(),
 			"The metrics endpoint did not return content type text/plain.");
 
-	// Make sure the metrics endpoint doesn't return any data if there is no registered pin.
-	TEST_ASSERT_EQUAL_MESSAGE(0, client.getSize(),
-			"Metrics endpoint did not return an empty string.");
+	// Make sure the metrics endpoint doesn't return any pin metrics if there is no registered pin.
+	TEST_ASSERT_LESS_THAN_MESSAGE(0,
+			client.getString().indexOf("esp_pin_state"),
+			"Metrics endpoint returned pin metrics without a registered pin.");
 
 	// Make sure that the metrics endpoint returns data after registering a pin to watch.
 	digitalWrite(OUT_PIN, LOW);
@@ -544,6 +471,297 @@ void test_metrics_endpoint() {
 	gpio_handler.unregisterGPIO(IN_PIN);
 }
 
+void test_request_stats() {
+	const RequestStats &stats = web_server.getRequestStats();
+	const uint32_t pins_json_requests = stats.getRequests(ENDPOINT_PINS_JSON);
+	const uint32_t not_found_requests = stats.getRequests(ENDPOINT_NOT_FOUND);
+
+	// Make sure each handled request is counted once.
+	client.begin("http://localhost/pins.json");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.json did not return http status code 200.");
+	client.end();
+	TEST_ASSERT_EQUAL_MESSAGE(pins_json_requests + 1,
+			stats.getRequests(ENDPOINT_PINS_JSON),
+			"A request to /pins.json wasn't counted once.");
+
+	client.begin("http://localhost/does_not_exist.html");
+	TEST_ASSERT_EQUAL_MESSAGE(404, client.GET(),
+			"Get /does_not_exist.html did not return http status code 404.");
+	client.end();
+	TEST_ASSERT_EQUAL_MESSAGE(not_found_requests + 1,
+			stats.getRequests(ENDPOINT_NOT_FOUND),
+			"A request to a missing page wasn't counted once.");
+
+	// Make sure the stats are exported on the metrics endpoint.
+	client.begin("http://localhost/metrics");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Metrics endpoint didn't return http status 200 OK.");
+	const String metrics = client.getString();
+	client.end();
+	const String pins_json_line = String(
+			"esp_http_requests_total{endpoint=\"/pins.json\",code=\"200\"} ")
+			+ (pins_json_requests + 1) + '\n';
+	TEST_ASSERT_TRUE_MESSAGE(metrics.indexOf(pins_json_line) >= 0,
+			"The metrics didn't contain the number of pins.json requests.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			metrics.indexOf(
+					"esp_http_requests_total{endpoint=\"not_found\",code=\"404\"} ")
+					>= 0,
+			"The metrics didn't contain the number of not found requests.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			metrics.indexOf(
+					String("esp_http_handler_duration_seconds_bucket{endpoint=\"/pins.json\",le=\"+Inf\"} ")
+							+ (pins_json_requests + 1) + '\n') >= 0,
+			"The metrics didn't contain the pins.json handler duration histogram.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			metrics.indexOf("esp_http_response_bytes_total{endpoint=\"/pins.json\"} ")
+					>= 0,
+			"The metrics didn't contain the pins.json response bytes.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			metrics.indexOf("esp_http_handler_heap_peak_bytes{endpoint=\"/pins.json\"} ")
+					>= 0,
+			"The metrics didn't contain the pins.json heap usage.");
+}
+
+void test_system_metrics() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	const uint32_t pin_interrupts = gpio_handler.getPinInterrupts();
+	const uint32_t timer_interrupts = gpio_handler.getTimerInterrupts();
+
+	// Make sure pin changes are counted by the interrupt counters.
+	for (uint8_t i = 0; i < 4; i++) {
+		digitalWrite(OUT_PIN, i % 2 == 0 ? HIGH : LOW);
+		delay(50);
+	}
+	TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(pin_interrupts + 4,
+			gpio_handler.getPinInterrupts(),
+			"The pin interrupts weren't counted.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(timer_interrupts,
+			gpio_handler.getTimerInterrupts(),
+			"The debounce timer interrupts weren't counted.");
+
+	// Make sure the system metrics are exported on the metrics endpoint.
+	client.begin("http://localhost/metrics");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Metrics endpoint didn't return http status 200 OK.");
+	const String metrics = client.getString();
+	client.end();
+	const char *lines[] = { "\nesp_uptime_seconds ",
+			"\nesp_reset_reason{reason=\"", "\nesp_heap_free_bytes ",
+			"\nesp_heap_largest_free_block_bytes ",
+			"\nesp_heap_min_free_bytes ", "\nesp_wifi_reconnects_total ",
+			"\nesp_debounce_timer_interrupts_total " };
+	for (const char *line : lines) {
+		TEST_ASSERT_TRUE_MESSAGE(metrics.indexOf(line) >= 0,
+				(String("The metrics didn't contain the line \"") + (line + 1) + "\".").c_str());
+	}
+
+	const int interrupts_start = metrics.indexOf("\nesp_pin_interrupts_total ");
+	TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(0, interrupts_start,
+			"The metrics didn't contain the number of pin interrupts.");
+	TEST_ASSERT_EQUAL_MESSAGE(gpio_handler.getPinInterrupts(),
+			metrics.substring(interrupts_start + 26).toInt(),
+			"The metrics contained the wrong number of pin interrupts.");
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_admission_control() {
+	AdmissionControl &admission = web_server.getAdmissionControl();
+	const admission_limits page_limits = admission.getLimits(REQUEST_PAGE);
+	const uint32_t heap_rejections = admission.getRejections(ENDPOINT_SETTINGS,
+			ADMISSION_LOW_HEAP);
+	const uint32_t busy_rejections = admission.getRejections(ENDPOINT_SETTINGS,
+			ADMISSION_BUSY);
+	const char *headerkeys[] = { "Retry-After" };
+	const size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
+
+	// Make sure pages are rejected if the heap is too low.
+	admission.setLimits(REQUEST_PAGE,
+			{ page_limits.max_renders, UINT32_MAX, 0 });
+	client.begin("http://localhost/settings.html");
+	client.collectHeaders(headerkeys, headerkeyssize);
+	TEST_ASSERT_EQUAL_MESSAGE(503, client.GET(),
+			"Get /settings.html with a low heap didn't return http status code 503.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("5", client.header("Retry-After").c_str(),
+			"The low heap response had an invalid Retry-After header.");
+	client.end();
+	TEST_ASSERT_EQUAL_MESSAGE(heap_rejections + 1,
+			admission.getRejections(ENDPOINT_SETTINGS, ADMISSION_LOW_HEAP),
+			"The low heap rejection wasn't counted.");
+
+	// Make sure the api still has priority over the pages.
+	client.begin("http://localhost/pins.json");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.json with a low page heap limit didn't return http status code 200.");
+	client.end();
+
+	// Make sure pages are rejected if too many responses are in flight.
+	admission.setLimits(REQUEST_PAGE, { 0, 0, 0 });
+	client.begin("http://localhost/settings.html");
+	client.collectHeaders(headerkeys, headerkeyssize);
+	TEST_ASSERT_EQUAL_MESSAGE(503, client.GET(),
+			"Get /settings.html without a free render slot didn't return http status code 503.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("1", client.header("Retry-After").c_str(),
+			"The busy response had an invalid Retry-After header.");
+	client.end();
+	TEST_ASSERT_EQUAL_MESSAGE(busy_rejections + 1,
+			admission.getRejections(ENDPOINT_SETTINGS, ADMISSION_BUSY),
+			"The busy rejection wasn't counted.");
+
+	// Make sure static assets are never rejected.
+	client.begin("http://localhost/main.css");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /main.css without a free render slot didn't return http status code 200.");
+	client.end();
+	client.begin("http://localhost/index.html");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /index.html without a free render slot didn't return http status code 200.");
+	client.end();
+
+	admission.setLimits(REQUEST_PAGE, page_limits);
+	client.begin("http://localhost/settings.html");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /settings.html with the default limits didn't return http status code 200.");
+	client.end();
+
+	// Make sure the render slots are released when the clients disconnect.
+	delay(50);
+	TEST_ASSERT_EQUAL_MESSAGE(0, admission.getActiveRenders(),
+			"The render slots weren't released after the requests finished.");
+
+	// Make sure the rejections are exported on the metrics endpoint.
+	client.begin("http://localhost/metrics");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Metrics endpoint didn't return http status 200 OK.");
+	const String metrics = client.getString();
+	client.end();
+	const String heap_line = String(
+			"esp_http_rejected_requests_total{endpoint=\"/settings.html\",reason=\"low_heap\"} ")
+			+ (heap_rejections + 1) + '\n';
+	TEST_ASSERT_TRUE_MESSAGE(metrics.indexOf(heap_line) >= 0,
+			"The metrics didn't contain the number of low heap rejections.");
+	const String busy_line = String(
+			"esp_http_rejected_requests_total{endpoint=\"/settings.html\",reason=\"busy\"} ")
+			+ (busy_rejections + 1) + '\n';
+	TEST_ASSERT_TRUE_MESSAGE(metrics.indexOf(busy_line) >= 0,
+			"The metrics didn't contain the number of busy rejections.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			metrics.indexOf("esp_http_requests_total{endpoint=\"/settings.html\",code=\"503\"} ")
+					>= 0,
+			"The request stats didn't contain the rejected requests.");
+}
+
+void test_api_pins() {
+	// Make sure pins aren't still registered from failed tests.
+	gpio_handler.unregisterGPIO(IN_PIN_2);
+	gpio_handler.unregisterGPIO(IN_PIN);
+
+	// Make sure multiple pins are registered in a single transaction.
+	uint32_t config_version = gpio_handler.getConfigVersion();
+	client.begin("http://localhost/api/pins");
+	client.addHeader("Content-Type", "application/json");
+	TEST_ASSERT_EQUAL_MESSAGE(200,
+			client.PATCH(
+					String("[{\"pin\": ") + IN_PIN
+							+ ", \"name\": \"Api Pin\", \"pull_up\": true}, {\"pin\": "
+							+ IN_PIN_2 + ", \"name\": \"Api Pin 2\"}]"),
+			"Registering two pins using PATCH /api/pins didn't return http status code 200.");
+	String response = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(response.indexOf("\"applied\": true") >= 0,
+			"The api response didn't report the pins as applied.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			response.indexOf(String("{\"pin\": ") + IN_PIN + ", \"result\": \"ok\"}") >= 0,
+			"The api response didn't contain the result of the first pin.");
+	TEST_ASSERT_EQUAL_MESSAGE(config_version + 1,
+			gpio_handler.getConfigVersion(),
+			"Registering two pins didn't change the config version exactly once.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			gpio_handler.isWatched(IN_PIN) && gpio_handler.isWatched(IN_PIN_2),
+			"The pins registered using the api weren't watched.");
+	for (const pin_state &pin : gpio_handler.getWatchedPins()) {
+		if (pin.number == IN_PIN || pin.number == IN_PIN_2) {
+			TEST_ASSERT_TRUE_MESSAGE(pin.pull_up == (pin.number == IN_PIN),
+					"The pull up setting of a pin wasn't applied.");
+		}
+	}
+
+	// Make sure an invalid pin prevents all changes.
+	config_version = gpio_handler.getConfigVersion();
+	client.begin("http://localhost/api/pins");
+	client.addHeader("Content-Type", "application/json");
+	TEST_ASSERT_EQUAL_MESSAGE(400,
+			client.PATCH(
+					String("[{\"pin\": ") + IN_PIN
+							+ ", \"name\": \"Renamed\"}, {\"pin\": 6, \"name\": \"Flash Pin\"}]"),
+			"A PATCH /api/pins request with a flash pin didn't return http status code 400.");
+	response = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(
+			response.indexOf("{\"pin\": 6, \"result\": \"flash_pin\"") >= 0,
+			"The api response didn't contain the flash pin error.");
+	TEST_ASSERT_EQUAL_MESSAGE(config_version, gpio_handler.getConfigVersion(),
+			"A failed api request changed the config version.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("Api Pin",
+			gpio_handler.getName(IN_PIN).c_str(),
+			"A failed api request renamed a valid pin.");
+
+	// Make sure invalid json is rejected.
+	client.begin("http://localhost/api/pins");
+	client.addHeader("Content-Type", "application/json");
+	TEST_ASSERT_EQUAL_MESSAGE(400, client.PUT("[{\"pin\": }"),
+			"A PUT /api/pins request with invalid json didn't return http status code 400.");
+	response = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(response.indexOf("\"error\": ") >= 0,
+			"The response to invalid json didn't contain an error.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			gpio_handler.isWatched(IN_PIN) && gpio_handler.isWatched(IN_PIN_2),
+			"A PUT request with invalid json unregistered pins.");
+
+	// Make sure the watched pins can be read.
+	client.begin("http://localhost/api/pins");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"GET /api/pins didn't return http status code 200.");
+	response = client.getString();
+	client.end();
+	TEST_ASSERT_EQUAL_MESSAGE('[', response[0],
+			"GET /api/pins didn't return a json array.");
+	TEST_ASSERT_TRUE_MESSAGE(response.indexOf("\"name\": \"Api Pin 2\"") >= 0,
+			"GET /api/pins didn't contain the second pin.");
+
+	// Make sure multiple pins are unregistered in a single transaction.
+	config_version = gpio_handler.getConfigVersion();
+	client.begin("http://localhost/api/pins");
+	client.addHeader("Content-Type", "application/json");
+	TEST_ASSERT_EQUAL_MESSAGE(200,
+			client.sendRequest("DELETE",
+					String("[") + IN_PIN + ", " + IN_PIN_2 + "]"),
+			"Unregistering two pins using DELETE /api/pins didn't return http status code 200.");
+	client.end();
+	TEST_ASSERT_EQUAL_MESSAGE(config_version + 1,
+			gpio_handler.getConfigVersion(),
+			"Unregistering two pins didn't change the config version exactly once.");
+	TEST_ASSERT_FALSE_MESSAGE(
+			gpio_handler.isWatched(IN_PIN) || gpio_handler.isWatched(IN_PIN_2),
+			"The pins unregistered using the api were still watched.");
+
+	// Make sure unregistering a pin that isn't watched fails.
+	client.begin("http://localhost/api/pins");
+	client.addHeader("Content-Type", "application/json");
+	TEST_ASSERT_EQUAL_MESSAGE(400,
+			client.sendRequest("DELETE", String("[") + IN_PIN + "]"),
+			"Unregistering a pin that isn't watched didn't return http status code 400.");
+	response = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(response.indexOf("\"result\": \"not_watched\"") >= 0,
+			"The api response didn't report the pin as not watched.");
+}
+
 void test_pins_json() {
 	// Make sure pins.json returns status code 200 and content type application/json
 	const char *url = "http://localhost/pins.json";
@@ -596,15 +814,664 @@ void test_pins_json() {
 	gpio_handler.unregisterGPIO(IN_PIN);
 }
 
+void test_state_etags() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.checkPins();
+
+	bool state = false;
+	const char *headerkeys[] = { "ETag" };
+	const size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
+	const char *urls[] = { "http://localhost/pins.json" };
+	for (const char *url : urls) {
+		// Make sure the endpoint returns a weak ETag.
+		client.begin(url);
+		client.collectHeaders(headerkeys, headerkeyssize);
+		TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+				(String("Get ") + url + " did not return http status code 200.").c_str());
+		const String etag = client.header("ETag");
+		client.end();
+		TEST_ASSERT_TRUE_MESSAGE(etag.startsWith("W/\""),
+				(String("Get ") + url + " did not return a weak ETag.").c_str());
+
+		// Make sure requesting it again with the ETag returns not modified.
+		client.begin(url);
+		client.addHeader("If-None-Match", etag);
+		TEST_ASSERT_EQUAL_MESSAGE(304, client.GET(),
+				(String("Get ") + url + " with a matching ETag did not return http status code 304.").c_str());
+		TEST_ASSERT_EQUAL_MESSAGE(0, client.getString().length(),
+				(String("Get ") + url + " with a matching ETag returned content.").c_str());
+		client.end();
+
+		// Make sure a pin state change changes the ETag.
+		state = !state;
+		digitalWrite(OUT_PIN, state ? HIGH : LOW);
+		delay(50);
+		gpio_handler.checkPins();
+		client.begin(url);
+		client.collectHeaders(headerkeys, headerkeyssize);
+		client.addHeader("If-None-Match", etag);
+		TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+				(String("Get ") + url + " with an outdated ETag did not return http status code 200.").c_str());
+		TEST_ASSERT_FALSE_MESSAGE(etag == client.header("ETag"),
+				(String("Get ") + url + " returned the same ETag after a pin change.").c_str());
+		client.end();
+	}
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_pins_json_since() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.checkPins();
+
+	// Make sure since=0 returns all pins and the current sequence number.
+	client.begin("http://localhost/pins.json?since=0");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.json?since=0 did not return http status code 200.");
+	String pins_json = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(
+			pins_json.indexOf(String("\"") + IN_PIN + "\": {") >= 0,
+			"pins.json?since=0 did not contain the registered pin.");
+	const int seq_start = pins_json.indexOf("\"sequence\": ");
+	TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(0, seq_start,
+			"pins.json?since=0 did not contain the sequence number.");
+	const uint32_t sequence = pins_json.substring(seq_start + 12).toInt();
+	TEST_ASSERT_EQUAL_MESSAGE(gpio_handler.getChangeSequence(), sequence,
+			"pins.json?since=0 returned the wrong sequence number.");
+
+	// Make sure nothing is returned if nothing changed.
+	const String url = String("http://localhost/pins.json?since=") + sequence;
+	client.begin(url + "&timeout=0");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.json with the current sequence did not return http status code 200.");
+	pins_json = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(pins_json.indexOf("\"pins\": {}") >= 0,
+			"pins.json with the current sequence returned pins.");
+
+	// Make sure a long-poll request returns after its timeout if nothing changes.
+	uint64_t start = millis();
+	client.begin(url + "&timeout=1");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"A long-poll request to /pins.json did not return http status code 200.");
+	pins_json = client.getString();
+	client.end();
+	TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(1000, millis() - start,
+			"A long-poll request to /pins.json returned before its timeout.");
+	TEST_ASSERT_TRUE_MESSAGE(pins_json.indexOf("\"pins\": {}") >= 0,
+			"A timed out long-poll request returned pins.");
+
+	// Make sure a long-poll request returns the changed pin.
+	WiFiClient poll;
+	TEST_ASSERT_TRUE_MESSAGE(poll.connect("localhost", 80),
+			"Failed to connect to the web server.");
+	poll.print((String("GET /pins.json?since=") + sequence
+					+ "&timeout=10 HTTP/1.1\r\nHost: localhost\r\n\r\n").c_str());
+	delay(100);
+	digitalWrite(OUT_PIN, HIGH);
+	String received = read_until(poll, "}}");
+	poll.stop();
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"state\": \"High\"") >= 0,
+			"A long-poll request did not return the changed pin.");
+
+	// Make sure a sequence number from before a reboot returns all pins immediately.
+	start = millis();
+	client.begin(String("http://localhost/pins.json?since=")
+			+ (gpio_handler.getChangeSequence() + 1000) + "&timeout=5");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.json with a future sequence did not return http status code 200.");
+	pins_json = client.getString();
+	client.end();
+	TEST_ASSERT_LESS_THAN_MESSAGE(1000, millis() - start,
+			"pins.json with a future sequence waited for a change.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			pins_json.indexOf(String("\"") + IN_PIN + "\": {") >= 0,
+			"pins.json with a future sequence did not contain the registered pin.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			pins_json.indexOf(String("\"sequence\": ") + gpio_handler.getChangeSequence()) >= 0,
+			"pins.json with a future sequence did not return the current sequence number.");
+
+	// Make sure an invalid sequence number is rejected.
+	client.begin("http://localhost/pins.json?since=abc");
+	TEST_ASSERT_EQUAL_MESSAGE(400, client.GET(),
+			"Get /pins.json with an invalid sequence did not return http status code 400.");
+	client.end();
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+std::string get_binary_body() {
+	const int size = client.getSize();
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, size,
+			"The response didn't have a content length.");
+	std::string body(size, 0);
+	TEST_ASSERT_EQUAL_MESSAGE(size,
+			client.getStream().readBytes((uint8_t*) &body[0], size),
+			"Failed to read the full response body.");
+	return body;
+}
+
+void check_cbor_pins(const std::string &cbor, const bool compact) {
+	size_t pos = 0;
+	uint64_t argument = 0;
+	TEST_ASSERT_EQUAL_MESSAGE(5, read_cbor_head(cbor, pos, argument),
+			"pins.cbor wasn't a CBOR map.");
+	TEST_ASSERT_EQUAL_MESSAGE(3, argument,
+			"pins.cbor didn't contain exactly three keys.");
+	TEST_ASSERT_EQUAL_MESSAGE(CBOR_KEY_SEQUENCE, read_cbor_unsigned(cbor, pos),
+			"The first key of pins.cbor wasn't the sequence number.");
+	TEST_ASSERT_EQUAL_MESSAGE(gpio_handler.getChangeSequence(),
+			read_cbor_unsigned(cbor, pos),
+			"pins.cbor contained the wrong sequence number.");
+	TEST_ASSERT_EQUAL_MESSAGE(CBOR_KEY_CONFIG, read_cbor_unsigned(cbor, pos),
+			"The second key of pins.cbor wasn't the config version.");
+	TEST_ASSERT_EQUAL_MESSAGE(gpio_handler.getConfigVersion(),
+			read_cbor_unsigned(cbor, pos),
+			"pins.cbor contained the wrong config version.");
+	TEST_ASSERT_EQUAL_MESSAGE(CBOR_KEY_PINS, read_cbor_unsigned(cbor, pos),
+			"The third key of pins.cbor wasn't the pins.");
+	TEST_ASSERT_EQUAL_MESSAGE(4, read_cbor_head(cbor, pos, argument),
+			"The pins of pins.cbor weren't an array.");
+	TEST_ASSERT_EQUAL_MESSAGE(1, argument,
+			"pins.cbor didn't contain exactly one pin.");
+
+	TEST_ASSERT_EQUAL_MESSAGE(5, read_cbor_head(cbor, pos, argument),
+			"The pin in pins.cbor wasn't a map.");
+	TEST_ASSERT_EQUAL_MESSAGE(compact ? 3 : 5, argument,
+			"The pin in pins.cbor had the wrong number of keys.");
+	TEST_ASSERT_EQUAL_MESSAGE(CBOR_PIN_NUMBER, read_cbor_unsigned(cbor, pos),
+			"The first key of the pin in pins.cbor wasn't its number.");
+	TEST_ASSERT_EQUAL_MESSAGE(IN_PIN, read_cbor_unsigned(cbor, pos),
+			"The pin in pins.cbor had the wrong number.");
+	TEST_ASSERT_EQUAL_MESSAGE(CBOR_PIN_STATE, read_cbor_unsigned(cbor, pos),
+			"The second key of the pin in pins.cbor wasn't its state.");
+	TEST_ASSERT_EQUAL_MESSAGE(7, read_cbor_head(cbor, pos, argument),
+			"The state of the pin in pins.cbor wasn't a boolean.");
+	TEST_ASSERT_EQUAL_MESSAGE(20, argument,
+			"The state of the pin in pins.cbor wasn't false.");
+	TEST_ASSERT_EQUAL_MESSAGE(CBOR_PIN_CHANGES, read_cbor_unsigned(cbor, pos),
+			"The third key of the pin in pins.cbor wasn't its changes.");
+	read_cbor_unsigned(cbor, pos);
+	if (!compact) {
+		TEST_ASSERT_EQUAL_MESSAGE(CBOR_PIN_PULL_UP,
+				read_cbor_unsigned(cbor, pos),
+				"The fourth key of the pin in pins.cbor wasn't its resistor.");
+		TEST_ASSERT_EQUAL_MESSAGE(7, read_cbor_head(cbor, pos, argument),
+				"The resistor of the pin in pins.cbor wasn't a boolean.");
+		TEST_ASSERT_EQUAL_MESSAGE(CBOR_PIN_NAME, read_cbor_unsigned(cbor, pos),
+				"The fifth key of the pin in pins.cbor wasn't its name.");
+		TEST_ASSERT_EQUAL_MESSAGE(3, read_cbor_head(cbor, pos, argument),
+				"The name of the pin in pins.cbor wasn't a text string.");
+		TEST_ASSERT_EQUAL_STRING_MESSAGE("Test Pin",
+				cbor.substr(pos, argument).c_str(),
+				"The pin in pins.cbor had the wrong name.");
+		pos += argument;
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(cbor.length(), pos,
+			"pins.cbor contained data after the pins.");
+}
+
+void test_pins_cbor() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.checkPins();
+
+	// Make sure pins.cbor contains the full pins.
+	const char *headerkeys[] = { "Content-Type", "ETag" };
+	const size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
+	client.begin("http://localhost/pins.cbor");
+	client.collectHeaders(headerkeys, headerkeyssize);
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.cbor did not return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("application/cbor",
+			client.header("Content-Type").c_str(),
+			"Get /pins.cbor did not return content type application/cbor.");
+	const String etag = client.header("ETag");
+	const std::string full = get_binary_body();
+	client.end();
+	check_cbor_pins(full, false);
+
+	// Make sure the names are omitted if the client has the current config version.
+	client.begin(
+			String("http://localhost/pins.cbor?config=")
+					+ gpio_handler.getConfigVersion());
+	client.collectHeaders(headerkeys, headerkeyssize);
+	client.addHeader("If-None-Match", etag);
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.cbor with the current config version did not return http status code 200.");
+	TEST_ASSERT_FALSE_MESSAGE(etag == client.header("ETag"),
+			"Get /pins.cbor returned the same ETag with and without names.");
+	const std::string compact = get_binary_body();
+	client.end();
+	check_cbor_pins(compact, true);
+	TEST_ASSERT_LESS_THAN_MESSAGE(full.length(), compact.length(),
+			"pins.cbor without names wasn't shorter than with names.");
+
+	// Make sure an outdated config version returns the names.
+	client.begin(
+			String("http://localhost/pins.cbor?config=")
+					+ (gpio_handler.getConfigVersion() - 1));
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.cbor with an old config version did not return http status code 200.");
+	check_cbor_pins(get_binary_body(), false);
+	client.end();
+
+	// Make sure pins.json returns CBOR if the client asks for it.
+	client.begin("http://localhost/pins.json");
+	client.collectHeaders(headerkeys, headerkeyssize);
+	client.addHeader("Accept", "application/cbor");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /pins.json accepting CBOR did not return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("application/cbor",
+			client.header("Content-Type").c_str(),
+			"Get /pins.json accepting CBOR did not return content type application/cbor.");
+	TEST_ASSERT_TRUE_MESSAGE(full == get_binary_body(),
+			"Get /pins.json accepting CBOR didn't return the same content as pins.cbor.");
+	client.end();
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_events() {
+	// Make sure no changes from previous tests are still queued.
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.checkPins();
+	web_dispatcher.dispatch();
+	web_server.handle();
+
+	WiFiClient events;
+	TEST_ASSERT_TRUE_MESSAGE(events.connect("localhost", 80),
+			"Failed to connect to the web server.");
+	events.print("GET /events HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+	// Make sure the stream starts with the current state of the pin.
+	String received;
+	uint64_t start = millis();
+	while (received.indexOf("\"state\": \"Low\"") < 0 && millis() - start < 2000) {
+		while (events.available()) {
+			received += (char) events.read();
+		}
+		delay(10);
+	}
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("text/event-stream") >= 0,
+			"Get /events did not return content type text/event-stream.");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("event: pin") >= 0,
+			"Get /events did not send the initial pin state.");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"state\": \"Low\"") >= 0,
+			"The initial pin event did not contain the current pin state.");
+
+	// Make sure a state change is sent to the client.
+	received = "";
+	digitalWrite(OUT_PIN, HIGH);
+	start = millis();
+	while (received.indexOf("\"state\": \"High\"") < 0 && millis() - start < 2000) {
+		gpio_handler.checkPins();
+		web_dispatcher.dispatch();
+		web_server.handle();
+		while (events.available()) {
+			received += (char) events.read();
+		}
+		delay(10);
+	}
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"state\": \"High\"") >= 0,
+			"The pin state change was not sent to the event stream client.");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"changes\": 1") >= 0,
+			"The pin event did not contain the number of changes.");
+
+	// Make sure unregistering the pin sends a config event.
+	received = "";
+	gpio_handler.unregisterGPIO(IN_PIN);
+	start = millis();
+	while (received.indexOf("event: config") < 0 && millis() - start < 2000) {
+		web_dispatcher.dispatch();
+		web_server.handle();
+		while (events.available()) {
+			received += (char) events.read();
+		}
+		delay(10);
+	}
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("event: config") >= 0,
+			"Unregistering a pin did not send a config event.");
+
+	events.stop();
+}
+
+void send_ws_text(WiFiClient &ws_client, const char *message) {
+	const size_t length = strlen(message);
+	const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+	ws_client.write((uint8_t) 0x81);
+	ws_client.write((uint8_t) (0x80 | length));
+	ws_client.write(mask, 4);
+	for (size_t i = 0; i < length; i++) {
+		ws_client.write((uint8_t) (message[i] ^ mask[i % 4]));
+	}
+}
+
+String read_until(WiFiClient &ws_client, const char *expected,
+		const uint32_t timeout) {
+	String received;
+	const uint64_t start = millis();
+	while (received.indexOf(expected) < 0 && millis() - start < timeout) {
+		gpio_handler.checkPins();
+		web_dispatcher.dispatch();
+		web_server.handle();
+		while (ws_client.available()) {
+			received += (char) ws_client.read();
+		}
+		delay(10);
+	}
+	return received;
+}
+
+void test_web_socket() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.checkPins();
+	web_dispatcher.dispatch();
+	web_server.handle();
+
+	// Make sure the web socket handshake succeeds.
+	WiFiClient ws_client;
+	TEST_ASSERT_TRUE_MESSAGE(ws_client.connect("localhost", 80),
+			"Failed to connect to the web server.");
+	ws_client.print("GET /ws HTTP/1.1\r\nHost: localhost\r\n"
+			"Upgrade: websocket\r\nConnection: Upgrade\r\n"
+			"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+			"Sec-WebSocket-Version: 13\r\n\r\n");
+	String received = read_until(ws_client, "\r\n\r\n");
+	TEST_ASSERT_TRUE_MESSAGE(received.startsWith("HTTP/1.1 101"),
+			"Get /ws did not return http status code 101.");
+
+	// Make sure subscribing sends the current pin state.
+	send_ws_text(ws_client, (String("subscribe ") + IN_PIN).c_str());
+	received = read_until(ws_client, "\"state\": \"Low\"");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"state\": \"Low\"") >= 0,
+			"Subscribing to a pin did not send its current state.");
+
+	// Make sure the client shows up in the metrics.
+	client.begin("http://localhost/metrics");
+	client.GET();
+	TEST_ASSERT_TRUE_MESSAGE(
+			client.getString().indexOf("esp_ws_client_queue_length{client=") >= 0,
+			"The metrics endpoint did not contain the web socket client queue length.");
+	client.end();
+
+	// Make sure a state change of the subscribed pin is sent.
+	digitalWrite(OUT_PIN, HIGH);
+	received = read_until(ws_client, "\"state\": \"High\"");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"state\": \"High\"") >= 0,
+			"The state change of a subscribed pin was not sent.");
+
+	// Make sure changes of unsubscribed pins aren't sent.
+	send_ws_text(ws_client, (String("unsubscribe ") + IN_PIN).c_str());
+	// Give the server some time to handle the command.
+	read_until(ws_client, "\"pin\"", 100);
+	digitalWrite(OUT_PIN, LOW);
+	received = read_until(ws_client, "\"state\": \"Low\"", 500);
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"pin\"") < 0,
+			"The state change of an unsubscribed pin was sent.");
+
+	// Make sure invalid commands return an error.
+	send_ws_text(ws_client, "subscribe 1,,2");
+	received = read_until(ws_client, "error");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("error") >= 0,
+			"An invalid pin list did not return an error.");
+
+	ws_client.stop();
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_api_wait() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.checkPins();
+	web_dispatcher.dispatch();
+	web_server.handle();
+
+	// Make sure an invalid pin list is rejected.
+	client.begin("http://localhost/api/wait?pins=1,,2");
+	TEST_ASSERT_EQUAL_MESSAGE(400, client.GET(),
+			"Get /api/wait with an invalid pin list didn't return http status code 400.");
+	client.end();
+
+	// Make sure a request without a change returns when the timeout expires.
+	client.begin("http://localhost/api/wait?timeout=0");
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /api/wait with a timeout of zero didn't return http status code 200.");
+	String body = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(body.indexOf("\"timeout\": true") >= 0,
+			"Get /api/wait without a change didn't report a timeout.");
+
+	// Make sure a waiting request is parked until the selected pin changes.
+	WiFiClient waiting;
+	TEST_ASSERT_TRUE_MESSAGE(waiting.connect("localhost", 80),
+			"Failed to connect to the web server.");
+	waiting.print(
+			String("GET /api/wait?pins=") + IN_PIN
+					+ "&timeout=10 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	const uint64_t start = millis();
+	while (web_server.getWaitRegistry().getWaiterCount() == 0
+			&& millis() - start < 2000) {
+		delay(10);
+	}
+	TEST_ASSERT_EQUAL_MESSAGE(1, web_server.getWaitRegistry().getWaiterCount(),
+			"The request to /api/wait wasn't parked.");
+
+	digitalWrite(OUT_PIN, HIGH);
+	String received = read_until(waiting, "}}");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"timeout\": false") >= 0,
+			"The pin change didn't wake the waiting request.");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"state\": \"High\"") >= 0,
+			"The response to the waiting request didn't contain the new pin state.");
+	TEST_ASSERT_TRUE_MESSAGE(received.indexOf("\"changes\": 1") >= 0,
+			"The response to the waiting request didn't contain the number of changes.");
+	waiting.stop();
+
+	delay(50);
+	TEST_ASSERT_EQUAL_MESSAGE(0, web_server.getWaitRegistry().getWaiterCount(),
+			"The answered request wasn't removed from the wait registry.");
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_wait_wraparound() {
+	WaitRegistry registry(1);
+	uint8_t buffer[256];
+
+	// Start the request 100ms before millis wraps around, with a timeout of one second.
+	const uint32_t start = UINT32_MAX - 99;
+	std::shared_ptr<WaitRegistry::waiter> w = registry.add(gpio_handler,
+			1ULL << IN_PIN, 1000, start);
+	TEST_ASSERT_TRUE_MESSAGE(w != NULL, "Adding a waiting request failed.");
+
+	// Make sure the request keeps waiting before and after the wraparound.
+	TEST_ASSERT_EQUAL_MESSAGE(RESPONSE_TRY_AGAIN,
+			registry.fill(w, buffer, sizeof(buffer), start + 50),
+			"The request stopped waiting before the wraparound.");
+	TEST_ASSERT_EQUAL_MESSAGE(RESPONSE_TRY_AGAIN,
+			registry.fill(w, buffer, sizeof(buffer), 800),
+			"The request stopped waiting after the wraparound, before its timeout.");
+
+	// Make sure the request times out after the wraparound.
+	const size_t length = registry.fill(w, buffer, sizeof(buffer), 901);
+	TEST_ASSERT_NOT_EQUAL_MESSAGE(RESPONSE_TRY_AGAIN, length,
+			"The request didn't time out after the wraparound.");
+	TEST_ASSERT_GREATER_THAN_MESSAGE(0, length,
+			"The timed out request didn't send a response.");
+	const std::string body((const char*) buffer, length);
+	TEST_ASSERT_TRUE_MESSAGE(body.find("\"timeout\": true") != std::string::npos,
+			"The timed out request didn't report a timeout.");
+	TEST_ASSERT_EQUAL_MESSAGE(0, registry.getWaiterCount(),
+			"The timed out request wasn't removed from the wait registry.");
+}
+
+void test_api_stats() {
+	pinMode(OUT_PIN, OUTPUT);
+	digitalWrite(OUT_PIN, LOW);
+	gpio_handler.unregisterGPIO(IN_PIN);
+
+	// Make sure a request without a valid pin is rejected.
+	client.begin("http://localhost/api/stats?pin=abc");
+	TEST_ASSERT_EQUAL_MESSAGE(400, client.GET(),
+			"Get /api/stats with an invalid pin didn't return http status code 400.");
+	client.end();
+
+	// Make sure a request for an unwatched pin returns not found.
+	client.begin(String("http://localhost/api/stats?pin=") + IN_PIN);
+	TEST_ASSERT_EQUAL_MESSAGE(404, client.GET(),
+			"Get /api/stats for an unwatched pin didn't return http status code 404.");
+	client.end();
+
+	// Make sure the edges of a watched pin are counted.
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	for (uint8_t i = 0; i < 3; i++) {
+		digitalWrite(OUT_PIN, HIGH);
+		delay(20);
+		digitalWrite(OUT_PIN, LOW);
+		delay(20);
+	}
+
+	client.begin(String("http://localhost/api/stats?pin=") + IN_PIN + "&window=30");
+	const char *headerkeys[] = { "Content-Type" };
+	client.collectHeaders(headerkeys, sizeof(headerkeys) / sizeof(char*));
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /api/stats for a watched pin didn't return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("application/json",
+			client.header("Content-Type").c_str(),
+			"Get /api/stats didn't return content type application/json.");
+	const String body = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(body.indexOf("\"rising\": 3") >= 0,
+			"Get /api/stats returned the wrong number of rising edges.");
+	TEST_ASSERT_TRUE_MESSAGE(body.indexOf("\"falling\": 3") >= 0,
+			"Get /api/stats returned the wrong number of falling edges.");
+	TEST_ASSERT_TRUE_MESSAGE(body.indexOf("\"duty_cycle\": ") >= 0,
+			"Get /api/stats didn't return the duty cycle.");
+
+	gpio_handler.unregisterGPIO(IN_PIN);
+}
+
+void test_history_endpoints() {
+	SPIFFS.begin(true);
+	if (SPIFFS.exists(web_history_path)) {
+		SPIFFS.remove(web_history_path);
+	}
+
+	StorageHandler *previous = gpio_handler.getStorageHandler();
+	StorageHandler storage(SPIFFS, NULL, web_history_path);
+	gpio_handler.setStorageHandler(&storage, false);
+
+	PinHistory &history = storage.getHistory();
+	const uint32_t start = 1700000000;
+	for (uint32_t i = 0; i < 10; i++) {
+		TEST_ASSERT_MESSAGE(history.beginRecord(start + i * 60, 1),
+				"Starting a history record failed.");
+		history.appendPin(IN_PIN, i % 2, i, i * 1000);
+		history.endRecord();
+	}
+	TEST_ASSERT_MESSAGE(history.flush(), "Flushing the pin history failed.");
+
+	const String range = String("from=") + String(start) + "&to=" + String(start + 599)
+			+ "&pin=" + IN_PIN;
+	const char *headerkeys[] = { "Content-Type" };
+
+	// Make sure /history.csv streams a csv header followed by every record.
+	client.begin(String("http://localhost/history.csv?") + range);
+	client.collectHeaders(headerkeys, sizeof(headerkeys) / sizeof(char*));
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /history.csv didn't return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("text/csv",
+			client.header("Content-Type").c_str(),
+			"Get /history.csv didn't return content type text/csv.");
+	String body = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(body.startsWith("Time,Pin,State,Changes,High Time\n"),
+			"Get /history.csv didn't start with the csv header.");
+	TEST_ASSERT_TRUE_MESSAGE(
+			body.indexOf(String(start + 540) + "," + IN_PIN + ",1,9,9000\n") >= 0,
+			"Get /history.csv didn't contain the last record.");
+
+	// Make sure /api/history streams a csv header by default.
+	client.begin(String("http://localhost/api/history?") + range);
+	client.collectHeaders(headerkeys, sizeof(headerkeys) / sizeof(char*));
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /api/history didn't return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("text/csv",
+			client.header("Content-Type").c_str(),
+			"Get /api/history didn't return content type text/csv.");
+	body = client.getString();
+	client.end();
+	TEST_ASSERT_TRUE_MESSAGE(
+			body.startsWith("Time,Pin,State,Records,Changes,High Time,Min Changes,Max Changes\n"),
+			"Get /api/history didn't start with the csv header.");
+
+	// Make sure the ndjson export contains one object per point.
+	client.begin(String("http://localhost/api/history?") + range
+			+ "&points=5&format=ndjson");
+	client.collectHeaders(headerkeys, sizeof(headerkeys) / sizeof(char*));
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
+			"Get /api/history as ndjson didn't return http status code 200.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("application/x-ndjson",
+			client.header("Content-Type").c_str(),
+			"Get /api/history as ndjson didn't return content type application/x-ndjson.");
+	body = client.getString();
+	client.end();
+	const std::unique_ptr<std::vector<std::string>> lines = split_lines(body.c_str());
+	TEST_ASSERT_EQUAL_MESSAGE(5, lines->size(),
+			"Get /api/history as ndjson didn't return one line per point.");
+	for (const std::string &line : *lines) {
+		TEST_ASSERT_EQUAL_MESSAGE(0, line.find("{\"time\": "),
+				"An ndjson line didn't start with the point time.");
+		TEST_ASSERT_TRUE_MESSAGE(line.find("\"max_changes\": ") != std::string::npos,
+				"An ndjson line didn't contain the max changes.");
+		TEST_ASSERT_EQUAL_MESSAGE('}', line[line.length() - 1],
+				"An ndjson line wasn't a single object.");
+	}
+
+	// Make sure invalid ranges are rejected by both endpoints.
+	const char *invalid[] = { "from=abc", "to=-1", "pin=x", "pin=300",
+			"from=1700000600&to=1700000000" };
+	for (const char *params : invalid) {
+		client.begin(String("http://localhost/history.csv?") + params);
+		TEST_ASSERT_EQUAL_MESSAGE(400, client.GET(),
+				"Get /history.csv with an invalid range didn't return http status code 400.");
+		client.end();
+		client.begin(String("http://localhost/api/history?") + params);
+		TEST_ASSERT_EQUAL_MESSAGE(400, client.GET(),
+				"Get /api/history with an invalid range didn't return http status code 400.");
+		client.end();
+	}
+
+	client.begin("http://localhost/api/history?points=many");
+	TEST_ASSERT_EQUAL_MESSAGE(400, client.GET(),
+			"Get /api/history with an invalid point count didn't return http status code 400.");
+	client.end();
+
+	gpio_handler.setStorageHandler(previous, false);
+	SPIFFS.remove(web_history_path);
+}
+
 void test_index_html() {
 	// Make sure pins aren't still registered from failed tests.
 	gpio_handler.unregisterGPIO(IN_PIN_2);
 	gpio_handler.unregisterGPIO(IN_PIN);
 
-	// Make sure /index.html returns content type text/html and status code 200.
+	// Make sure /index.html returns a gzip compressed static page with an ETag.
 	const char *url = "http://localhost/index.html";
 	client.begin(url);
-	const char *headerkeys[] = { "Content-Type" };
+	const char *headerkeys[] = { "Content-Type", "Content-Encoding", "ETag",
+			"Cache-Control" };
 	const size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
 	client.collectHeaders(headerkeys, headerkeyssize);
 	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
@@ -612,20 +1479,23 @@ void test_index_html() {
 	TEST_ASSERT_EQUAL_STRING_MESSAGE("text/html",
 			client.header("Content-Type").c_str(),
 			"Get /index.html did not return content type text/html.");
-
-	// Make sure /index.html without a registered pin doesn't return an empty page.
-	// Also make sure the page contains the no registered pin message.
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("gzip",
+			client.header("Content-Encoding").c_str(),
+			"Get /index.html was not gzip compressed.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("no-cache",
+			client.header("Cache-Control").c_str(),
+			"Get /index.html didn't require revalidation.");
+	const String etag = client.header("ETag");
+	TEST_ASSERT_TRUE_MESSAGE(etag.length() > 0,
+			"Get /index.html did not return an ETag.");
 	std::unique_ptr<String> index_page(new String(client.getString()));
 	client.end();
 	TEST_ASSERT_GREATER_THAN_MESSAGE(0, index_page->length(),
 			"The page returned by a get request to /index.html is empty.");
-	TEST_ASSERT_NOT_EQUAL_MESSAGE(std::string::npos,
-			std::string(index_page->c_str()).find(
-					"Currently no pin is registered to be watched."),
-			"Index page without a registered pin doesn't contain the no registered pin message.");
 
 	// Test whether / returns status code 200 and content type text/html.
 	client.begin("http://localhost/");
+	client.collectHeaders(headerkeys, headerkeyssize);
 	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
 			"Get /index.html did not return status code 200.");
 	TEST_ASSERT_EQUAL_STRING_MESSAGE("text/html",
@@ -638,48 +1508,29 @@ void test_index_html() {
 			"Get / and Get /index.html did not return the same content.");
 	client.end();
 
-	// Check generated pin block.
+	// Make sure the page doesn't depend on the watched pins.
 	pinMode(OUT_PIN, OUTPUT);
 	digitalWrite(OUT_PIN, LOW);
 	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
 	client.begin(url);
+	client.collectHeaders(headerkeys, headerkeyssize);
 	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
 			"Get /index.html did not return status code 200 with a registered pin.");
-	*index_page = client.getString();
-	client.end();
-	check_index_pin(index_page->c_str(), IN_PIN, "Test Pin", false, false, 0);
-
-	// Test pin block after a pin state change.
-	digitalWrite(OUT_PIN, HIGH);
-	client.begin(url);
-	client.GET();
-	*index_page = client.getString();
-	client.end();
-	check_index_pin(index_page->c_str(), IN_PIN, "Test Pin", false, true, 1);
-
-	// Test pin block after a gpiohandler update.
-	gpio_handler.updateGPIO(IN_PIN, "Test Pin Name", true);
-	client.begin(url);
-	client.GET();
-	*index_page = client.getString();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(etag.c_str(), client.header("ETag").c_str(),
+			"Registering a pin changed the ETag of /index.html.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(index_page->c_str(),
+			client.getString().c_str(),
+			"Registering a pin changed the content of /index.html.");
 	client.end();
-	check_index_pin(index_page->c_str(), IN_PIN, "Test Pin Name", true, true,
-			1);
 
-	// Test two pin blocks.
-	digitalWrite(OUT_PIN, LOW);
-	gpio_handler.registerGPIO(IN_PIN_2, "Some other test pin", true);
+	// Make sure requesting it again with the ETag returns not modified.
 	client.begin(url);
-	client.GET();
-	*index_page = client.getString();
+	client.addHeader("If-None-Match", etag);
+	TEST_ASSERT_EQUAL_MESSAGE(304, client.GET(),
+			"Get /index.html with a matching ETag did not return http status code 304.");
 	client.end();
-	check_index_pin(index_page->c_str(), IN_PIN, "Test Pin Name", true, false,
-			2);
-	check_index_pin(index_page->c_str(), IN_PIN_2, "Some other test pin", true,
-			true, 0);
 
 	// Unregister pins from the gpiohandler.
-	gpio_handler.unregisterGPIO(IN_PIN_2);
 	gpio_handler.unregisterGPIO(IN_PIN);
 }
 
@@ -688,10 +1539,11 @@ void test_settings_html() {
 	gpio_handler.unregisterGPIO(IN_PIN_2);
 	gpio_handler.unregisterGPIO(IN_PIN);
 
-	// Make sure /settings.html returns status code 200 and content type text/html.
+	// Make sure /settings.html returns a gzip compressed static page with an ETag.
 	const char *url = "http://localhost/settings.html";
 	client.begin(url);
-	const char *headerkeys[] = { "Content-Type" };
+	const char *headerkeys[] = { "Content-Type", "Content-Encoding", "ETag",
+			"Cache-Control" };
 	const size_t headerkeyssize = sizeof(headerkeys) / sizeof(char*);
 	client.collectHeaders(headerkeys, headerkeyssize);
 	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
@@ -699,68 +1551,48 @@ void test_settings_html() {
 	TEST_ASSERT_EQUAL_STRING_MESSAGE("text/html",
 			client.header("Content-Type").c_str(),
 			"Get /settings.html did not return content type text/html.");
-
-	// Make sure /settings.html without a registered pin doesn't return an empty page.
-	// Also make sure the page contains the no registered pin message.
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("gzip",
+			client.header("Content-Encoding").c_str(),
+			"Get /settings.html was not gzip compressed.");
+	TEST_ASSERT_EQUAL_STRING_MESSAGE("no-cache",
+			client.header("Cache-Control").c_str(),
+			"Get /settings.html didn't require revalidation.");
+	const String etag = client.header("ETag");
 	std::unique_ptr<String> settings_page(new String(client.getString()));
 	client.end();
 	TEST_ASSERT_GREATER_THAN_MESSAGE(0, settings_page->length(),
 			"The page returned by a get request to /settings.html is empty.");
-	TEST_ASSERT_NOT_EQUAL_MESSAGE(std::string::npos,
-			std::string(settings_page->c_str()).find(
-					"Currently no pin is registered to be watched."),
-			"Settings page without a registered pin doesn't contain the no registered pin message.");
 
-	// Test generated pin blocks.
+	// Make sure the page doesn't depend on the watched pins.
 	pinMode(OUT_PIN, OUTPUT);
 	digitalWrite(OUT_PIN, LOW);
-	gpio_handler.registerGPIO(IN_PIN, "Test Pin", false);
+	gpio_handler.registerGPIO(IN_PIN, "Test Pin Name", true);
 	client.begin(url);
+	client.collectHeaders(headerkeys, headerkeyssize);
 	TEST_ASSERT_EQUAL_MESSAGE(200, client.GET(),
 			"Get /settings.html did not return status code 200 with a registered pin.");
-	*settings_page = client.getString();
-	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin", false, false,
-			0);
-
-	// Test changed pin block.
-	digitalWrite(OUT_PIN, HIGH);
-	client.begin(url);
-	client.GET();
-	*settings_page = client.getString();
-	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin", false, true,
-			1);
-
-	// Test pin block after a gpiohandler update.
-	gpio_handler.updateGPIO(IN_PIN, "Test Pin Name", true);
-	client.begin(url);
-	client.GET();
-	*settings_page = client.getString();
+	TEST_ASSERT_EQUAL_STRING_MESSAGE(etag.c_str(), client.header("ETag").c_str(),
+			"Registering a pin changed the ETag of /settings.html.");
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			true, 1);
 
-	// Test two pin blocks.
-	digitalWrite(OUT_PIN, LOW);
-	gpio_handler.registerGPIO(IN_PIN_2, "Some other test pin", true);
+	// Make sure there isn't a message if nothing was changed.
 	client.begin(url);
-	client.GET();
+	client.addHeader("Content-Type", "application/x-www-form-urlencoded");
+	std::unique_ptr<std::ostringstream> post_body(new std::ostringstream());
+	*post_body << "name=Test+Pin+Name&pin=";
+	*post_body << (uint16_t) IN_PIN;
+	*post_body << "&resistor=pull_up&action=cancel";
+	TEST_ASSERT_EQUAL_MESSAGE(200, client.POST(post_body->str().c_str()),
+			"POST /settings.html canceling a change didn't return status code 200.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Some other test pin",
-			true, true, 0);
-
-	// Make sure there isn't a message by default.
 	check_message(settings_page->c_str(), "$message_type", "$message", true);
 
 	// Test registering a pin using a post request.
 	gpio_handler.unregisterGPIO(IN_PIN_2);
 	client.begin(url);
 	client.addHeader("Content-Type", "application/x-www-form-urlencoded");
-	std::unique_ptr<std::ostringstream> post_body(new std::ostringstream());
+	*post_body = std::ostringstream();
 	*post_body << "name=Test&pin=";
 	*post_body << (uint16_t) IN_PIN_2;
 	*post_body << "&resistor=pull_down&action=add";
@@ -768,10 +1600,8 @@ void test_settings_html() {
 			"POST /settings.html registering a pin didn't return status code 200.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test", false, false,
-			0);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test", false);
 	check_message(settings_page->c_str(), "success",
 			"Successfully added Pin to be watched.", false);
 
@@ -782,10 +1612,8 @@ void test_settings_html() {
 			"POST /settings.html registering an already registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test", false, false,
-			0);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test", false);
 	std::unique_ptr<std::ostringstream> str(new std::ostringstream());
 	*str << "Couldn't add pin ";
 	*str << (uint16_t) IN_PIN_2;
@@ -803,10 +1631,8 @@ void test_settings_html() {
 			"POST /settings.html registering an invalid pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test", false, false,
-			0);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test", false);
 	*str = std::ostringstream();
 	*str << "Couldn't add pin ";
 	*str << 24;
@@ -824,10 +1650,8 @@ void test_settings_html() {
 			"POST /settings.html registering an invalid pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test", false, false,
-			0);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test", false);
 	*str = std::ostringstream();
 	*str << "Couldn't add pin ";
 	*str << 10;
@@ -845,10 +1669,8 @@ void test_settings_html() {
 			"POST /settings.html updating a pin didn't return status code 200.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test Pin", true, true,
-			1);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test Pin", true);
 	check_message(settings_page->c_str(), "success",
 			"Successfully updated watched Pin.", false);
 
@@ -863,10 +1685,8 @@ void test_settings_html() {
 			"POST /settings.html updating a not registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test Pin", true, true,
-			1);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test Pin", true);
 	*str = std::ostringstream();
 	*str << "Couldn't update pin ";
 	*str << (uint16_t) OUT_PIN;
@@ -884,10 +1704,8 @@ void test_settings_html() {
 			"POST /settings.html updating a not registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test Pin", true, true,
-			1);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test Pin", true);
 	*str = std::ostringstream();
 	*str << "Couldn't update pin ";
 	*str << 24;
@@ -905,10 +1723,8 @@ void test_settings_html() {
 			"POST /settings.html updating a not registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
-	check_settings_pin(settings_page->c_str(), IN_PIN_2, "Test Pin", true, true,
-			1);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
+	check_watched_pin(IN_PIN_2, "Test Pin", true);
 	*str = std::ostringstream();
 	*str << "Couldn't update pin ";
 	*str << 10;
@@ -926,8 +1742,7 @@ void test_settings_html() {
 			"POST /settings.html removing a registered pin didn't return status code 200.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
 	check_message(settings_page->c_str(), "success",
 			"Successfully removed watched Pin.", false);
 
@@ -942,8 +1757,7 @@ void test_settings_html() {
 			"POST /settings.html removing a not registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
 	*str = std::ostringstream();
 	*str << "Couldn't delete pin ";
 	*str << (uint16_t) IN_PIN_2;
@@ -961,8 +1775,7 @@ void test_settings_html() {
 			"POST /settings.html removing a not registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
 	*str = std::ostringstream();
 	*str << "Couldn't delete pin ";
 	*str << 24;
@@ -980,8 +1793,7 @@ void test_settings_html() {
 			"POST /settings.html removing a not registered pin didn't return status code 400.");
 	*settings_page = client.getString();
 	client.end();
-	check_settings_pin(settings_page->c_str(), IN_PIN, "Test Pin Name", true,
-			false, 2);
+	check_watched_pin(IN_PIN, "Test Pin Name", true);
 	*str = std::ostringstream();
 	*str << "Couldn't delete pin ";
 	*str << 10;
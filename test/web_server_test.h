@@ -9,6 +9,7 @@
 #define TEST_WEB_SERVER_TEST_H_
 
 #include "WebServerHandler.h"
+#include "ChangeDispatcher.h"
 #include <HTTPClient.h>
 
 /**
@@ -16,6 +17,11 @@
  */
 extern WebServerHandler web_server;
 
+/**
+ * The dispatcher forwarding the pin changes to the tested web server.
+ */
+extern ChangeDispatcher web_dispatcher;
+
 /**
  * The http client used to request pages from the web server.
  */
@@ -77,32 +83,14 @@ void check_index_pin_line(const std::string *line, const char *line_type, const
 void check_index_pin_line(const std::string *line, const char *line_type, const char *value);
 
 /**
- * Tests whether the pin section in the index.html page for the given pin was generated correctly.
+ * Checks whether the given pin is being watched with the given configuration.
  *
- * @param index_page	The page returned by a get request to index.html.
- * @param pin_nr		The pin for which to check the pin section.
- * @param pin_name		The name of the pin to check.
- * @param pull_up		Whether the pin has a pull up resistor or a pull down resistor.
- * @param state			Whether the pin is currently high.
- * @param changes		The number of state changes for the pin to check.
- */
-void check_index_pin(const char *index_page, const uint8_t pin_nr,
-		const char *pin_name, const bool pull_up, const bool state,
-		const uint64_t changes);
-
-/**
- * Tests whether the generated pin section in the settings.html page for the given pin is correct.
- *
- * @param settings_page	The page returned by a request to /settings.html.
- * @param pin_nr		The pin for which to check the pin section.
- * @param name			The name of the pin for which to check the pin section.
- * @param pull_up		Whether the pin has a pull up resistor or a pull down resistor.
- * @param state			Whether the pin is currently high.
- * @param changes		The number of state changes for the pin to check.
- */
-void check_settings_pin(const char *settings_page, const uint8_t pin_nr,
-		const char *name, const bool pull_up, const bool state,
-		const uint64_t changes);
+ * @param pin_nr	The pin to check.
+ * @param name		The name the pin should have.
+ * @param pull_up	Whether the pin should have a pull up resistor.
+ */
+void check_watched_pin(const uint8_t pin_nr, const char *name,
+		const bool pull_up);
 
 /**
  * Checks whether a page contains the correct message on its top.
@@ -130,7 +118,7 @@ void check_delete_pin(const char *delete_page, const uint8_t pin_nr,
 		const uint64_t changes);
 
 /**
- * Initializes the WiFi interface in AP mode to test web server functionality, as well as the web server handler.
+ * Initializes the WiFi interface in AP mode to test web server functionality, as well as the web server handler and its change dispatcher.
  */
 void init_web_server();
 
@@ -139,16 +127,130 @@ void init_web_server();
  */
 void test_static_pages();
 
+/**
+ * Tests whether the static files are sent gzip compressed, with an ETag and caching headers.
+ * Also checks that a request with a matching If-None-Match header returns 304 Not Modified.
+ */
+void test_static_caching();
+
+/**
+ * Tests whether pins.json and index.html return a weak ETag,
+ * and return 304 Not Modified for a matching If-None-Match header until a pin changes.
+ */
+void test_state_etags();
+
 /**
  * Tests the functionality of the prometheus metrics endpoint.
  */
 void test_metrics_endpoint();
 
+/**
+ * Tests whether requests are counted in the request stats, and the stats are exported on the metrics endpoint.
+ */
+void test_request_stats();
+
+/**
+ * Tests whether the interrupt counters work, and the system metrics are exported on the metrics endpoint.
+ */
+void test_system_metrics();
+
+/**
+ * Tests whether requests are rejected with 503 when the admission control limits are exceeded.
+ */
+void test_admission_control();
+
+/**
+ * Tests whether pins can be read, registered, updated, and unregistered in batches using /api/pins.
+ */
+void test_api_pins();
+
 /**
  * Tests whether pins.json is generated correctly.
  */
 void test_pins_json();
 
+/**
+ * Tests whether pins.json only returns changed pins when given a sequence number,
+ * and waits for a change if there is none.
+ */
+void test_pins_json_since();
+
+/**
+ * Reads the body of the current response of the http client as binary data.
+ *
+ * @return	The response body.
+ */
+std::string get_binary_body();
+
+/**
+ * Checks whether the given pins.cbor contains exactly the test pin, with its current state.
+ *
+ * @param cbor		The content of pins.cbor.
+ * @param compact	Whether the name and resistor of the pin should be omitted.
+ */
+void check_cbor_pins(const std::string &cbor, const bool compact);
+
+/**
+ * Tests whether pins.cbor is generated correctly, and omits the pin names if requested.
+ */
+void test_pins_cbor();
+
+/**
+ * Sends a masked web socket text frame to the given client.
+ *
+ * @param ws_client	The client to send the frame with.
+ * @param message	The text message to send.
+ */
+void send_ws_text(WiFiClient &ws_client, const char *message);
+
+/**
+ * Reads data from the given client until it contains the given string, or the timeout expires.
+ * Calls WebServerHandler::handle and GPIOHandler::checkPins while waiting.
+ *
+ * @param ws_client	The client to read from.
+ * @param expected	The string to wait for.
+ * @param timeout	The max time to wait, in milliseconds.
+ * @return	All the data that was read.
+ */
+String read_until(WiFiClient &ws_client, const char *expected,
+		const uint32_t timeout = 2000);
+
+/**
+ * Tests whether the /events endpoint sends the initial pin states and debounced pin changes.
+ */
+void test_events();
+
+/**
+ * Tests whether the /ws web socket sends changes of subscribed pins, and reports its clients in the metrics.
+ */
+void test_web_socket();
+
+/**
+ * Tests whether the /api/wait endpoint parks requests until a selected pin changes, or the timeout expires.
+ */
+void test_api_wait();
+
+/**
+ * Tests whether a waiting request started just before millis wraps around still times out.
+ */
+void test_wait_wraparound();
+
+/**
+ * Tests whether the /api/stats endpoint returns the edge counts of a watched pin, and rejects invalid pins.
+ */
+void test_api_stats();
+
+/**
+ * The path of the pin history file used to test the history endpoints.
+ */
+const char web_history_path[] = "/test/web_history.bin";
+
+/**
+ * Tests whether /history.csv and /api/history stream the recorded pin history,
+ * and reject invalid time ranges.
+ */
+void test_history_endpoints();
+
 /**
  * Tests whether the index.html page contains the correct pin info.
  */